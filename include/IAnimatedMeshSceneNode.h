@@ -90,6 +90,21 @@ namespace scene
 		/** \return Frames per second played. */
 		virtual f32 getAnimationSpeed() const =0;
 
+		//! Updates the pose less often when the node is small on the screen
+		/** The pose is only updated every n-th time the node is
+		animated and kept in between. n is 1 plus the distance to the
+		active camera divided by distance times the radius of the
+		node. So with a distance of 20 the pose changes every second
+		frame when the camera is 20 radii away, every third frame at 40
+		radii and so on. The animation itself keeps its speed.
+		Nodes sharing a skinned mesh should enable its pose cache with
+		ISkinnedMesh::setPoseCacheSize(), else the mesh is still
+		skinned for each of them.
+		\param distance Distance per step in radii of the node, 0
+		updates the pose in every frame.
+		\param maxInterval Largest n. */
+		virtual void setAnimationLOD(f32 distance, u32 maxInterval=8) = 0;
+
 		//! Creates shadow volume scene node as child of this node.
 		/** The shadow can be rendered using the ZPass or the zfail
 		method. ZPass is a little bit faster because the shadow volume
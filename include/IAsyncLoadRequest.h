@@ -0,0 +1,84 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_ASYNC_LOAD_REQUEST_H_INCLUDED__
+#define __I_ASYNC_LOAD_REQUEST_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "path.h"
+
+namespace irr
+{
+namespace video
+{
+	class ITexture;
+} // end namespace video
+namespace scene
+{
+	class IAnimatedMesh;
+
+	//! State of a background load
+	enum E_ASYNC_LOAD_STATE
+	{
+		//! The file is still being read, decoded or waits for the upload
+		EALS_LOADING = 0,
+
+		//! Loading succeeded, the mesh or texture is available
+		EALS_FINISHED,
+
+		//! The file could not be opened or loaded
+		EALS_FAILED
+	};
+
+	//! Handle of a mesh or texture which is loaded in the background.
+	/** Returned by ISceneManager::getMeshAsync() and
+	ISceneManager::getTextureAsync(). Reading and decoding the file happens on
+	worker threads, the result is added to the mesh cache or the video driver
+	by ISceneManager::updateAsyncLoads(), which is also called by
+	ISceneManager::drawAll(). The scene manager drops the request after it
+	finished, so grab() it if you want to query it in later frames. */
+	class IAsyncLoadRequest : public virtual IReferenceCounted
+	{
+	public:
+
+		//! Get the name of the file which is loaded
+		virtual const io::path& getFileName() const = 0;
+
+		//! Get the state of the request
+		/** Only changes inside ISceneManager::updateAsyncLoads(), so it
+		is safe to use the result until the next call. */
+		virtual E_ASYNC_LOAD_STATE getState() const = 0;
+
+		//! Get the loaded mesh
+		/** \return Pointer to the mesh in the mesh cache, 0 if the request
+		is not finished or was not for a mesh. This pointer should not be
+		dropped. */
+		virtual IAnimatedMesh* getMesh() const = 0;
+
+		//! Get the loaded texture
+		/** \return Pointer to the texture, 0 if the request is not finished
+		or was not for a texture. This pointer should not be dropped. */
+		virtual video::ITexture* getTexture() const = 0;
+	};
+
+
+	//! Interface to get notified when a background load is done
+	/** Pass it to ISceneManager::getMeshAsync() or
+	ISceneManager::getTextureAsync(). */
+	class IAsyncLoadCallBack : public virtual IReferenceCounted
+	{
+	public:
+
+		//! Called when a load finished or failed
+		/** Called by ISceneManager::updateAsyncLoads() on its thread, after
+		the state of the request changed to EALS_FINISHED or EALS_FAILED.
+		\param request The load which is done. */
+		virtual void OnAsyncLoadDone(IAsyncLoadRequest* request) = 0;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
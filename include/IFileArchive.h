@@ -7,6 +7,7 @@
 
 #include "IReadFile.h"
 #include "IFileList.h"
+#include "irrArray.h"
 
 namespace irr
 {
@@ -67,6 +68,20 @@ public:
 	\return Returns a pointer to the created file on success, or 0 on failure. */
 	virtual IReadFile* createAndOpenFile(u32 index) =0;
 
+	//! Opens several files based on their positions in the file list.
+	/** Archives which decompress their files may decompress the requested
+	files in parallel. The default implementation opens one after another.
+	\param indices The zero based indices of the files.
+	\param files Receives a pointer to the created file for each index, or 0
+	if that file could not be opened. The pointers should be dropped when no
+	longer needed. */
+	virtual void createAndOpenFiles(const core::array<u32>& indices, core::array<IReadFile*>& files)
+	{
+		files.set_used(indices.size());
+		for (u32 i=0; i<indices.size(); ++i)
+			files[i] = createAndOpenFile(indices[i]);
+	}
+
 	//! Returns the complete file tree
 	/** \return Returns the complete directory tree for the archive,
 	including all files and folders */
@@ -75,6 +90,19 @@ public:
 	//! get the archive type
 	virtual E_FILE_ARCHIVE_TYPE getType() const { return EFAT_UNKNOWN; }
 
+	//! Check if the file system may look up the files of this archive in its index
+	/** The file system hashes the file names of such archives once when
+	they are added, instead of asking every archive in turn whenever a file
+	is opened. Only archives which open files by name with
+	IFileList::findFile of their file list, and whose file list does not
+	change afterwards, may return true.
+	\param ignorePaths Receives true if the archive finds files by their
+	name only, ignoring the path.
+	\param ignoreCase Receives true if the archive finds files regardless
+	of the case of their names. Archives which don't are not indexed.
+	\return True if the archive can be indexed. */
+	virtual bool isIndexable(bool& ignorePaths, bool& ignoreCase) const { return false; }
+
 	//! return the name (id) of the file Archive
 	virtual const io::path& getArchiveName() const =0;
 
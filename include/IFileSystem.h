@@ -40,6 +40,47 @@ public:
 	See IReferenceCounted::drop() for more information. */
 	virtual IReadFile* createAndOpenFile(const path& filename) =0;
 
+	//! Set the size from which files on disk are mapped into memory.
+	/** createAndOpenFile maps files at least this large into memory
+	instead of reading them with stdio. IReadFile::getData of those files,
+	and of the uncompressed entries of archives opened from them, then
+	returns the contents without copying them. Archives which are added
+	while mapping is enabled stay mapped as long as they are attached.
+	Platforms without memory mapped files ignore the setting.
+	\param minimumSize: Size in bytes, 0 disables mapping. Disabled by default. */
+	virtual void setFileMappingThreshold(long minimumSize) =0;
+
+	//! Get the size from which files on disk are mapped into memory.
+	/** \return Size in bytes, 0 if files are not mapped. */
+	virtual long getFileMappingThreshold() const =0;
+
+	//! Set the size from which deflated files in zip and gzip archives are inflated while they are read.
+	/** Smaller files are inflated completely when they are opened. Files
+	at least this large are inflated in chunks on demand instead, so they
+	are never held in memory completely. IReadFile::getData of those files
+	returns 0, and seeking backwards continues from a saved state of the
+	decompression, which is slower than seeking in memory. Files compressed
+	with other methods are always decompressed when they are opened.
+	\param minimumSize: Uncompressed size in bytes, 0 disables streaming.
+	Disabled by default. */
+	virtual void setStreamingThreshold(long minimumSize) =0;
+
+	//! Get the size from which deflated files in archives are inflated while they are read.
+	/** \return Size in bytes, 0 if files are inflated when they are opened. */
+	virtual long getStreamingThreshold() const =0;
+
+	//! Opens several files for reading at once.
+	/** Files are found like with createAndOpenFile. The compressed files
+	of one archive are decompressed in parallel, which is faster than
+	opening them one after another when many files are needed at once,
+	for example all textures of a level.
+	\param filenames: Names of the files to open.
+	\param files: Receives a pointer to the created file interface for
+	each name, or 0 if that file could not be opened. The pointers should be
+	dropped when no longer needed.
+	\return Number of files which were opened. */
+	virtual u32 createAndOpenFiles(const core::array<path>& filenames, core::array<IReadFile*>& files) =0;
+
 	//! Creates an IReadFile interface for accessing memory like a file.
 	/** This allows you to use a pointer to memory where an IReadFile is requested.
 	\param memory: A pointer to the start of the file in memory
@@ -17,6 +17,22 @@ namespace irr
 namespace video
 {
 
+//! Filters for IImage::copyToScalingFiltered
+enum E_IMAGE_FILTER
+{
+	//! Average of the covered pixels, the classic mip map filter
+	EIF_BOX = 0,
+
+	//! Tent filter, linear interpolation when enlarging
+	EIF_BILINEAR,
+
+	//! Lanczos windowed sinc with 3 lobes, sharp but can ring at hard edges
+	EIF_LANCZOS,
+
+	//! Kaiser windowed sinc, less ringing than Lanczos, good for mip maps
+	EIF_KAISER
+};
+
 //! Interface for software image data.
 /** Image loaders create these images from files. IVideoDrivers convert
 these images into their (hardware) textures.
@@ -280,6 +296,18 @@ public:
 	//! copies this surface into another, scaling it to fit, applying a box filter
 	virtual void copyToScalingBoxFilter(IImage* target, s32 bias = 0, bool blend = false) = 0;
 
+	//! Copies this surface into another, scaling it to fit with a separable filter
+	/** Much faster than copyToScalingBoxFilter and works for any scale in
+	both directions. Both images must be uncompressed A1R5G5B5, R5G6B5,
+	R8G8B8 or A8R8G8B8 images. Image implementations which don't
+	override it fall back to copyToScaling(IImage*).
+	\param target Image receiving the scaled copy.
+	\param filter Filter used for sampling this image. */
+	virtual void copyToScalingFiltered(IImage* target, E_IMAGE_FILTER filter = EIF_BILINEAR)
+	{
+		copyToScaling(target);
+	}
+
 	//! fills the surface with given color
 	virtual void fill(const SColor &color) =0;
 
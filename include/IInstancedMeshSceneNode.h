@@ -0,0 +1,85 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IMeshSceneNode.h"
+#include "matrix4.h"
+#include "SColor.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! A scene node displaying one static mesh many times
+/** Each instance has its own transformation relative to the node and a color.
+The node is registered for rendering once, culls all instances against the
+view frustum of the active camera in one pass and draws each mesh buffer
+for all visible instances with IVideoDriver::drawMeshBufferInstanced(). This
+is much faster than one IMeshSceneNode per instance for large amounts of
+identical objects like trees, rocks or crates.
+The instance colors are only visible with an instanced GLSL shader material,
+see IVideoDriver::drawMeshBufferInstanced() for the attributes it has to read.
+Shadow volumes are not supported.
+*/
+class IInstancedMeshSceneNode : public IMeshSceneNode
+{
+public:
+
+	//! Constructor
+	IInstancedMeshSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+		: IMeshSceneNode(parent, mgr, id, position, rotation, scale) {}
+
+	//! Adds an instance
+	/** \param transform Transformation of the instance relative to this node.
+	\param color Color of the instance.
+	\return Index of the new instance. */
+	virtual u32 addInstance(const core::matrix4& transform,
+		video::SColor color=video::SColor(255,255,255,255)) = 0;
+
+	//! Changes an instance
+	/** \param index Index of the instance, must be smaller than getInstanceCount().
+	\param transform Transformation of the instance relative to this node.
+	\param color Color of the instance. */
+	virtual void setInstance(u32 index, const core::matrix4& transform,
+		video::SColor color=video::SColor(255,255,255,255)) = 0;
+
+	//! Replaces all instances
+	/** \param transforms Transformations of the instances relative to this node.
+	\param colors Colors of the instances, the instances without a color are white. */
+	virtual void setInstances(const core::array<core::matrix4>& transforms,
+		const core::array<video::SColor>& colors) = 0;
+
+	//! Removes an instance
+	/** The last instance takes the index of the removed one.
+	\param index Index of the instance, must be smaller than getInstanceCount(). */
+	virtual void removeInstance(u32 index) = 0;
+
+	//! Removes all instances
+	virtual void clearInstances() = 0;
+
+	//! Get the amount of instances
+	virtual u32 getInstanceCount() const = 0;
+
+	//! Get the transformation of an instance relative to this node
+	virtual const core::matrix4& getInstanceTransform(u32 index) const = 0;
+
+	//! Get the color of an instance
+	virtual video::SColor getInstanceColor(u32 index) const = 0;
+
+	//! Get the amount of instances which passed the culling in the last frame
+	virtual u32 getVisibleInstanceCount() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+
+#endif
+
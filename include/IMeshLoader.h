@@ -52,6 +52,17 @@ public:
 	See IReferenceCounted::drop() for more information. */
 	virtual IAnimatedMesh* createMesh(io::IReadFile* file) = 0;
 
+	//! Returns true if createMesh() may be called on a worker thread.
+	/** Used by ISceneManager::getMeshAsync(). Loaders returning true must
+	not access the scene manager, video driver or file system in createMesh()
+	and must not grab or drop objects shared with other threads, as reference
+	counting is not thread safe. Several threads may call createMesh() of the
+	same loader at once. */
+	virtual bool canLoadOnWorkerThread() const
+	{
+		return false;
+	}
+
 	//! Set a new texture loader which this meshloader can use when searching for textures.
 	/** NOTE: Not all meshloaders do support this interface. Meshloaders which
 	support it will return a non-null value in getMeshTextureLoader from the start. Setting a
@@ -42,6 +42,16 @@ namespace io
 		//! Get name of file.
 		/** \return File name as zero terminated character string. */
 		virtual const io::path& getFileName() const = 0;
+
+		//! Get the contents of the file in memory, if the file has them.
+		/** Files mapped into memory, memory read files and uncompressed
+		archive entries inside such files return a pointer to all getSize()
+		bytes, so loaders can parse them without copying. The pointer is
+		valid until the file is dropped and does not depend on the current
+		position.
+		\return Pointer to the contents, or 0 if the file has to be read
+		with read(). */
+		virtual const void* getData() const { return 0; }
 	};
 
 	//! Internal function, please do not use.
@@ -20,6 +20,7 @@ namespace scene
 	class ICameraSceneNode;
 	class ITriangleSelector;
 	class IMeshBuffer;
+	struct SCollisionTriangleCache;
 
 	struct SCollisionHit
 	{
@@ -45,6 +46,53 @@ namespace scene
 		{}
 	};
 
+	//! Moving ellipsoid for ISceneCollisionManager::getCollisionResultPositions()
+	/** Holds the parameters and results of
+	ISceneCollisionManager::getCollisionResultPosition(). */
+	struct SCollisionEllipsoid
+	{
+		//! TriangleSelector containing the triangles of the world
+		ITriangleSelector* Selector;
+
+		//! Position of the ellipsoid
+		core::vector3df Position;
+
+		//! Radius of the ellipsoid
+		core::vector3df Radius;
+
+		//! Direction and speed of the movement of the ellipsoid
+		core::vector3df Velocity;
+
+		//! Direction and force of gravity
+		core::vector3df Gravity;
+
+		//! Distance the ellipsoid keeps to triangles it slides along
+		f32 SlidingSpeed;
+
+		//! Triangles of the world kept between movements, can be 0
+		/** Without a cache the triangles near the movement are gathered
+		from the selector for each movement. */
+		SCollisionTriangleCache* Cache;
+
+		//! New position of the ellipsoid
+		core::vector3df ResultPosition;
+
+		//! Last triangle causing a collision, unchanged if there was no collision
+		core::triangle3df Triangle;
+
+		//! Position of the collision
+		core::vector3df HitPosition;
+
+		//! Node with which the ellipsoid collided, 0 if there was no collision
+		ISceneNode* Node;
+
+		//! True if the ellipsoid is falling down, caused by gravity
+		bool Falling;
+
+		SCollisionEllipsoid() : Selector(0), SlidingSpeed(0.0005f), Cache(0), Node(0), Falling(false)
+		{}
+	};
+
 	//! The Scene Collision Manager provides methods for performing collision tests and picking on scene nodes.
 	class ISceneCollisionManager : public virtual IReferenceCounted
 	{
@@ -122,6 +170,23 @@ namespace scene
 			const core::vector3df& gravityDirectionAndSpeed
 			= core::vector3df(0.0f, 0.0f, 0.0f)) = 0;
 
+		//! Collides many moving ellipsoids with 3d worlds with gravity.
+		/** Gives the same results as calling getCollisionResultPosition
+		for each ellipsoid. The triangles near an ellipsoid are gathered
+		once for the whole movement including gravity, and can be kept
+		between frames in the cache of the ellipsoid, see
+		SCollisionTriangleCache.
+		\param ellipsoids: Array of ellipsoids, which get the results of
+		their movement.
+		\param count: Number of ellipsoids.
+		\param threadCount: Number of threads sharing the work, including
+		the calling thread. 0 uses one thread per processor. Selectors of
+		animated nodes are updated before the threads start, other than that
+		selectors must not be changed during the call. Ellipsoids must not
+		share a cache. */
+		virtual void getCollisionResultPositions(SCollisionEllipsoid* ellipsoids,
+			u32 count, u32 threadCount=1) = 0;
+
 		//! Returns a 3d ray which would go through the 2d screen coordinates.
 		/** \param pos: Screen coordinates in pixels.
 		\param camera: Camera from which the ray starts. If null, the
@@ -276,6 +341,59 @@ namespace scene
 			return node;
 		}
 
+		//! Finds the nearest collision points of many lines and lots of triangles.
+		/** Gives the same results as calling getCollisionPoint for each
+		line, but is a lot faster for many lines. The lines are sorted so
+		that lines close to each other are tested one after another, and
+		selectors which can't find collision points themselves (see
+		ITriangleSelector::isCollisionPointSupported) gather the triangles
+		only once for each group of close lines instead of once per line.
+		\param rays: Array of lines with which collisions are tested.
+		\param rayCount: Number of lines.
+		\param selector: TriangleSelector to be used for the collision checks.
+		\param hitResults: Array of rayCount results, which get the collision
+		of the line with the same index if there is one.
+		\param outHits: Array of rayCount flags, set to true for lines
+		which collided and to false for the others.
+		\param anyHit: Take the first hit found for each line instead of
+		the nearest one. Enough for line of sight tests, and faster.
+		\param threadCount: Number of threads sharing the work, including
+		the calling thread. 0 uses one thread per processor. Selectors of
+		animated nodes are updated before the threads start, other than that
+		selectors must not be changed during the call.
+		\return Number of lines which collided. */
+		virtual u32 getCollisionPoints(const core::line3d<f32>* rays, u32 rayCount,
+				ITriangleSelector* selector, SCollisionHit* hitResults, bool* outHits,
+				bool anyHit=false, u32 threadCount=1) = 0;
+
+		//! Perform ray/box and ray/triangle collision checks of many lines on a hierarchy of scene nodes.
+		/** Gives the same results as calling getSceneNodeAndCollisionPointFromRay
+		for each line, but walks the scene graph only once and tests the
+		lines in groups of close lines, like getCollisionPoints.
+		\param rays: Array of lines with which collisions are tested.
+		\param rayCount: Number of lines.
+		\param hitResults: Array of rayCount results, which get the nearest
+		collision of the line with the same index. The Node of lines which
+		didn't collide is 0.
+		\param idBitMask: Only scene nodes with an id which matches at least one of the
+		bits contained in this mask will be tested. However, if this parameter is 0, then
+		all nodes are checked.
+		\param collisionRootNode: the scene node at which to begin checking. Only this
+		node and its children will be checked. If you want to check the entire scene,
+		pass 0, and the root scene node will be used (this is the default).
+		\param noDebugObjects: when true, debug objects are not considered viable targets.
+		Debug objects are scene nodes with IsDebugObject() = true.
+		\param threadCount: Number of threads sharing the work, including
+		the calling thread. 0 uses one thread per processor.
+		\return Number of lines which collided. */
+		virtual u32 getSceneNodesAndCollisionPointsFromRays(
+								const core::line3df* rays, u32 rayCount,
+								SCollisionHit* hitResults,
+								s32 idBitMask = 0,
+								ISceneNode * collisionRootNode = 0,
+								bool noDebugObjects = false,
+								u32 threadCount = 1) = 0;
+
 	};
 
 } // end namespace scene
@@ -96,10 +96,13 @@ namespace scene
 
 	class IAnimatedMesh;
 	class IAnimatedMeshSceneNode;
+	class IAsyncLoadCallBack;
+	class IAsyncLoadRequest;
 	class IBillboardSceneNode;
 	class IBillboardTextSceneNode;
 	class ICameraSceneNode;
 	class IDummyTransformationSceneNode;
+	class IInstancedMeshSceneNode;
 	class ILightManager;
 	class ILightSceneNode;
 	class IMesh;
@@ -120,10 +123,12 @@ namespace scene
 	class ISceneNodeAnimatorFactory;
 	class ISceneNodeFactory;
 	class ISceneUserDataSerializer;
+	class ISkinnedMesh;
 	class ITerrainSceneNode;
 	class ITextSceneNode;
 	class ITriangleSelector;
 	class IVolumeLightSceneNode;
+	struct SViewFrustum;
 
 	namespace quake3
 	{
@@ -394,6 +399,46 @@ namespace scene
 		IReferenceCounted::drop() for more information. */
 		virtual IAnimatedMesh* getMesh(io::IReadFile* file) = 0;
 
+		//! Starts loading a mesh in the background.
+		/** Works like getMesh(const io::path&, const io::path&), but returns
+		immediately. The file is read on a worker thread, and mesh loaders
+		which return true for IMeshLoader::canLoadOnWorkerThread() also
+		create the mesh there. All other loaders run on the calling thread
+		inside updateAsyncLoads(), which also adds the mesh to the mesh cache.
+		Entries of file archives are read on the calling thread, as archives
+		share one file handle for all entries.
+		\param filename Filename of the mesh to load.
+		\param callBack Called by updateAsyncLoads() when the load finished
+		or failed, can be 0. It is grabbed until then.
+		\return Handle of the load, it is valid until the load finished and
+		was processed by updateAsyncLoads(). Requests for a file which is
+		already loading return the same handle. This pointer should not be
+		dropped. See IReferenceCounted::drop() for more information. */
+		virtual IAsyncLoadRequest* getMeshAsync(const io::path& filename, IAsyncLoadCallBack* callBack=0) = 0;
+
+		//! Starts loading a texture in the background.
+		/** Works like IVideoDriver::getTexture(const io::path&), but returns
+		immediately. Reading and decoding the image happens on a worker
+		thread, the texture is created by updateAsyncLoads().
+		\param filename Filename of the texture to load.
+		\param callBack Called by updateAsyncLoads() when the load finished
+		or failed, can be 0. It is grabbed until then.
+		\return Handle of the load, see getMeshAsync(). This pointer should
+		not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual IAsyncLoadRequest* getTextureAsync(const io::path& filename, IAsyncLoadCallBack* callBack=0) = 0;
+
+		//! Finishes loads started with getMeshAsync() or getTextureAsync().
+		/** Adds meshes and textures which were decoded by the worker threads
+		to the mesh cache and the video driver, in the order the loads were
+		started, and calls their callbacks. Messages which the loaders log
+		on the worker threads are passed to the logger here as well. Called
+		by drawAll() with the budget of the ASYNC_LOAD_BUDGET scene
+		parameter.
+		\param timeBudgetMs Time in milliseconds after which no more loads
+		are finished. At least one finished load is processed per call.
+		\return Number of loads which are still pending. */
+		virtual u32 updateAsyncLoads(u32 timeBudgetMs) = 0;
+
 		//! Get interface to the mesh cache which is shared between all existing scene managers.
 		/** With this interface, it is possible to manually add new loaded
 		meshes (if ISceneManager::getMesh() is not sufficient), to remove them and to iterate
@@ -509,6 +554,27 @@ namespace scene
 			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
 			bool alsoAddIfMeshPointerZero=false) = 0;
 
+		//! Adds a scene node for rendering a static mesh many times.
+		/** The instances are added to the returned node with
+		IInstancedMeshSceneNode::addInstance(). All instances are culled in
+		one pass and drawn together, which is a lot faster than adding a mesh
+		scene node for each of them.
+		\param mesh: Pointer to the loaded static mesh to be displayed.
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent where the
+		scene node will be placed.
+		\param rotation: Initial rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\param alsoAddIfMeshPointerZero: Add the scene node even if a 0 pointer is passed.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			bool alsoAddIfMeshPointerZero=false) = 0;
+
 		//! Adds a scene node for rendering a animated water surface mesh.
 		/** Looks really good when the Material type EMT_TRANSPARENT_REFLECTION
 		is used.
@@ -1090,6 +1156,54 @@ namespace scene
 				core::array<scene::ISceneNode*>& outNodes,
 				ISceneNode* start=0) = 0;
 
+		//! Get scene nodes whose transformed bounding box intersects a box.
+		/** The scene manager keeps the transformed bounding boxes of all
+		nodes of the scene in a spatial index, a tree of boxes, so this only
+		takes about logarithmic time in the number of nodes. The boxes are
+		updated when ISceneNode::updateAbsolutePosition() is called, which
+		usually happens once per frame in OnAnimate(). Nodes are found
+		whether they are visible or not.
+		\param box: Box in world space.
+		\param outNodes: results will be added to this array (outNodes is not cleared). */
+		virtual void getSceneNodesFromBox(const core::aabbox3df& box,
+				core::array<scene::ISceneNode*>& outNodes) = 0;
+
+		//! Get scene nodes whose transformed bounding box intersects a sphere.
+		/** Uses the spatial index, see getSceneNodesFromBox().
+		\param center: Center of the sphere in world space.
+		\param radius: Radius of the sphere.
+		\param outNodes: results will be added to this array (outNodes is not cleared). */
+		virtual void getSceneNodesFromSphere(const core::vector3df& center, f32 radius,
+				core::array<scene::ISceneNode*>& outNodes) = 0;
+
+		//! Get scene nodes whose transformed bounding box may be inside a view frustum.
+		/** Uses the spatial index, see getSceneNodesFromBox(). Nodes
+		are found unless their box is completely outside one of the planes.
+		\param frustum: View frustum in world space.
+		\param outNodes: results will be added to this array (outNodes is not cleared). */
+		virtual void getSceneNodesFromFrustum(const SViewFrustum& frustum,
+				core::array<scene::ISceneNode*>& outNodes) = 0;
+
+		//! Get scene nodes whose transformed bounding box intersects a line.
+		/** Uses the spatial index, see getSceneNodesFromBox().
+		\param line: Line in world space.
+		\param outNodes: results will be added to this array (outNodes is not cleared). */
+		virtual void getSceneNodesFromLine(const core::line3df& line,
+				core::array<scene::ISceneNode*>& outNodes) = 0;
+
+		//! Tells the spatial index that the bounding box of a node may have changed.
+		/** ISceneNode::updateAbsolutePosition() calls this, nodes which
+		change their bounding box at other times should call it as well.
+		The box is read again on the next query of the index.
+		\param node: Node which changed, nodes without parent are ignored. */
+		virtual void updateSceneNodeIndex(ISceneNode* node) = 0;
+
+		//! Removes a node from the spatial index.
+		/** Called by ISceneNode when nodes are removed from the scene, the
+		children of the node have to be removed as well.
+		\param node: Node which is removed. */
+		virtual void removeFromSceneNodeIndex(ISceneNode* node) = 0;
+
 		//! Get the current active camera.
 		/** \return The active camera is returned. Note that this can
 		be NULL, if there was no camera created yet.
@@ -1353,6 +1467,55 @@ namespace scene
 		virtual ITriangleSelector* createOctreeTriangleSelector(IMeshBuffer* meshBuffer, irr::u32 materialIndex,
 			ISceneNode* node, s32 minimalPolysPerNode=32) = 0;
 
+		//! Creates a Triangle Selector which keeps the triangles in a bounding volume hierarchy.
+		/** The hierarchy is built once with the surface area heuristic and
+		stored in the space of the mesh as a flat array. Lines, boxes and
+		view frustums only visit the parts of it they touch, and
+		ISceneCollisionManager::getCollisionPoint tests the triangles where
+		they are stored instead of copying them. This makes ray picking and
+		line of sight checks on large static meshes much faster than with
+		the octree selector.
+		Please note that the created triangle selector is not automatically attached
+		to the scene node. You will have to call ISceneNode::setTriangleSelector()
+		for this.
+		\param mesh: Mesh of which the triangles are taken.
+		\param node: Scene node of which visibility and transformation is used.
+		\param separateMeshbuffers: When true it's possible to get information
+		which meshbuffer got hit in collision tests. But has a slight speed cost.
+		\return The selector, or null if not successful.
+		If you no longer need the selector, you should call ITriangleSelector::drop().
+		See IReferenceCounted::drop() for more information. */
+		virtual ITriangleSelector* createBVHTriangleSelector(IMesh* mesh,
+			ISceneNode* node, bool separateMeshbuffers=false) = 0;
+
+		//! Creates a Triangle Selector for a single meshbuffer, which keeps the triangles in a bounding volume hierarchy.
+		/** See createBVHTriangleSelector(IMesh*, ISceneNode*, bool).
+		\param meshBuffer: Meshbuffer of which the triangles are taken.
+		\param materialIndex: Setting this value allows the triangle selector to return the material index
+		\param node: Scene node of which visibility and transformation is used.
+		\return The selector, or null if not successful.
+		If you no longer need the selector, you should call ITriangleSelector::drop().
+		See IReferenceCounted::drop() for more information. */
+		virtual ITriangleSelector* createBVHTriangleSelector(const IMeshBuffer* meshBuffer, irr::u32 materialIndex,
+			ISceneNode* node) = 0;
+
+		//! Creates a Triangle Selector for an animated node, which keeps the triangles in a bounding volume hierarchy.
+		/** The hierarchy is built once for the frame the node shows at
+		creation. When the node shows another frame, the triangles of that
+		frame are read and the boxes of the hierarchy are refit to them
+		without building it again. This is much cheaper than creating a new
+		selector per frame, but queries get slower when the animation moves
+		the triangles far from where they were grouped, so it works best for
+		skinned and morphed characters which keep their shape roughly.
+		\param node: Animated scene node of which the mesh, the current frame,
+		visibility and transformation is used.
+		\param separateMeshbuffers: When true it's possible to get information
+		which meshbuffer got hit in collision tests. But has a slight speed cost.
+		\return The selector, or null if not successful.
+		If you no longer need the selector, you should call ITriangleSelector::drop().
+		See IReferenceCounted::drop() for more information. */
+		virtual ITriangleSelector* createBVHTriangleSelector(IAnimatedMeshSceneNode* node, bool separateMeshbuffers=false) = 0;
+
 		//! //! Creates a Triangle Selector, optimized by an octree.
 		/** \deprecated Use createOctreeTriangleSelector instead. This method may be removed by Irrlicht 1.9. */
 		_IRR_DEPRECATED_ ITriangleSelector* createOctTreeTriangleSelector(IMesh* mesh,
@@ -1674,6 +1837,32 @@ namespace scene
 	};
 
 
+	// functions of ISceneNode which need the scene manager
+
+	inline void ISceneNode::updateIndexEntries(bool children)
+	{
+		if (SceneManager)
+			SceneManager->updateSceneNodeIndex(this);
+
+		if (children)
+		{
+			ISceneNodeList::Iterator it = Children.begin();
+			for (; it != Children.end(); ++it)
+				(*it)->updateIndexEntries(true);
+		}
+	}
+
+	inline void ISceneNode::removeIndexEntries()
+	{
+		if (SceneNodeIndexEntry >= 0 && SceneManager)
+			SceneManager->removeFromSceneNodeIndex(this);
+
+		ISceneNodeList::Iterator it = Children.begin();
+		for (; it != Children.end(); ++it)
+			(*it)->removeIndexEntries();
+	}
+
+
 } // end namespace scene
 } // end namespace irr
 
@@ -49,7 +49,7 @@ namespace scene
 			: RelativeTranslation(position), RelativeRotation(rotation), RelativeScale(scale),
 				Parent(0), SceneManager(mgr), TriangleSelector(0), ID(id),
 				AutomaticCullingState(EAC_BOX), DebugDataVisible(EDS_OFF),
-				IsVisible(true), IsDebugObject(false)
+				IsVisible(true), IsDebugObject(false), SceneNodeIndexEntry(-1)
 		{
 			if (parent)
 				parent->addChild(this);
@@ -298,12 +298,16 @@ namespace scene
 			{
 				// Change scene manager?
 				if (SceneManager != child->SceneManager)
+				{
+					child->removeIndexEntries();
 					child->setSceneManager(SceneManager);
+				}
 
 				child->grab();
 				child->remove(); // remove from old parent
 				Children.push_back(child);
 				child->Parent = this;
+				child->updateIndexEntries(true);
 			}
 		}
 
@@ -320,6 +324,7 @@ namespace scene
 			for (; it != Children.end(); ++it)
 				if ((*it) == child)
 				{
+					(*it)->removeIndexEntries();
 					(*it)->Parent = 0;
 					(*it)->drop();
 					Children.erase(it);
@@ -339,6 +344,7 @@ namespace scene
 			ISceneNodeList::Iterator it = Children.begin();
 			for (; it != Children.end(); ++it)
 			{
+				(*it)->removeIndexEntries();
 				(*it)->Parent = 0;
 				(*it)->drop();
 			}
@@ -596,6 +602,24 @@ namespace scene
 		}
 
 
+		//! Returns the entry of this node in the spatial index of its scene manager.
+		/** Only meant to be used by the scene manager.
+		\return Entry of the node, or -1 if the node is not in the index. */
+		s32 getSceneNodeIndexEntry() const
+		{
+			return SceneNodeIndexEntry;
+		}
+
+
+		//! Sets the entry of this node in the spatial index of its scene manager.
+		/** Only meant to be used by the scene manager.
+		\param entry Entry of the node, or -1 if the node is not in the index. */
+		void setSceneNodeIndexEntry(s32 entry)
+		{
+			SceneNodeIndexEntry = entry;
+		}
+
+
 		//! Returns a const reference to the list of all children.
 		/** \return The list of all children of this node. */
 		const core::list<ISceneNode*>& getChildren() const
@@ -661,7 +685,9 @@ namespace scene
 
 		//! Updates the absolute position based on the relative and the parents position
 		/** Note: This does not recursively update the parents absolute positions, so if you have a deeper
-			hierarchy you might want to update the parents first.*/
+			hierarchy you might want to update the parents first.
+			Also tells the scene manager to update the node in its spatial index,
+			see ISceneManager::updateSceneNodeIndex(). */
 		virtual void updateAbsolutePosition()
 		{
 			if (Parent)
@@ -671,6 +697,8 @@ namespace scene
 			}
 			else
 				AbsoluteTransformation = getRelativeTransformation();
+
+			updateIndexEntries(false);
 		}
 
 
@@ -809,6 +837,14 @@ namespace scene
 			}
 		}
 
+		//! Marks this node and maybe all children in the spatial index of the scene manager.
+		/** Defined at the end of ISceneManager.h, which needs this class. */
+		inline void updateIndexEntries(bool children);
+
+		//! Removes this node and all children from the spatial index of the scene manager.
+		/** Defined at the end of ISceneManager.h, which needs this class. */
+		inline void removeIndexEntries();
+
 		//! Sets the new scene manager for this node and all children.
 		//! Called by addChild when moving nodes between scene managers
 		void setSceneManager(ISceneManager* newManager)
@@ -864,11 +900,17 @@ namespace scene
 
 		//! Is debug object?
 		bool IsDebugObject;
+
+		//! Entry in the spatial index of the scene manager
+		s32 SceneNodeIndexEntry;
 	};
 
 
 } // end namespace scene
 } // end namespace irr
 
+// for the inline functions which need the scene manager
+#include "ISceneManager.h"
+
 #endif
 
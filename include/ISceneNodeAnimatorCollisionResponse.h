@@ -126,6 +126,16 @@ namespace scene
 		//! Get the current triangle selector containing all triangles for collision detection.
 		virtual ITriangleSelector* getWorld() const = 0;
 
+		//! Keep the triangles of the world near the node between frames ( default = false )
+		/** The triangles around the node are gathered from the world for a
+		box a bit larger than the movement, and used again as long as the
+		node moves inside that box. Only enable this if the triangles of the
+		world don't move, see SCollisionTriangleCache. */
+		virtual void setCacheTriangles(bool enable) = 0;
+
+		//! Are the triangles of the world kept between frames?
+		virtual bool getCacheTriangles() const = 0;
+
 		//! Set the single node that this animator will act on.
 		/** \param node The new target node. Setting this will force the animator to update
 					its last target position for the node, allowing setPosition() to teleport
@@ -79,6 +79,29 @@ namespace scene
 		/* This feature is not implemented in Irrlicht yet */
 		virtual bool setHardwareSkinning(bool on) = 0;
 
+		//! Replaces the animation keys by samples taken at a fixed rate
+		/** Looking up a frame takes constant time afterwards, and
+		rotations are stored with 16 bit per component, so meshes with
+		many keys need less memory. Tracks which don't change are stored
+		as one sample. The joints keep only their first and last keys,
+		so call this after finalize() and don't use the mesh as source
+		for useAnimationFrom() or write it with its animation afterwards.
+		\param framesPerSample Distance of the samples in frames.
+		Motion between the samples is interpolated linearly. */
+		virtual void compressAnimation(f32 framesPerSample=1.f) = 0;
+
+		//! Keeps the skinned vertices of the last animated frames for animated mesh scene nodes
+		/** A node showing a frame which is in the cache copies the
+		cached vertices into the mesh buffers instead of animating and
+		skinning the mesh again, and nodes drawn one after another at
+		the same frame don't copy them at all. Crowds playing the same
+		animation in sync, or updating their pose less often with
+		IAnimatedMeshSceneNode::setAnimationLOD(), share many frames.
+		Each pose holds a copy of the vertices of all mesh buffers.
+		Nodes which control or read their joints don't use the cache.
+		\param poses Number of frames kept, 0 disables the cache. */
+		virtual void setPoseCacheSize(u32 poses) = 0;
+
 		//! A vertex weight
 		struct SWeight
 		{
@@ -73,6 +73,16 @@ enum E_TEXTURE_CREATION_FLAG
 	*/
 	ETCF_ALLOW_MEMORY_COPY = 0x00000080,
 
+	//! Compress textures loaded from uncompressed images to DXT1 or DXT5
+	/** Only used when the driver supports EVDF_TEXTURE_COMPRESSED_DXT and
+	the image has a power of two size. Images with translucent pixels are
+	compressed to DXT5, others to DXT1, which uses a quarter or an eighth of
+	the memory of a 32 bit texture. The compression is done at load time on
+	several threads and loses some color detail, locking such a texture
+	returns the compressed data.
+	Default is off. */
+	ETCF_ALLOW_COMPRESSION = 0x00000100,
+
 	/** This flag is never used, it only forces the compiler to compile
 	these enumeration values to 32 bit. */
 	ETCF_FORCE_32_BIT_DO_NOT_USE = 0x7fffffff
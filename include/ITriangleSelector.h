@@ -11,6 +11,8 @@
 #include "matrix4.h"
 #include "line3d.h"
 #include "irrArray.h"
+#include "SViewFrustum.h"
+#include "ISceneCollisionManager.h"
 
 namespace irr
 {
@@ -62,6 +64,47 @@ struct SCollisionTriangleRange
 	irr::u32 MaterialIndex;
 };
 
+//! Triangles of a world near a moving ellipsoid, kept between movements
+/** Used by ISceneCollisionManager::getCollisionResultPositions() through
+SCollisionEllipsoid::Cache. The triangles around a movement are gathered from
+the triangle selector once and used for all steps of the collision response.
+Later movements of the same ellipsoid which stay inside the box the triangles
+were gathered for use them again instead of asking the selector. Only keep
+them between frames when the triangles of the world don't move, call
+invalidate() otherwise. */
+struct SCollisionTriangleCache
+{
+	SCollisionTriangleCache()
+		: Selector(0), Margin(0.f)
+	{}
+
+	//! Forgets the triangles, the next movement gathers them again
+	void invalidate()
+	{
+		Selector = 0;
+	}
+
+	//! Selector the triangles were gathered from, 0 if there are none
+	const ITriangleSelector* Selector;
+
+	//! How far the gathered box reaches beyond a movement, in radii of the ellipsoid
+	/** With 0 only the triangles needed for one movement are gathered. Larger
+	values gather more triangles, but later movements can use them longer. */
+	f32 Margin;
+
+	//! Radius of the ellipsoid, the triangles are scaled by its inverse
+	core::vector3df Radius;
+
+	//! Box in world space the triangles were gathered for
+	core::aabbox3df Box;
+
+	//! The triangles, scaled to the space in which the ellipsoid is a unit sphere
+	core::array<core::triangle3df> Triangles;
+
+	//! Ranges of the triangles as returned by ITriangleSelector::getTriangles
+	core::array<SCollisionTriangleRange> TriangleInfo;
+};
+
 //! Interface to return triangles with specific properties.
 /** Every ISceneNode may have a triangle selector, available with
 ISceneNode::getTriangleSelector() or ISceneManager::createTriangleSelector.
@@ -162,6 +205,81 @@ public:
 		const core::matrix4* transform=0, bool useNodeTransform=true,
 		irr::core::array<SCollisionTriangleRange>* outTriangleInfo=0) const = 0;
 
+	//! Gets the triangles for one associated node which may lie within a view frustum.
+	/**
+	This returns all triangles for one scene node associated with this
+	selector.  If there is more than one scene node associated (e.g. for
+	an IMetaTriangleSelector) this this function may be called multiple
+	times to retrieve all triangles.
+
+	This method will return at least the triangles that intersect the
+	frustum, but may return other triangles as well. Selectors which don't
+	know better return the triangles in the bounding box of the frustum.
+	\param triangles Array where the resulting triangles will be written
+	to.
+	\param arraySize Size of the target array.
+	\param outTriangleCount Amount of triangles which have been written
+	into the array.
+	\param frustum Only triangles which may be inside of this frustum
+	will be written into the array.
+	\param transform Pointer to matrix for transforming the triangles
+	before they are returned.
+	\param useNodeTransform When the selector has a node then transform the
+	triangles by that node's transformation matrix.
+	\param outTriangleInfo When a pointer to an array is passed then that
+	array is filled with additional information about the returned triangles.
+	One element of SCollisionTriangleRange added for each range of triangles which
+	has distinguishable information. For example one range per meshbuffer. */
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize,
+		s32& outTriangleCount, const SViewFrustum& frustum,
+		const core::matrix4* transform=0, bool useNodeTransform=true,
+		irr::core::array<SCollisionTriangleRange>* outTriangleInfo=0) const
+	{
+		getTriangles(triangles, arraySize, outTriangleCount, frustum.getBoundingBox(),
+			transform, useNodeTransform, outTriangleInfo);
+	}
+
+	//! Check if the selector can find collision points itself
+	/** See getCollisionPoint. */
+	virtual bool isCollisionPointSupported() const
+	{
+		return false;
+	}
+
+	//! Finds the nearest collision point of a 3d line and the triangles, if there is one.
+	/** Unlike getTriangles this doesn't copy any triangles. Selectors which
+	keep their triangles in a hierarchy, like the one created with
+	ISceneManager::createBVHTriangleSelector, test them where they are
+	stored and only look at those near the line.
+	ISceneCollisionManager::getCollisionPoint uses this when
+	isCollisionPointSupported returns true, else it tests the triangles
+	returned by getTriangles itself.
+	\param hitResult Contains collision result when there was a collision
+	detected. The intersection and triangle are transformed like the
+	triangles returned by getTriangles.
+	\param line Line with which collisions are tested. In world space when
+	useNodeTransform is true, else in the space of the triangles.
+	\param useNodeTransform When the selector has a node then transform the
+	triangles by that node's transformation matrix.
+	\param anyHit Take the first hit found instead of the nearest one.
+	Enough to find out if there is a line of sight, and faster.
+	\return True if a collision was detected, false if not or if the
+	selector doesn't support this. */
+	virtual bool getCollisionPoint(SCollisionHit& hitResult, const core::line3d<f32>& line,
+		bool useNodeTransform=true, bool anyHit=false) const
+	{
+		return false;
+	}
+
+	//! Updates the triangles of selectors of animated scene nodes to the current frame
+	/** Queries do this by themselves when the frame has changed, but the
+	update writes the triangles. Before querying a selector from several
+	threads at once, call this once, then the threads only read them.
+	Meta selectors update all selectors they contain. */
+	virtual void update() const
+	{
+	}
+
 	//! Get number of TriangleSelectors that are part of this one
 	/** Only useful for MetaTriangleSelector, others return 1
 	*/
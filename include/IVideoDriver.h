@@ -1000,6 +1000,25 @@ namespace video
 		/** \param mb Buffer to draw */
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) =0;
 
+		//! Draws a mesh buffer once for each of several world transformations
+		/** With OpenGL all instances are drawn in a single draw call if the
+		current material is a GLSL shader which declares the vertex
+		attributes "attribute mat4 InstanceWorld;" and optionally
+		"attribute vec4 InstanceColor;". The shader has to transform the
+		vertices with InstanceWorld itself, the world transformation is the
+		identity matrix during the call. Such materials draw single instances
+		and buffers which are not made of triangles one after another, with
+		the same attributes. The other drivers and other materials draw the
+		instances one after another with their world transformation and
+		ignore the colors.
+		The world transformation is undefined after this call.
+		\param mb Buffer to draw
+		\param transforms Array of count world transformations
+		\param colors Array of count instance colors, or 0 for white.
+		\param count Number of instances to draw */
+		virtual void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+			const core::matrix4* transforms, const SColor* colors, u32 count) =0;
+
 		//! Draws normals of a mesh buffer
 		/** \param mb Buffer to draw the normals of
 		\param length length scale factor of the normals
@@ -134,6 +134,24 @@ while it runs and enabling it will slow down the engine. */
 #undef _IRR_COMPILE_WITH_PROFILING_
 #endif
 
+//! Allow the engine to use worker threads for internal tasks
+/** Worker threads are only started when requested, for example with
+SIrrlichtCreationParameters::WorkerThreads. Disable this on platforms without
+pthreads or win32 threads. */
+#define _IRR_COMPILE_WITH_THREADS_
+#ifdef NO_IRR_COMPILE_WITH_THREADS_
+#undef _IRR_COMPILE_WITH_THREADS_
+#endif
+
+//! Allow the file system to map large files into memory
+/** Mapping is only used for files above IFileSystem::setFileMappingThreshold.
+Uses mmap on posix systems and file mappings on Windows. Disable this on
+platforms which have neither. */
+#define _IRR_COMPILE_WITH_MAPPED_FILES_
+#ifdef NO_IRR_COMPILE_WITH_MAPPED_FILES_
+#undef _IRR_COMPILE_WITH_MAPPED_FILES_
+#endif
+
 //! Define _IRR_COMPILE_WITH_DIRECT3D_9_ to compile the Irrlicht engine with DIRECT3D9.
 /** If you only want to use the software device or opengl you can disable those defines.
 This switch is mostly disabled because people do not get the g++ compiler compile
@@ -391,6 +409,11 @@ B3D, MS3D or X meshes */
 #ifdef NO_IRR_COMPILE_WITH_IRR_MESH_LOADER_
 #undef _IRR_COMPILE_WITH_IRR_MESH_LOADER_
 #endif
+//! Define _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_ if you want to load Irrlicht Engine binary .irrbin files
+#define _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+#ifdef NO_IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+#undef _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+#endif
 //! Define _IRR_COMPILE_WITH_HALFLIFE_LOADER_ if you want to load Halflife animated files
 #define _IRR_COMPILE_WITH_HALFLIFE_LOADER_
 #ifdef NO_IRR_COMPILE_WITH_HALFLIFE_LOADER_
@@ -477,6 +500,11 @@ B3D, MS3D or X meshes */
 #ifdef NO_IRR_COMPILE_WITH_IRR_WRITER_
 #undef _IRR_COMPILE_WITH_IRR_WRITER_
 #endif
+//! Define _IRR_COMPILE_WITH_IRR_BINARY_WRITER_ if you want to write binary .irrbin files
+#define _IRR_COMPILE_WITH_IRR_BINARY_WRITER_
+#ifdef NO_IRR_COMPILE_WITH_IRR_BINARY_WRITER_
+#undef _IRR_COMPILE_WITH_IRR_BINARY_WRITER_
+#endif
 //! Define _IRR_COMPILE_WITH_COLLADA_WRITER_ if you want to write Collada files
 #define _IRR_COMPILE_WITH_COLLADA_WRITER_
 #ifdef NO_IRR_COMPILE_WITH_COLLADA_WRITER_
@@ -47,6 +47,7 @@ namespace irr
 			DisplayAdapter(0),
 			DriverMultithreaded(false),
 			UsePerformanceTimer(true),
+			WorkerThreads(0),
 			SDK_version_do_not_use(IRRLICHT_SDK_VERSION)
 		{
 		}
@@ -79,6 +80,7 @@ namespace irr
 			DriverMultithreaded = other.DriverMultithreaded;
 			DisplayAdapter = other.DisplayAdapter;
 			UsePerformanceTimer = other.UsePerformanceTimer;
+			WorkerThreads = other.WorkerThreads;
 			return *this;
 		}
 
@@ -288,6 +290,13 @@ namespace irr
 		*/
 		bool UsePerformanceTimer;
 
+		//! Number of threads the engine may use for internal work.
+		/** 0 and 1 disable threading. So far only used by the
+		EDT_BURNINGSVIDEO driver, which then rasterizes in screen bands
+		on several threads. The resulting image is the same as with a
+		single thread. Needs _IRR_COMPILE_WITH_THREADS_. Default: 0 */
+		u32 WorkerThreads;
+
 		//! Don't use or change this parameter.
 		/** Always set it to IRRLICHT_SDK_VERSION, which is done by default.
 		This is needed for sdk version checks. */
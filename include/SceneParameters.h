@@ -174,6 +174,49 @@ namespace scene
 	**/
 	const c8* const DEBUG_NORMAL_COLOR = "DEBUG_Normal_Color";
 
+	//! Name of the parameter for the number of threads used by ISceneManager::drawAll()
+	/** With a value greater than 0, the nodes registered for rendering are
+	not culled inside ISceneManager::registerNodeForRendering() anymore, which
+	then always returns 1. They are collected in one list and culled in
+	parallel after all nodes are registered. The render lists get the nodes
+	in the same order as without threads. 0 (the default) disables it.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::PARALLEL_SCENE_THREADS, 4);
+	\endcode
+	**/
+	const c8* const PARALLEL_SCENE_THREADS = "Parallel_Scene_Threads";
+
+	//! Name of the parameter for animating the children of the root node in parallel
+	/** Only used together with PARALLEL_SCENE_THREADS. Each child of the root
+	scene node is animated together with its children on one of the threads.
+	Only enable this if the subtrees don't share data changed while animating,
+	like md2 or md3 meshes used by several animated mesh scene nodes or the
+	triangle selectors of animated nodes which collision response animators
+	use as world. Skinned meshes can be shared, nodes using the same skinned
+	mesh wait for each other. Collision response animators can collide with a
+	shared static world, their collision callbacks are called on the threads.
+	Reference counting is not thread safe either, so animators must not grab
+	or drop shared objects.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::PARALLEL_SCENE_ANIMATION, true);
+	\endcode
+	**/
+	const c8* const PARALLEL_SCENE_ANIMATION = "Parallel_Scene_Animation";
+
+	//! Name of the parameter for the time drawAll() spends on finishing background loads
+	/** Meshes and textures loaded with ISceneManager::getMeshAsync() and
+	getTextureAsync() are added to the mesh cache and the video driver by
+	drawAll() until this many milliseconds passed, the rest waits for the next
+	frame. At least one load is finished per frame. Default is 2.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::ASYNC_LOAD_BUDGET, 5);
+	\endcode
+	**/
+	const c8* const ASYNC_LOAD_BUDGET = "Async_Load_Budget";
+
 
 } // end namespace scene
 } // end namespace irr
@@ -13,6 +13,7 @@
 #include "IDummyTransformationSceneNode.h"
 #include "IBoneSceneNode.h"
 #include "IMaterialRenderer.h"
+#include "ICameraSceneNode.h"
 #include "IMesh.h"
 #include "IMeshCache.h"
 #include "IAnimatedMesh.h"
@@ -33,7 +34,8 @@ CAnimatedMeshSceneNode::CAnimatedMeshSceneNode(IAnimatedMesh* mesh,
 		const core::vector3df& scale)
 : IAnimatedMeshSceneNode(parent, mgr, id, position, rotation, scale), Mesh(0),
 	StartFrame(0), EndFrame(0), FramesPerSecond(0.025f),
-	CurrentFrameNr(0.f), LastTimeMs(0),
+	CurrentFrameNr(0.f), PoseFrameNr(0.f), AnimationLODDistance(0.f),
+	AnimationLODMaxInterval(1), AnimationLODCounter(0), LastTimeMs(0),
 	TransitionTime(0), Transiting(0.f), TransitingBlend(0.f),
 	JointMode(EJUOR_NONE), JointsUsed(false),
 	Looping(true), ReadOnlyMaterials(false), RenderFromIdentity(false),
@@ -69,6 +71,8 @@ void CAnimatedMeshSceneNode::setCurrentFrame(f32 frame)
 {
 	// if you pass an out of range value, we just clamp it
 	CurrentFrameNr = core::clamp ( frame, (f32)StartFrame, (f32)EndFrame );
+	PoseFrameNr = CurrentFrameNr;
+	AnimationLODCounter = 0;
 
 	beginTransition(); //transit to this frame if enabled
 }
@@ -189,8 +193,8 @@ IMesh * CAnimatedMeshSceneNode::getMeshForCurrentFrame()
 {
 	if(Mesh->getMeshType() != EAMT_SKINNED)
 	{
-		s32 frameNr = (s32) getFrameNr();
-		s32 frameBlend = (s32) (core::fract ( getFrameNr() ) * 1000.f);
+		s32 frameNr = (s32) PoseFrameNr;
+		s32 frameBlend = (s32) (core::fract ( PoseFrameNr ) * 1000.f);
 		return Mesh->getMesh(frameNr, frameBlend, StartFrame, EndFrame);
 	}
 	else
@@ -204,10 +208,18 @@ IMesh * CAnimatedMeshSceneNode::getMeshForCurrentFrame()
 
 		CSkinnedMesh* skinnedMesh = reinterpret_cast<CSkinnedMesh*>(Mesh);
 
+		// nodes showing the same frame can share one skinned copy of the mesh
+		if (JointMode == EJUOR_NONE)
+		{
+			IMesh* pose = skinnedMesh->getCachedPose(PoseFrameNr, AnimationCursors);
+			if (pose)
+				return pose;
+		}
+
 		if (JointMode == EJUOR_CONTROL)//write to mesh
 			skinnedMesh->transferJointsToMesh(JointChildSceneNodes);
 		else
-			skinnedMesh->animateMesh(getFrameNr(), 1.0f);
+			skinnedMesh->animateMesh(PoseFrameNr, 1.0f, AnimationCursors);
 
 		// Update the skinned mesh for the current joint transforms.
 		skinnedMesh->skinMesh();
@@ -247,13 +259,32 @@ void CAnimatedMeshSceneNode::OnAnimate(u32 timeMs)
 	// set CurrentFrameNr
 	buildFrameNr(timeMs-LastTimeMs);
 
+	// nodes which are small on the screen keep their pose for some frames
+	if (++AnimationLODCounter >= getAnimationLODInterval())
+	{
+		AnimationLODCounter = 0;
+		PoseFrameNr = CurrentFrameNr;
+	}
+
 	// update bbox
 	if (Mesh)
 	{
-		scene::IMesh * mesh = getMeshForCurrentFrame();
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+		// nodes sharing a skinned mesh can be animated on several threads,
+		// so the mesh must not be changed until we have its bounding box
+		if (Mesh->getMeshType() == EAMT_SKINNED)
+		{
+			CMutexLock lock(reinterpret_cast<CSkinnedMesh*>(Mesh)->getSkinningMutex());
+			Box = getMeshForCurrentFrame()->getBoundingBox();
+		}
+		else
+#endif
+		{
+			scene::IMesh * mesh = getMeshForCurrentFrame();
 
-		if (mesh)
-			Box = mesh->getBoundingBox();
+			if (mesh)
+				Box = mesh->getBoundingBox();
+		}
 	}
 	LastTimeMs = timeMs;
 
@@ -275,6 +306,17 @@ void CAnimatedMeshSceneNode::render()
 
 	++PassCount;
 
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	// nodes sharing a skinned mesh can be animated on other threads,
+	// and other nodes replace the cached pose in its buffers
+	CMutex* skinningMutex = 0;
+	if (Mesh->getMeshType() == EAMT_SKINNED)
+	{
+		skinningMutex = &reinterpret_cast<CSkinnedMesh*>(Mesh)->getSkinningMutex();
+		skinningMutex->lock();
+	}
+#endif
+
 	scene::IMesh* m = getMeshForCurrentFrame();
 
 	if(m)
@@ -468,6 +510,11 @@ void CAnimatedMeshSceneNode::render()
 			}
 		}
 	}
+
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	if (skinningMutex)
+		skinningMutex->unlock();
+#endif
 }
 
 
@@ -522,6 +569,33 @@ f32 CAnimatedMeshSceneNode::getAnimationSpeed() const
 }
 
 
+//! Updates the pose less often when the node is small on the screen
+void CAnimatedMeshSceneNode::setAnimationLOD(f32 distance, u32 maxInterval)
+{
+	AnimationLODDistance = distance;
+	AnimationLODMaxInterval = core::max_(maxInterval, 1u);
+}
+
+
+//! How many frames the pose is kept
+u32 CAnimatedMeshSceneNode::getAnimationLODInterval() const
+{
+	if (AnimationLODDistance <= 0.f || AnimationLODMaxInterval < 2)
+		return 1;
+
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (!camera)
+		return 1;
+
+	// the size on the screen depends on the radius divided by the distance
+	const f32 radius = getTransformedBoundingBox().getExtent().getLength() * 0.5f;
+	const f32 distance = camera->getAbsolutePosition().getDistanceFrom(getAbsolutePosition());
+	const f32 steps = distance / (AnimationLODDistance * core::max_(radius, core::ROUNDING_ERROR_f32));
+
+	return steps < (f32)AnimationLODMaxInterval ? 1 + (u32)steps : AnimationLODMaxInterval;
+}
+
+
 //! returns the axis aligned bounding box of this node
 const core::aabbox3d<f32>& CAnimatedMeshSceneNode::getBoundingBox() const
 {
@@ -826,6 +900,8 @@ void CAnimatedMeshSceneNode::setMesh(IAnimatedMesh* mesh)
 
 		// grab the mesh (it's non-null!)
 		Mesh->grab();
+
+		AnimationCursors.clear();
 	}
 
 	// get materials and bounding box
@@ -857,6 +933,8 @@ void CAnimatedMeshSceneNode::setMesh(IAnimatedMesh* mesh)
 	// get start and begin time
 	setAnimationSpeed(Mesh->getAnimationSpeed());	// NOTE: This had been commented out (but not removed!) in r3526. Which caused meshloader-values for speed to be ignored unless users specified explicitly. Missing a test-case where this could go wrong so I put the code back in.
 	setFrameLoop(0, Mesh->getFrameCount()-1);
+
+	SceneManager->updateSceneNodeIndex(this);
 }
 
 
@@ -1096,6 +1174,9 @@ ISceneNode* CAnimatedMeshSceneNode::clone(ISceneNode* newParent, ISceneManager*
 	newNode->EndFrame = EndFrame;
 	newNode->FramesPerSecond = FramesPerSecond;
 	newNode->CurrentFrameNr = CurrentFrameNr;
+	newNode->PoseFrameNr = PoseFrameNr;
+	newNode->AnimationLODDistance = AnimationLODDistance;
+	newNode->AnimationLODMaxInterval = AnimationLODMaxInterval;
 	newNode->JointMode = JointMode;
 	newNode->JointsUsed = JointsUsed;
 	newNode->TransitionTime = TransitionTime;
@@ -68,6 +68,9 @@ namespace scene
 		//! gets the speed with which the animation is played
 		virtual f32 getAnimationSpeed() const _IRR_OVERRIDE_;
 
+		//! Updates the pose less often when the node is small on the screen
+		virtual void setAnimationLOD(f32 distance, u32 maxInterval=8) _IRR_OVERRIDE_;
+
 		//! returns the material based on the zero based index i. To get the amount
 		//! of materials used by this scene node, use getMaterialCount().
 		//! This function is needed for inserting the node into the scene hirachy on a
@@ -167,6 +170,9 @@ namespace scene
 		IMesh* getMeshForCurrentFrame();
 
 		void buildFrameNr(u32 timeMs);
+
+		//! How many frames the pose is kept
+		u32 getAnimationLODInterval() const;
 		void checkJoints();
 		void beginTransition();
 
@@ -178,6 +184,11 @@ namespace scene
 		s32 EndFrame;
 		f32 FramesPerSecond;
 		f32 CurrentFrameNr;
+		//! Frame of the current pose, lags behind CurrentFrameNr with animation LOD
+		f32 PoseFrameNr;
+		f32 AnimationLODDistance;
+		u32 AnimationLODMaxInterval;
+		u32 AnimationLODCounter;
 
 		u32 LastTimeMs;
 		u32 TransitionTime; //Transition time in millisecs
@@ -198,6 +209,8 @@ namespace scene
 		IShadowVolumeSceneNode* Shadow;
 
 		core::array<IBoneSceneNode* > JointChildSceneNodes;
+		//! Key positions of the joints in the keys of a skinned mesh
+		core::array<s32> AnimationCursors;
 		core::array<core::matrix4> PretransitingSave;
 
 		// Quake3 Model
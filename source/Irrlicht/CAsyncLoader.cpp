@@ -0,0 +1,431 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CAsyncLoader.h"
+#include "ISceneManager.h"
+#include "IMeshCache.h"
+#include "IMeshLoader.h"
+#include "IAnimatedMesh.h"
+#include "IVideoDriver.h"
+#include "IFileSystem.h"
+#include "IFileArchive.h"
+#include "CReadFile.h"
+#include "CMemoryFile.h"
+#include "os.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+
+	//! reads a file completely into a memory file, drops the original file
+	io::IReadFile* createMemoryCopy(io::IReadFile* file)
+	{
+		const long size = file->getSize();
+		c8* memory = new c8[size > 0 ? size : 1];
+		file->seek(0);
+		const long read = (long)file->read(memory, size);
+		io::IReadFile* copy = new io::CMemoryReadFile(memory, read, file->getFileName(), true);
+		file->drop();
+		return copy;
+	}
+
+} // end anonymous namespace
+
+
+CAsyncLoadRequest::CAsyncLoadRequest(const io::path& filename, bool texture)
+	: FileName(filename), File(0), TextureType(video::ETT_2D), Driver(0),
+	Mesh(0), Texture(0), State(EALS_LOADING), IsTexture(texture),
+	LoadOnWorker(false), Loaded(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CAsyncLoadRequest");
+	#endif
+}
+
+
+CAsyncLoadRequest::~CAsyncLoadRequest()
+{
+	if (File)
+		File->drop();
+
+	for (u32 i=0; i<MeshLoaders.size(); ++i)
+		MeshLoaders[i]->drop();
+
+	for (u32 i=0; i<CallBacks.size(); ++i)
+		CallBacks[i]->drop();
+
+	for (u32 i=0; i<Images.size(); ++i)
+	{
+		if (Images[i])
+			Images[i]->drop();
+	}
+
+	if (Mesh)
+		Mesh->drop();
+
+	if (Texture)
+		Texture->drop();
+}
+
+
+//! grabs a callback, does nothing for 0
+void CAsyncLoadRequest::addCallBack(IAsyncLoadCallBack* callBack)
+{
+	if (!callBack)
+		return;
+
+	callBack->grab();
+	CallBacks.push_back(callBack);
+}
+
+
+CAsyncLoader::CAsyncLoader(ISceneManager* smgr)
+	: SceneManager(smgr), ThreadPool(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CAsyncLoader");
+	#endif
+
+	// keep the main thread free for rendering, but have at least one worker
+	ThreadPool = new CThreadPool(core::max_(CThreadPool::getProcessorCount(), 2u));
+}
+
+
+CAsyncLoader::~CAsyncLoader()
+{
+	// waits for all queued tasks
+	ThreadPool->drop();
+	os::Printer::logQueued();
+
+	for (u32 i=0; i<Requests.size(); ++i)
+		Requests[i]->drop();
+}
+
+
+//! starts loading a mesh
+IAsyncLoadRequest* CAsyncLoader::loadMesh(const io::path& filename, IAsyncLoadCallBack* callBack)
+{
+	CAsyncLoadRequest* request = findRequest(filename, false);
+	if (request)
+	{
+		request->addCallBack(callBack);
+		return request;
+	}
+
+	request = new CAsyncLoadRequest(filename, false);
+	request->addCallBack(callBack);
+	Requests.push_back(request);
+
+	request->Mesh = SceneManager->getMeshCache()->getMeshByName(filename);
+	if (request->Mesh)
+	{
+		request->Mesh->grab();
+		request->Loaded = true;
+		return request;
+	}
+
+	// iterate the list in reverse order like getMesh
+	request->LoadOnWorker = true;
+	for (s32 i=(s32)SceneManager->getMeshLoaderCount()-1; i>=0; --i)
+	{
+		IMeshLoader* loader = SceneManager->getMeshLoader(i);
+		if (loader->isALoadableFileExtension(filename))
+		{
+			loader->grab();
+			request->MeshLoaders.push_back(loader);
+			request->LoadOnWorker &= loader->canLoadOnWorkerThread();
+		}
+	}
+
+	start(request);
+	return request;
+}
+
+
+//! starts loading a texture
+IAsyncLoadRequest* CAsyncLoader::loadTexture(const io::path& filename, IAsyncLoadCallBack* callBack)
+{
+	CAsyncLoadRequest* request = findRequest(filename, true);
+	if (request)
+	{
+		request->addCallBack(callBack);
+		return request;
+	}
+
+	request = new CAsyncLoadRequest(filename, true);
+	request->addCallBack(callBack);
+	Requests.push_back(request);
+
+	request->Driver = SceneManager->getVideoDriver();
+	if (!request->Driver)
+	{
+		request->Loaded = true;
+		return request;
+	}
+
+	// same lookup as IVideoDriver::getTexture
+	request->Texture = request->Driver->findTexture(SceneManager->getFileSystem()->getAbsolutePath(filename));
+	if (!request->Texture)
+		request->Texture = request->Driver->findTexture(filename);
+
+	if (request->Texture)
+	{
+		request->Texture->grab();
+		request->Loaded = true;
+		return request;
+	}
+
+	request->LoadOnWorker = true;
+	start(request);
+	return request;
+}
+
+
+//! finishes loaded requests until the time budget is used up
+u32 CAsyncLoader::update(u32 timeBudgetMs)
+{
+	const u32 startTime = os::Timer::getRealTime();
+
+	// the loaders on the worker threads can't call the logger themselves
+	os::Printer::logQueued();
+
+	u32 i = 0;
+	while (i < Requests.size())
+	{
+		CAsyncLoadRequest* request = Requests[i];
+		{
+			CMutexLock lock(Mutex);
+			if (!request->Loaded)
+			{
+				++i;
+				continue;
+			}
+		}
+
+		finish(request);
+		Requests.erase(i);
+
+		// after erasing, as callbacks may start new loads
+		for (u32 j=0; j<request->CallBacks.size(); ++j)
+		{
+			request->CallBacks[j]->OnAsyncLoadDone(request);
+			request->CallBacks[j]->drop();
+		}
+		request->CallBacks.clear();
+		request->drop();
+
+		if (os::Timer::getRealTime() - startTime >= timeBudgetMs)
+			break;
+	}
+
+	return Requests.size();
+}
+
+
+//! returns a pending request for the file
+CAsyncLoadRequest* CAsyncLoader::findRequest(const io::path& filename, bool texture) const
+{
+	for (u32 i=0; i<Requests.size(); ++i)
+	{
+		if (Requests[i]->IsTexture == texture && Requests[i]->FileName == filename)
+			return Requests[i];
+	}
+	return 0;
+}
+
+
+//! opens archive files or hands the file to the thread pool
+void CAsyncLoader::start(CAsyncLoadRequest* request)
+{
+	io::IFileSystem* fileSystem = SceneManager->getFileSystem();
+
+	// Archives share one file handle for all their entries, so entries
+	// are read here. Same order as IFileSystem::createAndOpenFile.
+	for (u32 i=0; i<fileSystem->getFileArchiveCount(); ++i)
+	{
+		io::IReadFile* file = fileSystem->getFileArchive(i)->createAndOpenFile(request->FileName);
+		if (file)
+		{
+			request->File = createMemoryCopy(file);
+			break;
+		}
+	}
+
+	if (!request->File)
+		request->AbsolutePath = fileSystem->getAbsolutePath(request->FileName);
+
+	// nothing to do for the worker when the file is loaded and decoded here
+	if (request->File && !request->LoadOnWorker)
+	{
+		request->Loaded = true;
+		return;
+	}
+
+	{
+		CMutexLock lock(Mutex);
+		Queue.push_back(request);
+	}
+	ThreadPool->enqueue(loadTask, this);
+}
+
+
+//! reads and decodes the file of a request, runs on the thread pool
+void CAsyncLoader::loadTask(void* data, u32 index)
+{
+	CAsyncLoader* loader = (CAsyncLoader*)data;
+
+	CAsyncLoadRequest* request = 0;
+	{
+		CMutexLock lock(loader->Mutex);
+		request = loader->Queue[0];
+		loader->Queue.erase(0);
+	}
+
+	if (!request->File)
+		request->File = io::CReadFile::createReadFile(request->AbsolutePath);
+
+	if (request->File)
+	{
+		if (request->IsTexture)
+		{
+			request->Images = request->Driver->createImagesFromFile(request->File, &request->TextureType);
+		}
+		else if (request->LoadOnWorker)
+		{
+			for (u32 i=0; i<request->MeshLoaders.size() && !request->Mesh; ++i)
+			{
+				// reset file to avoid side effects of previous calls to createMesh
+				request->File->seek(0);
+				request->Mesh = request->MeshLoaders[i]->createMesh(request->File);
+			}
+		}
+		else
+		{
+			// the mesh loaders run on the main thread, only read the file
+			request->File = createMemoryCopy(request->File);
+		}
+	}
+
+	CMutexLock lock(loader->Mutex);
+	request->Loaded = true;
+}
+
+
+//! adds the result to the mesh cache or video driver
+void CAsyncLoader::finish(CAsyncLoadRequest* request)
+{
+	if (request->IsTexture)
+		finishTexture(request);
+	else
+		finishMesh(request);
+
+	if (request->File)
+	{
+		request->File->drop();
+		request->File = 0;
+	}
+
+	for (u32 i=0; i<request->MeshLoaders.size(); ++i)
+		request->MeshLoaders[i]->drop();
+	request->MeshLoaders.clear();
+
+	request->State = (request->Mesh || request->Texture) ? EALS_FINISHED : EALS_FAILED;
+}
+
+
+void CAsyncLoader::finishMesh(CAsyncLoadRequest* request)
+{
+	if (!request->File && !request->Mesh)
+	{
+		os::Printer::log("Could not load mesh, because file could not be opened: ", request->FileName, ELL_ERROR);
+		return;
+	}
+
+	IMeshCache* meshCache = SceneManager->getMeshCache();
+
+	// the mesh might have been loaded with getMesh in the meantime
+	IAnimatedMesh* cached = meshCache->getMeshByName(request->FileName);
+	if (cached)
+	{
+		cached->grab();
+		if (request->Mesh)
+			request->Mesh->drop();
+		request->Mesh = cached;
+		return;
+	}
+
+	if (!request->LoadOnWorker)
+	{
+		for (u32 i=0; i<request->MeshLoaders.size() && !request->Mesh; ++i)
+		{
+			request->File->seek(0);
+			request->Mesh = request->MeshLoaders[i]->createMesh(request->File);
+		}
+	}
+
+	if (request->Mesh)
+	{
+		meshCache->addMesh(request->FileName, request->Mesh);
+		os::Printer::log("Loaded mesh", request->FileName, ELL_DEBUG);
+	}
+	else
+		os::Printer::log("Could not load mesh, file format seems to be unsupported", request->FileName, ELL_ERROR);
+}
+
+
+void CAsyncLoader::finishTexture(CAsyncLoadRequest* request)
+{
+	if (request->Texture)
+		return;
+
+	if (!request->File)
+	{
+		os::Printer::log("Could not open file of texture", request->FileName, ELL_WARNING);
+		return;
+	}
+
+	video::IVideoDriver* driver = request->Driver;
+	const io::path& name = request->File->getFileName();
+
+	// the texture might have been loaded with getTexture in the meantime
+	request->Texture = driver->findTexture(name);
+
+	if (!request->Texture && request->Images.size())
+	{
+		if (request->TextureType == video::ETT_CUBEMAP)
+		{
+			if (request->Images.size() >= 6)
+				request->Texture = driver->addTextureCubemap(name, request->Images[0], request->Images[1],
+					request->Images[2], request->Images[3], request->Images[4], request->Images[5]);
+		}
+		else
+			request->Texture = driver->addTexture(name, request->Images[0]);
+
+		if (request->Texture)
+		{
+			request->Texture->updateSource(video::ETS_FROM_FILE);
+			os::Printer::log("Loaded texture", name, ELL_DEBUG);
+		}
+	}
+
+	if (request->Texture)
+		request->Texture->grab();
+	else
+		os::Printer::log("Could not load texture", request->FileName, ELL_ERROR);
+
+	for (u32 i=0; i<request->Images.size(); ++i)
+	{
+		if (request->Images[i])
+			request->Images[i]->drop();
+	}
+	request->Images.clear();
+}
+
+} // end namespace scene
+} // end namespace irr
+
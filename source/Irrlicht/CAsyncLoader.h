@@ -0,0 +1,148 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_ASYNC_LOADER_H_INCLUDED__
+#define __C_ASYNC_LOADER_H_INCLUDED__
+
+#include "IAsyncLoadRequest.h"
+#include "ITexture.h"
+#include "CThreadPool.h"
+
+namespace irr
+{
+namespace io
+{
+	class IReadFile;
+} // end namespace io
+namespace video
+{
+	class IImage;
+	class IVideoDriver;
+} // end namespace video
+namespace scene
+{
+	class ISceneManager;
+	class IMeshLoader;
+
+	//! A mesh or texture loaded by CAsyncLoader
+	class CAsyncLoadRequest : public IAsyncLoadRequest
+	{
+	public:
+
+		//! constructor
+		CAsyncLoadRequest(const io::path& filename, bool texture);
+
+		//! destructor
+		virtual ~CAsyncLoadRequest();
+
+		virtual const io::path& getFileName() const _IRR_OVERRIDE_ { return FileName; }
+
+		virtual E_ASYNC_LOAD_STATE getState() const _IRR_OVERRIDE_ { return State; }
+
+		virtual IAnimatedMesh* getMesh() const _IRR_OVERRIDE_
+		{
+			return State == EALS_FINISHED ? Mesh : 0;
+		}
+
+		virtual video::ITexture* getTexture() const _IRR_OVERRIDE_
+		{
+			return State == EALS_FINISHED ? Texture : 0;
+		}
+
+		//! grabs a callback, does nothing for 0
+		void addCallBack(IAsyncLoadCallBack* callBack);
+
+		io::path FileName;
+
+		//! file on disk opened by the worker thread when File is 0
+		io::path AbsolutePath;
+
+		//! file read by the worker thread, in memory when the main thread creates the mesh
+		io::IReadFile* File;
+
+		//! mesh loaders which can load the file, in the order getMesh() tries them
+		core::array<IMeshLoader*> MeshLoaders;
+
+		//! images decoded by the worker thread
+		core::array<video::IImage*> Images;
+		video::E_TEXTURE_TYPE TextureType;
+
+		//! driver for decoding images, not grabbed
+		video::IVideoDriver* Driver;
+
+		//! called and dropped when the request is finished, grabbed
+		core::array<IAsyncLoadCallBack*> CallBacks;
+
+		//! result, grabbed by the request
+		IAnimatedMesh* Mesh;
+		video::ITexture* Texture;
+
+		E_ASYNC_LOAD_STATE State;
+		bool IsTexture;
+
+		//! true if all MeshLoaders can run on the worker thread
+		bool LoadOnWorker;
+
+		//! set when the worker thread is done, protected by CAsyncLoader::Mutex
+		bool Loaded;
+	};
+
+
+	//! Loads meshes and textures for ISceneManager::getMeshAsync() and getTextureAsync()
+	/** Files are read and decoded on a thread pool, everything touching the
+	mesh cache, the video driver or the file system stays on the main thread. */
+	class CAsyncLoader : public virtual IReferenceCounted
+	{
+	public:
+
+		//! constructor, the scene manager owns the loader and is not grabbed
+		CAsyncLoader(ISceneManager* smgr);
+
+		//! destructor, waits for the worker threads
+		virtual ~CAsyncLoader();
+
+		//! starts loading a mesh
+		IAsyncLoadRequest* loadMesh(const io::path& filename, IAsyncLoadCallBack* callBack);
+
+		//! starts loading a texture
+		IAsyncLoadRequest* loadTexture(const io::path& filename, IAsyncLoadCallBack* callBack);
+
+		//! finishes loaded requests until the time budget is used up
+		/** Also logs the messages of the worker threads and calls the
+		callbacks of the finished requests.
+		\return number of pending requests */
+		u32 update(u32 timeBudgetMs);
+
+	private:
+
+		//! returns a pending request for the file
+		CAsyncLoadRequest* findRequest(const io::path& filename, bool texture) const;
+
+		//! opens archive files or hands the file to the thread pool
+		void start(CAsyncLoadRequest* request);
+
+		//! adds the result to the mesh cache or video driver
+		void finish(CAsyncLoadRequest* request);
+		void finishMesh(CAsyncLoadRequest* request);
+		void finishTexture(CAsyncLoadRequest* request);
+
+		//! reads and decodes the file of a request, runs on the thread pool
+		static void loadTask(void* loader, u32 index);
+
+		ISceneManager* SceneManager;
+		CThreadPool* ThreadPool;
+
+		//! requests which are not finished yet, in the order they were started
+		core::array<CAsyncLoadRequest*> Requests;
+
+		//! requests handed to loadTask, protected by Mutex
+		core::array<CAsyncLoadRequest*> Queue;
+		CMutex Mutex;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -0,0 +1,971 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CBVHTriangleSelector.h"
+#include "ISceneNode.h"
+#include "os.h"
+
+// the line tests use SSE2, which every x86 cpu with SSE2 has
+#if (defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(NO_IRR_TRIANGLE_SELECTOR_SSE_)
+	#define _IRR_TRIANGLE_SELECTOR_SSE_
+	#include <emmintrin.h>
+#endif
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+
+const u32 EmptyLane = 0xffffffff;
+
+//! nodes with at most this many triangles are always leaves, it's one packet
+const u32 MinSplitSize = 4;
+
+//! nodes with more triangles are split even when the heuristic says it doesn't pay
+const u32 MaxLeafSize = 8;
+
+//! bins per axis in which the surface area heuristic looks for splits
+const u32 BinCount = 16;
+
+//! deeper nodes are leaves, bounds the stacks of the traversals
+const u32 MaxDepth = 60;
+
+//! cost of visiting a node relative to testing a triangle
+const f32 TraversalCost = 1.f;
+
+//! slack of the barycentric coordinates, so lines through shared edges hit one of the triangles
+const f32 EdgeTolerance = 0.000001f;
+
+struct SBuildTask
+{
+	u32 Node;
+	u32 First;
+	u32 Count;
+	u32 Depth;
+};
+
+struct SBin
+{
+	f32 Min[3];
+	f32 Max[3];
+	u32 Count;
+};
+
+inline void resetBounds(f32* mn, f32* mx)
+{
+	for (u32 i=0; i<3; ++i)
+	{
+		mn[i] = FLT_MAX;
+		mx[i] = -FLT_MAX;
+	}
+}
+
+inline void addPoint(f32* mn, f32* mx, const core::vector3df& p)
+{
+	mn[0] = core::min_(mn[0], p.X);
+	mn[1] = core::min_(mn[1], p.Y);
+	mn[2] = core::min_(mn[2], p.Z);
+	mx[0] = core::max_(mx[0], p.X);
+	mx[1] = core::max_(mx[1], p.Y);
+	mx[2] = core::max_(mx[2], p.Z);
+}
+
+inline void addBounds(f32* mn, f32* mx, const f32* otherMin, const f32* otherMax)
+{
+	for (u32 i=0; i<3; ++i)
+	{
+		mn[i] = core::min_(mn[i], otherMin[i]);
+		mx[i] = core::max_(mx[i], otherMax[i]);
+	}
+}
+
+//! half the surface area of a box, empty boxes have none
+inline f32 getHalfArea(const f32* mn, const f32* mx)
+{
+	if (mn[0] > mx[0])
+		return 0.f;
+	const f32 dx = mx[0] - mn[0];
+	const f32 dy = mx[1] - mn[1];
+	const f32 dz = mx[2] - mn[2];
+	return dx*dy + dy*dz + dz*dx;
+}
+
+inline f32 getCoordinate(const core::vector3df& v, u32 axis)
+{
+	return axis == 0 ? v.X : (axis == 1 ? v.Y : v.Z);
+}
+
+//! bin of a triangle center, invalid coordinates end up in the first bin
+inline u32 getBin(f32 center, f32 start, f32 scale)
+{
+	const f32 f = (center - start) * scale;
+	if (!(f > 0.f))
+		return 0;
+	return f < (f32)BinCount ? (u32)f : BinCount - 1;
+}
+
+} // end anonymous namespace
+
+
+//! constructor
+CBVHTriangleSelector::CBVHTriangleSelector(const IMesh* mesh, ISceneNode* node, bool separateMeshbuffers)
+	: CTriangleSelector(mesh, node, separateMeshbuffers)
+{
+	#ifdef _DEBUG
+	setDebugName("CBVHTriangleSelector");
+	#endif
+
+	build();
+}
+
+
+//! constructor
+CBVHTriangleSelector::CBVHTriangleSelector(const IMeshBuffer* meshBuffer, irr::u32 materialIndex, ISceneNode* node)
+	: CTriangleSelector(meshBuffer, materialIndex, node)
+{
+	#ifdef _DEBUG
+	setDebugName("CBVHTriangleSelector");
+	#endif
+
+	build();
+}
+
+
+//! constructor
+CBVHTriangleSelector::CBVHTriangleSelector(IAnimatedMeshSceneNode* node, bool separateMeshbuffers)
+	: CTriangleSelector(node, separateMeshbuffers)
+{
+	#ifdef _DEBUG
+	setDebugName("CBVHTriangleSelector");
+	#endif
+
+	build();
+}
+
+
+//! builds the hierarchy over the current triangles
+void CBVHTriangleSelector::build()
+{
+	Nodes.clear();
+	Packets.clear();
+	PacketTriangles.clear();
+
+	const u32 triangleCount = Triangles.size();
+	if (!triangleCount)
+		return;
+
+	const u32 start = os::Timer::getRealTime();
+
+	// the build sorts the triangles into the leaves by reordering this list
+	core::array<core::vector3df> centers(triangleCount);
+	core::array<u32> order(triangleCount);
+	for (u32 i=0; i<triangleCount; ++i)
+	{
+		const core::triangle3df& tri = Triangles[i];
+		centers.push_back((tri.pointA + tri.pointB + tri.pointC) / 3.f);
+		order.push_back(i);
+	}
+
+	Nodes.reallocate(triangleCount / 2 + 1);
+	Nodes.push_back(SNode());
+
+	core::array<SBuildTask> tasks;
+	SBuildTask root = { 0, 0, triangleCount, 0 };
+	tasks.push_back(root);
+
+	SBin bins[BinCount];
+
+	while (!tasks.empty())
+	{
+		const SBuildTask task = tasks.getLast();
+		tasks.set_used(tasks.size() - 1);
+
+		// bounds of the triangles and of their centers
+		f32 mn[3], mx[3], centerMin[3], centerMax[3];
+		resetBounds(mn, mx);
+		resetBounds(centerMin, centerMax);
+		for (u32 i=task.First; i<task.First+task.Count; ++i)
+		{
+			const core::triangle3df& tri = Triangles[order[i]];
+			addPoint(mn, mx, tri.pointA);
+			addPoint(mn, mx, tri.pointB);
+			addPoint(mn, mx, tri.pointC);
+			addPoint(centerMin, centerMax, centers[order[i]]);
+		}
+		for (u32 i=0; i<3; ++i)
+		{
+			Nodes[task.Node].Min[i] = mn[i];
+			Nodes[task.Node].Max[i] = mx[i];
+		}
+
+		// find the split with the lowest cost by the surface area heuristic
+		s32 bestAxis = -1;
+		u32 bestSplit = 0;
+		f32 bestCost = FLT_MAX;
+		if (task.Count > MinSplitSize && task.Depth < MaxDepth)
+		{
+			const f32 nodeArea = getHalfArea(mn, mx);
+			const f32 invArea = nodeArea > 0.f ? 1.f / nodeArea : 0.f;
+
+			for (u32 axis=0; axis<3; ++axis)
+			{
+				const f32 extent = centerMax[axis] - centerMin[axis];
+				if (!(extent > 0.f))
+					continue;
+				const f32 scale = BinCount / extent;
+
+				for (u32 b=0; b<BinCount; ++b)
+				{
+					resetBounds(bins[b].Min, bins[b].Max);
+					bins[b].Count = 0;
+				}
+				for (u32 i=task.First; i<task.First+task.Count; ++i)
+				{
+					SBin& bin = bins[getBin(getCoordinate(centers[order[i]], axis), centerMin[axis], scale)];
+					const core::triangle3df& tri = Triangles[order[i]];
+					addPoint(bin.Min, bin.Max, tri.pointA);
+					addPoint(bin.Min, bin.Max, tri.pointB);
+					addPoint(bin.Min, bin.Max, tri.pointC);
+					++bin.Count;
+				}
+
+				// areas and counts left of each split, then sweep from the right
+				f32 leftArea[BinCount];
+				u32 leftCount[BinCount];
+				f32 boxMin[3], boxMax[3];
+				resetBounds(boxMin, boxMax);
+				u32 count = 0;
+				for (u32 b=1; b<BinCount; ++b)
+				{
+					addBounds(boxMin, boxMax, bins[b-1].Min, bins[b-1].Max);
+					count += bins[b-1].Count;
+					leftArea[b] = getHalfArea(boxMin, boxMax);
+					leftCount[b] = count;
+				}
+
+				resetBounds(boxMin, boxMax);
+				count = 0;
+				for (u32 b=BinCount-1; b>0; --b)
+				{
+					addBounds(boxMin, boxMax, bins[b].Min, bins[b].Max);
+					count += bins[b].Count;
+					if (!count || !leftCount[b])
+						continue;
+
+					const f32 cost = TraversalCost +
+						(leftArea[b] * leftCount[b] + getHalfArea(boxMin, boxMax) * count) * invArea;
+					if (cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = b;
+					}
+				}
+			}
+		}
+
+		const bool split = (bestAxis >= 0 && bestCost < task.Count) ||
+			(task.Count > MaxLeafSize && task.Depth < MaxDepth);
+		if (!split)
+		{
+			// leaves point into the order for now
+			Nodes[task.Node].First = task.First;
+			Nodes[task.Node].Count = task.Count;
+			continue;
+		}
+
+		u32 leftCount = task.Count / 2;
+		if (bestAxis >= 0)
+		{
+			const f32 scale = BinCount / (centerMax[bestAxis] - centerMin[bestAxis]);
+			u32 i = task.First;
+			u32 j = task.First + task.Count;
+			while (i < j)
+			{
+				if (getBin(getCoordinate(centers[order[i]], bestAxis), centerMin[bestAxis], scale) < bestSplit)
+					++i;
+				else
+					core::swap(order[i], order[--j]);
+			}
+			leftCount = i - task.First;
+		}
+		// else all centers are at the same place, the halves of the list are as good as anything
+
+		const u32 left = Nodes.size();
+		Nodes.push_back(SNode());
+		Nodes.push_back(SNode());
+		Nodes[task.Node].First = left;
+		Nodes[task.Node].Count = 0;
+
+		SBuildTask rightTask = { left + 1, task.First + leftCount, task.Count - leftCount, task.Depth + 1 };
+		SBuildTask leftTask = { left, task.First, leftCount, task.Depth + 1 };
+		tasks.push_back(rightTask);
+		tasks.push_back(leftTask);
+	}
+
+	// fill the leaves into packets of four triangles
+	PacketTriangles.reallocate(triangleCount + triangleCount / 2);
+	for (u32 n=0; n<Nodes.size(); ++n)
+	{
+		SNode& node = Nodes[n];
+		if (!node.Count)
+			continue;
+
+		const u32 first = node.First;
+		node.First = PacketTriangles.size() / 4;
+		for (u32 i=0; i<(node.Count + 3) / 4 * 4; ++i)
+			PacketTriangles.push_back(i < node.Count ? order[first + i] : EmptyLane);
+	}
+	updatePackets();
+
+	c8 tmp[256];
+	sprintf(tmp, "Needed %ums to create BVHTriangleSelector.(%u nodes, %u polys)",
+		os::Timer::getRealTime() - start, Nodes.size(), triangleCount);
+	os::Printer::log(tmp, ELL_INFORMATION);
+}
+
+
+//! copies the triangles into the packets of the leaves
+void CBVHTriangleSelector::updatePackets() const
+{
+	Packets.set_used(PacketTriangles.size() / 4);
+	for (u32 p=0; p<Packets.size(); ++p)
+	{
+		STrianglePacket& packet = Packets[p];
+		for (u32 lane=0; lane<4; ++lane)
+		{
+			const u32 index = PacketTriangles[p*4 + lane];
+			core::vector3df v0, edge1, edge2;
+			if (index != EmptyLane)
+			{
+				const core::triangle3df& tri = Triangles[index];
+				v0 = tri.pointA;
+				edge1 = tri.pointB - tri.pointA;
+				edge2 = tri.pointC - tri.pointA;
+			}
+			packet.V0[0][lane] = v0.X;
+			packet.V0[1][lane] = v0.Y;
+			packet.V0[2][lane] = v0.Z;
+			packet.Edge1[0][lane] = edge1.X;
+			packet.Edge1[1][lane] = edge1.Y;
+			packet.Edge1[2][lane] = edge1.Z;
+			packet.Edge2[0][lane] = edge2.X;
+			packet.Edge2[1][lane] = edge2.Y;
+			packet.Edge2[2][lane] = edge2.Z;
+		}
+	}
+}
+
+
+//! reads the triangles of a new frame of the animated node and refits the hierarchy
+void CBVHTriangleSelector::update() const
+{
+	const u32 lastFrame = LastMeshFrame;
+	CTriangleSelector::update();
+	if (LastMeshFrame != lastFrame)
+		refit();
+}
+
+
+//! sets the boxes of all nodes to the current triangles without changing the hierarchy
+void CBVHTriangleSelector::refit() const
+{
+	updatePackets();
+
+	// children are always behind their parent, so they are done first
+	for (u32 n=Nodes.size(); n>0; --n)
+	{
+		SNode& node = Nodes[n-1];
+		resetBounds(node.Min, node.Max);
+		if (node.Count)
+		{
+			for (u32 i=0; i<node.Count; ++i)
+			{
+				const core::triangle3df& tri = Triangles[PacketTriangles[node.First*4 + i]];
+				addPoint(node.Min, node.Max, tri.pointA);
+				addPoint(node.Min, node.Max, tri.pointB);
+				addPoint(node.Min, node.Max, tri.pointC);
+			}
+		}
+		else
+		{
+			addBounds(node.Min, node.Max, Nodes[node.First].Min, Nodes[node.First].Max);
+			addBounds(node.Min, node.Max, Nodes[node.First+1].Min, Nodes[node.First+1].Max);
+		}
+	}
+}
+
+
+namespace
+{
+
+//! prepares a line for the tests, the parameter of hits runs from 0 at the start to 1 at the end
+template <class TRay>
+void setRay(TRay& ray, const core::line3df& line)
+{
+	const core::vector3df dir = line.getVector();
+	const f32 d[3] = { dir.X, dir.Y, dir.Z };
+	ray.Origin[0] = line.start.X;
+	ray.Origin[1] = line.start.Y;
+	ray.Origin[2] = line.start.Z;
+	for (u32 i=0; i<3; ++i)
+	{
+		ray.Dir[i] = d[i];
+		// no infinities, they would make NaNs at the planes of boxes
+		if (core::abs_(d[i]) > 1e-30f)
+			ray.InvDir[i] = 1.f / d[i];
+		else
+			ray.InvDir[i] = d[i] < 0.f ? -1e30f : 1e30f;
+	}
+	// the fourth lanes are multiplied with the First and Count of nodes
+	ray.Origin[3] = ray.Dir[3] = ray.InvDir[3] = 0.f;
+}
+
+//! tests a line against the box of a node, hits are in [0,tMax]
+template <class TNode, class TRay>
+inline bool intersectBox(const TNode& node, const TRay& ray, f32 tMax, f32& tEnter)
+{
+#ifdef _IRR_TRIANGLE_SELECTOR_SSE_
+	const __m128 origin = _mm_loadu_ps(ray.Origin);
+	const __m128 invDir = _mm_loadu_ps(ray.InvDir);
+	const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.Min), origin), invDir);
+	const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.Max), origin), invDir);
+
+	// the fourth lane is 0, which clamps the entry to the start of the line,
+	// but it must not limit the exit
+	__m128 tNear = _mm_min_ps(t0, t1);
+	__m128 tFar = _mm_or_ps(_mm_max_ps(t0, t1), _mm_castsi128_ps(_mm_set_epi32(0x7f800000, 0, 0, 0)));
+
+	tNear = _mm_max_ps(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(2, 3, 0, 1)));
+	tNear = _mm_max_ps(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(1, 0, 3, 2)));
+	tFar = _mm_min_ps(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(2, 3, 0, 1)));
+	tFar = _mm_min_ps(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(1, 0, 3, 2)));
+
+	tEnter = _mm_cvtss_f32(tNear);
+	return tEnter <= core::min_(_mm_cvtss_f32(tFar), tMax);
+#else
+	f32 enter = 0.f;
+	f32 exit = tMax;
+	for (u32 i=0; i<3; ++i)
+	{
+		const f32 t0 = (node.Min[i] - ray.Origin[i]) * ray.InvDir[i];
+		const f32 t1 = (node.Max[i] - ray.Origin[i]) * ray.InvDir[i];
+		enter = core::max_(enter, core::min_(t0, t1));
+		exit = core::min_(exit, core::max_(t0, t1));
+	}
+	tEnter = enter;
+	return enter <= exit;
+#endif
+}
+
+//! tests a line against the four triangles of a packet
+/** \return Bit mask of the lanes which are hit in [0,tMax], their
+parameters are written to outT. */
+template <class TPacket, class TRay>
+inline u32 intersectPacket(const TPacket& p, const TRay& ray, f32 tMax, f32* outT)
+{
+#ifdef _IRR_TRIANGLE_SELECTOR_SSE_
+	const __m128 dx = _mm_set1_ps(ray.Dir[0]);
+	const __m128 dy = _mm_set1_ps(ray.Dir[1]);
+	const __m128 dz = _mm_set1_ps(ray.Dir[2]);
+	const __m128 e1x = _mm_loadu_ps(p.Edge1[0]);
+	const __m128 e1y = _mm_loadu_ps(p.Edge1[1]);
+	const __m128 e1z = _mm_loadu_ps(p.Edge1[2]);
+	const __m128 e2x = _mm_loadu_ps(p.Edge2[0]);
+	const __m128 e2y = _mm_loadu_ps(p.Edge2[1]);
+	const __m128 e2z = _mm_loadu_ps(p.Edge2[2]);
+
+	// Moeller-Trumbore, for both sides of the triangles
+	const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+	const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+	const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+	const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+
+	const __m128 tx = _mm_sub_ps(_mm_set1_ps(ray.Origin[0]), _mm_loadu_ps(p.V0[0]));
+	const __m128 ty = _mm_sub_ps(_mm_set1_ps(ray.Origin[1]), _mm_loadu_ps(p.V0[1]));
+	const __m128 tz = _mm_sub_ps(_mm_set1_ps(ray.Origin[2]), _mm_loadu_ps(p.V0[2]));
+	const __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+	const __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+	const __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+
+	const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.f), det);
+	const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), invDet);
+	const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+	const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 low = _mm_set1_ps(-EdgeTolerance);
+	__m128 mask = _mm_cmpneq_ps(det, zero);
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(u, low));
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(v, low));
+	mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.f + EdgeTolerance)));
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(t, zero));
+	mask = _mm_and_ps(mask, _mm_cmple_ps(t, _mm_set1_ps(tMax)));
+
+	_mm_storeu_ps(outT, t);
+	return (u32)_mm_movemask_ps(mask);
+#else
+	u32 mask = 0;
+	const f32* d = ray.Dir;
+	for (u32 lane=0; lane<4; ++lane)
+	{
+		const f32 e1[3] = { p.Edge1[0][lane], p.Edge1[1][lane], p.Edge1[2][lane] };
+		const f32 e2[3] = { p.Edge2[0][lane], p.Edge2[1][lane], p.Edge2[2][lane] };
+
+		// Moeller-Trumbore, for both sides of the triangles
+		const f32 pv[3] = { d[1]*e2[2] - d[2]*e2[1], d[2]*e2[0] - d[0]*e2[2], d[0]*e2[1] - d[1]*e2[0] };
+		const f32 det = e1[0]*pv[0] + e1[1]*pv[1] + e1[2]*pv[2];
+		if (det == 0.f)
+			continue;
+		const f32 invDet = 1.f / det;
+
+		const f32 tv[3] = { ray.Origin[0] - p.V0[0][lane], ray.Origin[1] - p.V0[1][lane], ray.Origin[2] - p.V0[2][lane] };
+		const f32 u = (tv[0]*pv[0] + tv[1]*pv[1] + tv[2]*pv[2]) * invDet;
+		if (!(u >= -EdgeTolerance))
+			continue;
+
+		const f32 qv[3] = { tv[1]*e1[2] - tv[2]*e1[1], tv[2]*e1[0] - tv[0]*e1[2], tv[0]*e1[1] - tv[1]*e1[0] };
+		const f32 v = (d[0]*qv[0] + d[1]*qv[1] + d[2]*qv[2]) * invDet;
+		if (!(v >= -EdgeTolerance) || !(u + v <= 1.f + EdgeTolerance))
+			continue;
+
+		const f32 t = (e2[0]*qv[0] + e2[1]*qv[1] + e2[2]*qv[2]) * invDet;
+		if (t >= 0.f && t <= tMax)
+		{
+			outT[lane] = t;
+			mask |= 1 << lane;
+		}
+	}
+	return mask;
+#endif
+}
+
+//! node and triangle test of box queries
+struct SBoxTest
+{
+	SBoxTest(const core::aabbox3df& box) : Box(box) {}
+
+	template <class TNode>
+	bool node(const TNode& n) const
+	{
+		return n.Min[0] <= Box.MaxEdge.X && n.Max[0] >= Box.MinEdge.X &&
+			n.Min[1] <= Box.MaxEdge.Y && n.Max[1] >= Box.MinEdge.Y &&
+			n.Min[2] <= Box.MaxEdge.Z && n.Max[2] >= Box.MinEdge.Z;
+	}
+
+	bool triangle(const core::triangle3df& tri) const
+	{
+		// This isn't an accurate test, but it's fast, and the
+		// API contract doesn't guarantee complete accuracy.
+		return !tri.isTotalOutsideBox(Box);
+	}
+
+	core::aabbox3df Box;
+};
+
+//! node and triangle test of line queries
+template <class TRay>
+struct SLineTest
+{
+	SLineTest(const core::line3df& line) : Box(line.start)
+	{
+		Box.addInternalPoint(line.end);
+		setRay(Ray, line);
+	}
+
+	template <class TNode>
+	bool node(const TNode& n) const
+	{
+		f32 t;
+		return intersectBox(n, Ray, 1.f, t);
+	}
+
+	bool triangle(const core::triangle3df& tri) const
+	{
+		return !tri.isTotalOutsideBox(Box);
+	}
+
+	core::aabbox3df Box;
+	TRay Ray;
+};
+
+//! node and triangle test of frustum queries, points in front of a plane are outside
+struct SFrustumTest
+{
+	SFrustumTest(const SViewFrustum& frustum)
+	{
+		for (u32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+			Planes[i] = frustum.planes[i];
+	}
+
+	template <class TNode>
+	bool node(const TNode& n) const
+	{
+		for (u32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+		{
+			// the corner of the box furthest behind the plane
+			const core::vector3df& normal = Planes[i].Normal;
+			const f32 d = normal.X * (normal.X > 0.f ? n.Min[0] : n.Max[0]) +
+				normal.Y * (normal.Y > 0.f ? n.Min[1] : n.Max[1]) +
+				normal.Z * (normal.Z > 0.f ? n.Min[2] : n.Max[2]) + Planes[i].D;
+			if (d > 0.f)
+				return false;
+		}
+		return true;
+	}
+
+	bool triangle(const core::triangle3df& tri) const
+	{
+		for (u32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+		{
+			const core::plane3df& plane = Planes[i];
+			if (plane.Normal.dotProduct(tri.pointA) + plane.D > 0.f &&
+				plane.Normal.dotProduct(tri.pointB) + plane.D > 0.f &&
+				plane.Normal.dotProduct(tri.pointC) + plane.D > 0.f)
+				return false;
+		}
+		return true;
+	}
+
+	core::plane3df Planes[SViewFrustum::VF_PLANE_COUNT];
+};
+
+} // end anonymous namespace
+
+
+//! finds the nearest triangle the line hits
+s32 CBVHTriangleSelector::intersect(const SRay& ray, bool anyHit, f32& outT) const
+{
+	if (Nodes.empty())
+		return -1;
+
+	struct SEntry
+	{
+		u32 Node;
+		f32 T;
+	};
+	SEntry stack[MaxDepth + 2];
+	u32 stackSize = 0;
+
+	f32 best = 1.f;
+	s32 result = -1;
+
+	f32 t;
+	if (!intersectBox(Nodes[0], ray, best, t))
+		return -1;
+	stack[stackSize].Node = 0;
+	stack[stackSize++].T = t;
+
+	while (stackSize)
+	{
+		const SEntry entry = stack[--stackSize];
+		if (entry.T > best)
+			continue;
+
+		const SNode& node = Nodes[entry.Node];
+		if (node.Count)
+		{
+			const u32 end = node.First + (node.Count + 3) / 4;
+			for (u32 p=node.First; p<end; ++p)
+			{
+				f32 hits[4];
+				const u32 mask = intersectPacket(Packets[p], ray, best, hits);
+				if (!mask)
+					continue;
+
+				for (u32 lane=0; lane<4; ++lane)
+				{
+					if ((mask & (1 << lane)) && hits[lane] <= best)
+					{
+						best = hits[lane];
+						result = PacketTriangles[p*4 + lane];
+					}
+				}
+				if (anyHit)
+				{
+					outT = best;
+					return result;
+				}
+			}
+		}
+		else
+		{
+			// visit the nearer child first, it may make the other one too far
+			f32 tLeft, tRight;
+			const bool left = intersectBox(Nodes[node.First], ray, best, tLeft);
+			const bool right = intersectBox(Nodes[node.First + 1], ray, best, tRight);
+			if (left && right)
+			{
+				const bool leftFirst = tLeft <= tRight;
+				stack[stackSize].Node = leftFirst ? node.First + 1 : node.First;
+				stack[stackSize++].T = leftFirst ? tRight : tLeft;
+				stack[stackSize].Node = leftFirst ? node.First : node.First + 1;
+				stack[stackSize++].T = leftFirst ? tLeft : tRight;
+			}
+			else if (left || right)
+			{
+				stack[stackSize].Node = left ? node.First : node.First + 1;
+				stack[stackSize++].T = left ? tLeft : tRight;
+			}
+		}
+	}
+
+	outT = best;
+	return result;
+}
+
+
+//! writes the triangles of the leaves which pass a test into an array
+template <class TTest>
+void CBVHTriangleSelector::collectTriangles(const TTest& test, core::triangle3df* triangles,
+		s32 arraySize, s32& outTriangleCount, const core::matrix4& transform,
+		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const
+{
+	outTriangleCount = 0;
+	if (Nodes.empty() || arraySize <= 0 || !test.node(Nodes[0]))
+		return;
+
+	const u32 firstInfo = outTriangleInfo ? outTriangleInfo->size() : 0;
+	s32 triangleCount = 0;
+
+	u32 stack[MaxDepth + 2];
+	u32 stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize && triangleCount < arraySize)
+	{
+		const SNode& node = Nodes[stack[--stackSize]];
+		if (!node.Count)
+		{
+			if (test.node(Nodes[node.First]))
+				stack[stackSize++] = node.First;
+			if (test.node(Nodes[node.First + 1]))
+				stack[stackSize++] = node.First + 1;
+			continue;
+		}
+
+		for (u32 i=0; i<node.Count && triangleCount < arraySize; ++i)
+		{
+			const u32 index = PacketTriangles[node.First*4 + i];
+			const core::triangle3df& tri = Triangles[index];
+			if (!test.triangle(tri))
+				continue;
+
+			transform.transformVect(triangles[triangleCount].pointA, tri.pointA);
+			transform.transformVect(triangles[triangleCount].pointB, tri.pointB);
+			transform.transformVect(triangles[triangleCount].pointC, tri.pointC);
+
+			if (outTriangleInfo)
+			{
+				// ranges of triangles from the same meshbuffer
+				const SCollisionTriangleRange* bufferRange = getBufferRange(index);
+				const IMeshBuffer* meshBuffer = bufferRange ? bufferRange->MeshBuffer : MeshBuffer;
+				const u32 materialIndex = bufferRange ? bufferRange->MaterialIndex : MaterialIndex;
+
+				if (outTriangleInfo->size() > firstInfo &&
+					outTriangleInfo->getLast().MeshBuffer == meshBuffer &&
+					outTriangleInfo->getLast().MaterialIndex == materialIndex)
+				{
+					++outTriangleInfo->getLast().RangeSize;
+				}
+				else
+				{
+					SCollisionTriangleRange triRange;
+					triRange.RangeStart = triangleCount;
+					triRange.RangeSize = 1;
+					triRange.Selector = const_cast<CBVHTriangleSelector*>(this);
+					triRange.SceneNode = SceneNode;
+					triRange.MeshBuffer = meshBuffer;
+					triRange.MaterialIndex = materialIndex;
+					outTriangleInfo->push_back(triRange);
+				}
+			}
+
+			++triangleCount;
+		}
+	}
+
+	outTriangleCount = triangleCount;
+}
+
+
+//! gets the meshbuffer range of a triangle, or 0 without ranges
+const SCollisionTriangleRange* CBVHTriangleSelector::getBufferRange(u32 triangleIndex) const
+{
+	if (BufferRanges.empty())
+		return 0;
+
+	// the last range starting at or before the triangle, empty ones are skipped that way
+	u32 lo = 0;
+	u32 hi = BufferRanges.size();
+	while (hi - lo > 1)
+	{
+		const u32 mid = (lo + hi) / 2;
+		if (BufferRanges[mid].RangeStart <= triangleIndex)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return &BufferRanges[lo];
+}
+
+
+//! Gets all triangles which lie within a specific bounding box.
+void CBVHTriangleSelector::getTriangles(core::triangle3df* triangles,
+					s32 arraySize, s32& outTriangleCount,
+					const core::aabbox3d<f32>& box,
+					const core::matrix4* transform, bool useNodeTransform,
+					irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const
+{
+	update();
+
+	core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
+	core::aabbox3df tBox(box);
+
+	if (SceneNode && useNodeTransform)
+	{
+		if ( SceneNode->getAbsoluteTransformation().getInverse(mat) )
+			mat.transformBoxEx(tBox);
+		else
+		{
+			// If a node has an axis scaled to 0 we return all triangles without any check
+			CTriangleSelector::getTriangles(triangles, arraySize, outTriangleCount,
+					transform, useNodeTransform, outTriangleInfo);
+			return;
+		}
+	}
+	if (transform)
+		mat = *transform;
+	else
+		mat.makeIdentity();
+	if (SceneNode && useNodeTransform)
+		mat *= SceneNode->getAbsoluteTransformation();
+
+	collectTriangles(SBoxTest(tBox), triangles, arraySize, outTriangleCount, mat, outTriangleInfo);
+}
+
+
+//! Gets all triangles which have or may have contact with a 3d line.
+void CBVHTriangleSelector::getTriangles(core::triangle3df* triangles,
+					s32 arraySize, s32& outTriangleCount,
+					const core::line3d<f32>& line,
+					const core::matrix4* transform, bool useNodeTransform,
+					irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const
+{
+	update();
+
+	core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
+	core::line3df tLine(line);
+
+	if (SceneNode && useNodeTransform)
+	{
+		if ( SceneNode->getAbsoluteTransformation().getInverse(mat) )
+		{
+			mat.transformVect(tLine.start);
+			mat.transformVect(tLine.end);
+		}
+		else
+		{
+			CTriangleSelector::getTriangles(triangles, arraySize, outTriangleCount,
+					transform, useNodeTransform, outTriangleInfo);
+			return;
+		}
+	}
+	if (transform)
+		mat = *transform;
+	else
+		mat.makeIdentity();
+	if (SceneNode && useNodeTransform)
+		mat *= SceneNode->getAbsoluteTransformation();
+
+	collectTriangles(SLineTest<SRay>(tLine), triangles, arraySize, outTriangleCount, mat, outTriangleInfo);
+}
+
+
+//! Gets all triangles which may lie within a view frustum.
+void CBVHTriangleSelector::getTriangles(core::triangle3df* triangles,
+					s32 arraySize, s32& outTriangleCount,
+					const SViewFrustum& frustum,
+					const core::matrix4* transform, bool useNodeTransform,
+					irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const
+{
+	update();
+
+	core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
+	SViewFrustum tFrustum(frustum);
+
+	if (SceneNode && useNodeTransform)
+	{
+		if ( SceneNode->getAbsoluteTransformation().getInverse(mat) )
+		{
+			for (u32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+				mat.transformPlane(tFrustum.planes[i]);
+		}
+		else
+		{
+			CTriangleSelector::getTriangles(triangles, arraySize, outTriangleCount,
+					transform, useNodeTransform, outTriangleInfo);
+			return;
+		}
+	}
+	if (transform)
+		mat = *transform;
+	else
+		mat.makeIdentity();
+	if (SceneNode && useNodeTransform)
+		mat *= SceneNode->getAbsoluteTransformation();
+
+	collectTriangles(SFrustumTest(tFrustum), triangles, arraySize, outTriangleCount, mat, outTriangleInfo);
+}
+
+
+//! Finds the nearest collision point of a 3d line and the triangles
+bool CBVHTriangleSelector::getCollisionPoint(SCollisionHit& hitResult, const core::line3d<f32>& line,
+		bool useNodeTransform, bool anyHit) const
+{
+	update();
+
+	const bool nodeTransform = SceneNode && useNodeTransform;
+	core::line3df tLine(line);
+	if (nodeTransform)
+	{
+		core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
+		if (!SceneNode->getAbsoluteTransformation().getInverse(mat))
+			return false;
+		mat.transformVect(tLine.start);
+		mat.transformVect(tLine.end);
+	}
+
+	SRay ray;
+	setRay(ray, tLine);
+	f32 t;
+	const s32 index = intersect(ray, anyHit, t);
+	if (index < 0)
+		return false;
+
+	// the parameter along the line is the same in both spaces
+	hitResult.Intersection = line.start + line.getVector() * t;
+	hitResult.Triangle = Triangles[index];
+	if (nodeTransform)
+	{
+		const core::matrix4& mat = SceneNode->getAbsoluteTransformation();
+		mat.transformVect(hitResult.Triangle.pointA);
+		mat.transformVect(hitResult.Triangle.pointB);
+		mat.transformVect(hitResult.Triangle.pointC);
+	}
+
+	const SCollisionTriangleRange* bufferRange = getBufferRange(index);
+	hitResult.TriangleSelector = const_cast<CBVHTriangleSelector*>(this);
+	hitResult.Node = SceneNode;
+	hitResult.MeshBuffer = bufferRange ? bufferRange->MeshBuffer : MeshBuffer;
+	hitResult.MaterialIndex = bufferRange ? bufferRange->MaterialIndex : MaterialIndex;
+	return true;
+}
+
+} // end namespace scene
+} // end namespace irr
+
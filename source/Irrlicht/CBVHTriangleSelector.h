@@ -0,0 +1,127 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BVH_TRIANGLE_SELECTOR_H_INCLUDED__
+#define __C_BVH_TRIANGLE_SELECTOR_H_INCLUDED__
+
+#include "CTriangleSelector.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Triangle selector which keeps the triangles in a bounding volume hierarchy
+/** The hierarchy is built in the space of the mesh with a binned surface
+area heuristic. Nodes are stored in one array, the children of a node are
+next to each other and always behind it. Leaves reference packets of four
+triangles which hold the first corner and both edges of each triangle as
+structure of arrays, so lines are tested against four triangles at once
+(with SSE where available) without copying any of them.
+Selectors of animated mesh scene nodes build the hierarchy for the first
+frame. When the frame changes, the triangles are read again and the boxes of
+the nodes are refit to them, the structure of the hierarchy stays. */
+class CBVHTriangleSelector : public CTriangleSelector
+{
+public:
+
+	//! Constructs a selector based on a mesh
+	CBVHTriangleSelector(const IMesh* mesh, ISceneNode* node, bool separateMeshbuffers);
+
+	//! Constructs a selector based on a meshbuffer
+	CBVHTriangleSelector(const IMeshBuffer* meshBuffer, irr::u32 materialIndex, ISceneNode* node);
+
+	//! Constructs a selector based on an animated mesh scene node, which follows its animation
+	CBVHTriangleSelector(IAnimatedMeshSceneNode* node, bool separateMeshbuffers);
+
+	//! Gets all triangles which lie within a specific bounding box.
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize, s32& outTriangleCount,
+		const core::aabbox3d<f32>& box, const core::matrix4* transform, bool useNodeTransform,
+		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const _IRR_OVERRIDE_;
+
+	//! Gets all triangles which have or may have contact with a 3d line.
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize,
+		s32& outTriangleCount, const core::line3d<f32>& line,
+		const core::matrix4* transform, bool useNodeTransform,
+		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const _IRR_OVERRIDE_;
+
+	//! Gets all triangles which may lie within a view frustum.
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize,
+		s32& outTriangleCount, const SViewFrustum& frustum,
+		const core::matrix4* transform, bool useNodeTransform,
+		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const _IRR_OVERRIDE_;
+
+	//! Check if the selector can find collision points itself
+	virtual bool isCollisionPointSupported() const _IRR_OVERRIDE_ { return true; }
+
+	//! Finds the nearest collision point of a 3d line and the triangles
+	virtual bool getCollisionPoint(SCollisionHit& hitResult, const core::line3d<f32>& line,
+		bool useNodeTransform, bool anyHit) const _IRR_OVERRIDE_;
+
+	//! reads the triangles of a new frame of the animated node and refits the hierarchy
+	virtual void update() const _IRR_OVERRIDE_;
+
+protected:
+
+	//! builds the hierarchy over the current triangles
+	void build();
+
+	//! copies the triangles into the packets of the leaves
+	void updatePackets() const;
+
+	//! sets the boxes of all nodes to the current triangles without changing the hierarchy
+	void refit() const;
+
+	struct SNode
+	{
+		f32 Min[3];
+		//! index of the first child for inner nodes, of the first packet for leaves
+		u32 First;
+		f32 Max[3];
+		//! 0 for inner nodes, number of triangles for leaves
+		u32 Count;
+	};
+
+	//! four triangles as first corner and edges, unused lanes have empty edges
+	struct STrianglePacket
+	{
+		f32 V0[3][4];
+		f32 Edge1[3][4];
+		f32 Edge2[3][4];
+	};
+
+	//! a line prepared for the box and triangle tests
+	struct SRay
+	{
+		f32 Origin[4];
+		f32 Dir[4];
+		f32 InvDir[4];
+	};
+
+	//! finds the nearest triangle the line hits
+	/** \return Index of the triangle in Triangles, or -1. */
+	s32 intersect(const SRay& ray, bool anyHit, f32& outT) const;
+
+	//! writes the triangles of the leaves which pass a test into an array
+	template <class TTest>
+	void collectTriangles(const TTest& test, core::triangle3df* triangles, s32 arraySize,
+		s32& outTriangleCount, const core::matrix4& transform,
+		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const;
+
+	//! gets the meshbuffer range of a triangle, or 0 without ranges
+	const SCollisionTriangleRange* getBufferRange(u32 triangleIndex) const;
+
+	// mutable for refitting to the frames of animated meshes
+	mutable core::array<SNode> Nodes;
+	mutable core::array<STrianglePacket> Packets;
+
+	//! index in Triangles of each lane of the packets, EmptyLane for unused ones
+	core::array<u32> PacketTriangles;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
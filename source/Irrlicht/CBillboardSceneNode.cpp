@@ -165,6 +165,7 @@ void CBillboardSceneNode::setSize(const core::dimension2d<f32>& size)
 	const f32 avg = (Size.Width + Size.Height)/6;
 	BBoxSafe.MinEdge.set(-avg,-avg,-avg);
 	BBoxSafe.MaxEdge.set(avg,avg,avg);
+	SceneManager->updateSceneNodeIndex(this);
 }
 
 
@@ -185,6 +186,7 @@ void CBillboardSceneNode::setSize(f32 height, f32 bottomEdgeWidth, f32 topEdgeWi
 	const f32 avg = (core::max_(Size.Width,TopEdgeWidth) + Size.Height)/6;
 	BBoxSafe.MinEdge.set(-avg,-avg,-avg);
 	BBoxSafe.MaxEdge.set(avg,avg,avg);
+	SceneManager->updateSceneNodeIndex(this);
 }
 
 
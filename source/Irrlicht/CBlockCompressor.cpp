@@ -0,0 +1,550 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CBlockCompressor.h"
+#include "CThreadPool.h"
+#include "CImage.h"
+#include "CImageResampler.h"
+#include "irrMath.h"
+
+// the block fitting uses SSE2, which every x86 cpu with SSE2 has
+#if (defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(NO_IRR_BLOCK_COMPRESSOR_SSE_)
+	#define _IRR_BLOCK_COMPRESSOR_SSE_
+	#include <emmintrin.h>
+#endif
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+	//! expands a 565 color to A8R8G8B8
+	inline u32 expand565(u16 c)
+	{
+		const u32 r = (c >> 11) & 0x1F;
+		const u32 g = (c >> 5) & 0x3F;
+		const u32 b = c & 0x1F;
+		return 0xFF000000 | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+	}
+
+	//! rounds the color channels of an A8R8G8B8 color to 565
+	inline u16 round565(u32 c)
+	{
+		const u32 r = (((c >> 16) & 0xFF) * 31 + 127) / 255;
+		const u32 g = (((c >> 8) & 0xFF) * 63 + 127) / 255;
+		const u32 b = ((c & 0xFF) * 31 + 127) / 255;
+		return (u16)((r << 11) | (g << 5) | b);
+	}
+
+	//! weighted mean of two A8R8G8B8 colors, alpha is set to 255
+	inline u32 mixColor(u32 a, u32 b, u32 wa, u32 wb)
+	{
+		const u32 sum = wa + wb;
+		const u32 r = (((a >> 16) & 0xFF) * wa + ((b >> 16) & 0xFF) * wb) / sum;
+		const u32 g = (((a >> 8) & 0xFF) * wa + ((b >> 8) & 0xFF) * wb) / sum;
+		const u32 bl = ((a & 0xFF) * wa + (b & 0xFF) * wb) / sum;
+		return 0xFF000000 | (r << 16) | (g << 8) | bl;
+	}
+
+	inline u16 readU16(const u8* p)
+	{
+		return (u16)(p[0] | (p[1] << 8));
+	}
+
+	inline void writeU16(u8* p, u16 v)
+	{
+		p[0] = (u8)v;
+		p[1] = (u8)(v >> 8);
+	}
+
+	//! per channel minimum and maximum of 16 colors
+	void getMinMax(const u32* pixels, u32& minColor, u32& maxColor)
+	{
+#ifdef _IRR_BLOCK_COMPRESSOR_SSE_
+		const __m128i p0 = _mm_loadu_si128((const __m128i*)pixels);
+		const __m128i p1 = _mm_loadu_si128((const __m128i*)(pixels + 4));
+		const __m128i p2 = _mm_loadu_si128((const __m128i*)(pixels + 8));
+		const __m128i p3 = _mm_loadu_si128((const __m128i*)(pixels + 12));
+
+		__m128i mn = _mm_min_epu8(_mm_min_epu8(p0, p1), _mm_min_epu8(p2, p3));
+		__m128i mx = _mm_max_epu8(_mm_max_epu8(p0, p1), _mm_max_epu8(p2, p3));
+		mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(1, 0, 3, 2)));
+		mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(1, 0, 3, 2)));
+		mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(2, 3, 0, 1)));
+		mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(2, 3, 0, 1)));
+
+		minColor = (u32)_mm_cvtsi128_si32(mn);
+		maxColor = (u32)_mm_cvtsi128_si32(mx);
+#else
+		u32 mn[4] = { 255, 255, 255, 255 };
+		u32 mx[4] = { 0, 0, 0, 0 };
+		for (u32 i = 0; i < 16; ++i)
+		{
+			for (u32 c = 0; c < 4; ++c)
+			{
+				const u32 v = (pixels[i] >> (c * 8)) & 0xFF;
+				mn[c] = core::min_(mn[c], v);
+				mx[c] = core::max_(mx[c], v);
+			}
+		}
+		minColor = mn[0] | (mn[1] << 8) | (mn[2] << 16) | (mn[3] << 24);
+		maxColor = mx[0] | (mx[1] << 8) | (mx[2] << 16) | (mx[3] << 24);
+#endif
+	}
+
+	//! Projects the colors on the line between two colors.
+	/** Writes the step along the line from base (0) to base + dir (steps)
+	for each pixel. */
+	void projectColors(const u32* pixels, u32 base, const s32* dir, s32 steps, s32* result)
+	{
+		const s32 len2 = dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2];
+		const f32 scale = len2 ? (f32)steps / (f32)len2 : 0.f;
+
+#ifdef _IRR_BLOCK_COMPRESSOR_SSE_
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i dirv = _mm_set_epi16(0, (s16)dir[0], (s16)dir[1], (s16)dir[2], 0, (s16)dir[0], (s16)dir[1], (s16)dir[2]);
+		const __m128i basev = _mm_unpacklo_epi8(_mm_set1_epi32((s32)(base & 0x00FFFFFF)), zero);
+		const __m128 scalev = _mm_set1_ps(scale);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 maxStep = _mm_set1_ps((f32)steps);
+
+		for (u32 i = 0; i < 16; i += 4)
+		{
+			const __m128i p = _mm_loadu_si128((const __m128i*)(pixels + i));
+			__m128i lo = _mm_madd_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(p, zero), basev), dirv);
+			__m128i hi = _mm_madd_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(p, zero), basev), dirv);
+			lo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+			hi = _mm_add_epi32(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+			const __m128i dot = _mm_unpacklo_epi64(_mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0)),
+				_mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0)));
+
+			__m128 f = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(dot), scalev), half);
+			f = _mm_min_ps(_mm_max_ps(f, _mm_setzero_ps()), maxStep);
+			_mm_storeu_si128((__m128i*)(result + i), _mm_cvttps_epi32(f));
+		}
+#else
+		const s32 br = (base >> 16) & 0xFF;
+		const s32 bg = (base >> 8) & 0xFF;
+		const s32 bb = base & 0xFF;
+
+		for (u32 i = 0; i < 16; ++i)
+		{
+			const s32 dot = (((s32)(pixels[i] >> 16) & 0xFF) - br) * dir[0]
+				+ (((s32)(pixels[i] >> 8) & 0xFF) - bg) * dir[1]
+				+ (((s32)pixels[i] & 0xFF) - bb) * dir[2];
+			result[i] = (s32)core::clamp((f32)dot * scale + 0.5f, 0.f, (f32)steps);
+		}
+#endif
+	}
+
+	//! Returns the step of each alpha value between minAlpha (0) and maxAlpha (steps).
+	void projectAlpha(const u32* pixels, u32 minAlpha, u32 maxAlpha, s32 steps, s32* result)
+	{
+		const f32 scale = (f32)steps / (f32)(maxAlpha - minAlpha);
+
+#ifdef _IRR_BLOCK_COMPRESSOR_SSE_
+		const __m128i minv = _mm_set1_epi32((s32)minAlpha);
+		const __m128 scalev = _mm_set1_ps(scale);
+		const __m128 half = _mm_set1_ps(0.5f);
+
+		for (u32 i = 0; i < 16; i += 4)
+		{
+			const __m128i a = _mm_sub_epi32(_mm_srli_epi32(_mm_loadu_si128((const __m128i*)(pixels + i)), 24), minv);
+			const __m128 f = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(a), scalev), half);
+			_mm_storeu_si128((__m128i*)(result + i), _mm_cvttps_epi32(f));
+		}
+#else
+		for (u32 i = 0; i < 16; ++i)
+			result[i] = (s32)((f32)((pixels[i] >> 24) - minAlpha) * scale + 0.5f);
+#endif
+	}
+
+	//! writes the 8 byte color part of a block
+	void compressColorBlock(const u32* pixels, u32 minColor, u32 maxColor, u8* block)
+	{
+		// move the ends of the bounding box inwards a bit, which reduces the
+		// error of the colors in between
+		u32 lo = 0;
+		u32 hi = 0;
+		for (u32 c = 0; c < 24; c += 8)
+		{
+			const u32 mn = (minColor >> c) & 0xFF;
+			const u32 mx = (maxColor >> c) & 0xFF;
+			const u32 inset = (mx - mn) >> 4;
+			lo |= (mn + inset) << c;
+			hi |= (mx - inset) << c;
+		}
+
+		const u16 c0 = round565(hi);
+		const u16 c1 = round565(lo);
+		writeU16(block, c0);
+		writeU16(block + 2, c1);
+
+		u32 indices = 0;
+		if (c0 != c1)
+		{
+			// c0 > c1 selects the four color mode, in which the colors
+			// along the line from c1 to c0 have the indices 1, 3, 2, 0
+			static const u32 stepToIndex[4] = { 1, 3, 2, 0 };
+
+			const u32 e0 = expand565(c0);
+			const u32 e1 = expand565(c1);
+			const s32 dir[3] = {
+				(s32)((e0 >> 16) & 0xFF) - (s32)((e1 >> 16) & 0xFF),
+				(s32)((e0 >> 8) & 0xFF) - (s32)((e1 >> 8) & 0xFF),
+				(s32)(e0 & 0xFF) - (s32)(e1 & 0xFF) };
+
+			s32 steps[16];
+			projectColors(pixels, e1, dir, 3, steps);
+
+			for (u32 i = 0; i < 16; ++i)
+				indices |= stepToIndex[steps[i]] << (i * 2);
+		}
+
+		block[4] = (u8)indices;
+		block[5] = (u8)(indices >> 8);
+		block[6] = (u8)(indices >> 16);
+		block[7] = (u8)(indices >> 24);
+	}
+
+	//! Decodes the 8 byte color part of a block.
+	/** The DXT1 format has a three color mode with transparent black. */
+	void decompressColorBlock(const u8* block, u32* pixels, bool dxt1)
+	{
+		const u16 c0 = readU16(block);
+		const u16 c1 = readU16(block + 2);
+
+		u32 colors[4];
+		colors[0] = expand565(c0);
+		colors[1] = expand565(c1);
+		if (!dxt1 || c0 > c1)
+		{
+			colors[2] = mixColor(colors[0], colors[1], 2, 1);
+			colors[3] = mixColor(colors[0], colors[1], 1, 2);
+		}
+		else
+		{
+			colors[2] = mixColor(colors[0], colors[1], 1, 1);
+			colors[3] = 0;
+		}
+
+		const u32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((u32)block[7] << 24);
+		for (u32 i = 0; i < 16; ++i)
+			pixels[i] = colors[(indices >> (i * 2)) & 3];
+	}
+
+	//! replaces the alpha of the pixels
+	inline void setAlpha(u32* pixels, const u32* alpha)
+	{
+		for (u32 i = 0; i < 16; ++i)
+			pixels[i] = (pixels[i] & 0x00FFFFFF) | (alpha[i] << 24);
+	}
+
+	//! DXT2 and DXT4 store colors multiplied by alpha
+	void unpremultiplyAlpha(u32* pixels)
+	{
+		for (u32 i = 0; i < 16; ++i)
+		{
+			const u32 a = pixels[i] >> 24;
+			if (a == 0 || a == 255)
+				continue;
+
+			const u32 r = core::min_<u32>(((pixels[i] >> 16) & 0xFF) * 255 / a, 255);
+			const u32 g = core::min_<u32>(((pixels[i] >> 8) & 0xFF) * 255 / a, 255);
+			const u32 b = core::min_<u32>((pixels[i] & 0xFF) * 255 / a, 255);
+			pixels[i] = (a << 24) | (r << 16) | (g << 8) | b;
+		}
+	}
+
+	//! surface shared by the threads of a compress() call
+	struct SCompressJob
+	{
+		ECOLOR_FORMAT Format;
+		const u8* Pixels;
+		core::dimension2d<u32> Size;
+		u32 Pitch;
+		u8* Blocks;
+		u32 BlocksPerRow;
+		u32 BlockSize;
+	};
+
+	//! compresses one row of blocks
+	void compressBlockRow(void* userData, u32 row)
+	{
+		const SCompressJob& job = *(const SCompressJob*)userData;
+
+		u32 pixels[16];
+		u8* block = job.Blocks + row * job.BlocksPerRow * job.BlockSize;
+
+		for (u32 x = 0; x < job.BlocksPerRow; ++x, block += job.BlockSize)
+		{
+			// blocks at the border of images smaller than 4 pixels repeat the last pixel
+			for (u32 j = 0; j < 4; ++j)
+			{
+				const u32 py = core::min_(row * 4 + j, job.Size.Height - 1);
+				const u32* line = (const u32*)(job.Pixels + py * job.Pitch);
+
+				for (u32 i = 0; i < 4; ++i)
+					pixels[j * 4 + i] = line[core::min_(x * 4 + i, job.Size.Width - 1)];
+			}
+
+			if (job.Format == ECF_DXT1)
+				CBlockCompressor::compressBlockDXT1(pixels, block);
+			else
+				CBlockCompressor::compressBlockDXT5(pixels, block);
+		}
+	}
+
+} // end anonymous namespace
+
+
+void CBlockCompressor::compressBlockDXT1(const u32* pixels, u8* block)
+{
+	u32 minColor, maxColor;
+	getMinMax(pixels, minColor, maxColor);
+	compressColorBlock(pixels, minColor, maxColor, block);
+}
+
+
+void CBlockCompressor::compressBlockDXT5(const u32* pixels, u8* block)
+{
+	u32 minColor, maxColor;
+	getMinMax(pixels, minColor, maxColor);
+
+	const u32 minAlpha = minColor >> 24;
+	const u32 maxAlpha = maxColor >> 24;
+
+	// maxAlpha > minAlpha selects the mode with eight alpha values, in which
+	// the values from minAlpha to maxAlpha have the indices 1, 7, 6, ... 2, 0
+	block[0] = (u8)maxAlpha;
+	block[1] = (u8)minAlpha;
+
+	u64 indices = 0;
+	if (maxAlpha != minAlpha)
+	{
+		static const u64 stepToIndex[8] = { 1, 7, 6, 5, 4, 3, 2, 0 };
+
+		s32 steps[16];
+		projectAlpha(pixels, minAlpha, maxAlpha, 7, steps);
+
+		for (u32 i = 0; i < 16; ++i)
+			indices |= stepToIndex[steps[i]] << (i * 3);
+	}
+
+	for (u32 i = 0; i < 6; ++i)
+		block[2 + i] = (u8)(indices >> (i * 8));
+
+	compressColorBlock(pixels, minColor, maxColor, block + 8);
+}
+
+
+void CBlockCompressor::decompressBlock(ECOLOR_FORMAT format, const u8* block, u32* pixels)
+{
+	u32 alpha[16];
+
+	switch (format)
+	{
+	case ECF_DXT1:
+		decompressColorBlock(block, pixels, true);
+		break;
+	case ECF_DXT2:
+	case ECF_DXT3:
+		// four bits per pixel
+		for (u32 i = 0; i < 16; ++i)
+			alpha[i] = ((block[i / 2] >> ((i & 1) * 4)) & 0x0F) * 17;
+
+		decompressColorBlock(block + 8, pixels, false);
+		setAlpha(pixels, alpha);
+		if (format == ECF_DXT2)
+			unpremultiplyAlpha(pixels);
+		break;
+	case ECF_DXT4:
+	case ECF_DXT5:
+		{
+			// two alpha values and three bit indices
+			u32 values[8];
+			values[0] = block[0];
+			values[1] = block[1];
+			if (values[0] > values[1])
+			{
+				for (u32 i = 1; i < 7; ++i)
+					values[i + 1] = ((7 - i) * values[0] + i * values[1]) / 7;
+			}
+			else
+			{
+				for (u32 i = 1; i < 5; ++i)
+					values[i + 1] = ((5 - i) * values[0] + i * values[1]) / 5;
+				values[6] = 0;
+				values[7] = 255;
+			}
+
+			u64 indices = 0;
+			for (u32 i = 0; i < 6; ++i)
+				indices |= (u64)block[2 + i] << (i * 8);
+
+			for (u32 i = 0; i < 16; ++i)
+				alpha[i] = values[(indices >> (i * 3)) & 7];
+
+			decompressColorBlock(block + 8, pixels, false);
+			setAlpha(pixels, alpha);
+			if (format == ECF_DXT4)
+				unpremultiplyAlpha(pixels);
+		}
+		break;
+	default:
+		for (u32 i = 0; i < 16; ++i)
+			pixels[i] = 0;
+		break;
+	}
+}
+
+
+void CBlockCompressor::compress(ECOLOR_FORMAT format, const void* pixels, const core::dimension2d<u32>& size,
+	u32 pitch, void* blocks, CThreadPool* pool)
+{
+	if (size.Width == 0 || size.Height == 0)
+		return;
+
+	SCompressJob job;
+	job.Format = format;
+	job.Pixels = (const u8*)pixels;
+	job.Size = size;
+	job.Pitch = pitch;
+	job.Blocks = (u8*)blocks;
+	job.BlocksPerRow = (size.Width + 3) / 4;
+	job.BlockSize = (format == ECF_DXT1) ? 8 : 16;
+
+	const u32 rows = (size.Height + 3) / 4;
+
+	if (pool && rows > 1)
+		pool->run(compressBlockRow, &job, rows);
+	else
+	{
+		for (u32 y = 0; y < rows; ++y)
+			compressBlockRow(&job, y);
+	}
+}
+
+
+void CBlockCompressor::decompress(ECOLOR_FORMAT format, const void* blocks, const core::dimension2d<u32>& size,
+	void* pixels, u32 pitch)
+{
+	const u8* block = (const u8*)blocks;
+	const u32 blockSize = (format == ECF_DXT1) ? 8 : 16;
+
+	u32 decoded[16];
+	for (u32 y = 0; y < size.Height; y += 4)
+	{
+		for (u32 x = 0; x < size.Width; x += 4, block += blockSize)
+		{
+			decompressBlock(format, block, decoded);
+
+			const u32 w = core::min_(size.Width - x, 4u);
+			const u32 h = core::min_(size.Height - y, 4u);
+			for (u32 j = 0; j < h; ++j)
+			{
+				u32* line = (u32*)((u8*)pixels + (y + j) * pitch) + x;
+				for (u32 i = 0; i < w; ++i)
+					line[i] = decoded[j * 4 + i];
+			}
+		}
+	}
+}
+
+
+ECOLOR_FORMAT CBlockCompressor::getCompressedFormat(const IImage* image, bool discardAlpha)
+{
+	switch (image->getColorFormat())
+	{
+	case ECF_R5G6B5:
+	case ECF_R8G8B8:
+		return ECF_DXT1;
+	case ECF_A1R5G5B5:
+	case ECF_A8R8G8B8:
+		break;
+	default:
+		return ECF_UNKNOWN;
+	}
+
+	if (discardAlpha)
+		return ECF_DXT1;
+
+	const core::dimension2d<u32>& size = image->getDimension();
+	for (u32 y = 0; y < size.Height; ++y)
+	{
+		for (u32 x = 0; x < size.Width; ++x)
+		{
+			if (image->getPixel(x, y).getAlpha() != 0xFF)
+				return ECF_DXT5;
+		}
+	}
+	return ECF_DXT1;
+}
+
+
+IImage* CBlockCompressor::createCompressedImage(IImage* image, ECOLOR_FORMAT format, bool mipMaps, CThreadPool* pool)
+{
+	const core::dimension2d<u32> size = image->getDimension();
+	if ((format != ECF_DXT1 && format != ECF_DXT5) || IImage::isCompressedFormat(image->getColorFormat())
+		|| size.Width == 0 || size.Height == 0)
+		return 0;
+
+	// the encoder reads A8R8G8B8
+	IImage* source = image;
+	if (image->getColorFormat() == ECF_A8R8G8B8)
+		source->grab();
+	else
+	{
+		source = new CImage(ECF_A8R8G8B8, size);
+		image->copyTo(source);
+	}
+
+	IImage* compressed = new CImage(format, size);
+	compress(format, source->getData(), size, source->getPitch(), compressed->getData(), pool);
+
+	if (mipMaps && (size.Width > 1 || size.Height > 1))
+	{
+		// the levels are stored one after another, as expected by IImage::setMipMapsData
+		u32 dataSize = 0;
+		core::dimension2d<u32> levelSize(size);
+		do
+		{
+			levelSize.Width = core::max_(levelSize.Width >> 1, 1u);
+			levelSize.Height = core::max_(levelSize.Height >> 1, 1u);
+			dataSize += IImage::getDataSizeFromFormat(format, levelSize.Width, levelSize.Height);
+		} while (levelSize.Width != 1 || levelSize.Height != 1);
+
+		u8* data = new u8[dataSize];
+		u8* levelData = data;
+		levelSize = size;
+
+		do
+		{
+			levelSize.Width = core::max_(levelSize.Width >> 1, 1u);
+			levelSize.Height = core::max_(levelSize.Height >> 1, 1u);
+
+			IImage* level = new CImage(ECF_A8R8G8B8, levelSize);
+			CImageResampler::resample(source, level, EIF_BOX, pool);
+			source->drop();
+			source = level;
+
+			compress(format, source->getData(), levelSize, source->getPitch(), levelData, pool);
+			levelData += IImage::getDataSizeFromFormat(format, levelSize.Width, levelSize.Height);
+		} while (levelSize.Width != 1 || levelSize.Height != 1);
+
+		compressed->setMipMapsData(data, false, true);
+		delete [] data;
+	}
+
+	source->drop();
+
+	return compressed;
+}
+
+
+} // end namespace video
+} // end namespace irr
+
@@ -0,0 +1,72 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BLOCK_COMPRESSOR_H_INCLUDED__
+#define __C_BLOCK_COMPRESSOR_H_INCLUDED__
+
+#include "irrTypes.h"
+#include "IImage.h"
+
+namespace irr
+{
+
+class CThreadPool;
+
+namespace video
+{
+
+//! Encodes and decodes the DXT (BC1 to BC3) block compressed color formats.
+/** A block stores 4x4 pixels, the pixels passed to and returned by the block
+functions are 16 A8R8G8B8 colors in rows from top to bottom. The encoder fits
+the endpoints to the bounding box of the block colors, which is fast enough
+to compress textures at load time but doesn't reach the quality of offline
+compressors. */
+class CBlockCompressor
+{
+public:
+
+	//! Encodes 16 opaque pixels to a DXT1 block of 8 bytes.
+	static void compressBlockDXT1(const u32* pixels, u8* block);
+
+	//! Encodes 16 pixels to a DXT5 block of 16 bytes.
+	static void compressBlockDXT5(const u32* pixels, u8* block);
+
+	//! Decodes a DXT1 to DXT5 block to 16 pixels.
+	static void decompressBlock(ECOLOR_FORMAT format, const u8* block, u32* pixels);
+
+	//! Encodes an A8R8G8B8 surface.
+	/** \param format ECF_DXT1 or ECF_DXT5.
+	\param pool Block rows are shared out to the threads of this pool, can be 0. */
+	static void compress(ECOLOR_FORMAT format, const void* pixels, const core::dimension2d<u32>& size,
+		u32 pitch, void* blocks, CThreadPool* pool = 0);
+
+	//! Decodes a surface to A8R8G8B8.
+	static void decompress(ECOLOR_FORMAT format, const void* blocks, const core::dimension2d<u32>& size,
+		void* pixels, u32 pitch);
+
+	//! Returns the format an uncompressed image is compressed to.
+	/** \return ECF_DXT5 if the image has pixels which are not fully opaque
+	and alpha is not discarded, ECF_DXT1 for other images and ECF_UNKNOWN if
+	the format of the image can't be compressed. */
+	static ECOLOR_FORMAT getCompressedFormat(const IImage* image, bool discardAlpha);
+
+	//! Creates a DXT1 or DXT5 copy of an uncompressed image.
+	/** \param mipMaps Also creates and encodes all mip map levels.
+	\return The new image, or 0 if the image can't be compressed. */
+	static IImage* createCompressedImage(IImage* image, ECOLOR_FORMAT format, bool mipMaps, CThreadPool* pool = 0);
+
+	//! Returns true if the format is one of the formats this class can decode.
+	static bool isDXTFormat(ECOLOR_FORMAT format)
+	{
+		return format == ECF_DXT1 || format == ECF_DXT2 || format == ECF_DXT3
+			|| format == ECF_DXT4 || format == ECF_DXT5;
+	}
+};
+
+
+} // end namespace video
+} // end namespace irr
+
+#endif
+
@@ -0,0 +1,686 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "IrrCompileConfig.h"
+#include "CBurningShader_SIMD.h"
+#include "os.h"
+
+#ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
+
+#ifdef SOFTWARE_DRIVER_2_SIMD
+
+#include <string.h>
+#include <emmintrin.h>
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+/*
+	The functions are compiled for their instruction set with target attributes,
+	so the rest of the engine doesn't need any special compiler flags.
+	Fused multiply add must not be used, else the results differ from the
+	scalar shaders.
+*/
+#if defined(__GNUC__) || defined(__clang__)
+	#define BURNING_TARGET_SSE2 __attribute__((target("sse2")))
+	#define BURNING_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define BURNING_TARGET_SSE2
+	#define BURNING_TARGET_AVX2
+#endif
+
+namespace irr
+{
+
+namespace video
+{
+
+// interpolants needed by a span function
+enum eSpanLanes
+{
+	LANE_TEX0 = 1,
+	LANE_TEX1 = 2,
+	LANE_COLOR = 4
+};
+
+// interpolated values of up to 8 pixels
+struct sSpanLanes
+{
+	f32 w[8];
+	f32 tx[2][8];
+	f32 ty[2][8];
+	f32 r[8];
+	f32 g[8];
+	f32 b[8];
+};
+
+// step the interpolants pixel by pixel like the scalar loops, so rounding is the same
+static inline void stepLanes ( sSpanLanes &l, sBurningSpan &s, const s32 n, const s32 width, const u32 flags )
+{
+	// unused lanes of the last pixels get valid values, they are masked out later
+	s32 k;
+	for ( k = 0; k < n; ++k )
+	{
+		l.w[k] = s.w;
+		s.w += s.slopeW;
+	}
+	for ( ; k < width; ++k )
+		l.w[k] = l.w[0];
+
+	for ( u32 t = 0; t < 2; ++t )
+	{
+		if ( 0 == ( flags & ( LANE_TEX0 << t ) ) )
+			continue;
+		for ( k = 0; k < n; ++k )
+		{
+			l.tx[t][k] = s.t[t].x;
+			l.ty[t][k] = s.t[t].y;
+			s.t[t] += s.slopeT[t];
+		}
+		for ( ; k < width; ++k )
+		{
+			l.tx[t][k] = l.tx[t][0];
+			l.ty[t][k] = l.ty[t][0];
+		}
+	}
+
+	if ( flags & LANE_COLOR )
+	{
+		for ( k = 0; k < n; ++k )
+		{
+			l.r[k] = s.c.y;
+			l.g[k] = s.c.z;
+			l.b[k] = s.c.w;
+			s.c += s.slopeC;
+		}
+		for ( ; k < width; ++k )
+		{
+			l.r[k] = l.r[0];
+			l.g[k] = l.g[0];
+			l.b[k] = l.b[0];
+		}
+	}
+}
+
+static inline u32 getSpanLanes ( const eBurningSpanFunc func )
+{
+	switch ( func )
+	{
+		case EBSF_LIGHTMAP_M4_MAG:
+		case EBSF_LIGHTMAP_M4_MIN:
+			return LANE_TEX0 | LANE_TEX1;
+		default:
+			return LANE_TEX0 | LANE_COLOR;
+	}
+}
+
+
+// ----------------------------- SSE2, 4 pixels -----------------------------
+
+// 32 bit multiply, low part
+static inline BURNING_TARGET_SSE2 __m128i sse2_mullo ( const __m128i a, const __m128i b )
+{
+	const __m128i even = _mm_mul_epu32 ( a, b );
+	const __m128i odd = _mm_mul_epu32 ( _mm_srli_epi64 ( a, 32 ), _mm_srli_epi64 ( b, 32 ) );
+	return _mm_unpacklo_epi32 ( _mm_shuffle_epi32 ( even, _MM_SHUFFLE ( 0, 0, 2, 0 ) ),
+								_mm_shuffle_epi32 ( odd, _MM_SHUFFLE ( 0, 0, 2, 0 ) ) );
+}
+
+static inline BURNING_TARGET_SSE2 __m128i sse2_gather ( const sInternalTexture * t, const __m128i ofs )
+{
+	u32 o[4];
+	_mm_storeu_si128 ( (__m128i*) o, ofs );
+
+	const u8 *data = (const u8*) t->data;
+	return _mm_set_epi32 (	*(const s32*) ( data + o[3] ),
+							*(const s32*) ( data + o[2] ),
+							*(const s32*) ( data + o[1] ),
+							*(const s32*) ( data + o[0] ) );
+}
+
+// getTexel_fix
+static inline BURNING_TARGET_SSE2 void sse2_texel ( __m128i &r, __m128i &g, __m128i &b,
+						const sInternalTexture * t, const __m128i tx, const __m128i ty )
+{
+	const __m128i pitch = _mm_cvtsi32_si128 ( t->pitchlog2 );
+	const __m128i ofs = _mm_or_si128 (
+		_mm_sll_epi32 ( _mm_srli_epi32 ( _mm_and_si128 ( ty, _mm_set1_epi32 ( t->textureYMask ) ), FIX_POINT_PRE ), pitch ),
+		_mm_srli_epi32 ( _mm_and_si128 ( tx, _mm_set1_epi32 ( t->textureXMask ) ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY ) );
+
+	const __m128i t00 = sse2_gather ( t, ofs );
+
+	r = _mm_srli_epi32 ( _mm_and_si128 ( t00, _mm_set1_epi32 ( MASK_R ) ), SHIFT_R - FIX_POINT_PRE );
+	g = _mm_slli_epi32 ( _mm_and_si128 ( t00, _mm_set1_epi32 ( MASK_G ) ), FIX_POINT_PRE - SHIFT_G );
+	b = _mm_slli_epi32 ( _mm_and_si128 ( t00, _mm_set1_epi32 ( MASK_B ) ), FIX_POINT_PRE - SHIFT_B );
+}
+
+// bilinear getSample_texture
+static inline BURNING_TARGET_SSE2 void sse2_bilinear ( __m128i &r, __m128i &g, __m128i &b,
+						const sInternalTexture * t, const __m128i tx, const __m128i ty )
+{
+	const __m128i one = _mm_set1_epi32 ( FIX_POINT_ONE );
+	const __m128i xMask = _mm_set1_epi32 ( t->textureXMask );
+	const __m128i yMask = _mm_set1_epi32 ( t->textureYMask );
+	const __m128i pitch = _mm_cvtsi32_si128 ( t->pitchlog2 );
+
+	const __m128i o0 = _mm_sll_epi32 ( _mm_srli_epi32 ( _mm_and_si128 ( ty, yMask ), FIX_POINT_PRE ), pitch );
+	const __m128i o1 = _mm_sll_epi32 ( _mm_srli_epi32 ( _mm_and_si128 ( _mm_add_epi32 ( ty, one ), yMask ), FIX_POINT_PRE ), pitch );
+	const __m128i o2 = _mm_srli_epi32 ( _mm_and_si128 ( tx, xMask ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	const __m128i o3 = _mm_srli_epi32 ( _mm_and_si128 ( _mm_add_epi32 ( tx, one ), xMask ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+
+	const __m128i t00 = sse2_gather ( t, _mm_or_si128 ( o0, o2 ) );
+	const __m128i t10 = sse2_gather ( t, _mm_or_si128 ( o0, o3 ) );
+	const __m128i t01 = sse2_gather ( t, _mm_or_si128 ( o1, o2 ) );
+	const __m128i t11 = sse2_gather ( t, _mm_or_si128 ( o1, o3 ) );
+
+	const __m128i fract = _mm_set1_epi32 ( FIX_POINT_FRACT_MASK );
+	const __m128i txFract = _mm_and_si128 ( tx, fract );
+	const __m128i txFractInv = _mm_sub_epi32 ( one, txFract );
+	const __m128i tyFract = _mm_and_si128 ( ty, fract );
+	const __m128i tyFractInv = _mm_sub_epi32 ( one, tyFract );
+
+	// all factors fit into 16 bit
+	const __m128i w00 = _mm_srli_epi32 ( _mm_madd_epi16 ( txFractInv, tyFractInv ), FIX_POINT_PRE );
+	const __m128i w10 = _mm_srli_epi32 ( _mm_madd_epi16 ( txFract, tyFractInv ), FIX_POINT_PRE );
+	const __m128i w01 = _mm_srli_epi32 ( _mm_madd_epi16 ( txFractInv, tyFract ), FIX_POINT_PRE );
+	const __m128i w11 = _mm_srli_epi32 ( _mm_madd_epi16 ( txFract, tyFract ), FIX_POINT_PRE );
+
+	// weights of the texels x0 and x1 packed as 16 bit pairs (y0,y1)
+	const __m128i wA = _mm_or_si128 ( w00, _mm_slli_epi32 ( w01, 16 ) );
+	const __m128i wB = _mm_or_si128 ( w10, _mm_slli_epi32 ( w11, 16 ) );
+
+	const __m128i lo = _mm_set1_epi32 ( 0x000000FF );
+	const __m128i hi = _mm_set1_epi32 ( 0x00FF0000 );
+
+	r = _mm_add_epi32 (
+		_mm_madd_epi16 ( _mm_or_si128 ( _mm_and_si128 ( _mm_srli_epi32 ( t00, 16 ), lo ), _mm_and_si128 ( t01, hi ) ), wA ),
+		_mm_madd_epi16 ( _mm_or_si128 ( _mm_and_si128 ( _mm_srli_epi32 ( t10, 16 ), lo ), _mm_and_si128 ( t11, hi ) ), wB ) );
+
+	g = _mm_add_epi32 (
+		_mm_madd_epi16 ( _mm_or_si128 ( _mm_and_si128 ( _mm_srli_epi32 ( t00, 8 ), lo ), _mm_and_si128 ( _mm_slli_epi32 ( t01, 8 ), hi ) ), wA ),
+		_mm_madd_epi16 ( _mm_or_si128 ( _mm_and_si128 ( _mm_srli_epi32 ( t10, 8 ), lo ), _mm_and_si128 ( _mm_slli_epi32 ( t11, 8 ), hi ) ), wB ) );
+
+	b = _mm_add_epi32 (
+		_mm_madd_epi16 ( _mm_or_si128 ( _mm_and_si128 ( t00, lo ), _mm_and_si128 ( _mm_slli_epi32 ( t01, 16 ), hi ) ), wA ),
+		_mm_madd_epi16 ( _mm_or_si128 ( _mm_and_si128 ( t10, lo ), _mm_and_si128 ( _mm_slli_epi32 ( t11, 16 ), hi ) ), wB ) );
+}
+
+static inline BURNING_TARGET_SSE2 __m128i sse2_imulFix ( const __m128i x, const __m128i y )
+{
+	return _mm_srai_epi32 ( sse2_mullo ( x, y ), FIX_POINT_PRE );
+}
+
+static inline BURNING_TARGET_SSE2 __m128i sse2_imulFix_tex4_clamp ( const __m128i x, const __m128i y )
+{
+	const __m128i a = _mm_srli_epi32 ( sse2_mullo ( _mm_srli_epi32 ( x, 2 ), _mm_srli_epi32 ( y, 2 ) ), FIX_POINT_PRE + 2 );
+
+	// clampfix_maxcolor
+	const __m128i m = _mm_set1_epi32 ( FIXPOINT_COLOR_MAX );
+	const __m128i c = _mm_srai_epi32 ( _mm_sub_epi32 ( a, m ), 31 );
+	return _mm_or_si128 ( _mm_and_si128 ( a, c ), _mm_andnot_si128 ( c, m ) );
+}
+
+static inline BURNING_TARGET_SSE2 __m128i sse2_fix_to_color ( const __m128i r, const __m128i g, const __m128i b )
+{
+	const __m128i m = _mm_set1_epi32 ( FIXPOINT_COLOR_MAX );
+	return _mm_or_si128 ( _mm_or_si128 ( _mm_set1_epi32 ( MASK_A ),
+			_mm_slli_epi32 ( _mm_and_si128 ( r, m ), SHIFT_R - FIX_POINT_PRE ) ),
+			_mm_or_si128 ( _mm_srli_epi32 ( _mm_and_si128 ( g, m ), FIX_POINT_PRE - SHIFT_G ),
+			_mm_srli_epi32 ( _mm_and_si128 ( b, m ), FIX_POINT_PRE - SHIFT_B ) ) );
+}
+
+static inline BURNING_TARGET_SSE2 __m128 sse2_select ( const __m128 mask, const __m128 a, const __m128 b )
+{
+	return _mm_or_ps ( _mm_and_ps ( mask, a ), _mm_andnot_ps ( mask, b ) );
+}
+
+template < eBurningSpanFunc F >
+static BURNING_TARGET_SSE2 void sse2_span ( sBurningSpan &s )
+{
+	if ( F == EBSF_BLEND_DST_COLOR_ZERO && s.zCompare != 1 && s.zCompare != 2 )
+		return;
+
+	sSpanLanes l;
+	tVideoSample tailDst[4];
+	fp24 tailZ[4];
+
+	const __m128i lane = _mm_set_epi32 ( 3, 2, 1, 0 );
+	const __m128 fixMul = _mm_set1_ps ( FIX_POINT_F32_MUL );
+
+	for ( s32 i = 0; i < s.count; i += 4 )
+	{
+		const s32 n = core::s32_min ( s.count - i, 4 );
+		stepLanes ( l, s, n, 4, getSpanLanes ( F ) );
+
+		tVideoSample *dst = s.dst + i;
+		fp24 *z = s.z + i;
+		if ( n < 4 )
+		{
+			memcpy ( tailDst, dst, n * sizeof ( tVideoSample ) );
+			memcpy ( tailZ, z, n * sizeof ( fp24 ) );
+			dst = tailDst;
+			z = tailZ;
+		}
+
+		const __m128 w = _mm_loadu_ps ( l.w );
+		const __m128 zOld = _mm_loadu_ps ( z );
+		const __m128 valid = _mm_castsi128_ps ( _mm_cmplt_epi32 ( lane, _mm_set1_epi32 ( n ) ) );
+		const __m128 pass = _mm_and_ps ( valid,
+			F == EBSF_BLEND_DST_COLOR_ZERO && s.zCompare == 2 ? _mm_cmpeq_ps ( w, zOld ) : _mm_cmpge_ps ( w, zOld ) );
+
+		if ( _mm_movemask_ps ( pass ) )
+		{
+			_mm_storeu_ps ( z, sse2_select ( pass, w, zOld ) );
+
+			const __m128 iw = _mm_div_ps ( fixMul, w );
+			const __m128i dOld = _mm_loadu_si128 ( (const __m128i*) dst );
+
+			__m128i r0, g0, b0;
+			__m128i r1, g1, b1;
+			__m128i color;
+
+			const __m128i tx0 = _mm_cvttps_epi32 ( _mm_mul_ps ( _mm_loadu_ps ( l.tx[0] ), iw ) );
+			const __m128i ty0 = _mm_cvttps_epi32 ( _mm_mul_ps ( _mm_loadu_ps ( l.ty[0] ), iw ) );
+
+			if ( F == EBSF_LIGHTMAP_M4_MAG || F == EBSF_LIGHTMAP_M4_MIN )
+			{
+				const __m128i tx1 = _mm_cvttps_epi32 ( _mm_mul_ps ( _mm_loadu_ps ( l.tx[1] ), iw ) );
+				const __m128i ty1 = _mm_cvttps_epi32 ( _mm_mul_ps ( _mm_loadu_ps ( l.ty[1] ), iw ) );
+
+				if ( F == EBSF_LIGHTMAP_M4_MAG )
+				{
+					sse2_bilinear ( r0, g0, b0, s.it + 0, tx0, ty0 );
+					sse2_bilinear ( r1, g1, b1, s.it + 1, tx1, ty1 );
+				}
+				else
+				{
+					sse2_texel ( r0, g0, b0, s.it + 0, tx0, ty0 );
+					sse2_texel ( r1, g1, b1, s.it + 1, tx1, ty1 );
+				}
+
+				color = sse2_fix_to_color ( sse2_imulFix_tex4_clamp ( r0, r1 ),
+											sse2_imulFix_tex4_clamp ( g0, g1 ),
+											sse2_imulFix_tex4_clamp ( b0, b1 ) );
+			}
+			else
+			{
+				sse2_bilinear ( r0, g0, b0, s.it + 0, tx0, ty0 );
+
+				const __m128i r2 = _mm_cvttps_epi32 ( _mm_mul_ps ( _mm_loadu_ps ( l.r ), iw ) );
+				const __m128i g2 = _mm_cvttps_epi32 ( _mm_mul_ps ( _mm_loadu_ps ( l.g ), iw ) );
+				const __m128i b2 = _mm_cvttps_epi32 ( _mm_mul_ps ( _mm_loadu_ps ( l.b ), iw ) );
+
+				if ( F == EBSF_BLEND_DST_COLOR_ZERO )
+				{
+					// color_to_fix1
+					r1 = _mm_srli_epi32 ( _mm_and_si128 ( dOld, _mm_set1_epi32 ( MASK_R ) ), SHIFT_R + COLOR_MAX_LOG2 - FIX_POINT_PRE );
+					g1 = _mm_srli_epi32 ( _mm_and_si128 ( dOld, _mm_set1_epi32 ( MASK_G ) ), SHIFT_G + COLOR_MAX_LOG2 - FIX_POINT_PRE );
+					b1 = _mm_slli_epi32 ( _mm_and_si128 ( dOld, _mm_set1_epi32 ( MASK_B ) ), FIX_POINT_PRE - COLOR_MAX_LOG2 );
+
+					color = sse2_fix_to_color ( sse2_imulFix ( sse2_imulFix ( r0, r1 ), r2 ),
+												sse2_imulFix ( sse2_imulFix ( g0, g1 ), g2 ),
+												sse2_imulFix ( sse2_imulFix ( b0, b1 ), b2 ) );
+				}
+				else
+				{
+					color = sse2_fix_to_color ( sse2_imulFix ( r0, r2 ),
+												sse2_imulFix ( g0, g2 ),
+												sse2_imulFix ( b0, b2 ) );
+				}
+			}
+
+			_mm_storeu_si128 ( (__m128i*) dst, _mm_castps_si128 (
+				sse2_select ( pass, _mm_castsi128_ps ( color ), _mm_castsi128_ps ( dOld ) ) ) );
+		}
+
+		if ( n < 4 )
+		{
+			memcpy ( s.dst + i, tailDst, n * sizeof ( tVideoSample ) );
+			memcpy ( s.z + i, tailZ, n * sizeof ( fp24 ) );
+		}
+	}
+}
+
+
+// 4 positions per step, same operation order as matrix4::transformVect
+static BURNING_TARGET_SSE2 u32 sse2_transformVertices ( f32* x, f32* y, f32* z, f32* w,
+						const u8* source, const u32 pitch, const u32 count, const f32* M )
+{
+	const __m128 m0 = _mm_set1_ps ( M[0] );
+	const __m128 m1 = _mm_set1_ps ( M[1] );
+	const __m128 m2 = _mm_set1_ps ( M[2] );
+	const __m128 m3 = _mm_set1_ps ( M[3] );
+	const __m128 m4 = _mm_set1_ps ( M[4] );
+	const __m128 m5 = _mm_set1_ps ( M[5] );
+	const __m128 m6 = _mm_set1_ps ( M[6] );
+	const __m128 m7 = _mm_set1_ps ( M[7] );
+	const __m128 m8 = _mm_set1_ps ( M[8] );
+	const __m128 m9 = _mm_set1_ps ( M[9] );
+	const __m128 m10 = _mm_set1_ps ( M[10] );
+	const __m128 m11 = _mm_set1_ps ( M[11] );
+	const __m128 m12 = _mm_set1_ps ( M[12] );
+	const __m128 m13 = _mm_set1_ps ( M[13] );
+	const __m128 m14 = _mm_set1_ps ( M[14] );
+	const __m128 m15 = _mm_set1_ps ( M[15] );
+
+	u32 i;
+	for ( i = 0; i + 4 <= count; i += 4 )
+	{
+		const f32 *p0 = (const f32*) ( source + ( i + 0 ) * pitch );
+		const f32 *p1 = (const f32*) ( source + ( i + 1 ) * pitch );
+		const f32 *p2 = (const f32*) ( source + ( i + 2 ) * pitch );
+		const f32 *p3 = (const f32*) ( source + ( i + 3 ) * pitch );
+
+		const __m128 px = _mm_setr_ps ( p0[0], p1[0], p2[0], p3[0] );
+		const __m128 py = _mm_setr_ps ( p0[1], p1[1], p2[1], p3[1] );
+		const __m128 pz = _mm_setr_ps ( p0[2], p1[2], p2[2], p3[2] );
+
+		_mm_storeu_ps ( x + i, _mm_add_ps ( _mm_add_ps ( _mm_add_ps ( _mm_mul_ps ( px, m0 ), _mm_mul_ps ( py, m4 ) ), _mm_mul_ps ( pz, m8 ) ), m12 ) );
+		_mm_storeu_ps ( y + i, _mm_add_ps ( _mm_add_ps ( _mm_add_ps ( _mm_mul_ps ( px, m1 ), _mm_mul_ps ( py, m5 ) ), _mm_mul_ps ( pz, m9 ) ), m13 ) );
+		_mm_storeu_ps ( z + i, _mm_add_ps ( _mm_add_ps ( _mm_add_ps ( _mm_mul_ps ( px, m2 ), _mm_mul_ps ( py, m6 ) ), _mm_mul_ps ( pz, m10 ) ), m14 ) );
+		_mm_storeu_ps ( w + i, _mm_add_ps ( _mm_add_ps ( _mm_add_ps ( _mm_mul_ps ( px, m3 ), _mm_mul_ps ( py, m7 ) ), _mm_mul_ps ( pz, m11 ) ), m15 ) );
+	}
+
+	return i;
+}
+
+
+// ----------------------------- AVX2, 8 pixels -----------------------------
+
+static inline BURNING_TARGET_AVX2 __m256i avx2_gather ( const sInternalTexture * t, const __m256i ofs )
+{
+	return _mm256_i32gather_epi32 ( (const int*) t->data, ofs, 1 );
+}
+
+// getTexel_fix
+static inline BURNING_TARGET_AVX2 void avx2_texel ( __m256i &r, __m256i &g, __m256i &b,
+						const sInternalTexture * t, const __m256i tx, const __m256i ty )
+{
+	const __m128i pitch = _mm_cvtsi32_si128 ( t->pitchlog2 );
+	const __m256i ofs = _mm256_or_si256 (
+		_mm256_sll_epi32 ( _mm256_srli_epi32 ( _mm256_and_si256 ( ty, _mm256_set1_epi32 ( t->textureYMask ) ), FIX_POINT_PRE ), pitch ),
+		_mm256_srli_epi32 ( _mm256_and_si256 ( tx, _mm256_set1_epi32 ( t->textureXMask ) ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY ) );
+
+	const __m256i t00 = avx2_gather ( t, ofs );
+
+	r = _mm256_srli_epi32 ( _mm256_and_si256 ( t00, _mm256_set1_epi32 ( MASK_R ) ), SHIFT_R - FIX_POINT_PRE );
+	g = _mm256_slli_epi32 ( _mm256_and_si256 ( t00, _mm256_set1_epi32 ( MASK_G ) ), FIX_POINT_PRE - SHIFT_G );
+	b = _mm256_slli_epi32 ( _mm256_and_si256 ( t00, _mm256_set1_epi32 ( MASK_B ) ), FIX_POINT_PRE - SHIFT_B );
+}
+
+// bilinear getSample_texture
+static inline BURNING_TARGET_AVX2 void avx2_bilinear ( __m256i &r, __m256i &g, __m256i &b,
+						const sInternalTexture * t, const __m256i tx, const __m256i ty )
+{
+	const __m256i one = _mm256_set1_epi32 ( FIX_POINT_ONE );
+	const __m256i xMask = _mm256_set1_epi32 ( t->textureXMask );
+	const __m256i yMask = _mm256_set1_epi32 ( t->textureYMask );
+	const __m128i pitch = _mm_cvtsi32_si128 ( t->pitchlog2 );
+
+	const __m256i o0 = _mm256_sll_epi32 ( _mm256_srli_epi32 ( _mm256_and_si256 ( ty, yMask ), FIX_POINT_PRE ), pitch );
+	const __m256i o1 = _mm256_sll_epi32 ( _mm256_srli_epi32 ( _mm256_and_si256 ( _mm256_add_epi32 ( ty, one ), yMask ), FIX_POINT_PRE ), pitch );
+	const __m256i o2 = _mm256_srli_epi32 ( _mm256_and_si256 ( tx, xMask ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	const __m256i o3 = _mm256_srli_epi32 ( _mm256_and_si256 ( _mm256_add_epi32 ( tx, one ), xMask ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+
+	const __m256i t00 = avx2_gather ( t, _mm256_or_si256 ( o0, o2 ) );
+	const __m256i t10 = avx2_gather ( t, _mm256_or_si256 ( o0, o3 ) );
+	const __m256i t01 = avx2_gather ( t, _mm256_or_si256 ( o1, o2 ) );
+	const __m256i t11 = avx2_gather ( t, _mm256_or_si256 ( o1, o3 ) );
+
+	const __m256i fract = _mm256_set1_epi32 ( FIX_POINT_FRACT_MASK );
+	const __m256i txFract = _mm256_and_si256 ( tx, fract );
+	const __m256i txFractInv = _mm256_sub_epi32 ( one, txFract );
+	const __m256i tyFract = _mm256_and_si256 ( ty, fract );
+	const __m256i tyFractInv = _mm256_sub_epi32 ( one, tyFract );
+
+	// all factors fit into 16 bit
+	const __m256i w00 = _mm256_srli_epi32 ( _mm256_madd_epi16 ( txFractInv, tyFractInv ), FIX_POINT_PRE );
+	const __m256i w10 = _mm256_srli_epi32 ( _mm256_madd_epi16 ( txFract, tyFractInv ), FIX_POINT_PRE );
+	const __m256i w01 = _mm256_srli_epi32 ( _mm256_madd_epi16 ( txFractInv, tyFract ), FIX_POINT_PRE );
+	const __m256i w11 = _mm256_srli_epi32 ( _mm256_madd_epi16 ( txFract, tyFract ), FIX_POINT_PRE );
+
+	// weights of the texels x0 and x1 packed as 16 bit pairs (y0,y1)
+	const __m256i wA = _mm256_or_si256 ( w00, _mm256_slli_epi32 ( w01, 16 ) );
+	const __m256i wB = _mm256_or_si256 ( w10, _mm256_slli_epi32 ( w11, 16 ) );
+
+	const __m256i lo = _mm256_set1_epi32 ( 0x000000FF );
+	const __m256i hi = _mm256_set1_epi32 ( 0x00FF0000 );
+
+	r = _mm256_add_epi32 (
+		_mm256_madd_epi16 ( _mm256_or_si256 ( _mm256_and_si256 ( _mm256_srli_epi32 ( t00, 16 ), lo ), _mm256_and_si256 ( t01, hi ) ), wA ),
+		_mm256_madd_epi16 ( _mm256_or_si256 ( _mm256_and_si256 ( _mm256_srli_epi32 ( t10, 16 ), lo ), _mm256_and_si256 ( t11, hi ) ), wB ) );
+
+	g = _mm256_add_epi32 (
+		_mm256_madd_epi16 ( _mm256_or_si256 ( _mm256_and_si256 ( _mm256_srli_epi32 ( t00, 8 ), lo ), _mm256_and_si256 ( _mm256_slli_epi32 ( t01, 8 ), hi ) ), wA ),
+		_mm256_madd_epi16 ( _mm256_or_si256 ( _mm256_and_si256 ( _mm256_srli_epi32 ( t10, 8 ), lo ), _mm256_and_si256 ( _mm256_slli_epi32 ( t11, 8 ), hi ) ), wB ) );
+
+	b = _mm256_add_epi32 (
+		_mm256_madd_epi16 ( _mm256_or_si256 ( _mm256_and_si256 ( t00, lo ), _mm256_and_si256 ( _mm256_slli_epi32 ( t01, 16 ), hi ) ), wA ),
+		_mm256_madd_epi16 ( _mm256_or_si256 ( _mm256_and_si256 ( t10, lo ), _mm256_and_si256 ( _mm256_slli_epi32 ( t11, 16 ), hi ) ), wB ) );
+}
+
+static inline BURNING_TARGET_AVX2 __m256i avx2_imulFix ( const __m256i x, const __m256i y )
+{
+	return _mm256_srai_epi32 ( _mm256_mullo_epi32 ( x, y ), FIX_POINT_PRE );
+}
+
+static inline BURNING_TARGET_AVX2 __m256i avx2_imulFix_tex4_clamp ( const __m256i x, const __m256i y )
+{
+	const __m256i a = _mm256_srli_epi32 ( _mm256_mullo_epi32 ( _mm256_srli_epi32 ( x, 2 ), _mm256_srli_epi32 ( y, 2 ) ), FIX_POINT_PRE + 2 );
+
+	// clampfix_maxcolor
+	const __m256i m = _mm256_set1_epi32 ( FIXPOINT_COLOR_MAX );
+	const __m256i c = _mm256_srai_epi32 ( _mm256_sub_epi32 ( a, m ), 31 );
+	return _mm256_or_si256 ( _mm256_and_si256 ( a, c ), _mm256_andnot_si256 ( c, m ) );
+}
+
+static inline BURNING_TARGET_AVX2 __m256i avx2_fix_to_color ( const __m256i r, const __m256i g, const __m256i b )
+{
+	const __m256i m = _mm256_set1_epi32 ( FIXPOINT_COLOR_MAX );
+	return _mm256_or_si256 ( _mm256_or_si256 ( _mm256_set1_epi32 ( MASK_A ),
+			_mm256_slli_epi32 ( _mm256_and_si256 ( r, m ), SHIFT_R - FIX_POINT_PRE ) ),
+			_mm256_or_si256 ( _mm256_srli_epi32 ( _mm256_and_si256 ( g, m ), FIX_POINT_PRE - SHIFT_G ),
+			_mm256_srli_epi32 ( _mm256_and_si256 ( b, m ), FIX_POINT_PRE - SHIFT_B ) ) );
+}
+
+template < eBurningSpanFunc F >
+static BURNING_TARGET_AVX2 void avx2_span ( sBurningSpan &s )
+{
+	if ( F == EBSF_BLEND_DST_COLOR_ZERO && s.zCompare != 1 && s.zCompare != 2 )
+		return;
+
+	sSpanLanes l;
+	tVideoSample tailDst[8];
+	fp24 tailZ[8];
+
+	const __m256i lane = _mm256_setr_epi32 ( 0, 1, 2, 3, 4, 5, 6, 7 );
+	const __m256 fixMul = _mm256_set1_ps ( FIX_POINT_F32_MUL );
+
+	for ( s32 i = 0; i < s.count; i += 8 )
+	{
+		const s32 n = core::s32_min ( s.count - i, 8 );
+		stepLanes ( l, s, n, 8, getSpanLanes ( F ) );
+
+		tVideoSample *dst = s.dst + i;
+		fp24 *z = s.z + i;
+		if ( n < 8 )
+		{
+			memcpy ( tailDst, dst, n * sizeof ( tVideoSample ) );
+			memcpy ( tailZ, z, n * sizeof ( fp24 ) );
+			dst = tailDst;
+			z = tailZ;
+		}
+
+		const __m256 w = _mm256_loadu_ps ( l.w );
+		const __m256 zOld = _mm256_loadu_ps ( z );
+		const __m256 valid = _mm256_castsi256_ps ( _mm256_cmpgt_epi32 ( _mm256_set1_epi32 ( n ), lane ) );
+		const __m256 pass = _mm256_and_ps ( valid,
+			F == EBSF_BLEND_DST_COLOR_ZERO && s.zCompare == 2 ? _mm256_cmp_ps ( w, zOld, _CMP_EQ_OQ ) : _mm256_cmp_ps ( w, zOld, _CMP_GE_OQ ) );
+
+		if ( _mm256_movemask_ps ( pass ) )
+		{
+			_mm256_storeu_ps ( z, _mm256_blendv_ps ( zOld, w, pass ) );
+
+			const __m256 iw = _mm256_div_ps ( fixMul, w );
+			const __m256i dOld = _mm256_loadu_si256 ( (const __m256i*) dst );
+
+			__m256i r0, g0, b0;
+			__m256i r1, g1, b1;
+			__m256i color;
+
+			const __m256i tx0 = _mm256_cvttps_epi32 ( _mm256_mul_ps ( _mm256_loadu_ps ( l.tx[0] ), iw ) );
+			const __m256i ty0 = _mm256_cvttps_epi32 ( _mm256_mul_ps ( _mm256_loadu_ps ( l.ty[0] ), iw ) );
+
+			if ( F == EBSF_LIGHTMAP_M4_MAG || F == EBSF_LIGHTMAP_M4_MIN )
+			{
+				const __m256i tx1 = _mm256_cvttps_epi32 ( _mm256_mul_ps ( _mm256_loadu_ps ( l.tx[1] ), iw ) );
+				const __m256i ty1 = _mm256_cvttps_epi32 ( _mm256_mul_ps ( _mm256_loadu_ps ( l.ty[1] ), iw ) );
+
+				if ( F == EBSF_LIGHTMAP_M4_MAG )
+				{
+					avx2_bilinear ( r0, g0, b0, s.it + 0, tx0, ty0 );
+					avx2_bilinear ( r1, g1, b1, s.it + 1, tx1, ty1 );
+				}
+				else
+				{
+					avx2_texel ( r0, g0, b0, s.it + 0, tx0, ty0 );
+					avx2_texel ( r1, g1, b1, s.it + 1, tx1, ty1 );
+				}
+
+				color = avx2_fix_to_color ( avx2_imulFix_tex4_clamp ( r0, r1 ),
+											avx2_imulFix_tex4_clamp ( g0, g1 ),
+											avx2_imulFix_tex4_clamp ( b0, b1 ) );
+			}
+			else
+			{
+				avx2_bilinear ( r0, g0, b0, s.it + 0, tx0, ty0 );
+
+				const __m256i r2 = _mm256_cvttps_epi32 ( _mm256_mul_ps ( _mm256_loadu_ps ( l.r ), iw ) );
+				const __m256i g2 = _mm256_cvttps_epi32 ( _mm256_mul_ps ( _mm256_loadu_ps ( l.g ), iw ) );
+				const __m256i b2 = _mm256_cvttps_epi32 ( _mm256_mul_ps ( _mm256_loadu_ps ( l.b ), iw ) );
+
+				if ( F == EBSF_BLEND_DST_COLOR_ZERO )
+				{
+					// color_to_fix1
+					r1 = _mm256_srli_epi32 ( _mm256_and_si256 ( dOld, _mm256_set1_epi32 ( MASK_R ) ), SHIFT_R + COLOR_MAX_LOG2 - FIX_POINT_PRE );
+					g1 = _mm256_srli_epi32 ( _mm256_and_si256 ( dOld, _mm256_set1_epi32 ( MASK_G ) ), SHIFT_G + COLOR_MAX_LOG2 - FIX_POINT_PRE );
+					b1 = _mm256_slli_epi32 ( _mm256_and_si256 ( dOld, _mm256_set1_epi32 ( MASK_B ) ), FIX_POINT_PRE - COLOR_MAX_LOG2 );
+
+					color = avx2_fix_to_color ( avx2_imulFix ( avx2_imulFix ( r0, r1 ), r2 ),
+												avx2_imulFix ( avx2_imulFix ( g0, g1 ), g2 ),
+												avx2_imulFix ( avx2_imulFix ( b0, b1 ), b2 ) );
+				}
+				else
+				{
+					color = avx2_fix_to_color ( avx2_imulFix ( r0, r2 ),
+												avx2_imulFix ( g0, g2 ),
+												avx2_imulFix ( b0, b2 ) );
+				}
+			}
+
+			_mm256_storeu_si256 ( (__m256i*) dst, _mm256_castps_si256 (
+				_mm256_blendv_ps ( _mm256_castsi256_ps ( dOld ), _mm256_castsi256_ps ( color ), pass ) ) );
+		}
+
+		if ( n < 8 )
+		{
+			memcpy ( s.dst + i, tailDst, n * sizeof ( tVideoSample ) );
+			memcpy ( s.z + i, tailZ, n * sizeof ( fp24 ) );
+		}
+	}
+}
+
+
+tBurningSpanFunc getBurningSpanFunc ( eBurningSpanFunc func )
+{
+	static const tBurningSpanFunc sse2[EBSF_COUNT] =
+	{
+		sse2_span < EBSF_TEXTURE_GOURAUD >,
+		sse2_span < EBSF_LIGHTMAP_M4_MAG >,
+		sse2_span < EBSF_LIGHTMAP_M4_MIN >,
+		sse2_span < EBSF_BLEND_DST_COLOR_ZERO >
+	};
+
+	static const tBurningSpanFunc avx2[EBSF_COUNT] =
+	{
+		avx2_span < EBSF_TEXTURE_GOURAUD >,
+		avx2_span < EBSF_LIGHTMAP_M4_MAG >,
+		avx2_span < EBSF_LIGHTMAP_M4_MIN >,
+		avx2_span < EBSF_BLEND_DST_COLOR_ZERO >
+	};
+
+	if ( (u32) func >= EBSF_COUNT )
+		return 0;
+
+	switch ( os::CPU::getSIMDLevel () )
+	{
+		case os::CPU::ESL_AVX2: return avx2[func];
+		case os::CPU::ESL_SSE2: return sse2[func];
+		default: return 0;
+	}
+}
+
+const c8* getBurningSpanSIMDName ()
+{
+	return os::CPU::getSIMDName ( os::CPU::getSIMDLevel () );
+}
+
+} // end namespace video
+} // end namespace irr
+
+#else // SOFTWARE_DRIVER_2_SIMD
+
+namespace irr
+{
+namespace video
+{
+
+tBurningSpanFunc getBurningSpanFunc ( eBurningSpanFunc func )
+{
+	return 0;
+}
+
+const c8* getBurningSpanSIMDName ()
+{
+	return "none";
+}
+
+} // end namespace video
+} // end namespace irr
+
+#endif // SOFTWARE_DRIVER_2_SIMD
+
+namespace irr
+{
+namespace video
+{
+
+void burningTransformVertices ( f32* x, f32* y, f32* z, f32* w,
+						const u8* source, u32 pitch, u32 count, const core::matrix4& m )
+{
+	const f32 *M = m.pointer();
+	u32 i = 0;
+
+#ifdef SOFTWARE_DRIVER_2_SIMD
+	if ( os::CPU::getSIMDLevel () != os::CPU::ESL_NONE )
+		i = sse2_transformVertices ( x, y, z, w, source, pitch, count, M );
+#endif
+
+	for ( ; i < count; ++i )
+	{
+		const f32 *p = (const f32*) ( source + i * pitch );
+		x[i] = p[0] * M[0] + p[1] * M[4] + p[2] * M[8] + M[12];
+		y[i] = p[0] * M[1] + p[1] * M[5] + p[2] * M[9] + M[13];
+		z[i] = p[0] * M[2] + p[1] * M[6] + p[2] * M[10] + M[14];
+		w[i] = p[0] * M[3] + p[1] * M[7] + p[2] * M[11] + M[15];
+	}
+}
+
+} // end namespace video
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_BURNINGSVIDEO_
+
@@ -0,0 +1,80 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BURNING_SHADER_SIMD_H_INCLUDED__
+#define __C_BURNING_SHADER_SIMD_H_INCLUDED__
+
+#include "SoftwareDriver2_compile_config.h"
+#include "SoftwareDriver2_helper.h"
+#include "S4DVertex.h"
+#include "matrix4.h"
+
+namespace irr
+{
+
+namespace video
+{
+
+	//! Interpolated values at the first pixel of a span and their per pixel slopes.
+	/** The span functions step the values exactly like the scalar scanline
+	loops, so both produce the same pixels. */
+	struct sBurningSpan
+	{
+		tVideoSample* dst;
+		fp24* z;
+		s32 count;
+
+		fp24 w;
+		fp24 slopeW;
+		sVec2 t[2];
+		sVec2 slopeT[2];
+		sVec4 c;
+		sVec4 slopeC;
+
+		const sInternalTexture* it;
+
+		//! 1: write if w >= z, 2: write if w == z, others: write nothing
+		u32 zCompare;
+	};
+
+	//! Draws count pixels of a span
+	typedef void (*tBurningSpanFunc) ( sBurningSpan& span );
+
+	//! Span functions with a SIMD version
+	enum eBurningSpanFunc
+	{
+		//! texture0 bilinear * vertex color, CTRTextureGouraud2
+		EBSF_TEXTURE_GOURAUD = 0,
+
+		//! texture0 * texture1 * 4 bilinear, CTRTextureLightMap2_M4 magnification
+		EBSF_LIGHTMAP_M4_MAG,
+
+		//! texture0 * texture1 * 4 nearest, CTRTextureLightMap2_M4 minification
+		EBSF_LIGHTMAP_M4_MIN,
+
+		//! texture0 bilinear * vertex color * framebuffer, CTRTextureBlend dst_color/zero
+		EBSF_BLEND_DST_COLOR_ZERO,
+
+		EBSF_COUNT
+	};
+
+	//! Returns the SIMD span function for the instruction sets of this cpu
+	/** Returns 0 if the cpu has no usable instruction set, the shaders then use
+	their scalar loops. */
+	tBurningSpanFunc getBurningSpanFunc ( eBurningSpanFunc func );
+
+	//! Name of the instruction set used by getBurningSpanFunc(), "none" if there is none
+	const c8* getBurningSpanSIMDName ();
+
+	//! Transforms count positions like matrix4::transformVect(f32*, const vector3df&)
+	/** The positions are read from source with pitch bytes between them, the
+	results are written as structure of arrays. Uses SSE2 if available. */
+	void burningTransformVertices ( f32* x, f32* y, f32* z, f32* w,
+						const u8* source, u32 pitch, u32 count, const core::matrix4& m );
+
+} // end namespace video
+} // end namespace irr
+
+#endif
+
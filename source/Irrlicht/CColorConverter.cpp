@@ -360,10 +360,14 @@ void CColorConverter::convert_A1R5G5B5toB8G8R8(const void* sP, s32 sN, void* dP)
 
 void CColorConverter::convert_A1R5G5B5toA8R8G8B8(const void* sP, s32 sN, void* dP)
 {
+	const s32 done = convertSIMD(ESC_A1R5G5B5toA8R8G8B8, sP, sN, dP);
 	u16* sB = (u16*)sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	sB += done;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 		*dB++ = A1R5G5B5toA8R8G8B8(*sB++);
 }
 
@@ -374,19 +378,27 @@ void CColorConverter::convert_A1R5G5B5toA1R5G5B5(const void* sP, s32 sN, void* d
 
 void CColorConverter::convert_A1R5G5B5toR5G6B5(const void* sP, s32 sN, void* dP)
 {
+	const s32 done = convertSIMD(ESC_A1R5G5B5toR5G6B5, sP, sN, dP);
 	u16* sB = (u16*)sP;
 	u16* dB = (u16*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	sB += done;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 		*dB++ = A1R5G5B5toR5G6B5(*sB++);
 }
 
 void CColorConverter::convert_A8R8G8B8toR8G8B8(const void* sP, s32 sN, void* dP)
 {
+	const s32 done = convertSIMD(ESC_A8R8G8B8toR8G8B8, sP, sN, dP);
 	u8* sB = (u8*)sP;
 	u8* dB = (u8*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	sB += done * 4;
+	dB += done * 3;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		// sB[3] is alpha
 		dB[0] = sB[2];
@@ -400,10 +412,14 @@ void CColorConverter::convert_A8R8G8B8toR8G8B8(const void* sP, s32 sN, void* dP)
 
 void CColorConverter::convert_A8R8G8B8toB8G8R8(const void* sP, s32 sN, void* dP)
 {
+	const s32 done = convertSIMD(ESC_A8R8G8B8toB8G8R8, sP, sN, dP);
 	u8* sB = (u8*)sP;
 	u8* dB = (u8*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	sB += done * 4;
+	dB += done * 3;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		// sB[3] is alpha
 		dB[0] = sB[0];
@@ -422,10 +438,14 @@ void CColorConverter::convert_A8R8G8B8toA8R8G8B8(const void* sP, s32 sN, void* d
 
 void CColorConverter::convert_A8R8G8B8toA1R5G5B5(const void* sP, s32 sN, void* dP)
 {
+	const s32 done = convertSIMD(ESC_A8R8G8B8toA1R5G5B5, sP, sN, dP);
 	u32* sB = (u32*)sP;
 	u16* dB = (u16*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	sB += done;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 		*dB++ = A8R8G8B8toA1R5G5B5(*sB++);
 }
 
@@ -450,10 +470,14 @@ void CColorConverter::convert_A8R8G8B8toA1B5G5R5(const void* sP, s32 sN, void* d
 
 void CColorConverter::convert_A8R8G8B8toR5G6B5(const void* sP, s32 sN, void* dP)
 {
+	const s32 done = convertSIMD(ESC_A8R8G8B8toR5G6B5, sP, sN, dP);
 	u8 * sB = (u8 *)sP;
 	u16* dB = (u16*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	sB += done * 4;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		s32 r = sB[2] >> 3;
 		s32 g = sB[1] >> 2;
@@ -491,10 +515,14 @@ void CColorConverter::convert_R8G8B8toR8G8B8(const void* sP, s32 sN, void* dP)
 
 void CColorConverter::convert_R8G8B8toA8R8G8B8(const void* sP, s32 sN, void* dP)
 {
+	const s32 done = convertSIMD(ESC_R8G8B8toA8R8G8B8, sP, sN, dP);
 	u8*  sB = (u8* )sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	sB += done * 3;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		*dB = 0xff000000 | (sB[0]<<16) | (sB[1]<<8) | sB[2];
 
@@ -523,10 +551,14 @@ void CColorConverter::convert_R8G8B8toA1R5G5B5(const void* sP, s32 sN, void* dP)
 
 void CColorConverter::convert_B8G8R8toA8R8G8B8(const void* sP, s32 sN, void* dP)
 {
+	const s32 done = convertSIMD(ESC_B8G8R8toA8R8G8B8, sP, sN, dP);
 	u8*  sB = (u8* )sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	sB += done * 3;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		*dB = 0xff000000 | (sB[2]<<16) | (sB[1]<<8) | sB[0];
 
@@ -537,10 +569,14 @@ void CColorConverter::convert_B8G8R8toA8R8G8B8(const void* sP, s32 sN, void* dP)
 
 void CColorConverter::convert_B8G8R8A8toA8R8G8B8(const void* sP, s32 sN, void* dP)
 {
+	const s32 done = convertSIMD(ESC_B8G8R8A8toA8R8G8B8, sP, sN, dP);
 	u8* sB = (u8*)sP;
 	u8* dB = (u8*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	sB += done * 4;
+	dB += done * 4;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		dB[0] = sB[3];
 		dB[1] = sB[2];
@@ -555,10 +591,14 @@ void CColorConverter::convert_B8G8R8A8toA8R8G8B8(const void* sP, s32 sN, void* d
 
 void CColorConverter::convert_A8R8G8B8toA8B8G8R8(const void* sP, s32 sN, void* dP)
 {
+	const s32 done = convertSIMD(ESC_A8R8G8B8toA8B8G8R8, sP, sN, dP);
 	const u32* sB = (const u32*)sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	sB += done;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		*dB++ = (*sB & 0xff00ff00) | ((*sB & 0x00ff0000) >> 16) | ((*sB & 0x000000ff) << 16);
 		++sB;
@@ -622,19 +662,27 @@ void CColorConverter::convert_R5G6B5toB8G8R8(const void* sP, s32 sN, void* dP)
 
 void CColorConverter::convert_R5G6B5toA8R8G8B8(const void* sP, s32 sN, void* dP)
 {
+	const s32 done = convertSIMD(ESC_R5G6B5toA8R8G8B8, sP, sN, dP);
 	u16* sB = (u16*)sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	sB += done;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 		*dB++ = R5G6B5toA8R8G8B8(*sB++);
 }
 
 void CColorConverter::convert_R5G6B5toA1R5G5B5(const void* sP, s32 sN, void* dP)
 {
+	const s32 done = convertSIMD(ESC_R5G6B5toA1R5G5B5, sP, sN, dP);
 	u16* sB = (u16*)sP;
 	u16* dB = (u16*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	sB += done;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 		*dB++ = R5G6B5toA1R5G5B5(*sB++);
 }
 
@@ -86,6 +86,31 @@ public:
 	static void convert_R5G6B5toA1R5G5B5(const void* sP, s32 sN, void* dP);
 	static void convert_viaFormat(const void* sP, ECOLOR_FORMAT sF, s32 sN,
 				void* dP, ECOLOR_FORMAT dF);
+
+	//! Conversions with SIMD kernels
+	enum E_SIMD_CONVERSION
+	{
+		ESC_A1R5G5B5toA8R8G8B8 = 0,
+		ESC_A1R5G5B5toR5G6B5,
+		ESC_A8R8G8B8toR8G8B8,
+		ESC_A8R8G8B8toB8G8R8,
+		ESC_A8R8G8B8toA1R5G5B5,
+		ESC_A8R8G8B8toR5G6B5,
+		ESC_A8R8G8B8toA8B8G8R8,
+		ESC_R8G8B8toA8R8G8B8,
+		ESC_B8G8R8toA8R8G8B8,
+		ESC_B8G8R8A8toA8R8G8B8,
+		ESC_R5G6B5toA8R8G8B8,
+		ESC_R5G6B5toA1R5G5B5,
+
+		ESC_COUNT
+	};
+
+	//! Converts the first pixels with the kernel for the instruction set of the cpu.
+	/** The kernels convert blocks of 4 to 16 pixels, the convert_ functions
+	convert the remaining pixels.
+	\return Number of converted pixels, 0 if there is no kernel for the cpu. */
+	static s32 convertSIMD(E_SIMD_CONVERSION conversion, const void* sP, s32 sN, void* dP);
 };
 
 
@@ -0,0 +1,443 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CColorConverter.h"
+#include "os.h"
+
+// the kernels are built with target attributes, so the engine needs no special compiler flags
+#if (defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)) && \
+	((defined(_MSC_VER) && _MSC_VER >= 1700) || (defined(__GNUC__) && __GNUC__ >= 5) || defined(__clang__)) && \
+	!defined(NO_IRR_COLOR_CONVERTER_SIMD_)
+	#define _IRR_COLOR_CONVERTER_SIMD_
+	#include <emmintrin.h>
+	#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+	#define CONVERTER_TARGET_SSE2 __attribute__((target("sse2")))
+	#define CONVERTER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define CONVERTER_TARGET_SSE2
+	#define CONVERTER_TARGET_AVX2
+#endif
+
+namespace irr
+{
+namespace video
+{
+
+#ifdef _IRR_COLOR_CONVERTER_SIMD_
+
+/*
+	Each pixel operation is written once for 128 bit and once for 256 bit
+	registers and gives the same bits as the scalar functions in SColor.h.
+	The loops below load, convert and store whole registers and return the
+	number of pixels done, the scalar code converts the rest.
+*/
+
+// 32 bit lanes
+struct sOpA1R5G5B5toA8R8G8B8
+{
+	static CONVERTER_TARGET_SSE2 __m128i sse2(__m128i c)
+	{
+		const __m128i a = _mm_and_si128(_mm_srai_epi32(_mm_slli_epi32(c, 16), 31), _mm_set1_epi32(0xFF000000));
+		const __m128i r = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x7C00)), 9),
+			_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x7000)), 4));
+		const __m128i g = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x03E0)), 6),
+			_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x0380)), 1));
+		const __m128i b = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x001F)), 3),
+			_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x001C)), 2));
+		return _mm_or_si128(_mm_or_si128(a, r), _mm_or_si128(g, b));
+	}
+
+	static CONVERTER_TARGET_AVX2 __m256i avx2(__m256i c)
+	{
+		const __m256i a = _mm256_and_si256(_mm256_srai_epi32(_mm256_slli_epi32(c, 16), 31), _mm256_set1_epi32(0xFF000000));
+		const __m256i r = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x7C00)), 9),
+			_mm256_slli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x7000)), 4));
+		const __m256i g = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x03E0)), 6),
+			_mm256_slli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x0380)), 1));
+		const __m256i b = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x001F)), 3),
+			_mm256_srli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x001C)), 2));
+		return _mm256_or_si256(_mm256_or_si256(a, r), _mm256_or_si256(g, b));
+	}
+};
+
+struct sOpR5G6B5toA8R8G8B8
+{
+	static CONVERTER_TARGET_SSE2 __m128i sse2(__m128i c)
+	{
+		const __m128i r = _mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0xF800)), 8);
+		const __m128i g = _mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x07E0)), 5);
+		const __m128i b = _mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x001F)), 3);
+		return _mm_or_si128(_mm_or_si128(_mm_set1_epi32(0xFF000000), r), _mm_or_si128(g, b));
+	}
+
+	static CONVERTER_TARGET_AVX2 __m256i avx2(__m256i c)
+	{
+		const __m256i r = _mm256_slli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0xF800)), 8);
+		const __m256i g = _mm256_slli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x07E0)), 5);
+		const __m256i b = _mm256_slli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x001F)), 3);
+		return _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi32(0xFF000000), r), _mm256_or_si256(g, b));
+	}
+};
+
+struct sOpA8R8G8B8toA1R5G5B5
+{
+	static CONVERTER_TARGET_SSE2 __m128i sse2(__m128i c)
+	{
+		const __m128i a = _mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x80000000)), 16);
+		const __m128i r = _mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x00F80000)), 9);
+		const __m128i g = _mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x0000F800)), 6);
+		const __m128i b = _mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x000000F8)), 3);
+		return _mm_or_si128(_mm_or_si128(a, r), _mm_or_si128(g, b));
+	}
+
+	static CONVERTER_TARGET_AVX2 __m256i avx2(__m256i c)
+	{
+		const __m256i a = _mm256_srli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x80000000)), 16);
+		const __m256i r = _mm256_srli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x00F80000)), 9);
+		const __m256i g = _mm256_srli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x0000F800)), 6);
+		const __m256i b = _mm256_srli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x000000F8)), 3);
+		return _mm256_or_si256(_mm256_or_si256(a, r), _mm256_or_si256(g, b));
+	}
+};
+
+struct sOpA8R8G8B8toR5G6B5
+{
+	static CONVERTER_TARGET_SSE2 __m128i sse2(__m128i c)
+	{
+		const __m128i r = _mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x00F80000)), 8);
+		const __m128i g = _mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x0000FC00)), 5);
+		const __m128i b = _mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x000000F8)), 3);
+		return _mm_or_si128(_mm_or_si128(r, g), b);
+	}
+
+	static CONVERTER_TARGET_AVX2 __m256i avx2(__m256i c)
+	{
+		const __m256i r = _mm256_srli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x00F80000)), 8);
+		const __m256i g = _mm256_srli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x0000FC00)), 5);
+		const __m256i b = _mm256_srli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x000000F8)), 3);
+		return _mm256_or_si256(_mm256_or_si256(r, g), b);
+	}
+};
+
+struct sOpA8R8G8B8toA8B8G8R8
+{
+	static CONVERTER_TARGET_SSE2 __m128i sse2(__m128i c)
+	{
+		const __m128i ag = _mm_and_si128(c, _mm_set1_epi32(0xFF00FF00));
+		const __m128i r = _mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x00FF0000)), 16);
+		const __m128i b = _mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x000000FF)), 16);
+		return _mm_or_si128(_mm_or_si128(ag, r), b);
+	}
+
+	static CONVERTER_TARGET_AVX2 __m256i avx2(__m256i c)
+	{
+		const __m256i ag = _mm256_and_si256(c, _mm256_set1_epi32(0xFF00FF00));
+		const __m256i r = _mm256_srli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x00FF0000)), 16);
+		const __m256i b = _mm256_slli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x000000FF)), 16);
+		return _mm256_or_si256(_mm256_or_si256(ag, r), b);
+	}
+};
+
+// reverses the bytes of each pixel
+struct sOpB8G8R8A8toA8R8G8B8
+{
+	static CONVERTER_TARGET_SSE2 __m128i sse2(__m128i c)
+	{
+		// swap the bytes of the words, then the words of the pixels
+		c = _mm_or_si128(_mm_slli_epi16(c, 8), _mm_srli_epi16(c, 8));
+		c = _mm_shufflelo_epi16(c, _MM_SHUFFLE(2, 3, 0, 1));
+		return _mm_shufflehi_epi16(c, _MM_SHUFFLE(2, 3, 0, 1));
+	}
+
+	static CONVERTER_TARGET_AVX2 __m256i avx2(__m256i c)
+	{
+		const __m256i reverse = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		return _mm256_shuffle_epi8(c, reverse);
+	}
+};
+
+// 16 bit lanes
+struct sOpA1R5G5B5toR5G6B5
+{
+	static CONVERTER_TARGET_SSE2 __m128i sse2(__m128i c)
+	{
+		return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(c, _mm_set1_epi16(0x7FE0)), 1),
+			_mm_and_si128(c, _mm_set1_epi16(0x001F)));
+	}
+
+	static CONVERTER_TARGET_AVX2 __m256i avx2(__m256i c)
+	{
+		return _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(c, _mm256_set1_epi16(0x7FE0)), 1),
+			_mm256_and_si256(c, _mm256_set1_epi16(0x001F)));
+	}
+};
+
+struct sOpR5G6B5toA1R5G5B5
+{
+	static CONVERTER_TARGET_SSE2 __m128i sse2(__m128i c)
+	{
+		const __m128i rg = _mm_srli_epi16(_mm_and_si128(c, _mm_set1_epi16((s16)0xFFC0)), 1);
+		const __m128i b = _mm_and_si128(c, _mm_set1_epi16(0x001F));
+		return _mm_or_si128(_mm_or_si128(_mm_set1_epi16((s16)0x8000), rg), b);
+	}
+
+	static CONVERTER_TARGET_AVX2 __m256i avx2(__m256i c)
+	{
+		const __m256i rg = _mm256_srli_epi16(_mm256_and_si256(c, _mm256_set1_epi16((s16)0xFFC0)), 1);
+		const __m256i b = _mm256_and_si256(c, _mm256_set1_epi16(0x001F));
+		return _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi16((s16)0x8000), rg), b);
+	}
+};
+
+
+// SSE2 loops
+
+template <class OP>
+CONVERTER_TARGET_SSE2 s32 convertSSE2_16to32(const void* sP, s32 sN, void* dP)
+{
+	const u16* sB = (const u16*)sP;
+	u32* dB = (u32*)dP;
+	const __m128i zero = _mm_setzero_si128();
+
+	s32 x = 0;
+	for (; x + 8 <= sN; x += 8)
+	{
+		const __m128i c = _mm_loadu_si128((const __m128i*)(sB + x));
+		_mm_storeu_si128((__m128i*)(dB + x), OP::sse2(_mm_unpacklo_epi16(c, zero)));
+		_mm_storeu_si128((__m128i*)(dB + x + 4), OP::sse2(_mm_unpackhi_epi16(c, zero)));
+	}
+	return x;
+}
+
+// sign extends the 16 bit results, so packing doesn't saturate them
+template <class OP>
+CONVERTER_TARGET_SSE2 s32 convertSSE2_32to16(const void* sP, s32 sN, void* dP)
+{
+	const u32* sB = (const u32*)sP;
+	u16* dB = (u16*)dP;
+
+	s32 x = 0;
+	for (; x + 8 <= sN; x += 8)
+	{
+		__m128i lo = OP::sse2(_mm_loadu_si128((const __m128i*)(sB + x)));
+		__m128i hi = OP::sse2(_mm_loadu_si128((const __m128i*)(sB + x + 4)));
+		lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+		hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+		_mm_storeu_si128((__m128i*)(dB + x), _mm_packs_epi32(lo, hi));
+	}
+	return x;
+}
+
+template <class OP>
+CONVERTER_TARGET_SSE2 s32 convertSSE2_32to32(const void* sP, s32 sN, void* dP)
+{
+	const u32* sB = (const u32*)sP;
+	u32* dB = (u32*)dP;
+
+	s32 x = 0;
+	for (; x + 4 <= sN; x += 4)
+		_mm_storeu_si128((__m128i*)(dB + x), OP::sse2(_mm_loadu_si128((const __m128i*)(sB + x))));
+	return x;
+}
+
+template <class OP>
+CONVERTER_TARGET_SSE2 s32 convertSSE2_16to16(const void* sP, s32 sN, void* dP)
+{
+	const u16* sB = (const u16*)sP;
+	u16* dB = (u16*)dP;
+
+	s32 x = 0;
+	for (; x + 8 <= sN; x += 8)
+		_mm_storeu_si128((__m128i*)(dB + x), OP::sse2(_mm_loadu_si128((const __m128i*)(sB + x))));
+	return x;
+}
+
+
+// AVX2 loops
+
+template <class OP>
+CONVERTER_TARGET_AVX2 s32 convertAVX2_16to32(const void* sP, s32 sN, void* dP)
+{
+	const u16* sB = (const u16*)sP;
+	u32* dB = (u32*)dP;
+
+	s32 x = 0;
+	for (; x + 16 <= sN; x += 16)
+	{
+		const __m128i lo = _mm_loadu_si128((const __m128i*)(sB + x));
+		const __m128i hi = _mm_loadu_si128((const __m128i*)(sB + x + 8));
+		_mm256_storeu_si256((__m256i*)(dB + x), OP::avx2(_mm256_cvtepu16_epi32(lo)));
+		_mm256_storeu_si256((__m256i*)(dB + x + 8), OP::avx2(_mm256_cvtepu16_epi32(hi)));
+	}
+	return x;
+}
+
+// packing works on 128 bit lanes, the permute puts the pixels back in order
+template <class OP>
+CONVERTER_TARGET_AVX2 s32 convertAVX2_32to16(const void* sP, s32 sN, void* dP)
+{
+	const u32* sB = (const u32*)sP;
+	u16* dB = (u16*)dP;
+
+	s32 x = 0;
+	for (; x + 16 <= sN; x += 16)
+	{
+		__m256i lo = OP::avx2(_mm256_loadu_si256((const __m256i*)(sB + x)));
+		__m256i hi = OP::avx2(_mm256_loadu_si256((const __m256i*)(sB + x + 8)));
+		lo = _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16);
+		hi = _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16);
+		const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm256_storeu_si256((__m256i*)(dB + x), packed);
+	}
+	return x;
+}
+
+template <class OP>
+CONVERTER_TARGET_AVX2 s32 convertAVX2_32to32(const void* sP, s32 sN, void* dP)
+{
+	const u32* sB = (const u32*)sP;
+	u32* dB = (u32*)dP;
+
+	s32 x = 0;
+	for (; x + 8 <= sN; x += 8)
+		_mm256_storeu_si256((__m256i*)(dB + x), OP::avx2(_mm256_loadu_si256((const __m256i*)(sB + x))));
+	return x;
+}
+
+template <class OP>
+CONVERTER_TARGET_AVX2 s32 convertAVX2_16to16(const void* sP, s32 sN, void* dP)
+{
+	const u16* sB = (const u16*)sP;
+	u16* dB = (u16*)dP;
+
+	s32 x = 0;
+	for (; x + 16 <= sN; x += 16)
+		_mm256_storeu_si256((__m256i*)(dB + x), OP::avx2(_mm256_loadu_si256((const __m256i*)(sB + x))));
+	return x;
+}
+
+/*
+	The 24 bit formats need a byte shuffle, which SSE2 doesn't have. Each 128
+	bit lane holds 4 pixels, 12 bytes of a lane are used. The loads and stores
+	of the second lane reach 4 bytes past the 8 pixels, so the loops stop 2
+	pixels early to stay inside the buffers.
+*/
+
+// R8G8B8 is stored as R,G,B bytes, B8G8R8 as B,G,R bytes
+template <bool BGR>
+CONVERTER_TARGET_AVX2 s32 convertAVX2_24to32(const void* sP, s32 sN, void* dP)
+{
+	const u8* sB = (const u8*)sP;
+	u32* dB = (u32*)dP;
+
+	const __m256i shuffle = BGR ?
+		_mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+			0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1) :
+		_mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+			2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+	const __m256i alpha = _mm256_set1_epi32(0xFF000000);
+
+	s32 x = 0;
+	for (; x + 10 <= sN; x += 8)
+	{
+		const u8* s = sB + x * 3;
+		__m256i c = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)s));
+		c = _mm256_inserti128_si256(c, _mm_loadu_si128((const __m128i*)(s + 12)), 1);
+		_mm256_storeu_si256((__m256i*)(dB + x), _mm256_or_si256(_mm256_shuffle_epi8(c, shuffle), alpha));
+	}
+	return x;
+}
+
+// the first lane is stored first, so the second lane overwrites its 4 unused bytes
+template <bool BGR>
+CONVERTER_TARGET_AVX2 s32 convertAVX2_32to24(const void* sP, s32 sN, void* dP)
+{
+	const u32* sB = (const u32*)sP;
+	u8* dB = (u8*)dP;
+
+	const __m256i shuffle = BGR ?
+		_mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+			0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1) :
+		_mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+	s32 x = 0;
+	for (; x + 10 <= sN; x += 8)
+	{
+		const __m256i c = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(sB + x)), shuffle);
+		u8* d = dB + x * 3;
+		_mm_storeu_si128((__m128i*)d, _mm256_castsi256_si128(c));
+		_mm_storeu_si128((__m128i*)(d + 12), _mm256_extracti128_si256(c, 1));
+	}
+	return x;
+}
+
+
+typedef s32 (*tConvertKernel)(const void* sP, s32 sN, void* dP);
+
+// kernels in the order of CColorConverter::E_SIMD_CONVERSION, 0 for none
+static const tConvertKernel SSE2Kernels[CColorConverter::ESC_COUNT] =
+{
+	convertSSE2_16to32<sOpA1R5G5B5toA8R8G8B8>,
+	convertSSE2_16to16<sOpA1R5G5B5toR5G6B5>,
+	0,
+	0,
+	convertSSE2_32to16<sOpA8R8G8B8toA1R5G5B5>,
+	convertSSE2_32to16<sOpA8R8G8B8toR5G6B5>,
+	convertSSE2_32to32<sOpA8R8G8B8toA8B8G8R8>,
+	0,
+	0,
+	convertSSE2_32to32<sOpB8G8R8A8toA8R8G8B8>,
+	convertSSE2_16to32<sOpR5G6B5toA8R8G8B8>,
+	convertSSE2_16to16<sOpR5G6B5toA1R5G5B5>
+};
+
+static const tConvertKernel AVX2Kernels[CColorConverter::ESC_COUNT] =
+{
+	convertAVX2_16to32<sOpA1R5G5B5toA8R8G8B8>,
+	convertAVX2_16to16<sOpA1R5G5B5toR5G6B5>,
+	convertAVX2_32to24<false>,
+	convertAVX2_32to24<true>,
+	convertAVX2_32to16<sOpA8R8G8B8toA1R5G5B5>,
+	convertAVX2_32to16<sOpA8R8G8B8toR5G6B5>,
+	convertAVX2_32to32<sOpA8R8G8B8toA8B8G8R8>,
+	convertAVX2_24to32<false>,
+	convertAVX2_24to32<true>,
+	convertAVX2_32to32<sOpB8G8R8A8toA8R8G8B8>,
+	convertAVX2_16to32<sOpR5G6B5toA8R8G8B8>,
+	convertAVX2_16to16<sOpR5G6B5toA1R5G5B5>
+};
+
+#endif // _IRR_COLOR_CONVERTER_SIMD_
+
+
+// Other instruction sets, like NEON on ARM, would add a table of kernels here.
+s32 CColorConverter::convertSIMD(E_SIMD_CONVERSION conversion, const void* sP, s32 sN, void* dP)
+{
+#ifdef _IRR_COLOR_CONVERTER_SIMD_
+	// too short to be worth it
+	if (sN < 16 || conversion >= ESC_COUNT)
+		return 0;
+
+	const os::CPU::E_SIMD_LEVEL level = os::CPU::getSIMDLevel();
+
+	tConvertKernel kernel = 0;
+	if (level >= os::CPU::ESL_AVX2)
+		kernel = AVX2Kernels[conversion];
+	if (!kernel && level >= os::CPU::ESL_SSE2)
+		kernel = SSE2Kernels[conversion];
+
+	if (kernel)
+		return kernel(sP, sN, dP);
+#endif
+	return 0;
+}
+
+
+} // end namespace video
+} // end namespace irr
@@ -13,10 +13,16 @@ namespace irr
 namespace video
 {
 
+// 8x8 pixel blocks
+#define DEPTH_BLOCK_LOG2 3
+
+// interpolated depths may step a bit beyond the depth of the vertices
+#define DEPTH_BLOCK_EPSILON (1.f / 1024.f)
+
 
 //! constructor
 CDepthBuffer::CDepthBuffer(const core::dimension2d<u32>& size)
-: Buffer(0), Size(0,0)
+: Buffer(0), Size(0,0), Block(0), BlockPitch(0), BlockRows(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CDepthBuffer");
@@ -31,6 +37,7 @@ CDepthBuffer::CDepthBuffer(const core::dimension2d<u32>& size)
 CDepthBuffer::~CDepthBuffer()
 {
 	delete [] Buffer;
+	delete [] Block;
 }
 
 
@@ -49,6 +56,7 @@ void CDepthBuffer::clear()
 	zMaxValue = IR(zMax);
 
 	memset32 ( Buffer, zMaxValue, TotalSize );
+	memset32 ( Block, zMaxValue, BlockPitch * BlockRows * sizeof ( fp24 ) );
 }
 
 
@@ -62,10 +70,15 @@ void CDepthBuffer::setSize(const core::dimension2d<u32>& size)
 	Size = size;
 
 	delete [] Buffer;
+	delete [] Block;
 
 	Pitch = size.Width * sizeof ( fp24 );
 	TotalSize = Pitch * size.Height;
 	Buffer = new u8[TotalSize];
+
+	BlockPitch = ( size.Width + ( 1 << DEPTH_BLOCK_LOG2 ) - 1 ) >> DEPTH_BLOCK_LOG2;
+	BlockRows = ( size.Height + ( 1 << DEPTH_BLOCK_LOG2 ) - 1 ) >> DEPTH_BLOCK_LOG2;
+	Block = new fp24[BlockPitch * BlockRows];
 	clear ();
 }
 
@@ -77,6 +90,103 @@ const core::dimension2d<u32>& CDepthBuffer::getSize() const
 	return Size;
 }
 
+
+//! returns true if no pixel of the triangle can pass a w >= z depth test
+bool CDepthBuffer::isOccluded(const s4DVertex* a, const s4DVertex* b, const s4DVertex* c) const
+{
+	if ( 0 == BlockPitch || 0 == BlockRows )
+		return false;
+
+	f32 w = core::max_ ( a->Pos.w, b->Pos.w, c->Pos.w );
+	w += w * DEPTH_BLOCK_EPSILON;
+
+	// the shaders draw the pixels from ceil(min) to ceil(max) - 1
+	const s32 x0 = core::s32_clamp ( core::floor32 ( core::min_ ( a->Pos.x, b->Pos.x, c->Pos.x ) ), 0, Size.Width - 1 ) >> DEPTH_BLOCK_LOG2;
+	const s32 x1 = core::s32_clamp ( core::floor32 ( core::max_ ( a->Pos.x, b->Pos.x, c->Pos.x ) ), 0, Size.Width - 1 ) >> DEPTH_BLOCK_LOG2;
+	const s32 y0 = core::s32_clamp ( core::floor32 ( core::min_ ( a->Pos.y, b->Pos.y, c->Pos.y ) ), 0, Size.Height - 1 ) >> DEPTH_BLOCK_LOG2;
+	const s32 y1 = core::s32_clamp ( core::floor32 ( core::max_ ( a->Pos.y, b->Pos.y, c->Pos.y ) ), 0, Size.Height - 1 ) >> DEPTH_BLOCK_LOG2;
+
+	for ( s32 y = y0; y <= y1; ++y )
+	{
+		const fp24* block = Block + y * BlockPitch;
+		for ( s32 x = x0; x <= x1; ++x )
+		{
+			if ( block[x] <= w )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
+//! raises the farthest depth of the blocks fully covered by a triangle
+void CDepthBuffer::addOccluder(const s4DVertex* a, const s4DVertex* b, const s4DVertex* c)
+{
+	const f32 minX = core::min_ ( a->Pos.x, b->Pos.x, c->Pos.x );
+	const f32 maxX = core::max_ ( a->Pos.x, b->Pos.x, c->Pos.x );
+	const f32 minY = core::min_ ( a->Pos.y, b->Pos.y, c->Pos.y );
+	const f32 maxY = core::max_ ( a->Pos.y, b->Pos.y, c->Pos.y );
+
+	// too small to cover a block
+	if ( maxX - minX < 10.f || maxY - minY < 10.f )
+		return;
+
+	const f32 wMax = core::max_ ( a->Pos.w, b->Pos.w, c->Pos.w );
+	const f32 w = core::min_ ( a->Pos.w, b->Pos.w, c->Pos.w ) - wMax * DEPTH_BLOCK_EPSILON;
+	if ( w <= 0.f )
+		return;
+
+	// edge functions, positive inside. double, because the products get large
+	const f64 area = ( (f64) b->Pos.x - a->Pos.x ) * ( (f64) c->Pos.y - a->Pos.y ) -
+					( (f64) b->Pos.y - a->Pos.y ) * ( (f64) c->Pos.x - a->Pos.x );
+	if ( area == 0.0 )
+		return;
+
+	const f64 sign = area > 0.0 ? 1.0 : -1.0;
+	const s4DVertex* v[4] = { a, b, c, a };
+	f64 edge[3][3];
+	u32 i;
+	for ( i = 0; i != 3; ++i )
+	{
+		edge[i][0] = -( (f64) v[i+1]->Pos.y - v[i]->Pos.y ) * sign;
+		edge[i][1] = ( (f64) v[i+1]->Pos.x - v[i]->Pos.x ) * sign;
+		edge[i][2] = -( edge[i][0] * v[i]->Pos.x + edge[i][1] * v[i]->Pos.y );
+	}
+
+	// a block counts as covered if a one pixel border around it is inside the triangle
+	const s32 size = 1 << DEPTH_BLOCK_LOG2;
+	const s32 x0 = core::s32_max ( core::ceil32 ( ( minX + 1.f ) * ( 1.f / size ) ), 0 );
+	const s32 x1 = core::s32_min ( core::floor32 ( ( maxX - size ) * ( 1.f / size ) ), BlockPitch - 1 );
+	const s32 y0 = core::s32_max ( core::ceil32 ( ( minY + 1.f ) * ( 1.f / size ) ), 0 );
+	const s32 y1 = core::s32_min ( core::floor32 ( ( maxY - size ) * ( 1.f / size ) ), BlockRows - 1 );
+
+	for ( s32 y = y0; y <= y1; ++y )
+	{
+		fp24* block = Block + y * BlockPitch;
+		const f64 top = (f64) ( y * size - 1 );
+		const f64 bottom = (f64) ( y * size + size );
+
+		for ( s32 x = x0; x <= x1; ++x )
+		{
+			const f64 left = (f64) ( x * size - 1 );
+			const f64 right = (f64) ( x * size + size );
+
+			// the corner with the smallest value of each edge function
+			for ( i = 0; i != 3; ++i )
+			{
+				if ( edge[i][0] * ( edge[i][0] > 0.0 ? left : right ) +
+					edge[i][1] * ( edge[i][1] > 0.0 ? top : bottom ) +
+					edge[i][2] <= 0.0 )
+					break;
+			}
+
+			if ( i == 3 && block[x] < w )
+				block[x] = w;
+		}
+	}
+}
+
 // -----------------------------------------------------------------
 
 //! constructor
@@ -40,6 +40,15 @@ namespace video
 		//! returns pitch of depthbuffer (in bytes)
 		virtual u32 getPitch() const _IRR_OVERRIDE_ { return Pitch; }
 
+		//! returns true if no pixel of the triangle can pass a w >= z depth test
+		/** Compares the nearest depth of the triangle with the farthest depth
+		of the 8x8 pixel blocks under its bounding box. */
+		bool isOccluded(const s4DVertex* a, const s4DVertex* b, const s4DVertex* c) const;
+
+		//! raises the farthest depth of the blocks fully covered by a triangle
+		/** Only valid for shaders which test with w >= z and write the depth
+		of every pixel passing the test. */
+		void addOccluder(const s4DVertex* a, const s4DVertex* b, const s4DVertex* c);
 
 	private:
 
@@ -47,6 +56,12 @@ namespace video
 		core::dimension2d<u32> Size;
 		u32 TotalSize;
 		u32 Pitch;
+
+		// farthest depth of each 8x8 block, never nearer than any pixel of the block.
+		// The shaders only write nearer depths, so it stays valid until they cover the block.
+		fp24* Block;
+		u32 BlockPitch;
+		u32 BlockRows;
 	};
 
 
@@ -0,0 +1,205 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CFileIndex.h"
+#include "IFileList.h"
+
+namespace irr
+{
+namespace io
+{
+
+namespace
+{
+
+const u32 EmptySlot = 0xffffffff;
+
+//! character as IFileList::findFile compares it
+inline u32 normalize(fschar_t c)
+{
+	return c == '\\' ? '/' : core::locale_lower(c);
+}
+
+//! FNV-1a hash of a normalized name
+u32 getHash(const fschar_t* name, u32 length)
+{
+	u32 hash = 2166136261u;
+	for (u32 i=0; i<length; ++i)
+	{
+		hash ^= normalize(name[i]);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+bool sameName(const io::path& a, const fschar_t* b, u32 length)
+{
+	if (a.size() != length)
+		return false;
+
+	for (u32 i=0; i<length; ++i)
+	{
+		if (normalize(a[i]) != normalize(b[i]))
+			return false;
+	}
+	return true;
+}
+
+} // end anonymous namespace
+
+
+//! removes all archives
+void CFileIndex::clear()
+{
+	Paths.Entries.clear();
+	Paths.Count = 0;
+	Names.Entries.clear();
+	Names.Count = 0;
+	Lists.clear();
+}
+
+
+//! adds the files of the archive at a position of the file system
+bool CFileIndex::addArchive(const IFileArchive* archive, u32 position)
+{
+	bool ignorePaths = false;
+	bool ignoreCase = false;
+	const IFileList* list = archive ? archive->getFileList() : 0;
+	// names are compared regardless of case, so archives which keep the case are asked themselves
+	const bool indexable = list && archive->isIndexable(ignorePaths, ignoreCase) && ignoreCase;
+
+	if (Lists.size() <= position)
+	{
+		while (Lists.size() < position)
+			Lists.push_back(0);
+		Lists.push_back(indexable ? list : 0);
+	}
+	else
+		Lists[position] = indexable ? list : 0;
+
+	if (!indexable)
+		return false;
+
+	STable& table = ignorePaths ? Names : Paths;
+	const u32 count = list->getFileCount();
+	for (u32 i=0; i<count; ++i)
+	{
+		if (!list->isDirectory(i))
+			insert(table, list->getFullFileName(i), position, i);
+	}
+	return true;
+}
+
+
+//! finds the archive at the lowest position which has a file
+bool CFileIndex::findFile(const io::path& filename, u32& position, u32& index) const
+{
+	const u32 length = filename.size();
+	if (length == 0 || filename[length-1] == '/' || filename[length-1] == '\\')
+		return false;
+
+	bool found = false;
+	const fschar_t* name = filename.c_str();
+
+	if (Paths.Count)
+	{
+		const SEntry& entry = Paths.Entries[findSlot(Paths, name, length, getHash(name, length))];
+		if (entry.Position != EmptySlot)
+		{
+			position = entry.Position;
+			index = entry.Index;
+			found = true;
+		}
+	}
+
+	if (Names.Count)
+	{
+		u32 start = length;
+		while (start && name[start-1] != '/' && name[start-1] != '\\')
+			--start;
+
+		const SEntry& entry = Names.Entries[findSlot(Names, name + start, length - start, getHash(name + start, length - start))];
+		if (entry.Position != EmptySlot && (!found || entry.Position < position))
+		{
+			position = entry.Position;
+			index = entry.Index;
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+
+//! finds a name in a table, returns the slot or the empty slot where it belongs
+u32 CFileIndex::findSlot(const STable& table, const fschar_t* name, u32 length, u32 hash) const
+{
+	const u32 mask = table.Entries.size() - 1;
+	u32 slot = hash & mask;
+	for (;;)
+	{
+		const SEntry& entry = table.Entries[slot];
+		if (entry.Position == EmptySlot)
+			return slot;
+		if (entry.Hash == hash && sameName(Lists[entry.Position]->getFullFileName(entry.Index), name, length))
+			return slot;
+		slot = (slot + 1) & mask;
+	}
+}
+
+
+//! adds a file if the table does not have its name yet
+void CFileIndex::insert(STable& table, const io::path& name, u32 position, u32 index)
+{
+	if ((table.Count + 1) * 2 > table.Entries.size())
+		grow(table);
+
+	const u32 hash = getHash(name.c_str(), name.size());
+	SEntry& entry = table.Entries[findSlot(table, name.c_str(), name.size(), hash)];
+
+	// archives added before have priority
+	if (entry.Position != EmptySlot)
+		return;
+
+	entry.Hash = hash;
+	entry.Position = position;
+	entry.Index = index;
+	++table.Count;
+}
+
+
+//! doubles the size of a table
+void CFileIndex::grow(STable& table)
+{
+	const u32 size = core::max_(table.Entries.size() * 2, 64u);
+
+	SEntry empty;
+	empty.Hash = 0;
+	empty.Position = EmptySlot;
+	empty.Index = 0;
+
+	core::array<SEntry> entries(size);
+	for (u32 i=0; i<size; ++i)
+		entries.push_back(empty);
+
+	// the hashes are kept, so names are not compared again
+	for (u32 i=0; i<table.Entries.size(); ++i)
+	{
+		const SEntry& entry = table.Entries[i];
+		if (entry.Position == EmptySlot)
+			continue;
+
+		u32 slot = entry.Hash & (size - 1);
+		while (entries[slot].Position != EmptySlot)
+			slot = (slot + 1) & (size - 1);
+		entries[slot] = entry;
+	}
+
+	table.Entries.swap(entries);
+}
+
+
+} // end namespace io
+} // end namespace irr
+
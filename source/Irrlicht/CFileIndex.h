@@ -0,0 +1,89 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_FILE_INDEX_H_INCLUDED__
+#define __C_FILE_INDEX_H_INCLUDED__
+
+#include "IFileArchive.h"
+#include "irrArray.h"
+
+namespace irr
+{
+namespace io
+{
+
+//! Hash index of the files in all archives of the file system.
+/** The names of the files of each archive are hashed once when the archive is
+added. Names are hashed and compared regardless of case and with '\\' taken as
+'/', which is how IFileList::findFile compares them, so the index finds the
+same files as asking the archives. Archives which ignore paths are found by
+the name without path. Only archives which ignore case are indexed, the file
+system asks the others itself. When several archives have a file, the one at
+the lowest position wins, as if the archives were asked in turn. Directories
+are not in the index. */
+class CFileIndex
+{
+public:
+
+	//! removes all archives
+	void clear();
+
+	//! adds the files of the archive at a position of the file system
+	/** Archives must be added in the order of their positions.
+	\return False if the archive can't be indexed, the file system has to
+	ask it itself then. */
+	bool addArchive(const IFileArchive* archive, u32 position);
+
+	//! finds the archive at the lowest position which has a file
+	/** \param filename Name of a file, names of directories are not found.
+	\param position Receives the position of the archive.
+	\param index Receives the index of the file in the file list of the archive.
+	\return False if no archive in the index has the file. */
+	bool findFile(const io::path& filename, u32& position, u32& index) const;
+
+	//! returns the number of files in the index
+	u32 getFileCount() const { return Paths.Count + Names.Count; }
+
+private:
+
+	struct SEntry
+	{
+		u32 Hash;
+		u32 Position;
+		u32 Index;
+	};
+
+	//! open addressing table, empty slots have no file list
+	struct STable
+	{
+		STable() : Count(0) {}
+
+		core::array<SEntry> Entries;
+		u32 Count;
+	};
+
+	//! finds a name in a table, returns the slot or the empty slot where it belongs
+	u32 findSlot(const STable& table, const fschar_t* name, u32 length, u32 hash) const;
+
+	//! adds a file if the table does not have its name yet
+	void insert(STable& table, const io::path& name, u32 position, u32 index);
+
+	//! doubles the size of a table
+	void grow(STable& table);
+
+	//! files of archives which keep paths, by full name
+	STable Paths;
+
+	//! files of archives which ignore paths, by name only
+	STable Names;
+
+	//! file lists of the archives by position, 0 for archives not in the index
+	core::array<const IFileList*> Lists;
+};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
+
@@ -21,6 +21,7 @@
 #include "CAttributes.h"
 #include "CReadFile.h"
 #include "CMemoryFile.h"
+#include "CMappedReadFile.h"
 #include "CLimitReadFile.h"
 #include "CWriteFile.h"
 #include "irrList.h"
@@ -55,6 +56,7 @@ namespace io
 
 //! constructor
 CFileSystem::CFileSystem()
+: FileMappingThreshold(0), StreamingThreshold(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CFileSystem");
@@ -117,16 +119,142 @@ IReadFile* CFileSystem::createAndOpenFile(const io::path& filename)
 	IReadFile* file = 0;
 	u32 i;
 
-	for (i=0; i< FileArchives.size(); ++i)
+	// the index resolves which archive has the file, archives which are not
+	// in the index are asked first if they have priority over that one
+	u32 position = FileArchives.size();
+	u32 index = 0;
+	const bool indexed = FileIndex.findFile(filename, position, index);
+
+	for (i=0; i < UnindexedArchives.size() && UnindexedArchives[i] < position; ++i)
+	{
+		file = FileArchives[UnindexedArchives[i]]->createAndOpenFile(filename);
+		if (file)
+			return file;
+	}
+
+	if (indexed)
 	{
-		file = FileArchives[i]->createAndOpenFile(filename);
+		file = FileArchives[position]->createAndOpenFile(index);
 		if (file)
 			return file;
 	}
 
+	// names of directories are not in the index, and when the archive failed
+	// to open its file the archives after it are asked in turn
+	const fschar_t last = filename.lastChar();
+	if (indexed || last == '/' || last == '\\')
+	{
+		for (i = indexed ? position+1 : 0; i < FileArchives.size(); ++i)
+		{
+			file = FileArchives[i]->createAndOpenFile(filename);
+			if (file)
+				return file;
+		}
+	}
+
 	// Create the file using an absolute path so that it matches
 	// the scheme used by CNullDriver::getTexture().
-	return CReadFile::createReadFile(getAbsolutePath(filename));
+	const io::path absolutePath = getAbsolutePath(filename);
+
+#ifdef _IRR_COMPILE_WITH_MAPPED_FILES_
+	if (FileMappingThreshold > 0)
+	{
+		file = CMappedReadFile::createMappedReadFile(absolutePath, FileMappingThreshold);
+		if (file)
+			return file;
+	}
+#endif
+
+	return CReadFile::createReadFile(absolutePath);
+}
+
+
+//! Set the size from which files on disk are mapped into memory.
+void CFileSystem::setFileMappingThreshold(long minimumSize)
+{
+	FileMappingThreshold = core::max_(minimumSize, 0L);
+}
+
+
+//! Get the size from which files on disk are mapped into memory.
+long CFileSystem::getFileMappingThreshold() const
+{
+	return FileMappingThreshold;
+}
+
+
+//! Set the size from which deflated files in archives are inflated while they are read.
+void CFileSystem::setStreamingThreshold(long minimumSize)
+{
+	StreamingThreshold = core::max_(minimumSize, 0L);
+}
+
+
+//! Get the size from which deflated files in archives are inflated while they are read.
+long CFileSystem::getStreamingThreshold() const
+{
+	return StreamingThreshold;
+}
+
+
+//! opens several files, files of one archive are decompressed in parallel
+u32 CFileSystem::createAndOpenFiles(const core::array<io::path>& filenames, core::array<IReadFile*>& files)
+{
+	u32 i;
+	files.set_used(filenames.size());
+
+	// the archive each file is opened from, files which are not in the index
+	// or which an archive outside the index might have are opened one by one
+	core::array<u32> positions(filenames.size());
+	core::array<u32> indices(filenames.size());
+	for (i=0; i<filenames.size(); ++i)
+	{
+		files[i] = 0;
+		u32 position = FileArchives.size();
+		u32 index = 0;
+		if (!FileIndex.findFile(filenames[i], position, index) ||
+			(!UnindexedArchives.empty() && UnindexedArchives[0] < position))
+			position = FileArchives.size();
+
+		positions.push_back(position);
+		indices.push_back(index);
+	}
+
+	core::array<u32> archiveIndices;
+	core::array<u32> requests;
+	core::array<IReadFile*> archiveFiles;
+	for (u32 position=0; position<FileArchives.size(); ++position)
+	{
+		archiveIndices.set_used(0);
+		requests.set_used(0);
+		for (i=0; i<filenames.size(); ++i)
+		{
+			if (positions[i] == position)
+			{
+				archiveIndices.push_back(indices[i]);
+				requests.push_back(i);
+			}
+		}
+
+		if (archiveIndices.empty())
+			continue;
+
+		FileArchives[position]->createAndOpenFiles(archiveIndices, archiveFiles);
+		for (i=0; i<requests.size(); ++i)
+			files[requests[i]] = archiveFiles[i];
+	}
+
+	// everything else, and files an archive failed to open, the usual way
+	u32 count = 0;
+	for (i=0; i<filenames.size(); ++i)
+	{
+		if (!files[i])
+			files[i] = createAndOpenFile(filenames[i]);
+		if (files[i])
+			++count;
+	}
+
+	return count;
 }
 
 
@@ -214,6 +342,9 @@ bool CFileSystem::moveFileArchive(u32 sourceIndex, s32 relative)
 		FileArchives[s] = t;
 		r = true;
 	}
+
+	if (r)
+		rebuildFileIndex();
 	return r;
 }
 
@@ -311,6 +442,7 @@ bool CFileSystem::addFileArchive(const io::path& filename, bool ignoreCase,
 	if (archive)
 	{
 		FileArchives.push_back(archive);
+		indexLastArchive();
 		if (password.size())
 			archive->Password=password;
 		if (retArchive)
@@ -416,6 +548,7 @@ bool CFileSystem::addFileArchive(IReadFile* file, bool ignoreCase,
 		if (archive)
 		{
 			FileArchives.push_back(archive);
+			indexLastArchive();
 			if (password.size())
 				archive->Password=password;
 			if (retArchive)
@@ -446,6 +579,7 @@ bool CFileSystem::addFileArchive(IFileArchive* archive)
 		}
 		FileArchives.push_back(archive);
 		archive->grab();
+		indexLastArchive();
 
 		return true;
 	}
@@ -462,12 +596,35 @@ bool CFileSystem::removeFileArchive(u32 index)
 	{
 		FileArchives[index]->drop();
 		FileArchives.erase(index);
+		rebuildFileIndex();
 		ret = true;
 	}
 	return ret;
 }
 
 
+//! adds the archive at the end of FileArchives to the index
+void CFileSystem::indexLastArchive()
+{
+	const u32 position = FileArchives.size() - 1;
+	if (!FileIndex.addArchive(FileArchives[position], position))
+		UnindexedArchives.push_back(position);
+}
+
+
+//! indexes all archives again, after they were removed or moved
+void CFileSystem::rebuildFileIndex()
+{
+	FileIndex.clear();
+	UnindexedArchives.clear();
+	for (u32 i=0; i < FileArchives.size(); ++i)
+	{
+		if (!FileIndex.addArchive(FileArchives[i], i))
+			UnindexedArchives.push_back(i);
+	}
+}
+
+
 //! removes an archive from the file system.
 bool CFileSystem::removeFileArchive(const io::path& filename)
 {
@@ -959,9 +1116,19 @@ IFileList* CFileSystem::createEmptyFileList(const io::path& path, bool ignoreCas
 //! determines if a file exists and would be able to be opened.
 bool CFileSystem::existFile(const io::path& filename) const
 {
+	u32 position, index;
+	if (FileIndex.findFile(filename, position, index))
+		return true;
+
+	// directories are not in the index
+	const fschar_t last = filename.lastChar();
+	const bool directory = last == '/' || last == '\\';
 	for (u32 i=0; i < FileArchives.size(); ++i)
-		if (FileArchives[i]->getFileList()->findFile(filename)!=-1)
+	{
+		if ((directory || UnindexedArchives.binary_search(i) != -1) &&
+			FileArchives[i]->getFileList()->findFile(filename)!=-1)
 			return true;
+	}
 
 #if defined(_MSC_VER)
 	#if defined(_IRR_WCHAR_FILESYSTEM)
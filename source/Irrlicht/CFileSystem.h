@@ -7,6 +7,7 @@
 
 #include "IFileSystem.h"
 #include "irrArray.h"
+#include "CFileIndex.h"
 
 namespace irr
 {
@@ -33,6 +34,21 @@ public:
 	//! opens a file for read access
 	virtual IReadFile* createAndOpenFile(const io::path& filename) _IRR_OVERRIDE_;
 
+	//! Set the size from which files on disk are mapped into memory.
+	virtual void setFileMappingThreshold(long minimumSize) _IRR_OVERRIDE_;
+
+	//! Get the size from which files on disk are mapped into memory.
+	virtual long getFileMappingThreshold() const _IRR_OVERRIDE_;
+
+	//! Set the size from which deflated files in archives are inflated while they are read.
+	virtual void setStreamingThreshold(long minimumSize) _IRR_OVERRIDE_;
+
+	//! Get the size from which deflated files in archives are inflated while they are read.
+	virtual long getStreamingThreshold() const _IRR_OVERRIDE_;
+
+	//! opens several files, files of one archive are decompressed in parallel
+	virtual u32 createAndOpenFiles(const core::array<io::path>& filenames, core::array<IReadFile*>& files) _IRR_OVERRIDE_;
+
 	//! Creates an IReadFile interface for accessing memory like a file.
 	virtual IReadFile* createMemoryReadFile(const void* memory, s32 len, const io::path& fileName, bool deleteMemoryWhenDropped = false) _IRR_OVERRIDE_;
 
@@ -155,6 +171,12 @@ private:
 			const core::stringc& password,
 			IFileArchive** archive = 0);
 
+	//! adds the archive at the end of FileArchives to the index
+	void indexLastArchive();
+
+	//! indexes all archives again, after they were removed or moved
+	void rebuildFileIndex();
+
 	//! Currently used FileSystemType
 	EFileSystemType FileSystemType;
 	//! WorkingDirectory for Native and Virtual filesystems
@@ -163,6 +185,14 @@ private:
 	core::array<IArchiveLoader*> ArchiveLoader;
 	//! currently attached Archives
 	core::array<IFileArchive*> FileArchives;
+	//! the files of all attached archives which can be indexed
+	CFileIndex FileIndex;
+	//! positions of the archives which are not in FileIndex, in ascending order
+	core::array<u32> UnindexedArchives;
+	//! files at least this large are mapped into memory, 0 for none
+	long FileMappingThreshold;
+	//! deflated archive files at least this large are inflated while reading, 0 for none
+	long StreamingThreshold;
 };
 
 
@@ -6,6 +6,7 @@
 #include "irrString.h"
 #include "CColorConverter.h"
 #include "CBlit.h"
+#include "CImageResampler.h"
 #include "os.h"
 
 namespace irr
@@ -293,6 +294,17 @@ void CImage::copyToScalingBoxFilter(IImage* target, s32 bias, bool blend)
 }
 
 
+//! copies this surface into another, scaling it to fit with a separable filter
+void CImage::copyToScalingFiltered(IImage* target, E_IMAGE_FILTER filter)
+{
+	if (!target)
+		return;
+
+	if (!CImageResampler::resample(this, target, filter))
+		os::Printer::log("IImage::copyToScalingFiltered method doesn't work with this color format.", ELL_WARNING);
+}
+
+
 //! fills the surface with given color
 void CImage::fill(const SColor &color)
 {
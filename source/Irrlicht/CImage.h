@@ -55,6 +55,9 @@ public:
 	//! copies this surface into another, scaling it to fit, applying a box filter
 	virtual void copyToScalingBoxFilter(IImage* target, s32 bias = 0, bool blend = false) _IRR_OVERRIDE_;
 
+	//! copies this surface into another, scaling it to fit with a separable filter
+	virtual void copyToScalingFiltered(IImage* target, E_IMAGE_FILTER filter = EIF_BILINEAR) _IRR_OVERRIDE_;
+
 	//! fills the surface with given color
 	virtual void fill(const SColor &color) _IRR_OVERRIDE_;
 
@@ -0,0 +1,448 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CImageResampler.h"
+#include "CThreadPool.h"
+#include "CColorConverter.h"
+#include "CImage.h"
+#include "irrMath.h"
+
+// the rows are filtered with SSE2, which every x86 cpu with SSE2 has
+#if (defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(NO_IRR_IMAGE_RESAMPLER_SSE_)
+	#define _IRR_IMAGE_RESAMPLER_SSE_
+	#include <emmintrin.h>
+#endif
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+	//! filter radius in pixels of the filter
+	f32 getFilterRadius(E_IMAGE_FILTER filter)
+	{
+		switch (filter)
+		{
+		case EIF_BOX: return 0.5f;
+		case EIF_BILINEAR: return 1.f;
+		default: return 3.f;
+		}
+	}
+
+	f32 sinc(f32 x)
+	{
+		x *= core::PI;
+		if (fabsf(x) < 0.0001f)
+			return 1.f;
+		return sinf(x) / x;
+	}
+
+	//! modified bessel function of the first kind and order 0
+	f32 bessel0(f32 x)
+	{
+		const f32 xh = x * 0.5f;
+		f32 sum = 1.f;
+		f32 term = 1.f;
+		for (u32 k = 1; k < 32 && term > sum * 1e-7f; ++k)
+		{
+			const f32 t = xh / (f32)k;
+			term *= t * t;
+			sum += term;
+		}
+		return sum;
+	}
+
+	//! weight of a sample at distance t, in pixels of the filter
+	f32 getFilterWeight(E_IMAGE_FILTER filter, f32 t)
+	{
+		switch (filter)
+		{
+		case EIF_BOX:
+			return (t > -0.5f && t <= 0.5f) ? 1.f : 0.f;
+		case EIF_BILINEAR:
+			t = fabsf(t);
+			return t < 1.f ? 1.f - t : 0.f;
+		case EIF_LANCZOS:
+			return fabsf(t) < 3.f ? sinc(t) * sinc(t / 3.f) : 0.f;
+		case EIF_KAISER:
+			{
+				// alpha 4, like most mip map tools use
+				const f32 r = t / 3.f;
+				if (fabsf(r) >= 1.f)
+					return 0.f;
+				return sinc(t) * bessel0(4.f * sqrtf(1.f - r * r)) / bessel0(4.f);
+			}
+		}
+		return 0.f;
+	}
+
+	//! source pixels contributing to a target pixel
+	struct SContribution
+	{
+		s32 First;
+		u32 Count;
+		u32 Weights;
+	};
+
+	//! Computes the weights of all target pixels along one axis.
+	/** Samples outside the image are clamped to the border, their weights are
+	added to the border pixel, so the source pixels of each target pixel are
+	always a contiguous range. */
+	void computeContributions(u32 sourceSize, u32 targetSize, E_IMAGE_FILTER filter,
+		core::array<SContribution>& contributions, core::array<f32>& weights)
+	{
+		const f32 scale = (f32)sourceSize / (f32)targetSize;
+		const f32 filterScale = core::max_(scale, 1.f);
+		const f32 support = getFilterRadius(filter) * filterScale;
+
+		contributions.set_used(targetSize);
+		weights.set_used(0);
+		weights.reallocate(targetSize * (core::ceil32(support) * 2 + 2));
+
+		core::array<f32> samples;
+
+		for (u32 x = 0; x < targetSize; ++x)
+		{
+			const f32 center = ((f32)x + 0.5f) * scale;
+			s32 first = core::floor32(center - support - 0.5f);
+			s32 last = core::ceil32(center + support - 0.5f);
+
+			samples.set_used(last - first + 1);
+			f32 sum = 0.f;
+			for (s32 i = first; i <= last; ++i)
+			{
+				samples[i - first] = getFilterWeight(filter, ((f32)i + 0.5f - center) / filterScale);
+				sum += samples[i - first];
+			}
+
+			// no taps for samples outside of the filter
+			s32 begin = 0;
+			s32 end = samples.size() - 1;
+			while (begin < end && samples[begin] == 0.f)
+				++begin;
+			while (end > begin && samples[end] == 0.f)
+				--end;
+
+			if (sum == 0.f)
+			{
+				// can only happen with rounding errors, take the nearest pixel
+				first = last = core::floor32(center);
+				samples[0] = sum = 1.f;
+				begin = end = 0;
+			}
+			else
+			{
+				last = first + end;
+				first += begin;
+			}
+
+			const s32 clampedFirst = core::s32_clamp(first, 0, sourceSize - 1);
+			const s32 clampedLast = core::s32_clamp(last, 0, sourceSize - 1);
+
+			SContribution& c = contributions[x];
+			c.First = clampedFirst;
+			c.Count = clampedLast - clampedFirst + 1;
+			c.Weights = weights.size();
+
+			for (u32 i = 0; i < c.Count; ++i)
+				weights.push_back(0.f);
+
+			f32* w = weights.pointer() + c.Weights;
+			for (s32 i = begin; i <= end; ++i)
+			{
+				const s32 pixel = first + i - begin;
+				w[core::s32_clamp(pixel, clampedFirst, clampedLast) - clampedFirst] += samples[i] / sum;
+			}
+		}
+	}
+
+	//! expands A8R8G8B8 pixels to 4 floats in memory order b, g, r, a
+	void expandPixels(const u32* pixels, f32* out, u32 count)
+	{
+		u32 i = 0;
+#ifdef _IRR_IMAGE_RESAMPLER_SSE_
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i p = _mm_loadu_si128((const __m128i*)(pixels + i));
+			const __m128i lo = _mm_unpacklo_epi8(p, zero);
+			const __m128i hi = _mm_unpackhi_epi8(p, zero);
+			f32* o = out + i * 4;
+			_mm_storeu_ps(o, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+			_mm_storeu_ps(o + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+			_mm_storeu_ps(o + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+			_mm_storeu_ps(o + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			const u32 c = pixels[i];
+			out[i * 4 + 0] = (f32)(c & 0xFF);
+			out[i * 4 + 1] = (f32)((c >> 8) & 0xFF);
+			out[i * 4 + 2] = (f32)((c >> 16) & 0xFF);
+			out[i * 4 + 3] = (f32)(c >> 24);
+		}
+	}
+
+	//! rounds and clamps 4 floats per pixel back to A8R8G8B8
+	void packPixels(const f32* in, u32* pixels, u32 count)
+	{
+		u32 i = 0;
+#ifdef _IRR_IMAGE_RESAMPLER_SSE_
+		for (; i + 4 <= count; i += 4)
+		{
+			const f32* p = in + i * 4;
+			const __m128i c0 = _mm_cvtps_epi32(_mm_loadu_ps(p));
+			const __m128i c1 = _mm_cvtps_epi32(_mm_loadu_ps(p + 4));
+			const __m128i c2 = _mm_cvtps_epi32(_mm_loadu_ps(p + 8));
+			const __m128i c3 = _mm_cvtps_epi32(_mm_loadu_ps(p + 12));
+			// saturating packs clamp to 0..255
+			const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(c0, c1), _mm_packs_epi32(c2, c3));
+			_mm_storeu_si128((__m128i*)(pixels + i), packed);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			const f32* p = in + i * 4;
+			const u32 b = core::s32_clamp(core::round32(p[0]), 0, 255);
+			const u32 g = core::s32_clamp(core::round32(p[1]), 0, 255);
+			const u32 r = core::s32_clamp(core::round32(p[2]), 0, 255);
+			const u32 a = core::s32_clamp(core::round32(p[3]), 0, 255);
+			pixels[i] = (a << 24) | (r << 16) | (g << 8) | b;
+		}
+	}
+
+	//! filters an expanded row horizontally
+	void filterRow(const f32* in, f32* out, const SContribution* contributions, const f32* weights, u32 count)
+	{
+		for (u32 x = 0; x < count; ++x)
+		{
+			const SContribution& c = contributions[x];
+			const f32* w = weights + c.Weights;
+			const f32* p = in + c.First * 4;
+#ifdef _IRR_IMAGE_RESAMPLER_SSE_
+			__m128 sum = _mm_setzero_ps();
+			for (u32 i = 0; i < c.Count; ++i)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(p + i * 4), _mm_set1_ps(w[i])));
+			_mm_storeu_ps(out + x * 4, sum);
+#else
+			f32 b = 0.f, g = 0.f, r = 0.f, a = 0.f;
+			for (u32 i = 0; i < c.Count; ++i)
+			{
+				b += p[i * 4 + 0] * w[i];
+				g += p[i * 4 + 1] * w[i];
+				r += p[i * 4 + 2] * w[i];
+				a += p[i * 4 + 3] * w[i];
+			}
+			out[x * 4 + 0] = b;
+			out[x * 4 + 1] = g;
+			out[x * 4 + 2] = r;
+			out[x * 4 + 3] = a;
+#endif
+		}
+	}
+
+	//! sum = row * weight, or sum += row * weight
+	void accumulateRow(const f32* row, f32* sum, f32 weight, u32 count, bool first)
+	{
+		u32 i = 0;
+#ifdef _IRR_IMAGE_RESAMPLER_SSE_
+		const __m128 w = _mm_set1_ps(weight);
+		if (first)
+		{
+			for (; i + 4 <= count; i += 4)
+				_mm_storeu_ps(sum + i, _mm_mul_ps(_mm_loadu_ps(row + i), w));
+		}
+		else
+		{
+			for (; i + 4 <= count; i += 4)
+				_mm_storeu_ps(sum + i, _mm_add_ps(_mm_loadu_ps(sum + i), _mm_mul_ps(_mm_loadu_ps(row + i), w)));
+		}
+#endif
+		if (first)
+		{
+			for (; i < count; ++i)
+				sum[i] = row[i] * weight;
+		}
+		else
+		{
+			for (; i < count; ++i)
+				sum[i] += row[i] * weight;
+		}
+	}
+
+	struct SResampleJob
+	{
+		const u8* Source;
+		ECOLOR_FORMAT SourceFormat;
+		core::dimension2d<u32> SourceSize;
+		u32 SourcePitch;
+
+		u8* Target;
+		ECOLOR_FORMAT TargetFormat;
+		core::dimension2d<u32> TargetSize;
+		u32 TargetPitch;
+
+		core::array<SContribution> ColumnContributions;
+		core::array<f32> ColumnWeights;
+		core::array<SContribution> RowContributions;
+		core::array<f32> RowWeights;
+
+		u32 BandHeight;
+	};
+
+	//! resamples a band of target rows
+	void resampleBand(void* userData, u32 band)
+	{
+		const SResampleJob& job = *(const SResampleJob*)userData;
+
+		const u32 firstRow = band * job.BandHeight;
+		const u32 endRow = core::min_(firstRow + job.BandHeight, job.TargetSize.Height);
+
+		// the source rows of the band
+		s32 firstSource = job.RowContributions[firstRow].First;
+		s32 endSource = firstSource;
+		for (u32 y = firstRow; y < endRow; ++y)
+		{
+			const SContribution& c = job.RowContributions[y];
+			firstSource = core::min_(firstSource, c.First);
+			endSource = core::max_(endSource, c.First + (s32)c.Count);
+		}
+		const u32 sourceRows = endSource - firstSource;
+
+		const u32 sourceWidth = job.SourceSize.Width;
+		const u32 targetWidth = job.TargetSize.Width;
+
+		core::array<u32> pixels;
+		pixels.set_used(core::max_(sourceWidth, targetWidth));
+		core::array<f32> expanded;
+		expanded.set_used(sourceWidth * 4);
+		core::array<f32> filtered;
+		filtered.set_used(sourceRows * targetWidth * 4);
+		core::array<f32> sum;
+		sum.set_used(targetWidth * 4);
+
+		for (u32 y = 0; y < sourceRows; ++y)
+		{
+			const u8* line = job.Source + (firstSource + y) * job.SourcePitch;
+			CColorConverter::convert_viaFormat(line, job.SourceFormat, sourceWidth, pixels.pointer(), ECF_A8R8G8B8);
+			expandPixels(pixels.pointer(), expanded.pointer(), sourceWidth);
+			filterRow(expanded.pointer(), filtered.pointer() + y * targetWidth * 4,
+				job.ColumnContributions.const_pointer(), job.ColumnWeights.const_pointer(), targetWidth);
+		}
+
+		for (u32 y = firstRow; y < endRow; ++y)
+		{
+			const SContribution& c = job.RowContributions[y];
+			const f32* w = job.RowWeights.const_pointer() + c.Weights;
+
+			for (u32 i = 0; i < c.Count; ++i)
+			{
+				const f32* row = filtered.const_pointer() + (c.First - firstSource + i) * targetWidth * 4;
+				accumulateRow(row, sum.pointer(), w[i], targetWidth * 4, i == 0);
+			}
+
+			packPixels(sum.const_pointer(), pixels.pointer(), targetWidth);
+			CColorConverter::convert_viaFormat(pixels.const_pointer(), ECF_A8R8G8B8, targetWidth,
+				job.Target + y * job.TargetPitch, job.TargetFormat);
+		}
+	}
+
+} // end anonymous namespace
+
+
+bool CImageResampler::resample(const IImage* source, IImage* target, E_IMAGE_FILTER filter, CThreadPool* pool)
+{
+	if (!source || !target)
+		return false;
+
+	if (!canResample(source->getColorFormat()) || !canResample(target->getColorFormat()))
+		return false;
+
+	const core::dimension2d<u32>& sourceSize = source->getDimension();
+	const core::dimension2d<u32>& targetSize = target->getDimension();
+	if (sourceSize.Width == 0 || sourceSize.Height == 0 || targetSize.Width == 0 || targetSize.Height == 0)
+		return true;
+
+	SResampleJob job;
+	job.Source = (const u8*)source->getData();
+	job.SourceFormat = source->getColorFormat();
+	job.SourceSize = sourceSize;
+	job.SourcePitch = source->getPitch();
+	job.Target = (u8*)target->getData();
+	job.TargetFormat = target->getColorFormat();
+	job.TargetSize = targetSize;
+	job.TargetPitch = target->getPitch();
+
+	computeContributions(sourceSize.Width, targetSize.Width, filter, job.ColumnContributions, job.ColumnWeights);
+	computeContributions(sourceSize.Height, targetSize.Height, filter, job.RowContributions, job.RowWeights);
+
+	// bands limit the memory for filtered rows, the rows a filter reaches
+	// into the neighbour bands are filtered twice
+	job.BandHeight = 64;
+	const u32 threads = pool ? pool->getThreadCount() : 1;
+	if (threads > 1)
+		job.BandHeight = core::s32_clamp((targetSize.Height + threads - 1) / threads, 8, 64);
+
+	const u32 bands = (targetSize.Height + job.BandHeight - 1) / job.BandHeight;
+
+	// small images are not worth waking up the threads
+	if (pool && bands > 1 && targetSize.getArea() >= 64 * 64)
+		pool->run(resampleBand, &job, bands);
+	else
+	{
+		for (u32 i = 0; i < bands; ++i)
+			resampleBand(&job, i);
+	}
+
+	return true;
+}
+
+
+u8* CImageResampler::createMipMapsData(const IImage* image, E_IMAGE_FILTER filter, CThreadPool* pool)
+{
+	const ECOLOR_FORMAT format = image->getColorFormat();
+	const core::dimension2d<u32> size = image->getDimension();
+	if (!canResample(format) || size.Width == 0 || size.Height == 0 || (size.Width == 1 && size.Height == 1))
+		return 0;
+
+	u32 dataSize = 0;
+	core::dimension2d<u32> levelSize(size);
+	do
+	{
+		levelSize.Width = core::max_(levelSize.Width >> 1, 1u);
+		levelSize.Height = core::max_(levelSize.Height >> 1, 1u);
+		dataSize += IImage::getDataSizeFromFormat(format, levelSize.Width, levelSize.Height);
+	} while (levelSize.Width != 1 || levelSize.Height != 1);
+
+	u8* data = new u8[dataSize];
+	u8* levelData = data;
+	levelSize = size;
+
+	const IImage* previous = image;
+	do
+	{
+		levelSize.Width = core::max_(levelSize.Width >> 1, 1u);
+		levelSize.Height = core::max_(levelSize.Height >> 1, 1u);
+
+		IImage* level = new CImage(format, levelSize, levelData, true, false);
+		resample(previous, level, filter, pool);
+
+		if (previous != image)
+			previous->drop();
+		previous = level;
+
+		levelData += IImage::getDataSizeFromFormat(format, levelSize.Width, levelSize.Height);
+	} while (levelSize.Width != 1 || levelSize.Height != 1);
+
+	previous->drop();
+
+	return data;
+}
+
+
+} // end namespace video
+} // end namespace irr
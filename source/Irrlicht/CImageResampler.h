@@ -0,0 +1,53 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_IMAGE_RESAMPLER_H_INCLUDED__
+#define __C_IMAGE_RESAMPLER_H_INCLUDED__
+
+#include "irrTypes.h"
+#include "IImage.h"
+
+namespace irr
+{
+
+class CThreadPool;
+
+namespace video
+{
+
+//! Scales images with a separable filter.
+/** The image is filtered horizontally row by row, then the filtered rows are
+combined vertically. Filter weights are computed once per column and row.
+Target rows are split into bands which are filtered independently, each
+band filters the source rows it needs itself, so bands can run on several
+threads without sharing intermediate rows. */
+class CImageResampler
+{
+public:
+
+	//! Scales an image into another image.
+	/** \param pool Bands of target rows are shared out to the threads of this pool, can be 0.
+	\return False if one of the color formats is not supported. */
+	static bool resample(const IImage* source, IImage* target, E_IMAGE_FILTER filter, CThreadPool* pool = 0);
+
+	//! Creates all mip map levels of an image, each level from the level before.
+	/** \return Data of the levels one after another in the format of the
+	image, as expected by IImage::setMipMapsData. Must be deleted with
+	delete []. 0 if the format is not supported or the image is 1x1. */
+	static u8* createMipMapsData(const IImage* image, E_IMAGE_FILTER filter, CThreadPool* pool = 0);
+
+	//! Returns true if images of the format can be resampled.
+	static bool canResample(ECOLOR_FORMAT format)
+	{
+		return format == ECF_A1R5G5B5 || format == ECF_R5G6B5
+			|| format == ECF_R8G8B8 || format == ECF_A8R8G8B8;
+	}
+};
+
+
+} // end namespace video
+} // end namespace irr
+
+#endif
+
@@ -0,0 +1,236 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CInflateReadFile.h"
+
+#if defined(__IRR_COMPILE_WITH_ZIP_ARCHIVE_LOADER_) && defined(_IRR_COMPILE_WITH_ZLIB_)
+
+#ifndef _IRR_USE_NON_SYSTEM_ZLIB_
+#include <zlib.h> // use system lib
+#else
+#include "zlib/zlib.h"
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+namespace
+{
+	//! compressed bytes read from the archive at once
+	const u32 InputChunkSize = 16384;
+	//! uncompressed bytes between two saved states of the inflater
+	const long CheckpointDistance = 1024*1024;
+}
+
+
+CInflateReadFile::CInflateReadFile(IReadFile* archive, const u8* mapped, long offset,
+		u32 compressedSize, u32 uncompressedSize, const io::path& name)
+	: Filename(name), File(archive), Mapped(mapped), Offset(offset),
+	CompressedSize(compressedSize), Size(uncompressedSize), Pos(0),
+	Stream(0), InputPos(0), Input(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CInflateReadFile");
+	#endif
+
+	File->grab();
+
+	z_stream* stream = new z_stream;
+	memset(stream, 0, sizeof(z_stream));
+
+	// wbits < 0 indicates no zlib header inside the data.
+	if (inflateInit2(stream, -MAX_WBITS) != Z_OK)
+	{
+		delete stream;
+		return;
+	}
+	Stream = stream;
+
+	if (!Mapped)
+		Input = new u8[InputChunkSize];
+}
+
+
+CInflateReadFile::~CInflateReadFile()
+{
+	for (u32 i=0; i<Checkpoints.size(); ++i)
+	{
+		inflateEnd((z_stream*)Checkpoints[i].Stream);
+		delete (z_stream*)Checkpoints[i].Stream;
+	}
+
+	if (Stream)
+	{
+		inflateEnd((z_stream*)Stream);
+		delete (z_stream*)Stream;
+	}
+
+	delete [] Input;
+	File->drop();
+}
+
+
+//! inflates the next bytes into buffer, returns how many were inflated
+u32 CInflateReadFile::inflateData(u8* buffer, u32 size)
+{
+	z_stream* stream = (z_stream*)Stream;
+	stream->next_out = (Bytef*)buffer;
+	stream->avail_out = size;
+
+	while (stream->avail_out)
+	{
+		if (!stream->avail_in)
+		{
+			if (InputPos >= CompressedSize)
+				break;
+
+			const u32 chunk = core::min_(InputChunkSize, CompressedSize - InputPos);
+			if (Mapped)
+				stream->next_in = (Bytef*)Mapped + InputPos;
+			else
+			{
+				File->seek(Offset + InputPos);
+				if (File->read(Input, chunk) != chunk)
+					break;
+				stream->next_in = (Bytef*)Input;
+			}
+			stream->avail_in = chunk;
+			InputPos += chunk;
+		}
+
+		// stops at the end of the data and on errors
+		if (inflate(stream, Z_NO_FLUSH) != Z_OK)
+			break;
+	}
+
+	return size - stream->avail_out;
+}
+
+
+//! continues from the last checkpoint before pos, or from the start
+void CInflateReadFile::restart(long pos)
+{
+	z_stream* stream = (z_stream*)Stream;
+
+	s32 i = (s32)Checkpoints.size() - 1;
+	while (i >= 0 && Checkpoints[i].Pos > pos)
+		--i;
+
+	if (i >= 0)
+	{
+		inflateEnd(stream);
+		inflateCopy(stream, (z_stream*)Checkpoints[i].Stream);
+		InputPos = Checkpoints[i].InputPos;
+		Pos = Checkpoints[i].Pos;
+	}
+	else
+	{
+		inflateReset(stream);
+		InputPos = 0;
+		Pos = 0;
+	}
+
+	// the input of the checkpoint is read again
+	stream->avail_in = 0;
+}
+
+
+//! returns how much was read
+size_t CInflateReadFile::read(void* buffer, size_t sizeToRead)
+{
+	if (!Stream)
+		return 0;
+
+	u8* out = (u8*)buffer;
+	u32 remaining = (u32)core::min_((long)sizeToRead, Size - Pos);
+	while (remaining)
+	{
+		// stop at the position of the next checkpoint to save it
+		const long next = ((long)Checkpoints.size() + 1) * CheckpointDistance;
+		u32 size = remaining;
+		if (Pos < next && Pos + (long)size > next)
+			size = (u32)(next - Pos);
+
+		const u32 inflated = inflateData(out, size);
+		Pos += inflated;
+		out += inflated;
+		remaining -= inflated;
+
+		if (Pos == next)
+		{
+			z_stream* copy = new z_stream;
+			if (inflateCopy(copy, (z_stream*)Stream) == Z_OK)
+			{
+				SCheckpoint checkpoint;
+				checkpoint.Stream = copy;
+				checkpoint.InputPos = InputPos - ((z_stream*)Stream)->avail_in;
+				checkpoint.Pos = Pos;
+				Checkpoints.push_back(checkpoint);
+			}
+			else
+				delete copy;
+		}
+
+		if (inflated < size)
+			break;
+	}
+
+	return out - (u8*)buffer;
+}
+
+
+//! changes position in file, returns true if successful
+bool CInflateReadFile::seek(long finalPos, bool relativeMovement)
+{
+	if (!Stream)
+		return false;
+
+	const long pos = relativeMovement ? Pos + finalPos : finalPos;
+	if (pos < 0 || pos > Size)
+		return false;
+
+	if (pos < Pos)
+		restart(pos);
+
+	// inflate and throw away up to the new position
+	u8 skipped[4096];
+	while (Pos < pos)
+	{
+		const u32 size = (u32)core::min_(pos - Pos, (long)sizeof(skipped));
+		if (read(skipped, size) != size)
+			return false;
+	}
+
+	return true;
+}
+
+
+//! returns size of file
+long CInflateReadFile::getSize() const
+{
+	return Size;
+}
+
+
+//! returns where in the file we are.
+long CInflateReadFile::getPos() const
+{
+	return Pos;
+}
+
+
+//! returns name of file
+const io::path& CInflateReadFile::getFileName() const
+{
+	return Filename;
+}
+
+
+} // end namespace io
+} // end namespace irr
+
+#endif
+
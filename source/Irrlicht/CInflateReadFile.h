@@ -0,0 +1,102 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_INFLATE_READ_FILE_H_INCLUDED__
+#define __C_INFLATE_READ_FILE_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+
+#if defined(__IRR_COMPILE_WITH_ZIP_ARCHIVE_LOADER_) && defined(_IRR_COMPILE_WITH_ZLIB_)
+
+#include "IReadFile.h"
+#include "irrArray.h"
+#include "irrString.h"
+
+namespace irr
+{
+namespace io
+{
+
+	/*!
+		Read file for a deflated entry of a zip or gzip archive which is
+		inflated while it is read, so the whole uncompressed file is never
+		held in memory. Every CheckpointDistance bytes the state of the
+		inflater is saved, seeking backwards continues from the nearest
+		saved state instead of the start of the entry.
+	*/
+	class CInflateReadFile : public IReadFile
+	{
+	public:
+
+		//! Constructor
+		/** \param archive The archive file, is grabbed.
+		\param mapped The compressed data if the archive is in memory, read from archive otherwise.
+		\param offset Position of the compressed data in archive.
+		\param compressedSize Size of the compressed data.
+		\param uncompressedSize Size of the inflated file.
+		\param name Name of the file. */
+		CInflateReadFile(IReadFile* archive, const u8* mapped, long offset,
+			u32 compressedSize, u32 uncompressedSize, const io::path& name);
+
+		virtual ~CInflateReadFile();
+
+		//! returns false if the inflater could not be set up
+		bool isOpen() const { return Stream != 0; }
+
+		//! returns how much was read
+		virtual size_t read(void* buffer, size_t sizeToRead) _IRR_OVERRIDE_;
+
+		//! changes position in file, returns true if successful
+		//! if relativeMovement==true, the pos is changed relative to current pos,
+		//! otherwise from begin of file
+		virtual bool seek(long finalPos, bool relativeMovement = false) _IRR_OVERRIDE_;
+
+		//! returns size of file
+		virtual long getSize() const _IRR_OVERRIDE_;
+
+		//! returns where in the file we are.
+		virtual long getPos() const _IRR_OVERRIDE_;
+
+		//! returns name of file
+		virtual const io::path& getFileName() const _IRR_OVERRIDE_;
+
+	private:
+
+		//! inflates the next bytes into buffer, returns how many were inflated
+		u32 inflateData(u8* buffer, u32 size);
+
+		//! continues from the last checkpoint before pos, or from the start
+		void restart(long pos);
+
+		//! saved state of the inflater
+		struct SCheckpoint
+		{
+			void* Stream;
+			u32 InputPos;
+			long Pos;
+		};
+
+		io::path Filename;
+		IReadFile* File;
+		const u8* Mapped;
+		long Offset;
+		u32 CompressedSize;
+		long Size;
+		long Pos;
+
+		//! z_stream of the inflater
+		void* Stream;
+		//! compressed bytes given to the inflater so far
+		u32 InputPos;
+		u8* Input;
+
+		core::array<SCheckpoint> Checkpoints;
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
+#endif
+
@@ -0,0 +1,511 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CInstancedMeshSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "ICameraSceneNode.h"
+#include "IMeshCache.h"
+#include "IAnimatedMesh.h"
+#include "IMaterialRenderer.h"
+#include "IFileSystem.h"
+#include "SViewFrustum.h"
+#include "os.h"
+
+namespace irr
+{
+namespace scene
+{
+
+
+//! constructor
+CInstancedMeshSceneNode::CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: IInstancedMeshSceneNode(parent, mgr, id, position, rotation, scale), Mesh(0),
+	PassCount(0), ReadOnlyMaterials(false), BoxChanged(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CInstancedMeshSceneNode");
+	#endif
+
+	setMesh(mesh);
+}
+
+
+//! destructor
+CInstancedMeshSceneNode::~CInstancedMeshSceneNode()
+{
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+//! frame
+void CInstancedMeshSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible)
+	{
+		// the scene manager culls the node with the box of all instances
+		if (BoxChanged)
+			updateBoundingBox();
+
+		if (Mesh && Transforms.size())
+		{
+			video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+			PassCount = 0;
+			int transparentCount = 0;
+			int solidCount = 0;
+
+			// count transparent and solid materials in this scene node
+			for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+			{
+				const video::SMaterial& material = ReadOnlyMaterials ? Mesh->getMeshBuffer(i)->getMaterial() : Materials[i];
+				video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+
+				if ((rnd && rnd->isTransparent()) || material.isTransparent())
+					++transparentCount;
+				else
+					++solidCount;
+
+				if (solidCount && transparentCount)
+					break;
+			}
+
+			if (solidCount)
+				SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+			if (transparentCount)
+				SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+		}
+
+		ISceneNode::OnRegisterSceneNode();
+	}
+}
+
+
+//! renders the node.
+void CInstancedMeshSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (!Mesh || !driver)
+		return;
+
+	const bool isTransparentPass =
+		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+
+	++PassCount;
+
+	// the camera is the same in both passes
+	if (PassCount==1)
+		cullInstances();
+
+	if (VisibleTransforms.size())
+	{
+		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		{
+			scene::IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+			if (!mb)
+				continue;
+
+			const video::SMaterial& material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+
+			video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+			const bool transparent = (rnd && rnd->isTransparent());
+
+			// only render transparent buffer if this is the transparent render pass
+			// and solid only in solid pass
+			if (transparent == isTransparentPass)
+			{
+				driver->setMaterial(material);
+				driver->drawMeshBufferInstanced(mb, VisibleTransforms.const_pointer(),
+					VisibleColors.const_pointer(), VisibleTransforms.size());
+			}
+		}
+	}
+
+	// for debug purposes only:
+	if (DebugDataVisible && PassCount==1)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		m.AntiAliasing=0;
+		driver->setMaterial(m);
+		driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+
+		if (DebugDataVisible & scene::EDS_BBOX)
+		{
+			driver->draw3DBox(Box, video::SColor(255,255,255,255));
+		}
+		if (DebugDataVisible & scene::EDS_BBOX_BUFFERS)
+		{
+			for (u32 i=0; i<InstanceBoxes.size(); ++i)
+				driver->draw3DBox(InstanceBoxes[i], video::SColor(255,190,128,128));
+		}
+	}
+}
+
+
+//! collects world transformations and colors of the instances in the view frustum
+void CInstancedMeshSceneNode::cullInstances()
+{
+	VisibleTransforms.set_used(0);
+	VisibleColors.set_used(0);
+
+	// instances changed after the registration
+	if (BoxChanged)
+		updateBoundingBox();
+
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	const u32 count = Transforms.size();
+
+	if (!camera || getAutomaticCulling() == scene::EAC_OFF)
+	{
+		VisibleTransforms.set_used(count);
+		for (u32 i=0; i<count; ++i)
+			VisibleTransforms[i].setbyproduct_nocheck(AbsoluteTransformation, Transforms[i]);
+		VisibleColors = Colors;
+		return;
+	}
+
+	// test the instance boxes against the frustum in the space of this node
+	SViewFrustum frustum = *camera->getViewFrustum();
+	const core::matrix4 invTrans(AbsoluteTransformation, core::matrix4::EM4CONST_INVERSE);
+	frustum.transform(invTrans);
+
+	f32 planes[SViewFrustum::VF_PLANE_COUNT][4];
+	for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+	{
+		planes[p][0] = frustum.planes[p].Normal.X;
+		planes[p][1] = frustum.planes[p].Normal.Y;
+		planes[p][2] = frustum.planes[p].Normal.Z;
+		planes[p][3] = frustum.planes[p].D;
+	}
+
+	for (u32 i=0; i<count; ++i)
+	{
+		const core::aabbox3d<f32>& box = InstanceBoxes[i];
+
+		// the box is outside if its corner furthest in the opposite
+		// direction of a plane normal is in front of the plane
+		bool visible = true;
+		for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+		{
+			const f32 d = planes[p][3] +
+				planes[p][0] * (planes[p][0] > 0.f ? box.MinEdge.X : box.MaxEdge.X) +
+				planes[p][1] * (planes[p][1] > 0.f ? box.MinEdge.Y : box.MaxEdge.Y) +
+				planes[p][2] * (planes[p][2] > 0.f ? box.MinEdge.Z : box.MaxEdge.Z);
+
+			if (d > core::ROUNDING_ERROR_f32)
+			{
+				visible = false;
+				break;
+			}
+		}
+
+		if (visible)
+		{
+			VisibleTransforms.push_back(core::IdentityMatrix);
+			VisibleTransforms.getLast().setbyproduct_nocheck(AbsoluteTransformation, Transforms[i]);
+			VisibleColors.push_back(Colors[i]);
+		}
+	}
+}
+
+
+//! recalculates the bounding box of all instances
+void CInstancedMeshSceneNode::updateBoundingBox()
+{
+	BoxChanged = false;
+
+	const u32 count = Transforms.size();
+	InstanceBoxes.set_used(count);
+
+	if (!Mesh || !count)
+	{
+		Box.reset(0.f, 0.f, 0.f);
+		return;
+	}
+
+	for (u32 i=0; i<count; ++i)
+	{
+		InstanceBoxes[i] = Mesh->getBoundingBox();
+		Transforms[i].transformBoxEx(InstanceBoxes[i]);
+	}
+
+	Box = InstanceBoxes[0];
+	for (u32 i=1; i<count; ++i)
+		Box.addInternalBox(InstanceBoxes[i]);
+
+	SceneManager->updateSceneNodeIndex(this);
+}
+
+
+//! returns the axis aligned bounding box of all instances
+const core::aabbox3d<f32>& CInstancedMeshSceneNode::getBoundingBox() const
+{
+	return Box;
+}
+
+
+//! Adds an instance
+u32 CInstancedMeshSceneNode::addInstance(const core::matrix4& transform, video::SColor color)
+{
+	Transforms.push_back(transform);
+	Colors.push_back(color);
+
+	if (Mesh && !BoxChanged)
+	{
+		core::aabbox3d<f32> box = Mesh->getBoundingBox();
+		transform.transformBoxEx(box);
+		InstanceBoxes.push_back(box);
+
+		if (Transforms.size() == 1)
+			Box = box;
+		else
+			Box.addInternalBox(box);
+		SceneManager->updateSceneNodeIndex(this);
+	}
+	else
+		BoxChanged = true;
+
+	return Transforms.size()-1;
+}
+
+
+//! Changes an instance
+void CInstancedMeshSceneNode::setInstance(u32 index, const core::matrix4& transform, video::SColor color)
+{
+	if (index >= Transforms.size())
+		return;
+
+	Transforms[index] = transform;
+	Colors[index] = color;
+	BoxChanged = true;
+}
+
+
+//! Replaces all instances
+void CInstancedMeshSceneNode::setInstances(const core::array<core::matrix4>& transforms,
+		const core::array<video::SColor>& colors)
+{
+	Transforms = transforms;
+	Colors.set_used(Transforms.size());
+	for (u32 i=0; i<Colors.size(); ++i)
+		Colors[i] = i < colors.size() ? colors[i] : video::SColor(255,255,255,255);
+
+	updateBoundingBox();
+}
+
+
+//! Removes an instance
+void CInstancedMeshSceneNode::removeInstance(u32 index)
+{
+	if (index >= Transforms.size())
+		return;
+
+	const u32 last = Transforms.size()-1;
+	Transforms[index] = Transforms[last];
+	Colors[index] = Colors[last];
+	Transforms.erase(last);
+	Colors.erase(last);
+	BoxChanged = true;
+}
+
+
+//! Removes all instances
+void CInstancedMeshSceneNode::clearInstances()
+{
+	Transforms.clear();
+	Colors.clear();
+	VisibleTransforms.clear();
+	VisibleColors.clear();
+	updateBoundingBox();
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CInstancedMeshSceneNode::getMaterial(u32 i)
+{
+	if (Mesh && ReadOnlyMaterials && i<Mesh->getMeshBufferCount())
+	{
+		ReadOnlyMaterial = Mesh->getMeshBuffer(i)->getMaterial();
+		return ReadOnlyMaterial;
+	}
+
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CInstancedMeshSceneNode::getMaterialCount() const
+{
+	if (Mesh && ReadOnlyMaterials)
+		return Mesh->getMeshBufferCount();
+
+	return Materials.size();
+}
+
+
+//! Sets a new mesh
+void CInstancedMeshSceneNode::setMesh(IMesh* mesh)
+{
+	if (mesh)
+	{
+		mesh->grab();
+		if (Mesh)
+			Mesh->drop();
+
+		Mesh = mesh;
+		copyMaterials();
+		updateBoundingBox();
+	}
+}
+
+
+//! Shadow volumes are not supported, returns 0.
+IShadowVolumeSceneNode* CInstancedMeshSceneNode::addShadowVolumeSceneNode(
+		const IMesh* shadowMesh, s32 id, bool zfailmethod, f32 infinity)
+{
+	os::Printer::log("Instanced mesh scene nodes do not support shadow volumes.", ELL_WARNING);
+	return 0;
+}
+
+
+void CInstancedMeshSceneNode::copyMaterials()
+{
+	Materials.clear();
+
+	if (Mesh)
+	{
+		video::SMaterial mat;
+
+		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		{
+			IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+			if (mb)
+				mat = mb->getMaterial();
+
+			Materials.push_back(mat);
+		}
+	}
+}
+
+
+//! Writes attributes of the scene node.
+void CInstancedMeshSceneNode::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
+{
+	IInstancedMeshSceneNode::serializeAttributes(out, options);
+
+	if (options && (options->Flags&io::EARWF_USE_RELATIVE_PATHS) && options->Filename)
+	{
+		const io::path path = SceneManager->getFileSystem()->getRelativeFilename(
+				SceneManager->getFileSystem()->getAbsolutePath(SceneManager->getMeshCache()->getMeshName(Mesh).getPath()),
+				options->Filename);
+		out->addString("Mesh", path.c_str());
+	}
+	else
+		out->addString("Mesh", SceneManager->getMeshCache()->getMeshName(Mesh).getPath().c_str());
+	out->addBool("ReadOnlyMaterials", ReadOnlyMaterials);
+
+	out->addInt("InstanceCount", Transforms.size());
+	for (u32 i=0; i<Transforms.size(); ++i)
+	{
+		core::stringc name("InstanceTransform");
+		name += i;
+		out->addMatrix(name.c_str(), Transforms[i]);
+
+		name = "InstanceColor";
+		name += i;
+		out->addColor(name.c_str(), Colors[i]);
+	}
+}
+
+
+//! Reads attributes of the scene node.
+void CInstancedMeshSceneNode::deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options)
+{
+	io::path oldMeshStr = SceneManager->getMeshCache()->getMeshName(Mesh);
+	io::path newMeshStr = in->getAttributeAsString("Mesh");
+	ReadOnlyMaterials = in->getAttributeAsBool("ReadOnlyMaterials");
+
+	if (newMeshStr != "" && oldMeshStr != newMeshStr)
+	{
+		IMesh* newMesh = 0;
+		IAnimatedMesh* newAnimatedMesh = SceneManager->getMesh(newMeshStr.c_str());
+
+		if (newAnimatedMesh)
+			newMesh = newAnimatedMesh->getMesh(0);
+
+		if (newMesh)
+			setMesh(newMesh);
+	}
+
+	if (in->existsAttribute("InstanceCount"))
+	{
+		const s32 count = in->getAttributeAsInt("InstanceCount");
+
+		core::array<core::matrix4> transforms;
+		core::array<video::SColor> colors;
+		for (s32 i=0; i<count; ++i)
+		{
+			core::stringc name("InstanceTransform");
+			name += i;
+			transforms.push_back(in->getAttributeAsMatrix(name.c_str()));
+
+			name = "InstanceColor";
+			name += i;
+			colors.push_back(in->getAttributeAsColor(name.c_str(), video::SColor(255,255,255,255)));
+		}
+		setInstances(transforms, colors);
+	}
+
+	IInstancedMeshSceneNode::deserializeAttributes(in, options);
+}
+
+
+//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+void CInstancedMeshSceneNode::setReadOnlyMaterials(bool readonly)
+{
+	ReadOnlyMaterials = readonly;
+}
+
+
+//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+bool CInstancedMeshSceneNode::isReadOnlyMaterials() const
+{
+	return ReadOnlyMaterials;
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CInstancedMeshSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CInstancedMeshSceneNode* nb = new CInstancedMeshSceneNode(Mesh, newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	nb->ReadOnlyMaterials = ReadOnlyMaterials;
+	nb->Materials = Materials;
+	nb->setInstances(Transforms, Colors);
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
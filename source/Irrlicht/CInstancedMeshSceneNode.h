@@ -0,0 +1,136 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IInstancedMeshSceneNode.h"
+#include "IMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	class CInstancedMeshSceneNode : public IInstancedMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CInstancedMeshSceneNode();
+
+		//! frame
+		virtual void OnRegisterSceneNode() _IRR_OVERRIDE_;
+
+		//! renders the node.
+		virtual void render() _IRR_OVERRIDE_;
+
+		//! returns the axis aligned bounding box of all instances
+		virtual const core::aabbox3d<f32>& getBoundingBox() const _IRR_OVERRIDE_;
+
+		//! returns the material based on the zero based index i.
+		virtual video::SMaterial& getMaterial(u32 i) _IRR_OVERRIDE_;
+
+		//! returns amount of materials used by this scene node.
+		virtual u32 getMaterialCount() const _IRR_OVERRIDE_;
+
+		//! Writes attributes of the scene node.
+		virtual void serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options=0) const _IRR_OVERRIDE_;
+
+		//! Reads attributes of the scene node.
+		virtual void deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options=0) _IRR_OVERRIDE_;
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_INSTANCED_MESH; }
+
+		//! Sets a new mesh
+		virtual void setMesh(IMesh* mesh) _IRR_OVERRIDE_;
+
+		//! Returns the current mesh
+		virtual IMesh* getMesh(void) _IRR_OVERRIDE_ { return Mesh; }
+
+		//! Shadow volumes are not supported, returns 0.
+		virtual IShadowVolumeSceneNode* addShadowVolumeSceneNode(const IMesh* shadowMesh,
+			s32 id, bool zfailmethod=true, f32 infinity=10000.0f) _IRR_OVERRIDE_;
+
+		//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+		virtual void setReadOnlyMaterials(bool readonly) _IRR_OVERRIDE_;
+
+		//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+		virtual bool isReadOnlyMaterials() const _IRR_OVERRIDE_;
+
+		//! Adds an instance
+		virtual u32 addInstance(const core::matrix4& transform, video::SColor color) _IRR_OVERRIDE_;
+
+		//! Changes an instance
+		virtual void setInstance(u32 index, const core::matrix4& transform, video::SColor color) _IRR_OVERRIDE_;
+
+		//! Replaces all instances
+		virtual void setInstances(const core::array<core::matrix4>& transforms,
+			const core::array<video::SColor>& colors) _IRR_OVERRIDE_;
+
+		//! Removes an instance
+		virtual void removeInstance(u32 index) _IRR_OVERRIDE_;
+
+		//! Removes all instances
+		virtual void clearInstances() _IRR_OVERRIDE_;
+
+		//! Get the amount of instances
+		virtual u32 getInstanceCount() const _IRR_OVERRIDE_ { return Transforms.size(); }
+
+		//! Get the transformation of an instance relative to this node
+		virtual const core::matrix4& getInstanceTransform(u32 index) const _IRR_OVERRIDE_ { return Transforms[index]; }
+
+		//! Get the color of an instance
+		virtual video::SColor getInstanceColor(u32 index) const _IRR_OVERRIDE_ { return Colors[index]; }
+
+		//! Get the amount of instances which passed the culling in the last frame
+		virtual u32 getVisibleInstanceCount() const _IRR_OVERRIDE_ { return VisibleTransforms.size(); }
+
+		//! Creates a clone of this scene node and its children.
+		virtual ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) _IRR_OVERRIDE_;
+
+	protected:
+
+		void copyMaterials();
+
+		//! recalculates the bounding box of all instances
+		void updateBoundingBox();
+
+		//! collects world transformations and colors of the instances in the view frustum
+		void cullInstances();
+
+		core::array<video::SMaterial> Materials;
+		video::SMaterial ReadOnlyMaterial;
+
+		//! instance transformations relative to this node
+		core::array<core::matrix4> Transforms;
+		core::array<video::SColor> Colors;
+		//! bounding boxes of the instances relative to this node
+		core::array<core::aabbox3d<f32> > InstanceBoxes;
+
+		//! world transformations and colors of the instances drawn this frame
+		core::array<core::matrix4> VisibleTransforms;
+		core::array<video::SColor> VisibleColors;
+
+		core::aabbox3d<f32> Box;
+
+		IMesh* Mesh;
+
+		s32 PassCount;
+		bool ReadOnlyMaterials;
+		bool BoxChanged;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -0,0 +1,408 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "IrrCompileConfig.h"
+#ifdef _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+
+#include "CIrrBinaryMeshFileLoader.h"
+#include "SIrrBinaryMeshFormat.h"
+#include "os.h"
+#include "IReadFile.h"
+#include "IAttributes.h"
+#include "IVideoDriver.h"
+#include "SAnimatedMesh.h"
+#include "SMesh.h"
+#include "CDynamicMeshBuffer.h"
+#include "CSkinnedMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	core::aabbox3df getBox(const f32* box)
+	{
+		return core::aabbox3df(box[0], box[1], box[2], box[3], box[4], box[5]);
+	}
+
+	//! checks the values of a buffer which are used as enums or sizes
+	bool isValid(const SIrrBinaryMeshBuffer& info)
+	{
+		return info.VertexType <= video::EVT_TANGENTS &&
+			info.VertexSize == video::getVertexPitchFromType((video::E_VERTEX_TYPE)info.VertexType) &&
+			info.IndexType <= video::EIT_32BIT &&
+			info.PrimitiveType <= EPT_POINT_SPRITES &&
+			info.MappingHintVertex <= EHM_STATIC && info.MappingHintIndex <= EHM_STATIC;
+	}
+
+	u32 getIndexSize(const SIrrBinaryMeshBuffer& info)
+	{
+		return info.IndexType == video::EIT_32BIT ? sizeof(u32) : sizeof(u16);
+	}
+}
+
+
+//! returns the next size bytes, 0 if the file ends before
+const u8* CIrrBinaryMeshFileLoader::CReader::readData(u32 size)
+{
+	if (Failed || (u32)(End - Pos) < size)
+	{
+		Failed = true;
+		return 0;
+	}
+
+	const u8* data = Pos;
+	Pos += size;
+	return data;
+}
+
+
+//! returns the next count elements of elementSize bytes, 0 if the file ends before
+const u8* CIrrBinaryMeshFileLoader::CReader::readArray(u32 count, u32 elementSize)
+{
+	if (!checkArray(count, elementSize))
+		return 0;
+
+	return readData(count * elementSize);
+}
+
+
+//! checks that the rest of the file can hold count elements of elementSize bytes
+bool CIrrBinaryMeshFileLoader::CReader::checkArray(u32 count, u32 elementSize)
+{
+	if (Failed || count > (u32)(End - Pos) / elementSize)
+	{
+		Failed = true;
+		return false;
+	}
+	return true;
+}
+
+
+//! reads a string written by CIrrBinaryMeshWriter::writeString
+bool CIrrBinaryMeshFileLoader::CReader::readString(core::stringc& str)
+{
+	u32 size;
+	if (!read(size))
+		return false;
+
+	const c8* data = (const c8*)readData(size);
+	if (!data)
+		return false;
+
+	str = core::stringc(data, size);
+	return true;
+}
+
+
+//! Constructor
+CIrrBinaryMeshFileLoader::CIrrBinaryMeshFileLoader(scene::ISceneManager* smgr)
+	: SceneManager(smgr)
+{
+	#ifdef _DEBUG
+	setDebugName("CIrrBinaryMeshFileLoader");
+	#endif
+}
+
+
+//! Returns true if the file maybe is able to be loaded by this class.
+/** This decision should be based only on the file extension (e.g. ".cob") */
+bool CIrrBinaryMeshFileLoader::isALoadableFileExtension(const io::path& filename) const
+{
+	return core::hasFileExtension(filename, "irrbin");
+}
+
+
+//! creates/loads an animated mesh from the file.
+//! \return Pointer to the created mesh. Returns 0 if loading failed.
+//! If you no longer need the mesh, you should call IAnimatedMesh::drop().
+//! See IReferenceCounted::drop() for more information.
+IAnimatedMesh* CIrrBinaryMeshFileLoader::createMesh(io::IReadFile* file)
+{
+	const long size = file->getSize();
+
+	// read the file in place when it is in memory
+	const u8* data = (const u8*)file->getData();
+	u8* readBuf = 0;
+	if (!data)
+	{
+		readBuf = new u8[size];
+		file->seek(0);
+		if (file->read(readBuf, size) != (size_t)size)
+		{
+			delete [] readBuf;
+			return 0;
+		}
+		data = readBuf;
+	}
+
+	CReader reader(data, size);
+	SIrrBinaryMeshHeader header;
+	IAnimatedMesh* mesh = 0;
+
+	if (!reader.read(header) || header.Magic != IRR_BINARY_MESH_MAGIC)
+		os::Printer::log("Not an Irrlicht binary mesh", file->getFileName(), ELL_ERROR);
+	else if (header.Version != IRR_BINARY_MESH_VERSION)
+		os::Printer::log("Unsupported Irrlicht binary mesh version, convert the mesh again", file->getFileName(), ELL_ERROR);
+	else if (header.ByteOrder != IRR_BINARY_MESH_BYTE_ORDER)
+		os::Printer::log("Irrlicht binary mesh has the wrong byte order", file->getFileName(), ELL_ERROR);
+	else if (header.Flags & EIBMF_SKINNED)
+		mesh = readSkinnedMesh(reader, header);
+	else
+		mesh = readMesh(reader, header);
+
+	if (!mesh && reader.failed())
+		os::Printer::log("Irrlicht binary mesh ends too early", file->getFileName(), ELL_ERROR);
+
+	delete [] readBuf;
+	return mesh;
+}
+
+
+//! reads a static mesh
+IAnimatedMesh* CIrrBinaryMeshFileLoader::readMesh(CReader& reader, const SIrrBinaryMeshHeader& header)
+{
+	SMesh* mesh = new SMesh();
+
+	for (u32 i=0; i<header.BufferCount; ++i)
+	{
+		SIrrBinaryMeshBuffer info;
+		if (!reader.read(info) || !isValid(info))
+		{
+			mesh->drop();
+			return 0;
+		}
+
+		CDynamicMeshBuffer* buffer = new CDynamicMeshBuffer((video::E_VERTEX_TYPE)info.VertexType, (video::E_INDEX_TYPE)info.IndexType);
+		mesh->addMeshBuffer(buffer);
+		buffer->drop();
+
+		const u8* vertices = 0;
+		const u8* indices = 0;
+		if (!readMaterial(reader, buffer->Material) ||
+			!(vertices = reader.readArray(info.VertexCount, info.VertexSize)) ||
+			!(indices = reader.readArray(info.IndexCount, getIndexSize(info))))
+		{
+			mesh->drop();
+			return 0;
+		}
+
+		buffer->getVertexBuffer().set_used(info.VertexCount);
+		memcpy(buffer->getVertexBuffer().getData(), vertices, info.VertexCount * info.VertexSize);
+		buffer->getIndexBuffer().set_used(info.IndexCount);
+		memcpy(buffer->getIndexBuffer().getData(), indices, info.IndexCount * getIndexSize(info));
+
+		buffer->setPrimitiveType((E_PRIMITIVE_TYPE)info.PrimitiveType);
+		buffer->setHardwareMappingHint((E_HARDWARE_MAPPING)info.MappingHintVertex, EBT_VERTEX);
+		buffer->setHardwareMappingHint((E_HARDWARE_MAPPING)info.MappingHintIndex, EBT_INDEX);
+		buffer->setBoundingBox(getBox(info.BoundingBox));
+	}
+
+	mesh->setBoundingBox(getBox(header.BoundingBox));
+
+	SAnimatedMesh* animatedMesh = new SAnimatedMesh(mesh);
+	mesh->drop();
+	animatedMesh->recalculateBoundingBox();
+	return animatedMesh;
+}
+
+
+//! reads a skinned mesh with its joints
+IAnimatedMesh* CIrrBinaryMeshFileLoader::readSkinnedMesh(CReader& reader, const SIrrBinaryMeshHeader& header)
+{
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	if (header.PositionKeySize != sizeof(ISkinnedMesh::SPositionKey) ||
+		header.ScaleKeySize != sizeof(ISkinnedMesh::SScaleKey) ||
+		header.RotationKeySize != sizeof(ISkinnedMesh::SRotationKey))
+	{
+		os::Printer::log("Irrlicht binary mesh was written with other animation keys, convert the mesh again", ELL_ERROR);
+		return 0;
+	}
+
+	CSkinnedMesh* mesh = new CSkinnedMesh();
+
+	for (u32 i=0; i<header.BufferCount; ++i)
+	{
+		SIrrBinaryMeshBuffer info;
+		if (!reader.read(info) || !isValid(info) || info.IndexType != video::EIT_16BIT)
+		{
+			mesh->drop();
+			return 0;
+		}
+
+		SSkinMeshBuffer* buffer = mesh->addMeshBuffer();
+		buffer->VertexType = (video::E_VERTEX_TYPE)info.VertexType;
+
+		const u8* vertices = 0;
+		const u8* indices = 0;
+		if (!readMaterial(reader, buffer->Material) ||
+			!(vertices = reader.readArray(info.VertexCount, info.VertexSize)) ||
+			!(indices = reader.readArray(info.IndexCount, sizeof(u16))))
+		{
+			mesh->drop();
+			return 0;
+		}
+
+		switch (buffer->VertexType)
+		{
+		case video::EVT_2TCOORDS:
+			buffer->Vertices_2TCoords.set_used(info.VertexCount);
+			break;
+		case video::EVT_TANGENTS:
+			buffer->Vertices_Tangents.set_used(info.VertexCount);
+			break;
+		default:
+			buffer->Vertices_Standard.set_used(info.VertexCount);
+			break;
+		}
+		memcpy(buffer->getVertices(), vertices, info.VertexCount * info.VertexSize);
+		buffer->Indices.set_used(info.IndexCount);
+		memcpy(buffer->Indices.pointer(), indices, info.IndexCount * sizeof(u16));
+
+		buffer->setPrimitiveType((E_PRIMITIVE_TYPE)info.PrimitiveType);
+		buffer->setHardwareMappingHint((E_HARDWARE_MAPPING)info.MappingHintVertex, EBT_VERTEX);
+		buffer->setHardwareMappingHint((E_HARDWARE_MAPPING)info.MappingHintIndex, EBT_INDEX);
+		buffer->BoundingBox = getBox(info.BoundingBox);
+	}
+
+	if (!readJoints(reader, header, mesh))
+	{
+		mesh->drop();
+		return 0;
+	}
+
+	mesh->setAnimationSpeed(header.AnimationSpeed);
+	mesh->finalize();
+	return mesh;
+#else
+	os::Printer::log("Skinned mesh support not compiled in, cannot load skinned Irrlicht binary mesh", ELL_ERROR);
+	return 0;
+#endif
+}
+
+
+//! reads the joints of a skinned mesh
+bool CIrrBinaryMeshFileLoader::readJoints(CReader& reader, const SIrrBinaryMeshHeader& header, CSkinnedMesh* mesh)
+{
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	if (!reader.checkArray(header.JointCount, sizeof(SIrrBinaryMeshJoint)))
+		return false;
+
+	// create all joints first, children refer to joints after them
+	u32 i;
+	for (i=0; i<header.JointCount; ++i)
+		mesh->addJoint(0);
+
+	const core::array<SSkinMeshBuffer*>& buffers = mesh->getMeshBuffers();
+	for (i=0; i<header.JointCount; ++i)
+	{
+		ISkinnedMesh::SJoint* joint = mesh->getAllJoints()[i];
+
+		SIrrBinaryMeshJoint info;
+		if (!reader.read(info) || !reader.readString(joint->Name))
+			return false;
+
+		joint->LocalMatrix.setM(info.LocalMatrix);
+		joint->GlobalInversedMatrix.setM(info.GlobalInversedMatrix);
+		joint->Animatedposition.set(info.AnimatedPosition[0], info.AnimatedPosition[1], info.AnimatedPosition[2]);
+		joint->Animatedscale.set(info.AnimatedScale[0], info.AnimatedScale[1], info.AnimatedScale[2]);
+		joint->Animatedrotation.set(info.AnimatedRotation[0], info.AnimatedRotation[1], info.AnimatedRotation[2], info.AnimatedRotation[3]);
+
+		u32 j;
+		if (!reader.checkArray(info.ChildCount, sizeof(u32)))
+			return false;
+		joint->Children.reallocate(info.ChildCount);
+		for (j=0; j<info.ChildCount; ++j)
+		{
+			u32 child;
+			if (!reader.read(child) || child >= header.JointCount)
+				return false;
+			joint->Children.push_back(mesh->getAllJoints()[child]);
+		}
+
+		const u8* attached = reader.readArray(info.AttachedMeshCount, sizeof(u32));
+		const u8* positionKeys = reader.readArray(info.PositionKeyCount, sizeof(ISkinnedMesh::SPositionKey));
+		const u8* scaleKeys = reader.readArray(info.ScaleKeyCount, sizeof(ISkinnedMesh::SScaleKey));
+		const u8* rotationKeys = reader.readArray(info.RotationKeyCount, sizeof(ISkinnedMesh::SRotationKey));
+		if (reader.failed())
+			return false;
+
+		joint->AttachedMeshes.set_used(info.AttachedMeshCount);
+		memcpy(joint->AttachedMeshes.pointer(), attached, info.AttachedMeshCount * sizeof(u32));
+		for (j=0; j<info.AttachedMeshCount; ++j)
+		{
+			if (joint->AttachedMeshes[j] >= buffers.size())
+				return false;
+		}
+
+		joint->PositionKeys.set_used(info.PositionKeyCount);
+		memcpy((void*)joint->PositionKeys.pointer(), positionKeys, info.PositionKeyCount * sizeof(ISkinnedMesh::SPositionKey));
+		joint->ScaleKeys.set_used(info.ScaleKeyCount);
+		memcpy((void*)joint->ScaleKeys.pointer(), scaleKeys, info.ScaleKeyCount * sizeof(ISkinnedMesh::SScaleKey));
+		joint->RotationKeys.set_used(info.RotationKeyCount);
+		memcpy((void*)joint->RotationKeys.pointer(), rotationKeys, info.RotationKeyCount * sizeof(ISkinnedMesh::SRotationKey));
+
+		if (!reader.checkArray(info.WeightCount, sizeof(SIrrBinaryMeshWeight)))
+			return false;
+		joint->Weights.reallocate(info.WeightCount);
+		for (j=0; j<info.WeightCount; ++j)
+		{
+			SIrrBinaryMeshWeight weight;
+			if (!reader.read(weight) || weight.BufferIndex >= buffers.size() ||
+				weight.VertexIndex >= buffers[weight.BufferIndex]->getVertexCount())
+				return false;
+
+			ISkinnedMesh::SWeight* w = mesh->addWeight(joint);
+			w->buffer_id = (u16)weight.BufferIndex;
+			w->vertex_id = weight.VertexIndex;
+			w->strength = weight.Strength;
+		}
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+//! reads a material written by CIrrBinaryMeshWriter::writeMaterial
+bool CIrrBinaryMeshFileLoader::readMaterial(CReader& reader, video::SMaterial& material)
+{
+	u32 count;
+	if (!reader.read(count))
+		return false;
+
+	// start with the attributes of a default material, so each value is
+	// converted from its string to the type of the attribute
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	io::IAttributes* attributes = driver->createAttributesFromMaterial(video::SMaterial());
+	if (!attributes)
+		return false;
+
+	core::stringc name;
+	core::stringc value;
+	bool result = true;
+	for (u32 i=0; result && i<count; ++i)
+	{
+		result = reader.readString(name) && reader.readString(value);
+		if (result)
+			attributes->setAttribute(name.c_str(), value.c_str());
+	}
+
+	if (result)
+		driver->fillMaterialStructureFromAttributes(material, attributes);
+
+	attributes->drop();
+	return result;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+
@@ -0,0 +1,103 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_IRR_BINARY_MESH_FILE_LOADER_H_INCLUDED__
+#define __C_IRR_BINARY_MESH_FILE_LOADER_H_INCLUDED__
+
+#include "IMeshLoader.h"
+#include "ISceneManager.h"
+#include "SMaterial.h"
+
+namespace irr
+{
+namespace scene
+{
+	struct SIrrBinaryMeshHeader;
+	class CSkinnedMesh;
+
+//! Meshloader capable of loading .irrbin meshes, the binary Irrlicht Engine mesh format
+/** The arrays in the file are copied into the mesh buffers and joints as
+they are, files mapped into memory with IFileSystem::setFileMappingThreshold
+are read in place. */
+class CIrrBinaryMeshFileLoader : public IMeshLoader
+{
+public:
+
+	//! Constructor
+	CIrrBinaryMeshFileLoader(scene::ISceneManager* smgr);
+
+	//! returns true if the file maybe is able to be loaded by this class
+	//! based on the file extension (e.g. ".cob")
+	virtual bool isALoadableFileExtension(const io::path& filename) const _IRR_OVERRIDE_;
+
+	//! creates/loads an animated mesh from the file.
+	//! \return Pointer to the created mesh. Returns 0 if loading failed.
+	//! If you no longer need the mesh, you should call IAnimatedMesh::drop().
+	//! See IReferenceCounted::drop() for more information.
+	virtual IAnimatedMesh* createMesh(io::IReadFile* file) _IRR_OVERRIDE_;
+
+private:
+
+	//! reads consecutive parts of the file
+	class CReader
+	{
+	public:
+		CReader(const u8* data, long size) : Pos(data), End(data + size), Failed(false) {}
+
+		//! returns the next size bytes, 0 if the file ends before
+		const u8* readData(u32 size);
+
+		//! returns the next count elements of elementSize bytes, 0 if the file ends before
+		const u8* readArray(u32 count, u32 elementSize);
+
+		//! checks that the rest of the file can hold count elements of elementSize bytes
+		/** Counts read from the file are checked before memory is reserved
+		for them or their size is computed, so the size can't overflow. */
+		bool checkArray(u32 count, u32 elementSize);
+
+		//! reads a structure
+		template <class T>
+		bool read(T& value)
+		{
+			const u8* data = readData(sizeof(T));
+			if (data)
+				memcpy(&value, data, sizeof(T));
+			return data != 0;
+		}
+
+		//! reads a string written by CIrrBinaryMeshWriter::writeString
+		bool readString(core::stringc& str);
+
+		//! true if the file ended too early
+		bool failed() const { return Failed; }
+
+	private:
+		const u8* Pos;
+		const u8* End;
+		bool Failed;
+	};
+
+	//! reads a static mesh
+	IAnimatedMesh* readMesh(CReader& reader, const SIrrBinaryMeshHeader& header);
+
+	//! reads a skinned mesh with its joints
+	IAnimatedMesh* readSkinnedMesh(CReader& reader, const SIrrBinaryMeshHeader& header);
+
+	//! reads the joints of a skinned mesh
+	bool readJoints(CReader& reader, const SIrrBinaryMeshHeader& header, CSkinnedMesh* mesh);
+
+	//! reads a material written by CIrrBinaryMeshWriter::writeMaterial
+	bool readMaterial(CReader& reader, video::SMaterial& material);
+
+	// member variables
+
+	scene::ISceneManager* SceneManager;
+};
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
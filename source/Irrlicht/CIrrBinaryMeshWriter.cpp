@@ -0,0 +1,220 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "IrrCompileConfig.h"
+
+#ifdef _IRR_COMPILE_WITH_IRR_BINARY_WRITER_
+
+#include "CIrrBinaryMeshWriter.h"
+#include "SIrrBinaryMeshFormat.h"
+#include "os.h"
+#include "IWriteFile.h"
+#include "IMesh.h"
+#include "IAttributes.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	void copyBox(f32* dest, const core::aabbox3df& box)
+	{
+		dest[0] = box.MinEdge.X;
+		dest[1] = box.MinEdge.Y;
+		dest[2] = box.MinEdge.Z;
+		dest[3] = box.MaxEdge.X;
+		dest[4] = box.MaxEdge.Y;
+		dest[5] = box.MaxEdge.Z;
+	}
+
+	bool writeData(io::IWriteFile* file, const void* data, u32 size)
+	{
+		return !size || file->write(data, size) == (size_t)size;
+	}
+}
+
+
+CIrrBinaryMeshWriter::CIrrBinaryMeshWriter(video::IVideoDriver* driver)
+	: VideoDriver(driver)
+{
+	#ifdef _DEBUG
+	setDebugName("CIrrBinaryMeshWriter");
+	#endif
+
+	if (VideoDriver)
+		VideoDriver->grab();
+}
+
+
+CIrrBinaryMeshWriter::~CIrrBinaryMeshWriter()
+{
+	if (VideoDriver)
+		VideoDriver->drop();
+}
+
+
+//! Returns the type of the mesh writer
+EMESH_WRITER_TYPE CIrrBinaryMeshWriter::getType() const
+{
+	return EMWT_IRR_BINARY_MESH;
+}
+
+
+//! writes a mesh
+bool CIrrBinaryMeshWriter::writeMesh(io::IWriteFile* file, scene::IMesh* mesh, s32 flags)
+{
+	if (!file || !mesh)
+		return false;
+
+	os::Printer::log("Writing mesh", file->getFileName());
+
+	const ISkinnedMesh* skinnedMesh = 0;
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	if (mesh->getMeshType() == EAMT_SKINNED)
+		skinnedMesh = static_cast<const ISkinnedMesh*>(mesh);
+#endif
+
+	SIrrBinaryMeshHeader header;
+	memset(&header, 0, sizeof(header));
+	header.Magic = IRR_BINARY_MESH_MAGIC;
+	header.Version = IRR_BINARY_MESH_VERSION;
+	header.ByteOrder = IRR_BINARY_MESH_BYTE_ORDER;
+	header.BufferCount = mesh->getMeshBufferCount();
+	copyBox(header.BoundingBox, mesh->getBoundingBox());
+	header.PositionKeySize = sizeof(ISkinnedMesh::SPositionKey);
+	header.ScaleKeySize = sizeof(ISkinnedMesh::SScaleKey);
+	header.RotationKeySize = sizeof(ISkinnedMesh::SRotationKey);
+
+	if (skinnedMesh)
+	{
+		header.Flags |= EIBMF_SKINNED;
+		header.JointCount = skinnedMesh->getAllJoints().size();
+		header.AnimationSpeed = skinnedMesh->getAnimationSpeed();
+	}
+
+	bool result = writeData(file, &header, sizeof(header));
+
+	for (u32 i=0; result && i<header.BufferCount; ++i)
+		result = writeMeshBuffer(file, mesh->getMeshBuffer(i));
+
+	for (u32 i=0; result && i<header.JointCount; ++i)
+		result = writeJoint(file, skinnedMesh, skinnedMesh->getAllJoints()[i]);
+
+	if (!result)
+		os::Printer::log("Could not write mesh", file->getFileName(), ELL_ERROR);
+
+	return result;
+}
+
+
+bool CIrrBinaryMeshWriter::writeMeshBuffer(io::IWriteFile* file, const scene::IMeshBuffer* buffer)
+{
+	SIrrBinaryMeshBuffer info;
+	info.VertexType = buffer->getVertexType();
+	info.VertexSize = video::getVertexPitchFromType(buffer->getVertexType());
+	info.VertexCount = buffer->getVertexCount();
+	info.IndexType = buffer->getIndexType();
+	info.IndexCount = buffer->getIndexCount();
+	info.PrimitiveType = buffer->getPrimitiveType();
+	info.MappingHintVertex = buffer->getHardwareMappingHint_Vertex();
+	info.MappingHintIndex = buffer->getHardwareMappingHint_Index();
+	copyBox(info.BoundingBox, buffer->getBoundingBox());
+
+	const u32 indexSize = info.IndexType == video::EIT_32BIT ? sizeof(u32) : sizeof(u16);
+
+	return writeData(file, &info, sizeof(info)) &&
+		writeMaterial(file, buffer->getMaterial()) &&
+		writeData(file, buffer->getVertices(), info.VertexCount * info.VertexSize) &&
+		writeData(file, buffer->getIndices(), info.IndexCount * indexSize);
+}
+
+
+bool CIrrBinaryMeshWriter::writeMaterial(io::IWriteFile* file, const video::SMaterial& material)
+{
+	// simply use irrlichts built-in attribute serialization capabilities here:
+	io::IAttributes* attributes = VideoDriver->createAttributesFromMaterial(material);
+	const u32 count = attributes ? attributes->getAttributeCount() : 0;
+
+	bool result = writeData(file, &count, sizeof(count));
+	for (u32 i=0; result && i<count; ++i)
+	{
+		result = writeString(file, attributes->getAttributeName(i)) &&
+			writeString(file, attributes->getAttributeAsString(i));
+	}
+
+	if (attributes)
+		attributes->drop();
+	return result;
+}
+
+
+bool CIrrBinaryMeshWriter::writeJoint(io::IWriteFile* file, const ISkinnedMesh* mesh, const ISkinnedMesh::SJoint* joint)
+{
+	SIrrBinaryMeshJoint info;
+	memcpy(info.LocalMatrix, joint->LocalMatrix.pointer(), sizeof(info.LocalMatrix));
+	memcpy(info.GlobalInversedMatrix, joint->GlobalInversedMatrix.pointer(), sizeof(info.GlobalInversedMatrix));
+	info.AnimatedPosition[0] = joint->Animatedposition.X;
+	info.AnimatedPosition[1] = joint->Animatedposition.Y;
+	info.AnimatedPosition[2] = joint->Animatedposition.Z;
+	info.AnimatedScale[0] = joint->Animatedscale.X;
+	info.AnimatedScale[1] = joint->Animatedscale.Y;
+	info.AnimatedScale[2] = joint->Animatedscale.Z;
+	info.AnimatedRotation[0] = joint->Animatedrotation.X;
+	info.AnimatedRotation[1] = joint->Animatedrotation.Y;
+	info.AnimatedRotation[2] = joint->Animatedrotation.Z;
+	info.AnimatedRotation[3] = joint->Animatedrotation.W;
+	info.ChildCount = joint->Children.size();
+	info.AttachedMeshCount = joint->AttachedMeshes.size();
+	info.PositionKeyCount = joint->PositionKeys.size();
+	info.ScaleKeyCount = joint->ScaleKeys.size();
+	info.RotationKeyCount = joint->RotationKeys.size();
+	info.WeightCount = joint->Weights.size();
+
+	if (!writeData(file, &info, sizeof(info)) || !writeString(file, joint->Name))
+		return false;
+
+	// children by their position in the joint list
+	const core::array<ISkinnedMesh::SJoint*>& allJoints = mesh->getAllJoints();
+	u32 i;
+	for (i=0; i<info.ChildCount; ++i)
+	{
+		const u32 child = (u32)allJoints.linear_search(joint->Children[i]);
+		if (!writeData(file, &child, sizeof(child)))
+			return false;
+	}
+
+	if (!writeData(file, joint->AttachedMeshes.const_pointer(), info.AttachedMeshCount * sizeof(u32)) ||
+		!writeData(file, joint->PositionKeys.const_pointer(), info.PositionKeyCount * sizeof(ISkinnedMesh::SPositionKey)) ||
+		!writeData(file, joint->ScaleKeys.const_pointer(), info.ScaleKeyCount * sizeof(ISkinnedMesh::SScaleKey)) ||
+		!writeData(file, joint->RotationKeys.const_pointer(), info.RotationKeyCount * sizeof(ISkinnedMesh::SRotationKey)))
+		return false;
+
+	for (i=0; i<info.WeightCount; ++i)
+	{
+		SIrrBinaryMeshWeight weight;
+		weight.BufferIndex = joint->Weights[i].buffer_id;
+		weight.VertexIndex = joint->Weights[i].vertex_id;
+		weight.Strength = joint->Weights[i].strength;
+		if (!writeData(file, &weight, sizeof(weight)))
+			return false;
+	}
+
+	return true;
+}
+
+
+bool CIrrBinaryMeshWriter::writeString(io::IWriteFile* file, const core::stringc& str)
+{
+	const u32 size = str.size();
+	return writeData(file, &size, sizeof(size)) && writeData(file, str.c_str(), size);
+}
+
+
+} // end namespace
+} // end namespace
+
+#endif
+
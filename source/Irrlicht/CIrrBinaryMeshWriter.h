@@ -0,0 +1,54 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __IRR_IRR_BINARY_MESH_WRITER_H_INCLUDED__
+#define __IRR_IRR_BINARY_MESH_WRITER_H_INCLUDED__
+
+#include "IMeshWriter.h"
+#include "IVideoDriver.h"
+#include "ISkinnedMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IMeshBuffer;
+
+
+	//! class to write meshes, implementing a writer for binary .irrbin files
+	/** The vertices, indices and animation keys are written as they are in
+	memory, so CIrrBinaryMeshFileLoader loads them without parsing. Skinned
+	meshes are written with their joints, keys and weights, write them
+	before they are animated or their animation is compressed. */
+	class CIrrBinaryMeshWriter : public IMeshWriter
+	{
+	public:
+
+		CIrrBinaryMeshWriter(video::IVideoDriver* driver);
+		virtual ~CIrrBinaryMeshWriter();
+
+		//! Returns the type of the mesh writer
+		virtual EMESH_WRITER_TYPE getType() const _IRR_OVERRIDE_;
+
+		//! writes a mesh
+		virtual bool writeMesh(io::IWriteFile* file, scene::IMesh* mesh, s32 flags=EMWF_NONE) _IRR_OVERRIDE_;
+
+	protected:
+
+		bool writeMeshBuffer(io::IWriteFile* file, const scene::IMeshBuffer* buffer);
+
+		bool writeMaterial(io::IWriteFile* file, const video::SMaterial& material);
+
+		bool writeJoint(io::IWriteFile* file, const ISkinnedMesh* mesh, const ISkinnedMesh::SJoint* joint);
+
+		bool writeString(io::IWriteFile* file, const core::stringc& str);
+
+		video::IVideoDriver* VideoDriver;
+	};
+
+} // end namespace
+} // end namespace
+
+#endif
+
@@ -47,6 +47,17 @@ size_t CLimitReadFile::read(void* buffer, size_t sizeToRead)
 	long toRead = core::min_(AreaEnd, r + (long)sizeToRead) - core::max_(AreaStart, r);
 	if (toRead < 0)
 		return 0;
+
+	// copy straight from memory, this does not move the shared outer file
+	// so several limit files of one archive can be read at the same time
+	const c8* data = (const c8*)getData();
+	if (data)
+	{
+		memcpy(buffer, data + Pos, toRead);
+		Pos += toRead;
+		return toRead;
+	}
+
 	File->seek(r);
 	r = (long)File->read(buffer, toRead);
 	Pos += r;
@@ -116,6 +127,17 @@ const io::path& CLimitReadFile::getFileName() const
 }
 
 
+//! returns the area of the contents of the outer file, if it has them in memory
+const void* CLimitReadFile::getData() const
+{
+	if (!File || AreaEnd > File->getSize())
+		return 0;
+
+	const c8* data = (const c8*)File->getData();
+	return data ? data + AreaStart : 0;
+}
+
+
 IReadFile* createLimitReadFile(const io::path& fileName, IReadFile* alreadyOpenedFile, long pos, long areaSize)
 {
 	return new CLimitReadFile(alreadyOpenedFile, pos, areaSize, fileName);
@@ -46,6 +46,9 @@ namespace io
 		//! returns name of file
 		virtual const io::path& getFileName() const _IRR_OVERRIDE_;
 
+		//! returns the area of the contents of the outer file, if it has them in memory
+		virtual const void* getData() const _IRR_OVERRIDE_;
+
 	private:
 
 		io::path Filename;
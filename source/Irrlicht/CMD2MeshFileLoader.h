@@ -32,6 +32,9 @@ public:
 	//! See IReferenceCounted::drop() for more information.
 	virtual IAnimatedMesh* createMesh(io::IReadFile* file) _IRR_OVERRIDE_;
 
+	//! createMesh() only reads the file, so it can run on a worker thread
+	virtual bool canLoadOnWorkerThread() const _IRR_OVERRIDE_ { return true; }
+
 private:
 	//! Loads the file data into the mesh
 	bool loadFile(io::IReadFile* file, CAnimatedMeshMD2* mesh);
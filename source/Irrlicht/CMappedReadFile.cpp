@@ -0,0 +1,188 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CMappedReadFile.h"
+
+#ifdef _IRR_COMPILE_WITH_MAPPED_FILES_
+
+#if defined(_IRR_WINDOWS_API_)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+
+CMappedReadFile::CMappedReadFile(const io::path& fileName, long minimumSize)
+: Data(0), FileSize(0), Pos(0), Filename(fileName)
+#if defined(_IRR_WINDOWS_API_)
+	, FileHandle(INVALID_HANDLE_VALUE), MappingHandle(0)
+#endif
+{
+	#ifdef _DEBUG
+	setDebugName("CMappedReadFile");
+	#endif
+
+	mapFile(minimumSize);
+}
+
+
+CMappedReadFile::~CMappedReadFile()
+{
+#if defined(_IRR_WINDOWS_API_)
+	if (Data)
+		UnmapViewOfFile(Data);
+	if (MappingHandle)
+		CloseHandle(MappingHandle);
+	if (FileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(FileHandle);
+#else
+	if (Data)
+		munmap((void*)Data, FileSize);
+#endif
+}
+
+
+//! returns how much was read
+size_t CMappedReadFile::read(void* buffer, size_t sizeToRead)
+{
+	long amount = static_cast<long>(sizeToRead);
+	if (Pos + amount > FileSize)
+		amount = FileSize - Pos;
+
+	if (amount <= 0)
+		return 0;
+
+	memcpy(buffer, Data + Pos, amount);
+	Pos += amount;
+
+	return static_cast<size_t>(amount);
+}
+
+
+//! changes position in file, returns true if successful
+//! if relativeMovement==true, the pos is changed relative to current pos,
+//! otherwise from begin of file
+bool CMappedReadFile::seek(long finalPos, bool relativeMovement)
+{
+	if (relativeMovement)
+		finalPos += Pos;
+
+	if (finalPos < 0 || finalPos > FileSize)
+		return false;
+
+	Pos = finalPos;
+	return true;
+}
+
+
+//! returns size of file
+long CMappedReadFile::getSize() const
+{
+	return FileSize;
+}
+
+
+//! returns where in the file we are.
+long CMappedReadFile::getPos() const
+{
+	return Pos;
+}
+
+
+//! returns name of file
+const io::path& CMappedReadFile::getFileName() const
+{
+	return Filename;
+}
+
+
+//! returns the mapped contents of the file
+const void* CMappedReadFile::getData() const
+{
+	return Data;
+}
+
+
+//! opens and maps the file
+void CMappedReadFile::mapFile(long minimumSize)
+{
+	if (Filename.size() == 0)
+		return;
+
+#if defined(_IRR_WINDOWS_API_)
+#if defined(_IRR_WCHAR_FILESYSTEM)
+	FileHandle = CreateFileW(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+#else
+	FileHandle = CreateFileA(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+#endif
+	if (FileHandle == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER size;
+	// long is 32 bit on windows, larger files are read with CReadFile
+	if (!GetFileSizeEx(FileHandle, &size) || size.QuadPart < core::max_(minimumSize, 1L) || size.QuadPart > 0x7fffffff)
+		return;
+
+	MappingHandle = CreateFileMapping(FileHandle, 0, PAGE_READONLY, 0, 0, 0);
+	if (!MappingHandle)
+		return;
+
+	Data = (const c8*)MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (Data)
+		FileSize = (long)size.QuadPart;
+#else
+	const int fd = open(Filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size >= core::max_(minimumSize, 1L)
+		&& (off_t)(long)info.st_size == info.st_size)
+	{
+		void* mapping = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping != MAP_FAILED)
+		{
+#if defined(POSIX_MADV_WILLNEED)
+			// loaders read the whole file, start reading ahead right away
+			posix_madvise(mapping, info.st_size, POSIX_MADV_WILLNEED);
+#endif
+			Data = (const c8*)mapping;
+			FileSize = (long)info.st_size;
+		}
+	}
+
+	// the mapping stays valid without the descriptor
+	close(fd);
+#endif
+}
+
+
+IReadFile* CMappedReadFile::createMappedReadFile(const io::path& fileName, long minimumSize)
+{
+	CMappedReadFile* file = new CMappedReadFile(fileName, minimumSize);
+	if (file->Data)
+		return file;
+
+	file->drop();
+	return 0;
+}
+
+
+} // end namespace io
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_MAPPED_FILES_
+
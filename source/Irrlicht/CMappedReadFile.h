@@ -0,0 +1,79 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_MAPPED_READ_FILE_H_INCLUDED__
+#define __C_MAPPED_READ_FILE_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+
+#ifdef _IRR_COMPILE_WITH_MAPPED_FILES_
+
+#include "IReadFile.h"
+#include "irrString.h"
+
+namespace irr
+{
+
+namespace io
+{
+
+	/*!
+		Class for reading a real file from disk which is mapped into memory.
+		Reading copies from the mapping, getData gives loaders the whole
+		file without any copy.
+	*/
+	class CMappedReadFile : public IReadFile
+	{
+	public:
+
+		virtual ~CMappedReadFile();
+
+		//! returns how much was read
+		virtual size_t read(void* buffer, size_t sizeToRead) _IRR_OVERRIDE_;
+
+		//! changes position in file, returns true if successful
+		virtual bool seek(long finalPos, bool relativeMovement = false) _IRR_OVERRIDE_;
+
+		//! returns size of file
+		virtual long getSize() const _IRR_OVERRIDE_;
+
+		//! returns where in the file we are.
+		virtual long getPos() const _IRR_OVERRIDE_;
+
+		//! returns name of file
+		virtual const io::path& getFileName() const _IRR_OVERRIDE_;
+
+		//! returns the mapped contents of the file
+		virtual const void* getData() const _IRR_OVERRIDE_;
+
+		//! maps a file on disk into memory.
+		/** \param minimumSize Smaller files are not mapped.
+		\return 0 if the file could not be opened or mapped or is smaller
+		than minimumSize, empty files can't be mapped either. */
+		static IReadFile* createMappedReadFile(const io::path& fileName, long minimumSize = 1);
+
+	private:
+
+		CMappedReadFile(const io::path& fileName, long minimumSize);
+
+		//! opens and maps the file
+		void mapFile(long minimumSize);
+
+		const c8* Data;
+		long FileSize;
+		long Pos;
+		io::path Filename;
+#if defined(_IRR_WINDOWS_API_)
+		void* FileHandle;
+		void* MappingHandle;
+#endif
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_MAPPED_FILES_
+
+#endif
+
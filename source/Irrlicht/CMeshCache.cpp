@@ -28,7 +28,22 @@ void CMeshCache::addMesh(const io::path& filename, IAnimatedMesh* mesh)
 	MeshEntry e ( filename );
 	e.Mesh = mesh;
 
+	CWriteLock lock(Lock);
 	Meshes.push_back(e);
+	Index.insert(e.NamedPath.getInternalName(), mesh);
+}
+
+
+//! finds the entry of a mesh, Lock must be locked
+s32 CMeshCache::findMesh(const IMesh* const mesh) const
+{
+	for (u32 i=0; i<Meshes.size(); ++i)
+	{
+		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
+			return (s32)i;
+	}
+
+	return -1;
 }
 
 
@@ -37,14 +52,14 @@ void CMeshCache::removeMesh(const IMesh* const mesh)
 {
 	if ( !mesh )
 		return;
-	for (u32 i=0; i<Meshes.size(); ++i)
+
+	CWriteLock lock(Lock);
+	const s32 i = findMesh(mesh);
+	if (i != -1)
 	{
-		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
-		{
-			Meshes[i].Mesh->drop();
-			Meshes.erase(i);
-			return;
-		}
+		Index.remove(Meshes[i].NamedPath.getInternalName(), Meshes[i].Mesh);
+		Meshes[i].Mesh->drop();
+		Meshes.erase(i);
 	}
 }
 
@@ -52,6 +67,7 @@ void CMeshCache::removeMesh(const IMesh* const mesh)
 //! Returns amount of loaded meshes
 u32 CMeshCache::getMeshCount() const
 {
+	CReadLock lock(Lock);
 	return Meshes.size();
 }
 
@@ -59,19 +75,15 @@ u32 CMeshCache::getMeshCount() const
 //! Returns current number of the mesh
 s32 CMeshCache::getMeshIndex(const IMesh* const mesh) const
 {
-	for (u32 i=0; i<Meshes.size(); ++i)
-	{
-		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
-			return (s32)i;
-	}
-
-	return -1;
+	CReadLock lock(Lock);
+	return findMesh(mesh);
 }
 
 
 //! Returns a mesh based on its index number
 IAnimatedMesh* CMeshCache::getMeshByIndex(u32 number)
 {
+	CReadLock lock(Lock);
 	if (number >= Meshes.size())
 		return 0;
 
@@ -82,15 +94,14 @@ IAnimatedMesh* CMeshCache::getMeshByIndex(u32 number)
 //! Returns a mesh based on its name.
 IAnimatedMesh* CMeshCache::getMeshByName(const io::path& name)
 {
-	MeshEntry e ( name );
-	s32 id = Meshes.binary_search(e);
-	return (id != -1) ? Meshes[id].Mesh : 0;
+	return Index.find(io::SNamedPath(name).getInternalName());
 }
 
 
 //! Get the name of a loaded mesh, based on its index.
 const io::SNamedPath& CMeshCache::getMeshName(u32 index) const
 {
+	CReadLock lock(Lock);
 	if (index >= Meshes.size())
 		return emptyNamedPath;
 
@@ -104,23 +115,21 @@ const io::SNamedPath& CMeshCache::getMeshName(const IMesh* const mesh) const
 	if (!mesh)
 		return emptyNamedPath;
 
-	for (u32 i=0; i<Meshes.size(); ++i)
-	{
-		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
-			return Meshes[i].NamedPath;
-	}
-
-	return emptyNamedPath;
+	CReadLock lock(Lock);
+	const s32 i = findMesh(mesh);
+	return (i != -1) ? Meshes[i].NamedPath : emptyNamedPath;
 }
 
 //! Renames a loaded mesh.
 bool CMeshCache::renameMesh(u32 index, const io::path& name)
 {
+	CWriteLock lock(Lock);
 	if (index >= Meshes.size())
 		return false;
 
+	Index.remove(Meshes[index].NamedPath.getInternalName(), Meshes[index].Mesh);
 	Meshes[index].NamedPath.setPath(name);
-	Meshes.sort();
+	Index.insert(Meshes[index].NamedPath.getInternalName(), Meshes[index].Mesh);
 	return true;
 }
 
@@ -128,17 +137,13 @@ bool CMeshCache::renameMesh(u32 index, const io::path& name)
 //! Renames a loaded mesh.
 bool CMeshCache::renameMesh(const IMesh* const mesh, const io::path& name)
 {
-	for (u32 i=0; i<Meshes.size(); ++i)
+	s32 index;
 	{
-		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
-		{
-			Meshes[i].NamedPath.setPath(name);
-			Meshes.sort();
-			return true;
-		}
+		CReadLock lock(Lock);
+		index = findMesh(mesh);
 	}
 
-	return false;
+	return index != -1 && renameMesh((u32)index, name);
 }
 
 
@@ -152,19 +157,23 @@ bool CMeshCache::isMeshLoaded(const io::path& name)
 //! Clears the whole mesh cache, removing all meshes.
 void CMeshCache::clear()
 {
+	CWriteLock lock(Lock);
 	for (u32 i=0; i<Meshes.size(); ++i)
 		Meshes[i].Mesh->drop();
 
 	Meshes.clear();
+	Index.clear();
 }
 
 //! Clears all meshes that are held in the mesh cache but not used anywhere else.
 void CMeshCache::clearUnusedMeshes()
 {
+	CWriteLock lock(Lock);
 	for (u32 i=0; i<Meshes.size(); ++i)
 	{
 		if (Meshes[i].Mesh->getReferenceCount() == 1)
 		{
+			Index.remove(Meshes[i].NamedPath.getInternalName(), Meshes[i].Mesh);
 			Meshes[i].Mesh->drop();
 			Meshes.erase(i);
 			--i;
@@ -173,6 +182,20 @@ void CMeshCache::clearUnusedMeshes()
 }
 
 
+//! Returns the mesh with this name or prepares loading it.
+IAnimatedMesh* CMeshCache::beginLoad(const io::path& name, bool& load)
+{
+	return Index.beginLoad(io::SNamedPath(name).getInternalName(), load);
+}
+
+
+//! Ends a load started with beginLoad().
+void CMeshCache::endLoad(const io::path& name)
+{
+	Index.endLoad(io::SNamedPath(name).getInternalName());
+}
+
+
 } // end namespace scene
 } // end namespace irr
 
@@ -7,6 +7,7 @@
 
 #include "IMeshCache.h"
 #include "irrArray.h"
+#include "CResourceCache.h"
 
 namespace irr
 {
@@ -94,6 +95,18 @@ namespace scene
 		//! Clears all meshes that are held in the mesh cache but not used anywhere else.
 		virtual void clearUnusedMeshes() _IRR_OVERRIDE_;
 
+		//! Returns the mesh with this name or prepares loading it.
+		/** Only one thread loads a mesh, other threads asking for the same
+		name wait until it called endLoad().
+		\param name Name of the mesh in the cache.
+		\param load Set to true when the caller has to load the mesh. It must
+		call addMesh() if loading succeeds and endLoad() in any case.
+		\return The mesh if it is in the cache. */
+		IAnimatedMesh* beginLoad(const io::path& name, bool& load);
+
+		//! Ends a load started with beginLoad().
+		void endLoad(const io::path& name);
+
 	protected:
 
 		struct MeshEntry
@@ -104,15 +117,19 @@ namespace scene
 			}
 			io::SNamedPath NamedPath;
 			IAnimatedMesh* Mesh;
-
-			bool operator < (const MeshEntry& other) const
-			{
-				return (NamedPath < other.NamedPath);
-			}
 		};
 
-		//! loaded meshes
+		//! finds the entry of a mesh, Lock must be locked
+		s32 findMesh(const IMesh* const mesh) const;
+
+		//! loaded meshes in the order they were added
 		core::array<MeshEntry> Meshes;
+
+		//! index of Meshes by the internal names
+		CResourceCache<IAnimatedMesh> Index;
+
+		//! protects Meshes
+		mutable CReadWriteMutex Lock;
 	};
 
 
@@ -7,14 +7,92 @@
 #include "CMeshBuffer.h"
 #include "SAnimatedMesh.h"
 #include "os.h"
-#include "irrMap.h"
 #include "triangle3d.h"
+#include "CVertexHash.h"
 
 namespace irr
 {
 namespace scene
 {
 
+namespace
+{
+
+//! vertex comparisons for welding
+inline bool weldEquals(const video::S3DVertex& a, const video::S3DVertex& b, f32 tolerance)
+{
+	return a.Pos.equals(b.Pos, tolerance) &&
+		a.Normal.equals(b.Normal, tolerance) &&
+		a.TCoords.equals(b.TCoords) &&
+		(a.Color == b.Color);
+}
+
+inline bool weldEquals(const video::S3DVertex2TCoords& a, const video::S3DVertex2TCoords& b, f32 tolerance)
+{
+	return weldEquals((const video::S3DVertex&)a, (const video::S3DVertex&)b, tolerance) &&
+		a.TCoords2.equals(b.TCoords2);
+}
+
+inline bool weldEquals(const video::S3DVertexTangents& a, const video::S3DVertexTangents& b, f32 tolerance)
+{
+	return weldEquals((const video::S3DVertex&)a, (const video::S3DVertex&)b, tolerance) &&
+		a.Tangent.equals(b.Tangent, tolerance) &&
+		a.Binormal.equals(b.Binormal, tolerance);
+}
+
+//! CVertexHash predicate which compares vertices of a buffer to the current one
+template <class T>
+struct SWeldEquals
+{
+	SWeldEquals(const T* vertices, f32 tolerance)
+		: Vertices(vertices), Current(0), Tolerance(tolerance) {}
+
+	bool operator()(u32 index) const
+	{
+		return weldEquals(Vertices[Current], Vertices[index], Tolerance);
+	}
+
+	const T* Vertices;
+	u32 Current;
+	f32 Tolerance;
+};
+
+//! redirects each vertex to the first one it is equal to and copies the unique vertices
+/** Each vertex is compared to all vertices before it, as equality within a
+tolerance isn't transitive, and redirected where the lowest of those which
+are equal went. The hash makes that linear instead of quadratic time. */
+template <class T>
+void weldVertices(const T* v, u32 vertexCount, f32 tolerance,
+		core::array<u16>& redirects, core::array<T>& unique)
+{
+	f32 extent = 0.f;
+	for (u32 i=0; i < vertexCount; ++i)
+	{
+		extent = core::max_(extent, core::abs_(v[i].Pos.X),
+			core::max_(core::abs_(v[i].Pos.Y), core::abs_(v[i].Pos.Z)));
+	}
+
+	CVertexHash hash(tolerance, extent, vertexCount);
+	SWeldEquals<T> equal(v, tolerance);
+	unique.reallocate(vertexCount);
+
+	for (u32 i=0; i < vertexCount; ++i)
+	{
+		equal.Current = i;
+		const s32 j = hash.find(v[i].Pos, equal);
+		hash.add(v[i].Pos);
+		if (j >= 0)
+			redirects[i] = redirects[j];
+		else
+		{
+			redirects[i] = unique.size();
+			unique.push_back(v[i]);
+		}
+	}
+}
+
+} // end anonymous namespace
+
 static inline core::vector3df getAngleWeight(const core::vector3df& v1,
 		const core::vector3df& v2,
 		const core::vector3df& v3)
@@ -799,29 +877,7 @@ IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
 			indexCount = mb->getIndexCount();
 			outIdx = &buffer->Indices;
 
-			buffer->Vertices.reallocate(vertexCount);
-
-			for (u32 i=0; i < vertexCount; ++i)
-			{
-				bool found = false;
-				for (u32 j=0; j < i; ++j)
-				{
-					if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
-						 v[i].Normal.equals( v[j].Normal, tolerance) &&
-						 v[i].TCoords.equals( v[j].TCoords ) &&
-						(v[i].Color == v[j].Color) )
-					{
-						redirects[i] = redirects[j];
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					redirects[i] = buffer->Vertices.size();
-					buffer->Vertices.push_back(v[i]);
-				}
-			}
+			weldVertices(v, vertexCount, tolerance, redirects, buffer->Vertices);
 
 			break;
 		}
@@ -842,30 +898,7 @@ IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
 			indexCount = mb->getIndexCount();
 			outIdx = &buffer->Indices;
 
-			buffer->Vertices.reallocate(vertexCount);
-
-			for (u32 i=0; i < vertexCount; ++i)
-			{
-				bool found = false;
-				for (u32 j=0; j < i; ++j)
-				{
-					if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
-						 v[i].Normal.equals( v[j].Normal, tolerance) &&
-						 v[i].TCoords.equals( v[j].TCoords ) &&
-						 v[i].TCoords2.equals( v[j].TCoords2 ) &&
-						(v[i].Color == v[j].Color) )
-					{
-						redirects[i] = redirects[j];
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					redirects[i] = buffer->Vertices.size();
-					buffer->Vertices.push_back(v[i]);
-				}
-			}
+			weldVertices(v, vertexCount, tolerance, redirects, buffer->Vertices);
 			break;
 		}
 		case video::EVT_TANGENTS:
@@ -885,31 +918,7 @@ IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
 			indexCount = mb->getIndexCount();
 			outIdx = &buffer->Indices;
 
-			buffer->Vertices.reallocate(vertexCount);
-
-			for (u32 i=0; i < vertexCount; ++i)
-			{
-				bool found = false;
-				for (u32 j=0; j < i; ++j)
-				{
-					if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
-						 v[i].Normal.equals( v[j].Normal, tolerance) &&
-						 v[i].TCoords.equals( v[j].TCoords ) &&
-						 v[i].Tangent.equals( v[j].Tangent, tolerance ) &&
-						 v[i].Binormal.equals( v[j].Binormal, tolerance ) &&
-						(v[i].Color == v[j].Color) )
-					{
-						redirects[i] = redirects[j];
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					redirects[i] = buffer->Vertices.size();
-					buffer->Vertices.push_back(v[i]);
-				}
-			}
+			weldVertices(v, vertexCount, tolerance, redirects, buffer->Vertices);
 			break;
 		}
 		default:
@@ -1776,8 +1785,7 @@ IMesh* CMeshManipulator::createForsythOptimizedMesh(const IMesh *mesh) const
 				buf->Vertices.reallocate(vcount);
 				buf->Indices.reallocate(icount);
 
-				core::map<const video::S3DVertex, const u16> sind; // search index for fast operation
-				typedef core::map<const video::S3DVertex, const u16>::Node snode;
+				CVertexHash sind(0.f, 0.f, vcount); // search index for fast operation
 
 				// Main algorithm
 				u32 highest = 0;
@@ -1807,45 +1815,45 @@ IMesh* CMeshManipulator::createForsythOptimizedMesh(const IMesh *mesh) const
 					// Output the best triangle
 					u16 newind = buf->Vertices.size();
 
-					snode *s = sind.find(v[tc[highest].ind[0]]);
+					s32 s = findVertex(sind, buf->Vertices, v[tc[highest].ind[0]]);
 
-					if (!s)
+					if (s < 0)
 					{
 						buf->Vertices.push_back(v[tc[highest].ind[0]]);
 						buf->Indices.push_back(newind);
-						sind.insert(v[tc[highest].ind[0]], newind);
+						sind.add(v[tc[highest].ind[0]].Pos);
 						newind++;
 					}
 					else
 					{
-						buf->Indices.push_back(s->getValue());
+						buf->Indices.push_back((u16)s);
 					}
 
-					s = sind.find(v[tc[highest].ind[1]]);
+					s = findVertex(sind, buf->Vertices, v[tc[highest].ind[1]]);
 
-					if (!s)
+					if (s < 0)
 					{
 						buf->Vertices.push_back(v[tc[highest].ind[1]]);
 						buf->Indices.push_back(newind);
-						sind.insert(v[tc[highest].ind[1]], newind);
+						sind.add(v[tc[highest].ind[1]].Pos);
 						newind++;
 					}
 					else
 					{
-						buf->Indices.push_back(s->getValue());
+						buf->Indices.push_back((u16)s);
 					}
 
-					s = sind.find(v[tc[highest].ind[2]]);
+					s = findVertex(sind, buf->Vertices, v[tc[highest].ind[2]]);
 
-					if (!s)
+					if (s < 0)
 					{
 						buf->Vertices.push_back(v[tc[highest].ind[2]]);
 						buf->Indices.push_back(newind);
-						sind.insert(v[tc[highest].ind[2]], newind);
+						sind.add(v[tc[highest].ind[2]].Pos);
 					}
 					else
 					{
-						buf->Indices.push_back(s->getValue());
+						buf->Indices.push_back((u16)s);
 					}
 
 					vc[tc[highest].ind[0]].NumActiveTris--;
@@ -1888,8 +1896,7 @@ IMesh* CMeshManipulator::createForsythOptimizedMesh(const IMesh *mesh) const
 				buf->Vertices.reallocate(vcount);
 				buf->Indices.reallocate(icount);
 
-				core::map<const video::S3DVertex2TCoords, const u16> sind; // search index for fast operation
-				typedef core::map<const video::S3DVertex2TCoords, const u16>::Node snode;
+				CVertexHash sind(0.f, 0.f, vcount); // search index for fast operation
 
 				// Main algorithm
 				u32 highest = 0;
@@ -1919,45 +1926,45 @@ IMesh* CMeshManipulator::createForsythOptimizedMesh(const IMesh *mesh) const
 					// Output the best triangle
 					u16 newind = buf->Vertices.size();
 
-					snode *s = sind.find(v[tc[highest].ind[0]]);
+					s32 s = findVertex(sind, buf->Vertices, v[tc[highest].ind[0]]);
 
-					if (!s)
+					if (s < 0)
 					{
 						buf->Vertices.push_back(v[tc[highest].ind[0]]);
 						buf->Indices.push_back(newind);
-						sind.insert(v[tc[highest].ind[0]], newind);
+						sind.add(v[tc[highest].ind[0]].Pos);
 						newind++;
 					}
 					else
 					{
-						buf->Indices.push_back(s->getValue());
+						buf->Indices.push_back((u16)s);
 					}
 
-					s = sind.find(v[tc[highest].ind[1]]);
+					s = findVertex(sind, buf->Vertices, v[tc[highest].ind[1]]);
 
-					if (!s)
+					if (s < 0)
 					{
 						buf->Vertices.push_back(v[tc[highest].ind[1]]);
 						buf->Indices.push_back(newind);
-						sind.insert(v[tc[highest].ind[1]], newind);
+						sind.add(v[tc[highest].ind[1]].Pos);
 						newind++;
 					}
 					else
 					{
-						buf->Indices.push_back(s->getValue());
+						buf->Indices.push_back((u16)s);
 					}
 
-					s = sind.find(v[tc[highest].ind[2]]);
+					s = findVertex(sind, buf->Vertices, v[tc[highest].ind[2]]);
 
-					if (!s)
+					if (s < 0)
 					{
 						buf->Vertices.push_back(v[tc[highest].ind[2]]);
 						buf->Indices.push_back(newind);
-						sind.insert(v[tc[highest].ind[2]], newind);
+						sind.add(v[tc[highest].ind[2]].Pos);
 					}
 					else
 					{
-						buf->Indices.push_back(s->getValue());
+						buf->Indices.push_back((u16)s);
 					}
 
 					vc[tc[highest].ind[0]].NumActiveTris--;
@@ -2001,8 +2008,7 @@ IMesh* CMeshManipulator::createForsythOptimizedMesh(const IMesh *mesh) const
 				buf->Vertices.reallocate(vcount);
 				buf->Indices.reallocate(icount);
 
-				core::map<const video::S3DVertexTangents, const u16> sind; // search index for fast operation
-				typedef core::map<const video::S3DVertexTangents, const u16>::Node snode;
+				CVertexHash sind(0.f, 0.f, vcount); // search index for fast operation
 
 				// Main algorithm
 				u32 highest = 0;
@@ -2032,45 +2038,45 @@ IMesh* CMeshManipulator::createForsythOptimizedMesh(const IMesh *mesh) const
 					// Output the best triangle
 					u16 newind = buf->Vertices.size();
 
-					snode *s = sind.find(v[tc[highest].ind[0]]);
+					s32 s = findVertex(sind, buf->Vertices, v[tc[highest].ind[0]]);
 
-					if (!s)
+					if (s < 0)
 					{
 						buf->Vertices.push_back(v[tc[highest].ind[0]]);
 						buf->Indices.push_back(newind);
-						sind.insert(v[tc[highest].ind[0]], newind);
+						sind.add(v[tc[highest].ind[0]].Pos);
 						newind++;
 					}
 					else
 					{
-						buf->Indices.push_back(s->getValue());
+						buf->Indices.push_back((u16)s);
 					}
 
-					s = sind.find(v[tc[highest].ind[1]]);
+					s = findVertex(sind, buf->Vertices, v[tc[highest].ind[1]]);
 
-					if (!s)
+					if (s < 0)
 					{
 						buf->Vertices.push_back(v[tc[highest].ind[1]]);
 						buf->Indices.push_back(newind);
-						sind.insert(v[tc[highest].ind[1]], newind);
+						sind.add(v[tc[highest].ind[1]].Pos);
 						newind++;
 					}
 					else
 					{
-						buf->Indices.push_back(s->getValue());
+						buf->Indices.push_back((u16)s);
 					}
 
-					s = sind.find(v[tc[highest].ind[2]]);
+					s = findVertex(sind, buf->Vertices, v[tc[highest].ind[2]]);
 
-					if (!s)
+					if (s < 0)
 					{
 						buf->Vertices.push_back(v[tc[highest].ind[2]]);
 						buf->Indices.push_back(newind);
-						sind.insert(v[tc[highest].ind[2]], newind);
+						sind.add(v[tc[highest].ind[2]].Pos);
 					}
 					else
 					{
-						buf->Indices.push_back(s->getValue());
+						buf->Indices.push_back((u16)s);
 					}
 
 					vc[tc[highest].ind[0]].NumActiveTris--;
@@ -288,6 +288,7 @@ void CMeshSceneNode::setMesh(IMesh* mesh)
 
 		Mesh = mesh;
 		copyMaterials();
+		SceneManager->updateSceneNodeIndex(this);
 	}
 }
 
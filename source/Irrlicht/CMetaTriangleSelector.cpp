@@ -134,6 +134,72 @@ void CMetaTriangleSelector::getTriangles(core::triangle3df* triangles, s32 array
 }
 
 
+//! Gets all triangles which may lie within a view frustum.
+void CMetaTriangleSelector::getTriangles(core::triangle3df* triangles, s32 arraySize,
+		s32& outTriangleCount, const SViewFrustum& frustum,
+		const core::matrix4* transform, bool useNodeTransform,
+		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const
+{
+	s32 outWritten = 0;
+	irr::u32 outTriangleInfoSize = outTriangleInfo ? outTriangleInfo->size() : 0;
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	{
+		s32 t = 0;
+		TriangleSelectors[i]->getTriangles(triangles + outWritten,
+				arraySize - outWritten, t, frustum, transform, useNodeTransform, outTriangleInfo);
+
+		if ( outTriangleInfo )
+		{
+			irr::u32 newTriangleInfoSize = outTriangleInfo->size();
+			for ( u32 ti=outTriangleInfoSize; ti<newTriangleInfoSize; ++ti )
+			{
+				(*outTriangleInfo)[ti].RangeStart += outWritten;
+			}
+			outTriangleInfoSize = newTriangleInfoSize;
+		}
+
+		outWritten += t;
+		if (outWritten==arraySize)
+			break;
+	}
+
+	outTriangleCount = outWritten;
+}
+
+
+//! Check if all selectors in the collection can find collision points themselves
+bool CMetaTriangleSelector::isCollisionPointSupported() const
+{
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	{
+		if (!TriangleSelectors[i]->isCollisionPointSupported())
+			return false;
+	}
+	return !TriangleSelectors.empty();
+}
+
+
+//! Finds the nearest collision point of a 3d line and the triangles of all selectors
+bool CMetaTriangleSelector::getCollisionPoint(SCollisionHit& hitResult, const core::line3d<f32>& line,
+		bool useNodeTransform, bool anyHit) const
+{
+	// each hit shortens the line for the following selectors
+	core::line3df ray(line);
+	bool found = false;
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	{
+		if (TriangleSelectors[i]->getCollisionPoint(hitResult, ray, useNodeTransform, anyHit))
+		{
+			if (anyHit)
+				return true;
+			ray.end = hitResult.Intersection;
+			found = true;
+		}
+	}
+	return found;
+}
+
+
 //! Adds a triangle selector to the collection of triangle selectors
 //! in this metaTriangleSelector.
 void CMetaTriangleSelector::addTriangleSelector(ITriangleSelector* toAdd)
@@ -198,6 +264,14 @@ u32 CMetaTriangleSelector::getSelectorCount() const
 }
 
 
+//! Updates the triangles of all selectors of animated nodes
+void CMetaTriangleSelector::update() const
+{
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+		TriangleSelectors[i]->update();
+}
+
+
 /* Returns the TriangleSelector based on index based on getSelectorCount
 Only useful for MetaTriangleSelector others return 'this'
 */
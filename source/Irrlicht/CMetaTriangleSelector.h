@@ -44,6 +44,19 @@ public:
 		const core::matrix4* transform,	bool useNodeTransform, 
 		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const _IRR_OVERRIDE_;
 
+	//! Gets all triangles which may lie within a view frustum.
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize,
+		s32& outTriangleCount, const SViewFrustum& frustum,
+		const core::matrix4* transform,	bool useNodeTransform,
+		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const _IRR_OVERRIDE_;
+
+	//! Check if all selectors in the collection can find collision points themselves
+	virtual bool isCollisionPointSupported() const _IRR_OVERRIDE_;
+
+	//! Finds the nearest collision point of a 3d line and the triangles of all selectors
+	virtual bool getCollisionPoint(SCollisionHit& hitResult, const core::line3d<f32>& line,
+		bool useNodeTransform, bool anyHit) const _IRR_OVERRIDE_;
+
 	//! Adds a triangle selector to the collection of triangle selectors
 	//! in this metaTriangleSelector.
 	virtual void addTriangleSelector(ITriangleSelector* toAdd) _IRR_OVERRIDE_;
@@ -60,6 +73,9 @@ public:
 	// Get the number of TriangleSelectors that are part of this one
 	virtual u32 getSelectorCount() const _IRR_OVERRIDE_;
 
+	//! Updates the triangles of all selectors of animated nodes
+	virtual void update() const _IRR_OVERRIDE_;
+
 	// Get the TriangleSelector based on index based on getSelectorCount
 	virtual ITriangleSelector* getSelector(u32 index) _IRR_OVERRIDE_;
 
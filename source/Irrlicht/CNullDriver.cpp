@@ -14,6 +14,7 @@
 #include "IAnimatedMeshSceneNode.h"
 #include "CMeshManipulator.h"
 #include "CColorConverter.h"
+#include "CBlockCompressor.h"
 #include "IAttributeExchangingObject.h"
 #include "IRenderTarget.h"
 
@@ -86,7 +87,7 @@ IImageWriter* createImageWriterPPM();
 
 //! constructor
 CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize)
-	: SharedRenderTarget(0), CurrentRenderTarget(0), CurrentRenderTargetSize(0, 0), FileSystem(io), MeshManipulator(0),
+	: ImageThreads(0), SharedRenderTarget(0), CurrentRenderTarget(0), CurrentRenderTargetSize(0, 0), FileSystem(io), MeshManipulator(0),
 	ViewPort(0, 0, 0, 0), ScreenSize(screenSize), PrimitivesDrawn(0), MinVertexCountForVBO(500),
 	TextureCreationFlags(0), OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
 {
@@ -237,6 +238,9 @@ CNullDriver::~CNullDriver()
 
 	// delete hardware mesh buffers
 	removeAllHardwareBuffers();
+
+	if (ImageThreads)
+		ImageThreads->drop();
 }
 
 
@@ -308,10 +312,12 @@ void CNullDriver::deleteAllTextures()
 
 	// remove textures.
 
+	CWriteLock lock(TextureLock);
 	for (u32 i=0; i<Textures.size(); ++i)
 		Textures[i].Surface->drop();
 
 	Textures.clear();
+	TextureIndex.clear();
 
 	SharedDepthTextures.clear();
 }
@@ -379,12 +385,15 @@ void CNullDriver::removeTexture(ITexture* texture)
 	if (!texture)
 		return;
 
+	CWriteLock lock(TextureLock);
 	for (u32 i=0; i<Textures.size(); ++i)
 	{
 		if (Textures[i].Surface == texture)
 		{
+			TextureIndex.remove(texture->getName().getInternalName(), texture);
 			texture->drop();
 			Textures.erase(i);
+			--i;
 		}
 	}
 }
@@ -402,6 +411,7 @@ void CNullDriver::removeAllTextures()
 //! Returns a texture by index
 ITexture* CNullDriver::getTextureByIndex(u32 i)
 {
+	CReadLock lock(TextureLock);
 	if ( i < Textures.size() )
 		return Textures[i].Surface;
 
@@ -412,6 +422,7 @@ ITexture* CNullDriver::getTextureByIndex(u32 i)
 //! Returns amount of textures currently loaded
 u32 CNullDriver::getTextureCount() const
 {
+	CReadLock lock(TextureLock);
 	return Textures.size();
 }
 
@@ -421,12 +432,14 @@ void CNullDriver::renameTexture(ITexture* texture, const io::path& newName)
 {
 	// we can do a const_cast here safely, the name of the ITexture interface
 	// is just readonly to prevent the user changing the texture name without invoking
-	// this method, because the textures will need resorting afterwards
+	// this method, because the texture index needs to be updated
 
+	CWriteLock lock(TextureLock);
 	io::SNamedPath& name = const_cast<io::SNamedPath&>(texture->getName());
+	const bool cached = TextureIndex.remove(name.getInternalName(), texture);
 	name.setPath(newName);
-
-	Textures.sort();
+	if (cached)
+		TextureIndex.insert(name.getInternalName(), texture);
 }
 
 ITexture* CNullDriver::addTexture(const core::dimension2d<u32>& size, const io::path& name, ECOLOR_FORMAT format)
@@ -481,11 +494,18 @@ ITexture* CNullDriver::addTexture(const io::path& name, IImage* image)
 	core::array<IImage*> imageArray(1);
 	imageArray.push_back(image);
 
+	core::array<IImage*> compressedArray = createCompressedImages(imageArray);
+	if (compressedArray.size())
+		imageArray = compressedArray;
+
 	if (checkImage(imageArray))
 	{
-		t = createDeviceDependentTexture(name, image);
+		t = createDeviceDependentTexture(name, imageArray[0]);
 	}
 
+	for (u32 i = 0; i < compressedArray.size(); ++i)
+		compressedArray[i]->drop();
+
 	if (t)
 	{
 		addTexture(t);
@@ -511,11 +531,18 @@ ITexture* CNullDriver::addTextureCubemap(const io::path& name, IImage* imagePosX
 	imageArray.push_back(imagePosZ);
 	imageArray.push_back(imageNegZ);
 
+	core::array<IImage*> compressedArray = createCompressedImages(imageArray);
+	if (compressedArray.size())
+		imageArray = compressedArray;
+
 	if (checkImage(imageArray))
 	{
 		t = createDeviceDependentTextureCubemap(name, imageArray);
 	}
 
+	for (u32 i = 0; i < compressedArray.size(); ++i)
+		compressedArray[i]->drop();
+
 	if (t)
 	{
 		addTexture(t);
@@ -570,15 +597,28 @@ ITexture* CNullDriver::getTexture(const io::path& filename)
 	// Identify textures by their absolute filenames if possible.
 	const io::path absolutePath = FileSystem->getAbsolutePath(filename);
 
-	ITexture* texture = findTexture(absolutePath);
+	// threads asking for a texture which is being loaded wait for that load
+	const io::SNamedPath loadName(absolutePath);
+	bool load = false;
+	ITexture* texture = TextureIndex.beginLoad(loadName.getInternalName(), load);
 	if (texture)
 	{
 		texture->updateSource(ETS_FROM_CACHE);
 		return texture;
 	}
 
-	// Then try the raw filename, which might be in an Archive
-	texture = findTexture(filename);
+	texture = getUncachedTexture(filename, absolutePath);
+	TextureIndex.endLoad(loadName.getInternalName());
+
+	return texture;
+}
+
+
+//! opens and loads a texture which is not in the texture cache
+ITexture* CNullDriver::getUncachedTexture(const io::path& filename, const io::path& absolutePath)
+{
+	// Try the raw filename, which might be in an Archive
+	ITexture* texture = findTexture(filename);
 	if (texture)
 	{
 		texture->updateSource(ETS_FROM_CACHE);
@@ -667,6 +707,14 @@ video::ITexture* CNullDriver::loadTextureFromFile(io::IReadFile* file, const io:
 
 	core::array<IImage*> imageArray = createImagesFromFile(file, &type);
 
+	core::array<IImage*> compressedArray = createCompressedImages(imageArray);
+	if (compressedArray.size())
+	{
+		for (u32 i = 0; i < imageArray.size(); ++i)
+			imageArray[i]->drop();
+		imageArray = compressedArray;
+	}
+
 	if (checkImage(imageArray))
 	{
 		switch (type)
@@ -708,14 +756,9 @@ void CNullDriver::addTexture(video::ITexture* texture)
 		s.Surface = texture;
 		texture->grab();
 
+		CWriteLock lock(TextureLock);
 		Textures.push_back(s);
-
-		// the new texture is now at the end of the texture list. when searching for
-		// the next new texture, the texture array will be sorted and the index of this texture
-		// will be changed. to let the order be more consistent to the user, sort
-		// the textures now already although this isn't necessary:
-
-		Textures.sort();
+		TextureIndex.insert(texture->getName().getInternalName(), texture);
 	}
 }
 
@@ -723,15 +766,7 @@ void CNullDriver::addTexture(video::ITexture* texture)
 //! looks if the image is already loaded
 video::ITexture* CNullDriver::findTexture(const io::path& filename)
 {
-	SSurface s;
-	SDummyTexture dummy(filename, ETT_2D);
-	s.Surface = &dummy;
-
-	s32 index = Textures.binary_search(s);
-	if (index != -1)
-		return Textures[index].Surface;
-
-	return 0;
+	return TextureIndex.find(io::SNamedPath(filename).getInternalName());
 }
 
 ITexture* CNullDriver::createDeviceDependentTexture(const io::path& name, IImage* image)
@@ -1521,6 +1556,53 @@ bool CNullDriver::checkImage(const core::array<IImage*>& image) const
 	return status;
 }
 
+core::array<IImage*> CNullDriver::createCompressedImages(const core::array<IImage*>& image)
+{
+	core::array<IImage*> compressed;
+
+	if (!getTextureCreationFlag(ETCF_ALLOW_COMPRESSION) || !queryFeature(EVDF_TEXTURE_COMPRESSED_DXT) || image.empty())
+		return compressed;
+
+	// all images of a texture need the same format
+	ECOLOR_FORMAT format = ECF_DXT1;
+
+	for (u32 i = 0; i < image.size(); ++i)
+	{
+		if (!image[i])
+			return compressed;
+
+		const core::dimension2d<u32>& size = image[i]->getDimension();
+		if (size.getOptimalSize(true, false) != size || size.Width < 4 || size.Height < 4)
+			return compressed;
+
+		const ECOLOR_FORMAT imageFormat = CBlockCompressor::getCompressedFormat(image[i], getTextureCreationFlag(ETCF_NO_ALPHA_CHANNEL));
+		if (imageFormat == ECF_UNKNOWN)
+			return compressed;
+		if (imageFormat == ECF_DXT5)
+			format = ECF_DXT5;
+	}
+
+	compressed.reallocate(image.size());
+	for (u32 i = 0; i < image.size(); ++i)
+		compressed.push_back(CBlockCompressor::createCompressedImage(image[i], format,
+			getTextureCreationFlag(ETCF_CREATE_MIP_MAPS), getImageThreads()));
+
+	return compressed;
+}
+
+CThreadPool* CNullDriver::getImageThreads()
+{
+	if (!ImageThreads)
+		ImageThreads = new CThreadPool(0);
+
+	return ImageThreads;
+}
+
+E_IMAGE_FILTER CNullDriver::getMipMapFilter() const
+{
+	return getTextureCreationFlag(ETCF_OPTIMIZED_FOR_QUALITY) ? EIF_KAISER : EIF_BOX;
+}
+
 //! Enables or disables a texture creation flag.
 void CNullDriver::setTextureCreationFlag(E_TEXTURE_CREATION_FLAG flag, bool enabled)
 {
@@ -1784,6 +1866,28 @@ void CNullDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 }
 
 
+//! Draws a mesh buffer once for each world transformation
+void CNullDriver::drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+		const core::matrix4* transforms, const SColor* colors, u32 count)
+{
+	if (!mb || !count)
+		return;
+
+	// look up the hardware buffer only once
+	SHWBufferLink *HWBuffer=getBufferLink(mb);
+
+	for (u32 i=0; i<count; ++i)
+	{
+		setTransform(ETS_WORLD, transforms[i]);
+
+		if (HWBuffer)
+			drawHardwareBuffer(HWBuffer);
+		else
+			drawVertexPrimitiveList(mb->getVertices(), mb->getVertexCount(), mb->getIndices(), mb->getPrimitiveCount(), mb->getVertexType(), mb->getPrimitiveType(), mb->getIndexType());
+	}
+}
+
+
 //! Draws the normals of a mesh buffer
 void CNullDriver::drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length, SColor color)
 {
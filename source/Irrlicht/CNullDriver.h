@@ -21,6 +21,7 @@
 #include "SVertexIndex.h"
 #include "SLight.h"
 #include "SExposedVideoData.h"
+#include "CResourceCache.h"
 
 #ifdef _MSC_VER
 #pragma warning( disable: 4996)
@@ -378,6 +379,10 @@ namespace video
 		//! Draws a mesh buffer
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) _IRR_OVERRIDE_;
 
+		//! Draws a mesh buffer once for each world transformation
+		virtual void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+			const core::matrix4* transforms, const SColor* colors, u32 count) _IRR_OVERRIDE_;
+
 		//! Draws the normals of a mesh buffer
 		virtual void drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length=10.f,
 			SColor color=0xffffffff) _IRR_OVERRIDE_;
@@ -685,6 +690,13 @@ namespace video
 				const c8* name=0);
 
 		virtual bool checkDriverReset() _IRR_OVERRIDE_ {return false;}
+
+		//! Threads compressing and resampling texture images, created when used first.
+		CThreadPool* getImageThreads();
+
+		//! Filter for mip map levels created by the engine.
+		/** Kaiser with ETCF_OPTIMIZED_FOR_QUALITY, box otherwise. */
+		E_IMAGE_FILTER getMipMapFilter() const;
 	protected:
 
 		//! deletes all textures
@@ -693,6 +705,9 @@ namespace video
 		//! opens the file and loads it into the surface
 		video::ITexture* loadTextureFromFile(io::IReadFile* file, const io::path& hashName = "");
 
+		//! opens and loads a texture which is not in the texture cache
+		video::ITexture* getUncachedTexture(const io::path& filename, const io::path& absolutePath);
+
 		//! adds a surface, not loaded or created by the Irrlicht Engine
 		void addTexture(video::ITexture* surface);
 
@@ -705,6 +720,10 @@ namespace video
 
 		bool checkImage(const core::array<IImage*>& image) const;
 
+		//! Creates DXT copies of the images if ETCF_ALLOW_COMPRESSION is enabled.
+		/** \return The grabbed copies, or an empty array if the images are not compressed. */
+		core::array<IImage*> createCompressedImages(const core::array<IImage*>& image);
+
 		// adds a material renderer and drops it afterwards. To be used for internal creation
 		s32 addAndDropMaterialRenderer(IMaterialRenderer* m);
 
@@ -766,11 +785,6 @@ namespace video
 		struct SSurface
 		{
 			video::ITexture* Surface;
-
-			bool operator < (const SSurface& other) const
-			{
-				return Surface->getName() < other.Surface->getName();
-			}
 		};
 
 		struct SMaterialRenderer
@@ -787,8 +801,18 @@ namespace video
 			virtual void unlock()_IRR_OVERRIDE_ {}
 			virtual void regenerateMipMapLevels(void* data = 0, u32 layer = 0) _IRR_OVERRIDE_ {}
 		};
+		//! textures in the order they were added
 		core::array<SSurface> Textures;
 
+		//! index of Textures by the internal names
+		CResourceCache<ITexture> TextureIndex;
+
+		//! protects Textures
+		mutable CReadWriteMutex TextureLock;
+
+		//! threads compressing and resampling texture images
+		CThreadPool* ImageThreads;
+
 		struct SOccQuery
 		{
 			SOccQuery(scene::ISceneNode* node, const scene::IMesh* mesh=0) : Node(node), Mesh(mesh), PID(0), Result(0xffffffff), Run(0xffffffff)
@@ -89,9 +89,16 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	const io::path fullName = file->getFileName();
 	const io::path relPath = FileSystem->getFileDir(fullName)+"/";
 
-	c8* buf = new c8[filesize];
-	memset(buf, 0, filesize);
-	file->read((void*)buf, filesize);
+	// parse files which are in memory already without copying them
+	const c8* buf = (const c8*)file->getData();
+	c8* readBuf = 0;
+	if (!buf)
+	{
+		readBuf = new c8[filesize];
+		memset(readBuf, 0, filesize);
+		file->read((void*)readBuf, filesize);
+		buf = readBuf;
+	}
 	const c8* const bufEnd = buf+filesize;
 
 	// Process obj information
@@ -240,7 +247,7 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 				else
 				{
 					os::Printer::log("Invalid vertex index in this line:", wordBuffer.c_str(), ELL_ERROR);
-					delete [] buf;
+					delete [] readBuf;
 					return 0;
 				}
 				if ( -1 != Idx[1] && Idx[1] < (irr::s32)textureCoordBuffer.size() )
@@ -255,17 +262,11 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 					currMtl->RecalculateNormals=true;
 				}
 
-				int vertLocation;
-				core::map<video::S3DVertex, int>::Node* n = currMtl->VertMap.find(v);
-				if (n)
-				{
-					vertLocation = n->getValue();
-				}
-				else
+				int vertLocation = findVertex(currMtl->VertMap, currMtl->Meshbuffer->Vertices, v);
+				if (vertLocation < 0)
 				{
 					currMtl->Meshbuffer->Vertices.push_back(v);
-					vertLocation = currMtl->Meshbuffer->Vertices.size() -1;
-					currMtl->VertMap.insert(v, vertLocation);
+					vertLocation = currMtl->VertMap.add(v.Pos);
 				}
 
 				faceCorners.push_back(vertLocation);
@@ -329,7 +330,7 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	}
 
 	// Clean up the allocate obj file contents
-	delete [] buf;
+	delete [] readBuf;
 	// more cleaning up
 	cleanUp();
 	mesh->drop();
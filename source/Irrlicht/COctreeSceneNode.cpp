@@ -650,6 +650,7 @@ void COctreeSceneNode::deleteTree()
 void COctreeSceneNode::setMesh(IMesh* mesh)
 {
 	createTree(mesh);
+	SceneManager->updateSceneNodeIndex(this);
 }
 
 IMesh* COctreeSceneNode::getMesh(void)
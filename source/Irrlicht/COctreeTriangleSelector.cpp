@@ -185,7 +185,7 @@ void COctreeTriangleSelector::getTrianglesFromOctree(
 		s32 maximumSize, const core::aabbox3d<f32>& box,
 		const core::matrix4* mat, core::triangle3df* triangles) const
 {
-	if (!box.intersectsWithBox(node->Box))
+	if (trianglesWritten >= maximumSize || !box.intersectsWithBox(node->Box))
 		return;
 
 	const u32 cnt = node->Triangles.size();
@@ -16,6 +16,7 @@
 #include "os.h"
 #include "CImage.h"
 #include "CColorConverter.h"
+#include "CImageResampler.h"
 
 namespace irr
 {
@@ -71,7 +72,7 @@ public:
 
 				if (image[i]->getDimension() == Size)
 					image[i]->copyTo(Image[i]);
-				else
+				else if (!CImageResampler::resample(image[i], Image[i], EIF_BILINEAR, Driver->getImageThreads()))
 					image[i]->copyToScaling(Image[i]);
 			}
 
@@ -108,15 +109,28 @@ public:
 
 		bool autoGenerateRequired = true;
 
+		// the levels are filtered here if the hardware can't create them or if the quality matters more
+		const bool resampleMipMaps = HasMipMaps &&
+			(!AutoGenerateMipMaps || Driver->getTextureCreationFlag(ETCF_OPTIMIZED_FOR_QUALITY));
+
 		for (u32 i = 0; i < (*tmpImage).size(); ++i)
 		{
 			void* mipmapsData = (*tmpImage)[i]->getMipMapsData();
 
+			u8* resampledData = 0;
+			if (!mipmapsData && resampleMipMaps)
+			{
+				resampledData = CImageResampler::createMipMapsData((*tmpImage)[i], Driver->getMipMapFilter(), Driver->getImageThreads());
+				mipmapsData = resampledData;
+			}
+
 			if (autoGenerateRequired || mipmapsData)
 				regenerateMipMapLevels(mipmapsData, i);
 
 			if (!mipmapsData)
 				autoGenerateRequired = false;
+
+			delete [] resampledData;
 		}
 
 		if (!KeepImage)
@@ -34,7 +34,7 @@ const u16 COpenGLDriver::Quad2DIndices[4] = { 0, 1, 2, 3 };
 
 #if defined(_IRR_COMPILE_WITH_WINDOWS_DEVICE_) || defined(_IRR_COMPILE_WITH_X11_DEVICE_) || defined(_IRR_COMPILE_WITH_OSX_DEVICE_)
 COpenGLDriver::COpenGLDriver(const SIrrlichtCreationParameters& params, io::IFileSystem* io, IContextManager* contextManager)
-	: CNullDriver(io, params.WindowSize), COpenGLExtensionHandler(), CacheHandler(0), CurrentRenderMode(ERM_NONE), ResetRenderStates(true),
+	: CNullDriver(io, params.WindowSize), COpenGLExtensionHandler(), CacheHandler(0), InstanceCount(0), CurrentRenderMode(ERM_NONE), ResetRenderStates(true),
 	Transformation3DChanged(true), AntiAlias(params.AntiAlias), ColorFormat(ECF_R8G8B8), FixedPipelineState(EOFPS_ENABLE), Params(params),
 	ContextManager(contextManager),
 #if defined(_IRR_COMPILE_WITH_WINDOWS_DEVICE_)
@@ -54,7 +54,7 @@ COpenGLDriver::COpenGLDriver(const SIrrlichtCreationParameters& params, io::IFil
 #ifdef _IRR_COMPILE_WITH_SDL_DEVICE_
 COpenGLDriver::COpenGLDriver(const SIrrlichtCreationParameters& params, io::IFileSystem* io, CIrrDeviceSDL* device)
 	: CNullDriver(io, params.WindowSize), COpenGLExtensionHandler(), CacheHandler(0),
-	CurrentRenderMode(ERM_NONE), ResetRenderStates(true), Transformation3DChanged(true),
+	InstanceCount(0), CurrentRenderMode(ERM_NONE), ResetRenderStates(true), Transformation3DChanged(true),
 	AntiAlias(params.AntiAlias), ColorFormat(ECF_R8G8B8), FixedPipelineState(EOFPS_ENABLE),
 	Params(params), SDLDevice(device), ContextManager(0), DeviceType(EIDT_SDL)
 {
@@ -680,6 +680,88 @@ void COpenGLDriver::drawHardwareBuffer(SHWBufferLink *_HWBuffer)
 }
 
 
+//! Draws a mesh buffer once for each world transformation, in one call with instanced shaders
+void COpenGLDriver::drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+		const core::matrix4* transforms, const SColor* colors, u32 count)
+{
+	if (!mb || !count)
+		return;
+
+	// the instance data is only read by GLSL shaders with the instance attributes
+	if (InstancedMaterialTypes.binary_search(Material.MaterialType) == -1)
+	{
+		CNullDriver::drawMeshBufferInstanced(mb, transforms, colors, count);
+		return;
+	}
+
+	// the shader applies the instance transformation
+	setTransform(ETS_WORLD, core::IdentityMatrix);
+
+	// single instances, other primitives than triangles and drivers without
+	// instanced arrays draw one after another with constant instance attributes
+	if (count == 1 || mb->getPrimitiveType() != scene::EPT_TRIANGLES ||
+		!FeatureAvailable[IRR_ARB_instanced_arrays] || !FeatureAvailable[IRR_ARB_draw_instanced])
+	{
+		for (u32 i=0; i<count; ++i)
+		{
+			for (u32 j=0; j<4; ++j)
+				extGlVertexAttrib4fv(COpenGLSLMaterialRenderer::EIA_WORLD + j, transforms[i].pointer() + j*4);
+
+			const SColor color = colors ? colors[i] : SColor(0xffffffff);
+			const GLfloat instanceColor[4] = { color.getRed() / 255.f, color.getGreen() / 255.f,
+				color.getBlue() / 255.f, color.getAlpha() / 255.f };
+			extGlVertexAttrib4fv(COpenGLSLMaterialRenderer::EIA_COLOR, instanceColor);
+
+			drawMeshBuffer(mb);
+		}
+		return;
+	}
+
+	InstanceColorBuffer.set_used(count*4);
+	for (u32 i=0; i<count; ++i)
+	{
+		const SColor color = colors ? colors[i] : SColor(0xffffffff);
+		InstanceColorBuffer[i*4+0] = (u8)color.getRed();
+		InstanceColorBuffer[i*4+1] = (u8)color.getGreen();
+		InstanceColorBuffer[i*4+2] = (u8)color.getBlue();
+		InstanceColorBuffer[i*4+3] = (u8)color.getAlpha();
+	}
+
+	// the instance data is read from client memory
+#if defined(GL_ARB_vertex_buffer_object)
+	if (FeatureAvailable[IRR_ARB_vertex_buffer_object])
+		extGlBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+
+	for (u32 i=0; i<4; ++i)
+	{
+		const GLuint location = COpenGLSLMaterialRenderer::EIA_WORLD + i;
+		extGlVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(core::matrix4), transforms[0].pointer() + i*4);
+		extGlVertexAttribDivisor(location, 1);
+		extGlEnableVertexAttribArray(location);
+	}
+
+	extGlVertexAttribPointer(COpenGLSLMaterialRenderer::EIA_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, InstanceColorBuffer.const_pointer());
+	extGlVertexAttribDivisor(COpenGLSLMaterialRenderer::EIA_COLOR, 1);
+	extGlEnableVertexAttribArray(COpenGLSLMaterialRenderer::EIA_COLOR);
+
+	InstanceCount = count;
+	drawMeshBuffer(mb);
+	InstanceCount = 0;
+
+	// drawVertexPrimitiveList counted only one instance
+	PrimitivesDrawn += mb->getPrimitiveCount() * (count-1);
+
+	for (u32 i=0; i<4; ++i)
+	{
+		extGlVertexAttribDivisor(COpenGLSLMaterialRenderer::EIA_WORLD + i, 0);
+		extGlDisableVertexAttribArray(COpenGLSLMaterialRenderer::EIA_WORLD + i);
+	}
+	extGlVertexAttribDivisor(COpenGLSLMaterialRenderer::EIA_COLOR, 0);
+	extGlDisableVertexAttribArray(COpenGLSLMaterialRenderer::EIA_COLOR);
+}
+
+
 //! Create occlusion query.
 /** Use node for identification and mesh for occlusion test. */
 void COpenGLDriver::addOcclusionQuery(scene::ISceneNode* node,
@@ -1114,7 +1196,10 @@ void COpenGLDriver::renderArray(const void* indexList, u32 primitiveCount,
 			glDrawElements(GL_TRIANGLE_FAN, primitiveCount+2, indexSize, indexList);
 			break;
 		case scene::EPT_TRIANGLES:
-			glDrawElements(GL_TRIANGLES, primitiveCount*3, indexSize, indexList);
+			if (InstanceCount)
+				extGlDrawElementsInstanced(GL_TRIANGLES, primitiveCount*3, indexSize, indexList, InstanceCount);
+			else
+				glDrawElements(GL_TRIANGLES, primitiveCount*3, indexSize, indexList);
 			break;
 		case scene::EPT_QUAD_STRIP:
 			glDrawElements(GL_QUAD_STRIP, primitiveCount*2+2, indexSize, indexList);
@@ -3725,6 +3810,9 @@ s32 COpenGLDriver::addHighLevelShaderMaterial(
 			inType, outType, verticesOut,
 			callback,baseMaterial, userData);
 
+	if (nr != -1 && r->isInstanced())
+		InstancedMaterialTypes.push_back(nr);
+
 	r->drop();
 
 	return nr;
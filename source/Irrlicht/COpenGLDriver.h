@@ -88,6 +88,10 @@ namespace video
 		//! Draw hardware buffer
 		virtual void drawHardwareBuffer(SHWBufferLink *HWBuffer) _IRR_OVERRIDE_;
 
+		//! Draws a mesh buffer once for each world transformation, in one call with instanced shaders
+		virtual void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+			const core::matrix4* transforms, const SColor* colors, u32 count) _IRR_OVERRIDE_;
+
 		//! Create occlusion query.
 		/** Use node for identification and mesh for occlusion test. */
 		virtual void addOcclusionQuery(scene::ISceneNode* node,
@@ -453,6 +457,13 @@ namespace video
 		core::matrix4 Matrices[ETS_COUNT];
 		core::array<u8> ColorBuffer;
 
+		//! instance colors as RGBA bytes
+		core::array<u8> InstanceColorBuffer;
+		//! material types of GLSL shaders reading the instance attributes
+		core::array<s32> InstancedMaterialTypes;
+		//! number of instances drawn by renderArray(), 0 for a normal draw call
+		GLsizei InstanceCount;
+
 		//! enumeration for rendering modes such as 2d and 3d for minizing the switching of renderStates.
 		enum E_RENDER_MODE
 		{
@@ -78,7 +78,11 @@ COpenGLExtensionHandler::COpenGLExtensionHandler() :
 	pGlEnableIndexedEXT(0), pGlDisableIndexedEXT(0),
 	pGlColorMaskIndexedEXT(0),
 	pGlBlendFuncIndexedAMD(0), pGlBlendFunciARB(0), pGlBlendFuncSeparateIndexedAMD(0), pGlBlendFuncSeparateiARB(0),
-	pGlBlendEquationIndexedAMD(0), pGlBlendEquationiARB(0), pGlBlendEquationSeparateIndexedAMD(0), pGlBlendEquationSeparateiARB(0)
+	pGlBlendEquationIndexedAMD(0), pGlBlendEquationiARB(0), pGlBlendEquationSeparateIndexedAMD(0), pGlBlendEquationSeparateiARB(0),
+	// Vertex attributes and instancing
+	pGlBindAttribLocation(0), pGlGetAttribLocation(0), pGlVertexAttribPointer(0), pGlVertexAttrib4fv(0),
+	pGlEnableVertexAttribArray(0), pGlDisableVertexAttribArray(0),
+	pGlVertexAttribDivisorARB(0), pGlDrawElementsInstancedARB(0)
 #if defined(GLX_SGI_swap_control)
 	,pGlxSwapIntervalSGI(0)
 #endif
@@ -557,6 +561,16 @@ void COpenGLExtensionHandler::initExtensions(bool stencilBuffer)
 	pGlBlendEquationSeparateIndexedAMD = (PFNGLBLENDEQUATIONSEPARATEINDEXEDAMDPROC) IRR_OGL_LOAD_EXTENSION("glBlendEquationSeparateIndexedAMD");
 	pGlBlendEquationSeparateiARB = (PFNGLBLENDEQUATIONSEPARATEIPROC) IRR_OGL_LOAD_EXTENSION("glBlendEquationSeparateiARB");
 
+	// vertex attributes and instancing
+	pGlBindAttribLocation = (PFNGLBINDATTRIBLOCATIONPROC) IRR_OGL_LOAD_EXTENSION("glBindAttribLocation");
+	pGlGetAttribLocation = (PFNGLGETATTRIBLOCATIONPROC) IRR_OGL_LOAD_EXTENSION("glGetAttribLocation");
+	pGlVertexAttribPointer = (PFNGLVERTEXATTRIBPOINTERPROC) IRR_OGL_LOAD_EXTENSION("glVertexAttribPointer");
+	pGlVertexAttrib4fv = (PFNGLVERTEXATTRIB4FVPROC) IRR_OGL_LOAD_EXTENSION("glVertexAttrib4fv");
+	pGlEnableVertexAttribArray = (PFNGLENABLEVERTEXATTRIBARRAYPROC) IRR_OGL_LOAD_EXTENSION("glEnableVertexAttribArray");
+	pGlDisableVertexAttribArray = (PFNGLDISABLEVERTEXATTRIBARRAYPROC) IRR_OGL_LOAD_EXTENSION("glDisableVertexAttribArray");
+	pGlVertexAttribDivisorARB = (PFNGLVERTEXATTRIBDIVISORARBPROC) IRR_OGL_LOAD_EXTENSION("glVertexAttribDivisorARB");
+	pGlDrawElementsInstancedARB = (PFNGLDRAWELEMENTSINSTANCEDARBPROC) IRR_OGL_LOAD_EXTENSION("glDrawElementsInstancedARB");
+
 	// get vsync extension
 	#if defined(WGL_EXT_swap_control) && !defined(_IRR_COMPILE_WITH_SDL_DEVICE_)
 		pWglSwapIntervalEXT = (PFNWGLSWAPINTERVALEXTPROC) IRR_OGL_LOAD_EXTENSION("wglSwapIntervalEXT");
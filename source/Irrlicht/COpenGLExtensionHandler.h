@@ -1180,6 +1180,16 @@ class COpenGLExtensionHandler
 	void irrGlBlendEquationIndexed(GLuint buf, GLenum mode);
 	void irrGlBlendEquationSeparateIndexed(GLuint buf, GLenum modeRGB, GLenum modeAlpha);
 
+	// vertex attributes and instancing
+	void extGlBindAttribLocation(GLuint program, GLuint index, const GLchar *name);
+	GLint extGlGetAttribLocation(GLuint program, const GLchar *name);
+	void extGlVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer);
+	void extGlVertexAttrib4fv(GLuint index, const GLfloat *v);
+	void extGlEnableVertexAttribArray(GLuint index);
+	void extGlDisableVertexAttribArray(GLuint index);
+	void extGlVertexAttribDivisor(GLuint index, GLuint divisor);
+	void extGlDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei primcount);
+
 	// generic vsync setting method for several extensions
 	void extGlSwapInterval(int interval);
 
@@ -1325,6 +1335,15 @@ class COpenGLExtensionHandler
 		PFNGLBLENDEQUATIONIPROC pGlBlendEquationiARB;
 		PFNGLBLENDEQUATIONSEPARATEINDEXEDAMDPROC pGlBlendEquationSeparateIndexedAMD;
 		PFNGLBLENDEQUATIONSEPARATEIPROC pGlBlendEquationSeparateiARB;
+		// Vertex attributes and instancing
+		PFNGLBINDATTRIBLOCATIONPROC pGlBindAttribLocation;
+		PFNGLGETATTRIBLOCATIONPROC pGlGetAttribLocation;
+		PFNGLVERTEXATTRIBPOINTERPROC pGlVertexAttribPointer;
+		PFNGLVERTEXATTRIB4FVPROC pGlVertexAttrib4fv;
+		PFNGLENABLEVERTEXATTRIBARRAYPROC pGlEnableVertexAttribArray;
+		PFNGLDISABLEVERTEXATTRIBARRAYPROC pGlDisableVertexAttribArray;
+		PFNGLVERTEXATTRIBDIVISORARBPROC pGlVertexAttribDivisorARB;
+		PFNGLDRAWELEMENTSINSTANCEDARBPROC pGlDrawElementsInstancedARB;
 		#if defined(WGL_EXT_swap_control)
 		PFNWGLSWAPINTERVALEXTPROC pWglSwapIntervalEXT;
 		#endif
@@ -2688,6 +2707,103 @@ inline void COpenGLExtensionHandler::irrGlBlendEquationSeparateIndexed(GLuint bu
 #endif
 }
 
+inline void COpenGLExtensionHandler::extGlBindAttribLocation(GLuint program, GLuint index, const GLchar *name)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlBindAttribLocation)
+		pGlBindAttribLocation(program, index, name);
+#elif defined(GL_VERSION_2_0)
+	glBindAttribLocation(program, index, name);
+#else
+	os::Printer::log("glBindAttribLocation not supported", ELL_ERROR);
+#endif
+}
+
+inline GLint COpenGLExtensionHandler::extGlGetAttribLocation(GLuint program, const GLchar *name)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlGetAttribLocation)
+		return pGlGetAttribLocation(program, name);
+#elif defined(GL_VERSION_2_0)
+	return glGetAttribLocation(program, name);
+#else
+	os::Printer::log("glGetAttribLocation not supported", ELL_ERROR);
+#endif
+	return -1;
+}
+
+inline void COpenGLExtensionHandler::extGlVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlVertexAttribPointer)
+		pGlVertexAttribPointer(index, size, type, normalized, stride, pointer);
+#elif defined(GL_VERSION_2_0)
+	glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+#else
+	os::Printer::log("glVertexAttribPointer not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlVertexAttrib4fv(GLuint index, const GLfloat *v)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlVertexAttrib4fv)
+		pGlVertexAttrib4fv(index, v);
+#elif defined(GL_VERSION_2_0)
+	glVertexAttrib4fv(index, v);
+#else
+	os::Printer::log("glVertexAttrib4fv not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlEnableVertexAttribArray(GLuint index)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlEnableVertexAttribArray)
+		pGlEnableVertexAttribArray(index);
+#elif defined(GL_VERSION_2_0)
+	glEnableVertexAttribArray(index);
+#else
+	os::Printer::log("glEnableVertexAttribArray not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlDisableVertexAttribArray(GLuint index)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlDisableVertexAttribArray)
+		pGlDisableVertexAttribArray(index);
+#elif defined(GL_VERSION_2_0)
+	glDisableVertexAttribArray(index);
+#else
+	os::Printer::log("glDisableVertexAttribArray not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlVertexAttribDivisorARB)
+		pGlVertexAttribDivisorARB(index, divisor);
+#elif defined(GL_ARB_instanced_arrays)
+	glVertexAttribDivisorARB(index, divisor);
+#else
+	os::Printer::log("glVertexAttribDivisor not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei primcount)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlDrawElementsInstancedARB)
+		pGlDrawElementsInstancedARB(mode, count, type, indices, primcount);
+#elif defined(GL_ARB_draw_instanced)
+	glDrawElementsInstancedARB(mode, count, type, indices, primcount);
+#else
+	os::Printer::log("glDrawElementsInstanced not supported", ELL_ERROR);
+#endif
+}
+
 inline void COpenGLExtensionHandler::extGlSwapInterval(int interval)
 {
 	// we have wglext, so try to use that
@@ -48,7 +48,7 @@ COpenGLSLMaterialRenderer::COpenGLSLMaterialRenderer(video::COpenGLDriver* drive
 		IShaderConstantSetCallBack* callback,
 		E_MATERIAL_TYPE baseMaterial,
 		s32 userData)
-	: Driver(driver), CallBack(callback), Alpha(false), Blending(false), FixedBlending(false), AlphaTest(false), Program(0), Program2(0), UserData(userData)
+	: Driver(driver), CallBack(callback), Alpha(false), Blending(false), FixedBlending(false), AlphaTest(false), Instanced(false), Program(0), Program2(0), UserData(userData)
 {
 	#ifdef _DEBUG
 	setDebugName("COpenGLSLMaterialRenderer");
@@ -92,7 +92,7 @@ COpenGLSLMaterialRenderer::COpenGLSLMaterialRenderer(video::COpenGLDriver* drive
 COpenGLSLMaterialRenderer::COpenGLSLMaterialRenderer(COpenGLDriver* driver,
 					IShaderConstantSetCallBack* callback,
 					E_MATERIAL_TYPE baseMaterial, s32 userData)
-: Driver(driver), CallBack(callback), Alpha(false), Blending(false), FixedBlending(false), AlphaTest(false), Program(0), Program2(0), UserData(userData)
+: Driver(driver), CallBack(callback), Alpha(false), Blending(false), FixedBlending(false), AlphaTest(false), Instanced(false), Program(0), Program2(0), UserData(userData)
 {
 	switch (baseMaterial)
 	{
@@ -404,6 +404,10 @@ bool COpenGLSLMaterialRenderer::linkProgram()
 {
 	if (Program2)
 	{
+		// fixed locations for the instance data, names not used by the shaders are ignored
+		Driver->extGlBindAttribLocation(Program2, EIA_WORLD, "InstanceWorld");
+		Driver->extGlBindAttribLocation(Program2, EIA_COLOR, "InstanceColor");
+
 		Driver->extGlLinkProgram(Program2);
 
 		GLint status = 0;
@@ -432,6 +436,8 @@ bool COpenGLSLMaterialRenderer::linkProgram()
 			return false;
 		}
 
+		Instanced = (Driver->extGlGetAttribLocation(Program2, "InstanceWorld") == EIA_WORLD);
+
 		// get uniforms information
 
 		GLint num = 0;
@@ -83,6 +83,17 @@ public:
 	virtual bool setPixelShaderConstant(s32 index, const s32* ints, int count) _IRR_OVERRIDE_;
 	virtual IVideoDriver* getVideoDriver() _IRR_OVERRIDE_;
 
+	//! Attribute locations of the per instance data of COpenGLDriver::drawMeshBufferInstanced()
+	/** The world matrix uses four locations, one per column. */
+	enum E_INSTANCE_ATTRIBUTE
+	{
+		EIA_COLOR = 7,
+		EIA_WORLD = 12
+	};
+
+	//! Returns if the vertex shader reads the InstanceWorld attribute
+	bool isInstanced() const { return Instanced; }
+
 protected:
 
 	//! constructor only for use by derived classes who want to
@@ -111,6 +122,7 @@ protected:
 	bool Blending;
 	bool FixedBlending;
 	bool AlphaTest;
+	bool Instanced;
 
 	struct SUniformInfo
 	{
@@ -9,6 +9,7 @@
 #include "IMeshManipulator.h"
 #include "SMesh.h"
 #include "CDynamicMeshBuffer.h"
+#include "CVertexHash.h"
 #include "SAnimatedMesh.h"
 #include "IReadFile.h"
 #include "fast_atof.h"
@@ -259,6 +260,7 @@ IAnimatedMesh* CPLYMeshFileLoader::createMesh(io::IReadFile* file)
 						skipElement(*ElementList[i]);
 				}
 			}
+			weldVertices(mb);
 			mb->recalculateBoundingBox();
 			if (!hasNormals)
 				SceneManager->getMeshManipulator()->recalculateNormals(mb);
@@ -359,6 +361,46 @@ bool CPLYMeshFileLoader::readVertex(const SPLYElement &Element, scene::CDynamicM
 }
 
 
+//! merges equal vertices, some exporters write the corners of each face as vertices of their own
+void CPLYMeshFileLoader::weldVertices(scene::CDynamicMeshBuffer* mb) const
+{
+	scene::IVertexBuffer& vertices = mb->getVertexBuffer();
+	scene::IIndexBuffer& indices = mb->getIndexBuffer();
+	const u32 vertexCount = vertices.size();
+	if (!indices.size())
+		return;
+
+	// unique vertices are moved to the front, the hash has their new indices
+	video::S3DVertex* v = vertices.pointer();
+	core::array<u32> redirects(vertexCount);
+	redirects.set_used(vertexCount);
+	CVertexHash hash(0.f, 0.f, vertexCount);
+	u32 uniqueCount = 0;
+	for (u32 i=0; i<vertexCount; ++i)
+	{
+		s32 index = hash.find(v[i].Pos, SVertexEquals<video::S3DVertex>(v, v[i]));
+		if (index < 0)
+		{
+			v[uniqueCount] = v[i];
+			index = hash.add(v[uniqueCount].Pos);
+			++uniqueCount;
+		}
+		redirects[i] = index;
+	}
+
+	if (uniqueCount == vertexCount)
+		return;
+
+	vertices.set_used(uniqueCount);
+	for (u32 i=0; i<indices.size(); ++i)
+	{
+		const u32 index = indices[i];
+		if (index < vertexCount)
+			indices.setValue(i, redirects[index]);
+	}
+}
+
+
 bool CPLYMeshFileLoader::readFace(const SPLYElement &Element, scene::CDynamicMeshBuffer* mb)
 {
 	if (!IsBinaryFile)
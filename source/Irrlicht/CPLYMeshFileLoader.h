@@ -125,6 +125,7 @@ private:
 
 	bool readVertex(const SPLYElement &Element, scene::CDynamicMeshBuffer* mb);
 	bool readFace(const SPLYElement &Element, scene::CDynamicMeshBuffer* mb);
+	void weldVertices(scene::CDynamicMeshBuffer* mb) const;
 	void skipElement(const SPLYElement &Element);
 	void skipProperty(const SPLYProperty &Property);
 	f32 getFloat(E_PLY_PROPERTY_TYPE t);
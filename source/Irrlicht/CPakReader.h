@@ -104,6 +104,9 @@ namespace io
 		//! get the class Type
 		virtual E_FILE_ARCHIVE_TYPE getType() const _IRR_OVERRIDE_ { return EFAT_PAK; }
 
+		//! files are found with findFile, so the file system can index them
+		virtual bool isIndexable(bool& ignorePaths, bool& ignoreCase) const _IRR_OVERRIDE_ { ignorePaths = IgnorePaths; ignoreCase = IgnoreCase; return true; }
+
 	private:
 
 		//! scans for a local header, returns false if the header is invalid
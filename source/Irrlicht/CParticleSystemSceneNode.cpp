@@ -541,6 +541,9 @@ void CParticleSystemSceneNode::doParticleSystem(u32 time)
 	}
 
 	LastAbsoluteTransformation = AbsoluteTransformation;
+
+	// the box changes after OnAnimate, before the node is culled
+	SceneManager->updateSceneNodeIndex(this);
 }
 
 
@@ -0,0 +1,211 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_RESOURCE_CACHE_H_INCLUDED__
+#define __C_RESOURCE_CACHE_H_INCLUDED__
+
+#include "path.h"
+#include "irrArray.h"
+#include "CThreadPool.h"
+
+namespace irr
+{
+
+	//! Thread safe index from names to objects, used by the mesh and texture caches.
+	/** The names are hashed into shards, each with its own reader writer lock,
+	so lookups only wait for writers of the same shard. Names are compared as
+	they are, pass io::SNamedPath::getInternalName() for Irrlicht's case
+	insensitive names. Objects are not grabbed. Several objects can have the
+	same name, find() returns one of them.
+
+	Loads are deduplicated with beginLoad() and endLoad(): only the first
+	thread asking for a name which is not in the index loads it, the others
+	wait until it called endLoad() and look the name up again. */
+	template <class T>
+	class CResourceCache
+	{
+	public:
+
+		//! returns an object with this name or 0
+		T* find(const io::path& name) const
+		{
+			const u32 hash = getHash(name);
+			const SShard& shard = Shards[hash % SHARD_COUNT];
+
+			CReadLock lock(shard.Lock);
+			return findInShard(shard, name, hash);
+		}
+
+		//! adds an object under a name
+		void insert(const io::path& name, T* object)
+		{
+			const u32 hash = getHash(name);
+			SShard& shard = Shards[hash % SHARD_COUNT];
+
+			CWriteLock lock(shard.Lock);
+			if (shard.Count >= shard.Buckets.size() * 2)
+				rehash(shard);
+
+			SEntry entry;
+			entry.Name = name;
+			entry.Object = object;
+			entry.Hash = hash;
+			shard.Buckets[(hash / SHARD_COUNT) % shard.Buckets.size()].push_back(entry);
+			++shard.Count;
+		}
+
+		//! removes an object added under this name, returns false if it wasn't found
+		bool remove(const io::path& name, T* object)
+		{
+			const u32 hash = getHash(name);
+			SShard& shard = Shards[hash % SHARD_COUNT];
+
+			CWriteLock lock(shard.Lock);
+			if (shard.Buckets.empty())
+				return false;
+
+			core::array<SEntry>& bucket = shard.Buckets[(hash / SHARD_COUNT) % shard.Buckets.size()];
+			for (u32 i=0; i<bucket.size(); ++i)
+			{
+				if (bucket[i].Object == object && bucket[i].Hash == hash && bucket[i].Name == name)
+				{
+					bucket.erase(i);
+					--shard.Count;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		//! removes all objects
+		void clear()
+		{
+			for (u32 i=0; i<SHARD_COUNT; ++i)
+			{
+				CWriteLock lock(Shards[i].Lock);
+				Shards[i].Buckets.clear();
+				Shards[i].Count = 0;
+			}
+		}
+
+		//! returns the object with this name or prepares loading it
+		/** \param name Name to look up.
+		\param load Set to true when the caller has to load the object. It
+		must insert() it if loading succeeds and call endLoad() in any case.
+		\return The object if it is in the index. When another thread is
+		loading the name, this waits for it and looks the name up again. */
+		T* beginLoad(const io::path& name, bool& load)
+		{
+			const u32 hash = getHash(name);
+			SShard& shard = Shards[hash % SHARD_COUNT];
+
+			load = false;
+			CMutexLock lock(shard.LoadMutex);
+			for (;;)
+			{
+				T* object = find(name);
+				if (object)
+					return object;
+
+				if (shard.Loading.linear_search(name) == -1)
+				{
+					shard.Loading.push_back(name);
+					load = true;
+					return 0;
+				}
+
+				shard.LoadDone.wait(shard.LoadMutex);
+			}
+		}
+
+		//! ends a load started with beginLoad() and wakes the threads waiting for it
+		void endLoad(const io::path& name)
+		{
+			SShard& shard = Shards[getHash(name) % SHARD_COUNT];
+
+			CMutexLock lock(shard.LoadMutex);
+			const s32 index = shard.Loading.linear_search(name);
+			if (index != -1)
+				shard.Loading.erase(index);
+			shard.LoadDone.broadcast();
+		}
+
+	private:
+
+		enum { SHARD_COUNT = 16 };
+
+		struct SEntry
+		{
+			io::path Name;
+			T* Object;
+			u32 Hash;
+		};
+
+		struct SShard
+		{
+			SShard() : Count(0) {}
+
+			//! protects Buckets and Count
+			mutable CReadWriteMutex Lock;
+			core::array<core::array<SEntry> > Buckets;
+			u32 Count;
+
+			//! protects Loading
+			CMutex LoadMutex;
+			CCondition LoadDone;
+			core::array<io::path> Loading;
+		};
+
+		//! FNV-1a hash of the name
+		static u32 getHash(const io::path& name)
+		{
+			u32 hash = 2166136261u;
+			for (u32 i=0; i<name.size(); ++i)
+			{
+				hash ^= (u32)name[i];
+				hash *= 16777619u;
+			}
+			return hash;
+		}
+
+		static T* findInShard(const SShard& shard, const io::path& name, u32 hash)
+		{
+			if (shard.Buckets.empty())
+				return 0;
+
+			const core::array<SEntry>& bucket = shard.Buckets[(hash / SHARD_COUNT) % shard.Buckets.size()];
+			for (u32 i=0; i<bucket.size(); ++i)
+			{
+				if (bucket[i].Hash == hash && bucket[i].Name == name)
+					return bucket[i].Object;
+			}
+			return 0;
+		}
+
+		//! doubles the number of buckets, shard must be locked for writing
+		static void rehash(SShard& shard)
+		{
+			const u32 count = core::max_(shard.Buckets.size() * 2, 8u);
+			core::array<core::array<SEntry> > buckets(count);
+			for (u32 i=0; i<count; ++i)
+				buckets.push_back(core::array<SEntry>());
+
+			for (u32 i=0; i<shard.Buckets.size(); ++i)
+			{
+				for (u32 j=0; j<shard.Buckets[i].size(); ++j)
+				{
+					const SEntry& entry = shard.Buckets[i][j];
+					buckets[(entry.Hash / SHARD_COUNT) % buckets.size()].push_back(entry);
+				}
+			}
+			shard.Buckets.swap(buckets);
+		}
+
+		SShard Shards[SHARD_COUNT];
+	};
+
+} // end namespace irr
+
+#endif
+
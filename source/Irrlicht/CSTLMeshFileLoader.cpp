@@ -10,6 +10,7 @@
 #include "SMesh.h"
 #include "SMeshBuffer.h"
 #include "SAnimatedMesh.h"
+#include "CVertexHash.h"
 #include "IReadFile.h"
 #include "fast_atof.h"
 #include "coreutil.h"
@@ -68,6 +69,10 @@ IAnimatedMesh* CSTLMeshFileLoader::createMesh(io::IReadFile* file)
 	u16 attrib=0;
 	token.reserve(32);
 
+	// STL has no shared vertices, corners of neighbouring facets are found
+	// and merged with a hash when they have the same normal and color
+	CVertexHash vertexHash(0.f, 0.f, binFaceCount);
+
 	while (file->getPos() < filesize)
 	{
 		if (!binary)
@@ -133,18 +138,22 @@ IAnimatedMesh* CSTLMeshFileLoader::createMesh(io::IReadFile* file)
 		}
 
 		SMeshBuffer* mb = reinterpret_cast<SMeshBuffer*>(mesh->getMeshBuffer(mesh->getMeshBufferCount()-1));
-		u32 vCount = mb->getVertexCount();
 		video::SColor color(0xffffffff);
 		if (attrib & 0x8000)
 			color = video::A1R5G5B5toA8R8G8B8(attrib);
 		if (normal==core::vector3df())
 			normal=core::plane3df(vertex[2],vertex[1],vertex[0]).Normal;
-		mb->Vertices.push_back(video::S3DVertex(vertex[2],normal,color, core::vector2df()));
-		mb->Vertices.push_back(video::S3DVertex(vertex[1],normal,color, core::vector2df()));
-		mb->Vertices.push_back(video::S3DVertex(vertex[0],normal,color, core::vector2df()));
-		mb->Indices.push_back(vCount);
-		mb->Indices.push_back(vCount+1);
-		mb->Indices.push_back(vCount+2);
+		for (s32 i=2; i>=0; --i)
+		{
+			const video::S3DVertex v(vertex[i],normal,color, core::vector2df());
+			s32 index = findVertex(vertexHash, mb->Vertices, v);
+			if (index < 0)
+			{
+				mb->Vertices.push_back(v);
+				index = vertexHash.add(v.Pos);
+			}
+			mb->Indices.push_back((u16)index);
+		}
 	}	// end while (file->getPos() < filesize)
 	mesh->getMeshBuffer(0)->recalculateBoundingBox();
 
@@ -7,6 +7,7 @@
 #include "ICameraSceneNode.h"
 #include "ITriangleSelector.h"
 #include "SViewFrustum.h"
+#include "CThreadPool.h"
 
 #include "os.h"
 #include "irrMath.h"
@@ -16,9 +17,122 @@ namespace irr
 namespace scene
 {
 
+namespace
+{
+
+//! lines of batch queries which gather their triangles together
+const u32 RayGroupSize = 16;
+
+//! sort key of a line in a batch
+struct SRayKey
+{
+	u32 Key;
+	u32 Index;
+
+	bool operator<(const SRayKey& other) const
+	{
+		return Key < other.Key;
+	}
+};
+
+//! 10 bit coordinate of the Morton order, invalid ones are 0
+inline u32 quantize(f32 v)
+{
+	if (!(v > 0.f))
+		return 0;
+	return v < 1023.f ? (u32)v : 1023;
+}
+
+//! puts two zero bits between each of the lower 10 bits
+inline u32 spreadBits(u32 v)
+{
+	v = (v | (v << 16)) & 0x030000ff;
+	v = (v | (v << 8)) & 0x0300f00f;
+	v = (v | (v << 4)) & 0x030c30c3;
+	v = (v | (v << 2)) & 0x09249249;
+	return v;
+}
+
+//! finds the nearest hit of a line with triangles returned by a selector
+bool getNearestHit(SCollisionHit& hitResult, const core::line3df& ray,
+		const core::triangle3df* triangles, s32 cnt,
+		const core::array<SCollisionTriangleRange>& outTriangleInfo, bool anyHit)
+{
+	const core::vector3df linevect = ray.getVector().normalize();
+	core::vector3df intersection;
+	f32 nearest = FLT_MAX;
+	irr::s32 foundIndex = -1;
+	const f32 raylength = ray.getLengthSQ();
+
+	const f32 minX = core::min_(ray.start.X, ray.end.X);
+	const f32 maxX = core::max_(ray.start.X, ray.end.X);
+	const f32 minY = core::min_(ray.start.Y, ray.end.Y);
+	const f32 maxY = core::max_(ray.start.Y, ray.end.Y);
+	const f32 minZ = core::min_(ray.start.Z, ray.end.Z);
+	const f32 maxZ = core::max_(ray.start.Z, ray.end.Z);
+
+	for (s32 i=0; i<cnt; ++i)
+	{
+		const core::triangle3df & triangle = triangles[i];
+
+		if(minX > triangle.pointA.X && minX > triangle.pointB.X && minX > triangle.pointC.X)
+			continue;
+		if(maxX < triangle.pointA.X && maxX < triangle.pointB.X && maxX < triangle.pointC.X)
+			continue;
+		if(minY > triangle.pointA.Y && minY > triangle.pointB.Y && minY > triangle.pointC.Y)
+			continue;
+		if(maxY < triangle.pointA.Y && maxY < triangle.pointB.Y && maxY < triangle.pointC.Y)
+			continue;
+		if(minZ > triangle.pointA.Z && minZ > triangle.pointB.Z && minZ > triangle.pointC.Z)
+			continue;
+		if(maxZ < triangle.pointA.Z && maxZ < triangle.pointB.Z && maxZ < triangle.pointC.Z)
+			continue;
+
+		if (triangle.getIntersectionWithLine(ray.start, linevect, intersection))
+		{
+			const f32 tmp = intersection.getDistanceFromSQ(ray.start);
+			const f32 tmp2 = intersection.getDistanceFromSQ(ray.end);
+
+			if (tmp < raylength && tmp2 < raylength && tmp < nearest)
+			{
+				nearest = tmp;
+
+				hitResult.Triangle = triangle;
+				hitResult.Intersection = intersection;
+				foundIndex = i;
+				if (anyHit)
+					break;
+			}
+		}
+	}
+
+	if ( foundIndex >= 0 )
+	{
+		for ( irr::u32 t=0; t<outTriangleInfo.size(); ++t )
+		{
+			if ( outTriangleInfo[t].isIndexInRange(foundIndex) )
+			{
+				hitResult.Node = outTriangleInfo[t].SceneNode;
+				hitResult.MeshBuffer = outTriangleInfo[t].MeshBuffer;
+				hitResult.MaterialIndex = outTriangleInfo[t].MaterialIndex;
+				hitResult.TriangleSelector = outTriangleInfo[t].Selector;
+
+				break;
+			}
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+} // end anonymous namespace
+
+
 //! constructor
 CSceneCollisionManager::CSceneCollisionManager(ISceneManager* smanager, video::IVideoDriver* driver)
-: SceneManager(smanager), Driver(driver)
+: SceneManager(smanager), Driver(driver), Threads(0), ThreadCount(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CSceneCollisionManager");
@@ -34,6 +148,9 @@ CSceneCollisionManager::~CSceneCollisionManager()
 {
 	if (Driver)
 		Driver->drop();
+
+	if (Threads)
+		Threads->drop();
 }
 
 
@@ -69,20 +186,28 @@ ISceneNode* CSceneCollisionManager::getSceneNodeFromRayBB(
 }
 
 
-//! recursive method for going through all scene nodes
+//! tests the nodes below root which the spatial index of the scene finds on the ray
 void CSceneCollisionManager::getPickedNodeBB(ISceneNode* root,
 		core::line3df& ray, s32 bits, bool noDebugObjects,
 		f32& outbestdistance, ISceneNode*& outbestnode)
 {
-	const ISceneNodeList& children = root->getChildren();
+	// a ray which hits the box of a node in object space also hits its
+	// transformed box, so the index finds all nodes which can be hit
+	core::array<ISceneNode*> candidates;
+	SceneManager->getSceneNodesFromLine(ray, candidates);
+
 	const core::vector3df rayVector = ray.getVector().normalize();
 
-	ISceneNodeList::ConstIterator it = children.begin();
-	for (; it != children.end(); ++it)
+	for (u32 i=0; i<candidates.size(); ++i)
 	{
-		ISceneNode* current = *it;
+		ISceneNode* current = candidates[i];
+
+		// only nodes below root whose parents up to root are visible
+		const ISceneNode* parent = current;
+		while (parent && parent != root && parent->isVisible())
+			parent = parent->getParent();
 
-		if (current->isVisible())
+		if (parent == root && current != root)
 		{
 			if((noDebugObjects ? !current->isDebugObject() : true) &&
 				(bits==0 || (bits != 0 && (current->getID() & bits))))
@@ -216,9 +341,6 @@ void CSceneCollisionManager::getPickedNodeBB(ISceneNode* root,
 					}
 				}
 			}
-
-			// Only check the children if this node is visible.
-			getPickedNodeBB(current, ray, bits, noDebugObjects, outbestdistance, outbestnode);
 		}
 	}
 }
@@ -344,6 +466,10 @@ bool CSceneCollisionManager::getCollisionPoint(SCollisionHit& hitResult, const c
 		return false;
 	}
 
+	// selectors with a hierarchy test the triangles where they are
+	if (selector->isCollisionPointSupported())
+		return selector->getCollisionPoint(hitResult, ray, true, false);
+
 	s32 totalcnt = selector->getTriangleCount();
 	if ( totalcnt <= 0 )
 		return false;
@@ -354,71 +480,339 @@ bool CSceneCollisionManager::getCollisionPoint(SCollisionHit& hitResult, const c
 	irr::core::array<SCollisionTriangleRange> outTriangleInfo;
 	selector->getTriangles(Triangles.pointer(), totalcnt, cnt, ray, 0, true, &outTriangleInfo);
 
-	const core::vector3df linevect = ray.getVector().normalize();
-	core::vector3df intersection;
-	f32 nearest = FLT_MAX;
-	irr::s32 foundIndex = -1;
-	const f32 raylength = ray.getLengthSQ();
+	return getNearestHit(hitResult, ray, Triangles.const_pointer(), cnt, outTriangleInfo, false);
+}
 
-	const f32 minX = core::min_(ray.start.X, ray.end.X);
-	const f32 maxX = core::max_(ray.start.X, ray.end.X);
-	const f32 minY = core::min_(ray.start.Y, ray.end.Y);
-	const f32 maxY = core::max_(ray.start.Y, ray.end.Y);
-	const f32 minZ = core::min_(ray.start.Z, ray.end.Z);
-	const f32 maxZ = core::max_(ray.start.Z, ray.end.Z);
 
-	for (s32 i=0; i<cnt; ++i)
+//! Finds the nearest collision points of many lines and lots of triangles.
+u32 CSceneCollisionManager::getCollisionPoints(const core::line3d<f32>* rays, u32 rayCount,
+		ITriangleSelector* selector, SCollisionHit* hitResults, bool* outHits,
+		bool anyHit, u32 threadCount)
+{
+	for (u32 i=0; i<rayCount; ++i)
+		outHits[i] = false;
+	if (!selector || !rayCount)
+		return 0;
+
+	SRayBatch batch;
+	batch.Rays = rays;
+	batch.Hits = hitResults;
+	batch.Found = outHits;
+	batch.Selector = selector;
+	batch.Candidates = 0;
+	batch.AnyHit = anyHit;
+	sortRays(batch, rayCount);
+
+	// selectors of animated nodes update their triangles when queried,
+	// which must happen before the threads read them
+	if (threadCount != 1)
+		selector->update();
+
+	runBatch(batch, rayCount, threadCount, collideRayChunk);
+
+	u32 hits = 0;
+	for (u32 i=0; i<rayCount; ++i)
 	{
-		const core::triangle3df & triangle = Triangles[i];
+		if (outHits[i])
+			++hits;
+	}
+	return hits;
+}
 
-		if(minX > triangle.pointA.X && minX > triangle.pointB.X && minX > triangle.pointC.X)
-			continue;
-		if(maxX < triangle.pointA.X && maxX < triangle.pointB.X && maxX < triangle.pointC.X)
-			continue;
-		if(minY > triangle.pointA.Y && minY > triangle.pointB.Y && minY > triangle.pointC.Y)
-			continue;
-		if(maxY < triangle.pointA.Y && maxY < triangle.pointB.Y && maxY < triangle.pointC.Y)
-			continue;
-		if(minZ > triangle.pointA.Z && minZ > triangle.pointB.Z && minZ > triangle.pointC.Z)
-			continue;
-		if(maxZ < triangle.pointA.Z && maxZ < triangle.pointB.Z && maxZ < triangle.pointC.Z)
-			continue;
 
-		if (triangle.getIntersectionWithLine(ray.start, linevect, intersection))
-		{
-			const f32 tmp = intersection.getDistanceFromSQ(ray.start);
-			const f32 tmp2 = intersection.getDistanceFromSQ(ray.end);
+//! Perform ray/box and ray/triangle collision checks of many lines on a hierarchy of scene nodes.
+u32 CSceneCollisionManager::getSceneNodesAndCollisionPointsFromRays(
+						const core::line3df* rays, u32 rayCount,
+						SCollisionHit* hitResults,
+						s32 idBitMask,
+						ISceneNode * collisionRootNode,
+						bool noDebugObjects,
+						u32 threadCount)
+{
+	for (u32 i=0; i<rayCount; ++i)
+		hitResults[i] = SCollisionHit();
+	if (!rayCount)
+		return 0;
 
-			if (tmp < raylength && tmp2 < raylength && tmp < nearest)
-			{
-				nearest = tmp;
+	if(0 == collisionRootNode)
+		collisionRootNode = SceneManager->getRootSceneNode();
 
-				hitResult.Triangle = triangle;
-				hitResult.Intersection = intersection;
-				foundIndex = i;
+	// walk the scene graph once for all lines
+	core::array<SPickCandidate> candidates;
+	getPickCandidates(collisionRootNode, idBitMask, noDebugObjects, candidates);
+	if (candidates.empty())
+		return 0;
+
+	if (threadCount != 1)
+	{
+		for (u32 i=0; i<candidates.size(); ++i)
+			candidates[i].Selector->update();
+	}
+
+	core::array<bool> found(rayCount);
+	found.set_used(rayCount);
+
+	SRayBatch batch;
+	batch.Rays = rays;
+	batch.Hits = hitResults;
+	batch.Found = found.pointer();
+	batch.Selector = 0;
+	batch.Candidates = &candidates;
+	batch.AnyHit = false;
+	sortRays(batch, rayCount);
+
+	runBatch(batch, rayCount, threadCount, pickRayChunk);
+
+	u32 hits = 0;
+	for (u32 i=0; i<rayCount; ++i)
+	{
+		if (found[i])
+			++hits;
+	}
+	return hits;
+}
+
+
+//! collects the nodes which getSceneNodesAndCollisionPointsFromRays tests
+void CSceneCollisionManager::getPickCandidates(ISceneNode* root, s32 bits, bool noDebugObjects,
+				core::array<SPickCandidate>& outCandidates) const
+{
+	// same nodes in the same order as getPickedNodeFromBBAndSelector
+	const ISceneNodeList& children = root->getChildren();
+
+	ISceneNodeList::ConstIterator it = children.begin();
+	for (; it != children.end(); ++it)
+	{
+		ISceneNode* current = *it;
+		ITriangleSelector * selector = current->getTriangleSelector();
+
+		if (selector && current->isVisible() &&
+			(noDebugObjects ? !current->isDebugObject() : true) &&
+			(bits==0 || (bits != 0 && (current->getID() & bits))))
+		{
+			SPickCandidate candidate;
+			if (current->getAbsoluteTransformation().getInverse(candidate.WorldToObject))
+			{
+				candidate.Node = current;
+				candidate.Selector = selector;
+				candidate.Box = current->getBoundingBox();
+				outCandidates.push_back(candidate);
 			}
 		}
+
+		getPickCandidates(current, bits, noDebugObjects, outCandidates);
 	}
+}
 
-	if ( foundIndex >= 0 )
+
+//! sorts the lines of a batch so that close lines follow each other
+void CSceneCollisionManager::sortRays(SRayBatch& batch, u32 rayCount)
+{
+	// Morton order of the centers of the lines
+	core::aabbox3df bounds(batch.Rays[0].getMiddle());
+	for (u32 i=1; i<rayCount; ++i)
+		bounds.addInternalPoint(batch.Rays[i].getMiddle());
+
+	const core::vector3df extent = bounds.getExtent();
+	const core::vector3df scale(extent.X > 0.f ? 1023.f / extent.X : 0.f,
+		extent.Y > 0.f ? 1023.f / extent.Y : 0.f,
+		extent.Z > 0.f ? 1023.f / extent.Z : 0.f);
+
+	core::array<SRayKey> keys(rayCount);
+	for (u32 i=0; i<rayCount; ++i)
 	{
-		for ( irr::u32 t=0; t<outTriangleInfo.size(); ++t )
+		const core::vector3df p = (batch.Rays[i].getMiddle() - bounds.MinEdge) * scale;
+		SRayKey key;
+		key.Key = spreadBits(quantize(p.X)) | (spreadBits(quantize(p.Y)) << 1) | (spreadBits(quantize(p.Z)) << 2);
+		key.Index = i;
+		keys.push_back(key);
+	}
+	keys.sort();
+
+	batch.Order.reallocate(rayCount);
+	batch.Order.set_used(0);
+	for (u32 i=0; i<rayCount; ++i)
+		batch.Order.push_back(keys[i].Index);
+}
+
+
+//! creates Threads if more than one thread is wanted
+u32 CSceneCollisionManager::prepareThreads(u32 threadCount)
+{
+	if (threadCount == 0)
+		threadCount = CThreadPool::getProcessorCount();
+
+	if (threadCount > 1 && (!Threads || ThreadCount != threadCount))
+	{
+		if (Threads)
+			Threads->drop();
+		Threads = new CThreadPool(threadCount);
+		ThreadCount = threadCount;
+	}
+	return threadCount;
+}
+
+
+//! runs a task for each chunk of a batch, on several threads if wanted
+void CSceneCollisionManager::runBatch(SRayBatch& batch, u32 rayCount, u32 threadCount, void (*task)(void*, u32))
+{
+	threadCount = prepareThreads(threadCount);
+
+	// a few chunks per thread, so threads which are done early help the others
+	const u32 chunkCount = threadCount > 1 ? threadCount * 4 : 1;
+	batch.ChunkSize = core::max_((rayCount + chunkCount - 1) / chunkCount, RayGroupSize);
+	const u32 chunks = (rayCount + batch.ChunkSize - 1) / batch.ChunkSize;
+
+	if (threadCount > 1 && chunks > 1)
+		Threads->run(task, &batch, chunks);
+	else
+	{
+		for (u32 i=0; i<chunks; ++i)
+			task(&batch, i);
+	}
+}
+
+
+//! tests a chunk of the lines of a batch against one selector
+void CSceneCollisionManager::collideRayChunk(void* data, u32 chunk)
+{
+	SRayBatch& batch = *(SRayBatch*)data;
+	const u32 begin = chunk * batch.ChunkSize;
+	const u32 end = core::min_(begin + batch.ChunkSize, batch.Order.size());
+	ITriangleSelector* selector = batch.Selector;
+
+	if (selector->isCollisionPointSupported())
+	{
+		for (u32 i=begin; i<end; ++i)
 		{
-			if ( outTriangleInfo[t].isIndexInRange(foundIndex) )
+			const u32 r = batch.Order[i];
+			batch.Found[r] = selector->getCollisionPoint(batch.Hits[r], batch.Rays[r], true, batch.AnyHit);
+		}
+		return;
+	}
+
+	const s32 totalCount = selector->getTriangleCount();
+	if (totalCount <= 0)
+		return;
+
+	core::array<core::triangle3df> triangles(totalCount);
+	triangles.set_used(totalCount);
+	core::array<SCollisionTriangleRange> triangleInfo;
+
+	// gather the triangles once for each group of close lines
+	for (u32 group=begin; group<end; group+=RayGroupSize)
+	{
+		const u32 groupEnd = core::min_(group + RayGroupSize, end);
+		core::aabbox3df box(batch.Rays[batch.Order[group]].start);
+		for (u32 i=group; i<groupEnd; ++i)
+		{
+			box.addInternalPoint(batch.Rays[batch.Order[i]].start);
+			box.addInternalPoint(batch.Rays[batch.Order[i]].end);
+		}
+
+		s32 count = 0;
+		triangleInfo.set_used(0);
+		selector->getTriangles(triangles.pointer(), totalCount, count, box, 0, true, &triangleInfo);
+
+		for (u32 i=group; i<groupEnd; ++i)
+		{
+			const u32 r = batch.Order[i];
+			batch.Found[r] = getNearestHit(batch.Hits[r], batch.Rays[r], triangles.const_pointer(),
+				count, triangleInfo, batch.AnyHit);
+		}
+	}
+}
+
+
+//! tests a chunk of the lines of a batch against the scene nodes
+void CSceneCollisionManager::pickRayChunk(void* data, u32 chunk)
+{
+	SRayBatch& batch = *(SRayBatch*)data;
+	const core::array<SPickCandidate>& candidates = *batch.Candidates;
+	const u32 begin = chunk * batch.ChunkSize;
+	const u32 end = core::min_(begin + batch.ChunkSize, batch.Order.size());
+
+	core::array<core::triangle3df> triangles;
+	core::array<SCollisionTriangleRange> triangleInfo;
+
+	for (u32 group=begin; group<end; group+=RayGroupSize)
+	{
+		const u32 groupSize = core::min_(group + RayGroupSize, end) - group;
+
+		// each hit shortens its line, like getPickedNodeFromBBAndSelector does
+		core::line3df lines[RayGroupSize];
+		f32 bestDistanceSquared[RayGroupSize];
+		for (u32 k=0; k<groupSize; ++k)
+		{
+			lines[k] = batch.Rays[batch.Order[group + k]];
+			bestDistanceSquared[k] = FLT_MAX;
+		}
+
+		for (u32 c=0; c<candidates.size(); ++c)
+		{
+			const SPickCandidate& candidate = candidates[c];
+
+			// lines of the group which pass the box of the node, in object space
+			u32 passing[RayGroupSize];
+			u32 passingCount = 0;
+			core::aabbox3df box;
+			for (u32 k=0; k<groupSize; ++k)
 			{
-				hitResult.Node = outTriangleInfo[t].SceneNode;
-				hitResult.MeshBuffer = outTriangleInfo[t].MeshBuffer;
-				hitResult.MaterialIndex = outTriangleInfo[t].MaterialIndex;
-				hitResult.TriangleSelector = outTriangleInfo[t].Selector;
+				core::line3df line(lines[k]);
+				candidate.WorldToObject.transformVect(line.start);
+				candidate.WorldToObject.transformVect(line.end);
+				if (!candidate.Box.intersectsWithLine(line))
+					continue;
 
-				break;
+				if (passingCount)
+					box.addInternalPoint(lines[k].start);
+				else
+					box.reset(lines[k].start);
+				box.addInternalPoint(lines[k].end);
+				passing[passingCount++] = k;
+			}
+			if (!passingCount)
+				continue;
+
+			ITriangleSelector* selector = candidate.Selector;
+			const bool ownHits = selector->isCollisionPointSupported();
+			s32 count = 0;
+			if (!ownHits)
+			{
+				const s32 totalCount = selector->getTriangleCount();
+				if (totalCount <= 0)
+					continue;
+				if (triangles.size() < (u32)totalCount)
+					triangles.set_used(totalCount);
+				triangleInfo.set_used(0);
+				selector->getTriangles(triangles.pointer(), totalCount, count, box, 0, true, &triangleInfo);
+			}
+
+			for (u32 p=0; p<passingCount; ++p)
+			{
+				const u32 k = passing[p];
+				SCollisionHit candidateHitResult;
+				const bool hit = ownHits ?
+					selector->getCollisionPoint(candidateHitResult, lines[k], true, false) :
+					getNearestHit(candidateHitResult, lines[k], triangles.const_pointer(), count, triangleInfo, false);
+				if (!hit)
+					continue;
+
+				const f32 distanceSquared = (candidateHitResult.Intersection - lines[k].start).getLengthSQ();
+				if (distanceSquared < bestDistanceSquared[k])
+				{
+					const u32 r = batch.Order[group + k];
+					bestDistanceSquared[k] = distanceSquared;
+					batch.Hits[r] = candidateHitResult;
+					const core::vector3df rayVector = lines[k].getVector().normalize();
+					lines[k].end = lines[k].start + (rayVector * sqrtf(distanceSquared));
+				}
 			}
 		}
 
-		return true;
+		for (u32 k=0; k<groupSize; ++k)
+			batch.Found[batch.Order[group + k]] = bestDistanceSquared[k] < FLT_MAX;
 	}
-
-	return false;
 }
 
 //! Collides a moving ellipsoid with a 3d world with gravity and returns
@@ -434,13 +828,148 @@ core::vector3df CSceneCollisionManager::getCollisionResultPosition(
 		f32 slidingSpeed,
 		const core::vector3df& gravity)
 {
-	return collideEllipsoidWithWorld(selector, position,
-		radius, direction, slidingSpeed, gravity, triout, hitPosition, outFalling, outNode);
+	if (!selector || radius.X == 0.0f || radius.Y == 0.0f || radius.Z == 0.0f)
+		return position;
+
+	SCollisionEllipsoid ellipsoid;
+	ellipsoid.Selector = selector;
+	ellipsoid.Position = position;
+	ellipsoid.Radius = radius;
+	ellipsoid.Velocity = direction;
+	ellipsoid.Gravity = gravity;
+	ellipsoid.SlidingSpeed = slidingSpeed;
+	ellipsoid.Triangle = triout;
+
+	// the triangles of the last call may be outdated
+	EllipsoidTriangles.invalidate();
+	if (collideEllipsoidWithWorld(ellipsoid, EllipsoidTriangles))
+		outNode = ellipsoid.Node;
+
+	triout = ellipsoid.Triangle;
+	hitPosition = ellipsoid.HitPosition;
+	outFalling = ellipsoid.Falling;
+	return ellipsoid.ResultPosition;
+}
+
+
+//! Collides many moving ellipsoids with 3d worlds with gravity.
+void CSceneCollisionManager::getCollisionResultPositions(SCollisionEllipsoid* ellipsoids,
+		u32 count, u32 threadCount)
+{
+	if (!count)
+		return;
+
+	threadCount = prepareThreads(threadCount);
+
+	// selectors of animated nodes update their triangles when queried,
+	// which must happen before the threads read them
+	if (threadCount > 1)
+	{
+		core::array<ITriangleSelector*> selectors;
+		for (u32 i=0; i<count; ++i)
+		{
+			ITriangleSelector* selector = ellipsoids[i].Selector;
+			if (selector && selectors.linear_search(selector) < 0)
+			{
+				selector->update();
+				selectors.push_back(selector);
+			}
+		}
+	}
+
+	SEllipsoidBatch batch;
+	batch.Manager = this;
+	batch.Ellipsoids = ellipsoids;
+	batch.Count = count;
+
+	const u32 chunkCount = threadCount > 1 ? threadCount * 4 : 1;
+	batch.ChunkSize = (count + chunkCount - 1) / chunkCount;
+	const u32 chunks = (count + batch.ChunkSize - 1) / batch.ChunkSize;
+
+	if (threadCount > 1 && chunks > 1)
+		Threads->run(collideEllipsoidChunk, &batch, chunks);
+	else
+	{
+		for (u32 i=0; i<chunks; ++i)
+			collideEllipsoidChunk(&batch, i);
+	}
+}
+
+
+//! moves a chunk of the ellipsoids of a batch
+void CSceneCollisionManager::collideEllipsoidChunk(void* data, u32 chunk)
+{
+	SEllipsoidBatch& batch = *(SEllipsoidBatch*)data;
+	const u32 begin = chunk * batch.ChunkSize;
+	const u32 end = core::min_(begin + batch.ChunkSize, batch.Count);
+
+	// for ellipsoids without a cache of their own
+	SCollisionTriangleCache triangles;
+
+	for (u32 i=begin; i<end; ++i)
+	{
+		SCollisionEllipsoid& ellipsoid = batch.Ellipsoids[i];
+		ellipsoid.ResultPosition = ellipsoid.Position;
+		ellipsoid.HitPosition = core::vector3df();
+		ellipsoid.Node = 0;
+		ellipsoid.Falling = false;
+
+		const core::vector3df& radius = ellipsoid.Radius;
+		if (!ellipsoid.Selector || radius.X == 0.0f || radius.Y == 0.0f || radius.Z == 0.0f)
+			continue;
+
+		if (ellipsoid.Cache)
+			batch.Manager->collideEllipsoidWithWorld(ellipsoid, *ellipsoid.Cache);
+		else
+		{
+			triangles.invalidate();
+			batch.Manager->collideEllipsoidWithWorld(ellipsoid, triangles);
+		}
+	}
+}
+
+
+//! gathers the triangles for the movement of an ellipsoid, unless the cache has them
+void CSceneCollisionManager::gatherTriangles(const SCollisionEllipsoid& ellipsoid,
+		const core::aabbox3df& box, SCollisionTriangleCache& cache)
+{
+	if (cache.Selector == ellipsoid.Selector && cache.Radius == ellipsoid.Radius &&
+		box.isFullInside(cache.Box))
+		return;
+
+	cache.Box = box;
+	cache.Box.MinEdge -= ellipsoid.Radius * cache.Margin;
+	cache.Box.MaxEdge += ellipsoid.Radius * cache.Margin;
+	cache.Radius = ellipsoid.Radius;
+	cache.Selector = ellipsoid.Selector;
+
+	core::matrix4 scaleMatrix;
+	scaleMatrix.setScale(
+			core::vector3df(1.0f / ellipsoid.Radius.X,
+					1.0f / ellipsoid.Radius.Y,
+					1.0f / ellipsoid.Radius.Z));
+
+	// usually only a small part of the world is near the ellipsoid, so
+	// start with the size of the last query and grow it if it was too small
+	const s32 totalTriangleCnt = ellipsoid.Selector->getTriangleCount();
+	s32 size = core::min_(core::max_((s32)cache.Triangles.allocated_size(), 64), totalTriangleCnt);
+	s32 triangleCnt = 0;
+	for (;;)
+	{
+		cache.Triangles.set_used(size);
+		cache.TriangleInfo.set_used(0);
+		ellipsoid.Selector->getTriangles(cache.Triangles.pointer(), size, triangleCnt,
+			cache.Box, &scaleMatrix, true, &cache.TriangleInfo);
+		if (triangleCnt < size || size == totalTriangleCnt)
+			break;
+		size = core::min_(size * 2, totalTriangleCnt);
+	}
+	cache.Triangles.set_used(core::max_(triangleCnt, 0));
 }
 
 
 bool CSceneCollisionManager::testTriangleIntersection(SCollisionData* colData,
-			const core::triangle3df& triangle)
+			const core::triangle3df& triangle) const
 {
 	const core::plane3d<f32> trianglePlane = triangle.getPlane();
 
@@ -689,43 +1218,43 @@ bool CSceneCollisionManager::testTriangleIntersection(SCollisionData* colData,
 }
 
 
-//! Collides a moving ellipsoid with a 3d world with gravity and returns
+//! Collides a moving ellipsoid with a 3d world with gravity and sets
 //! the resulting new position of the ellipsoid.
-core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
-		ITriangleSelector* selector, const core::vector3df &position,
-		const core::vector3df& radius,  const core::vector3df& velocity,
-		f32 slidingSpeed,
-		const core::vector3df& gravity,
-		core::triangle3df& triout,
-		core::vector3df& hitPosition,
-		bool& outFalling,
-		ISceneNode*& outNode)
+bool CSceneCollisionManager::collideEllipsoidWithWorld(
+		SCollisionEllipsoid& ellipsoid, SCollisionTriangleCache& cache) const
 {
-	if (!selector || radius.X == 0.0f || radius.Y == 0.0f || radius.Z == 0.0f)
-		return position;
-
 	// This code is based on the paper "Improved Collision detection and Response"
 	// by Kasper Fauerby, but some parts are modified.
 
 	SCollisionData colData;
-	colData.R3Position = position;
-	colData.R3Velocity = velocity;
-	colData.eRadius = radius;
+	colData.R3Position = ellipsoid.Position;
+	colData.R3Velocity = ellipsoid.Velocity;
+	colData.eRadius = ellipsoid.Radius;
 	colData.nearestDistance = FLT_MAX;
-	colData.selector = selector;
-	colData.slidingSpeed = slidingSpeed;
+	colData.triangles = &cache;
+	colData.slidingSpeed = ellipsoid.SlidingSpeed;
 	colData.triangleHits = 0;
 	colData.node = 0;
 
 	core::vector3df eSpacePosition = colData.R3Position / colData.eRadius;
 	core::vector3df eSpaceVelocity = colData.R3Velocity / colData.eRadius;
+	const core::vector3df& gravity = ellipsoid.Gravity;
+
+	// The sliding steps never take the ellipsoid further than the length of
+	// the movement in ellipsoid space, and the same holds for gravity. So
+	// the triangles of this box are all that all steps can touch, and they
+	// are gathered once instead of for each step.
+	const f32 reach = eSpaceVelocity.getLength() + (gravity / colData.eRadius).getLength() + 1.f;
+	core::aabbox3df box(colData.R3Position - colData.eRadius * reach,
+		colData.R3Position + colData.eRadius * reach);
+	gatherTriangles(ellipsoid, box, cache);
 
 	// iterate until we have our final position
 
 	core::vector3df finalPos = collideWithWorld(
 		0, colData, eSpacePosition, eSpaceVelocity);
 
-	outFalling = false;
+	ellipsoid.Falling = false;
 
 	// add gravity
 
@@ -740,26 +1269,27 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 		finalPos = collideWithWorld(0, colData,
 			finalPos, eSpaceVelocity);
 
-		outFalling = (colData.triangleHits == 0);
+		ellipsoid.Falling = (colData.triangleHits == 0);
 	}
 
+	ellipsoid.Node = 0;
 	if (colData.triangleHits)
 	{
-		triout = colData.intersectionTriangle;
-		triout.pointA *= colData.eRadius;
-		triout.pointB *= colData.eRadius;
-		triout.pointC *= colData.eRadius;
-		outNode = colData.node;
+		ellipsoid.Triangle = colData.intersectionTriangle;
+		ellipsoid.Triangle.pointA *= colData.eRadius;
+		ellipsoid.Triangle.pointB *= colData.eRadius;
+		ellipsoid.Triangle.pointC *= colData.eRadius;
+		ellipsoid.Node = colData.node;
 	}
 
-	finalPos *= colData.eRadius;
-	hitPosition = colData.intersectionPoint * colData.eRadius;
-	return finalPos;
+	ellipsoid.ResultPosition = finalPos * colData.eRadius;
+	ellipsoid.HitPosition = colData.intersectionPoint * colData.eRadius;
+	return colData.triangleHits != 0;
 }
 
 
 core::vector3df CSceneCollisionManager::collideWithWorld(s32 recursionDepth,
-	SCollisionData &colData, const core::vector3df& pos, const core::vector3df& vel)
+	SCollisionData &colData, const core::vector3df& pos, const core::vector3df& vel) const
 {
 	f32 veryCloseDistance = colData.slidingSpeed;
 
@@ -775,30 +1305,24 @@ core::vector3df CSceneCollisionManager::collideWithWorld(s32 recursionDepth,
 
 	//------------------ collide with world
 
-	// get all triangles with which we might collide
-	core::aabbox3d<f32> box(colData.R3Position);
-	box.addInternalPoint(colData.R3Position + colData.R3Velocity);
-	box.MinEdge -= colData.eRadius;
-	box.MaxEdge += colData.eRadius;
+	// all triangles with which we might collide, gathered by collideEllipsoidWithWorld
+	const core::array<core::triangle3df>& triangles = colData.triangles->Triangles;
+	const core::array<SCollisionTriangleRange>& outTriangleInfo = colData.triangles->TriangleInfo;
 
-	s32 totalTriangleCnt = colData.selector->getTriangleCount();
-	Triangles.set_used(totalTriangleCnt);
-
-	core::matrix4 scaleMatrix;
-	scaleMatrix.setScale(
-			core::vector3df(1.0f / colData.eRadius.X,
-					1.0f / colData.eRadius.Y,
-					1.0f / colData.eRadius.Z));
-
-	irr::core::array<SCollisionTriangleRange> outTriangleInfo;
-	s32 triangleCnt = 0;
-	colData.selector->getTriangles(Triangles.pointer(), totalTriangleCnt, triangleCnt, box, &scaleMatrix, true, &outTriangleInfo);
+	// the triangles are gathered for all steps, this step only reaches those in its box
+	core::aabbox3df stepBox(pos);
+	stepBox.addInternalPoint(pos + vel);
+	stepBox.MinEdge -= core::vector3df(1.f, 1.f, 1.f);
+	stepBox.MaxEdge += core::vector3df(1.f, 1.f, 1.f);
 
 	// Find closest intersection
 	irr::s32 nearestTriangleIndex = -1;
-	for (s32 i=0; i<triangleCnt; ++i)
+	for (s32 i=0; i<(s32)triangles.size(); ++i)
 	{
-		if(testTriangleIntersection(&colData, Triangles[i]))
+		if (triangles[i].isTotalOutsideBox(stepBox))
+			continue;
+
+		if(testTriangleIntersection(&colData, triangles[i]))
 		{
 			nearestTriangleIndex = i;
 		}
@@ -8,9 +8,12 @@
 #include "ISceneCollisionManager.h"
 #include "ISceneManager.h"
 #include "IVideoDriver.h"
+#include "ITriangleSelector.h"
 
 namespace irr
 {
+class CThreadPool;
+
 namespace scene
 {
 
@@ -59,6 +62,10 @@ namespace scene
 			f32 slidingSpeed,
 			const core::vector3df& gravityDirectionAndSpeed) _IRR_OVERRIDE_;
 
+		//! Collides many moving ellipsoids with 3d worlds with gravity.
+		virtual void getCollisionResultPositions(SCollisionEllipsoid* ellipsoids,
+			u32 count, u32 threadCount=1) _IRR_OVERRIDE_;
+
 		//! Returns a 3d ray which would go through the 2d screen coordinates.
 		virtual core::line3d<f32> getRayFromScreenCoordinates(
 			const core::position2d<s32> & pos, const ICameraSceneNode* camera = 0) _IRR_OVERRIDE_;
@@ -76,9 +83,77 @@ namespace scene
 								ISceneNode * collisionRootNode = 0,
 								bool noDebugObjects = false)  _IRR_OVERRIDE_;
 
+		//! Finds the nearest collision points of many lines and lots of triangles.
+		virtual u32 getCollisionPoints(const core::line3d<f32>* rays, u32 rayCount,
+				ITriangleSelector* selector, SCollisionHit* hitResults, bool* outHits,
+				bool anyHit=false, u32 threadCount=1) _IRR_OVERRIDE_;
+
+		//! Perform ray/box and ray/triangle collision checks of many lines on a hierarchy of scene nodes.
+		virtual u32 getSceneNodesAndCollisionPointsFromRays(
+								const core::line3df* rays, u32 rayCount,
+								SCollisionHit* hitResults,
+								s32 idBitMask = 0,
+								ISceneNode * collisionRootNode = 0,
+								bool noDebugObjects = false,
+								u32 threadCount = 1) _IRR_OVERRIDE_;
+
 	private:
 
-		//! recursive method for going through all scene nodes
+		//! node which getSceneNodesAndCollisionPointsFromRays tests
+		struct SPickCandidate
+		{
+			ISceneNode* Node;
+			ITriangleSelector* Selector;
+			core::matrix4 WorldToObject;
+			core::aabbox3df Box;
+		};
+
+		//! lines and results of a batch query, shared by the threads
+		struct SRayBatch
+		{
+			const core::line3df* Rays;
+			SCollisionHit* Hits;
+			bool* Found;
+			ITriangleSelector* Selector;
+			const core::array<SPickCandidate>* Candidates;
+			core::array<u32> Order;
+			u32 ChunkSize;
+			bool AnyHit;
+		};
+
+		//! ellipsoids of getCollisionResultPositions, shared by the threads
+		struct SEllipsoidBatch
+		{
+			const CSceneCollisionManager* Manager;
+			SCollisionEllipsoid* Ellipsoids;
+			u32 Count;
+			u32 ChunkSize;
+		};
+
+		//! creates Threads if more than one thread is wanted
+		/** \return Number of threads, 0 replaced by the number of processors. */
+		u32 prepareThreads(u32 threadCount);
+
+		//! sorts the lines of a batch so that close lines follow each other
+		static void sortRays(SRayBatch& batch, u32 rayCount);
+
+		//! runs a task for each chunk of a batch, on several threads if wanted
+		void runBatch(SRayBatch& batch, u32 rayCount, u32 threadCount, void (*task)(void*, u32));
+
+		//! tests a chunk of the lines of a batch against one selector
+		static void collideRayChunk(void* batch, u32 chunk);
+
+		//! tests a chunk of the lines of a batch against the scene nodes
+		static void pickRayChunk(void* batch, u32 chunk);
+
+		//! moves a chunk of the ellipsoids of a batch
+		static void collideEllipsoidChunk(void* batch, u32 chunk);
+
+		//! collects the nodes which getSceneNodesAndCollisionPointsFromRays tests
+		void getPickCandidates(ISceneNode* root, s32 bits, bool noDebugObjects,
+					core::array<SPickCandidate>& outCandidates) const;
+
+		//! tests the nodes below root which the spatial index of the scene finds on the ray
 		void getPickedNodeBB(ISceneNode* root, core::line3df& ray, s32 bits,
 					bool bNoDebugObjects,
 					f32& outbestdistance, ISceneNode*& outbestnode);
@@ -114,7 +189,7 @@ namespace scene
 
 			f32 slidingSpeed;
 
-			ITriangleSelector* selector;
+			const SCollisionTriangleCache* triangles;
 		};
 
 		//! Tests the current collision data against an individual triangle.
@@ -123,26 +198,30 @@ namespace scene
 		\param triangle: the triangle to test against.
 		\return true if the triangle is hit (and is the closest hit), false otherwise */
 		bool testTriangleIntersection(SCollisionData* colData,
-			const core::triangle3df& triangle);
+			const core::triangle3df& triangle) const;
 
-		//! recursive method for doing collision response
-		core::vector3df collideEllipsoidWithWorld(ITriangleSelector* selector,
-			const core::vector3df &position,
-			const core::vector3df& radius,  const core::vector3df& velocity,
-			f32 slidingSpeed,
-			const core::vector3df& gravity, core::triangle3df& triout,
-			core::vector3df& hitPosition,
-			bool& outFalling,
-			ISceneNode*& outNode);
+		//! gathers the triangles for the movement of an ellipsoid, unless the cache has them
+		/** \param box: Box which contains everything the ellipsoid may touch. */
+		static void gatherTriangles(const SCollisionEllipsoid& ellipsoid,
+			const core::aabbox3df& box, SCollisionTriangleCache& cache);
+
+		//! moves an ellipsoid, with the triangles of a cache
+		/** \return True if the ellipsoid collided. */
+		bool collideEllipsoidWithWorld(SCollisionEllipsoid& ellipsoid,
+			SCollisionTriangleCache& cache) const;
 
+		//! recursive method for doing collision response
 		core::vector3df collideWithWorld(s32 recursionDepth, SCollisionData &colData,
-			const core::vector3df& pos, const core::vector3df& vel);
+			const core::vector3df& pos, const core::vector3df& vel) const;
 
 		inline bool getLowestRoot(f32 a, f32 b, f32 c, f32 maxR, f32* root) const;
 
 		ISceneManager* SceneManager;
 		video::IVideoDriver* Driver;
 		core::array<core::triangle3df> Triangles; // triangle buffer
+		SCollisionTriangleCache EllipsoidTriangles; // triangle buffer of getCollisionResultPosition
+		CThreadPool* Threads; // for batch queries, created when first needed
+		u32 ThreadCount; // threads Threads was created for
 	};
 
 
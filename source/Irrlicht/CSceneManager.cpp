@@ -8,6 +8,7 @@
 #include "IFileSystem.h"
 #include "SAnimatedMesh.h"
 #include "CMeshCache.h"
+#include "CAsyncLoader.h"
 #include "IXMLWriter.h"
 #include "ISceneUserDataSerializer.h"
 #include "IGUIEnvironment.h"
@@ -30,6 +31,10 @@
 #include "CIrrMeshFileLoader.h"
 #endif
 
+#ifdef _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+#include "CIrrBinaryMeshFileLoader.h"
+#endif
+
 #ifdef _IRR_COMPILE_WITH_BSP_LOADER_
 #include "CBSPMeshFileLoader.h"
 #endif
@@ -122,6 +127,10 @@
 #include "CIrrMeshWriter.h"
 #endif
 
+#ifdef _IRR_COMPILE_WITH_IRR_BINARY_WRITER_
+#include "CIrrBinaryMeshWriter.h"
+#endif
+
 #ifdef _IRR_COMPILE_WITH_STL_WRITER_
 #include "CSTLMeshWriter.h"
 #endif
@@ -146,6 +155,7 @@
 #include "CLightSceneNode.h"
 #include "CBillboardSceneNode.h"
 #include "CMeshSceneNode.h"
+#include "CInstancedMeshSceneNode.h"
 #include "CSkyBoxSceneNode.h"
 #include "CSkyDomeSceneNode.h"
 
@@ -166,6 +176,7 @@
 #include "CSceneCollisionManager.h"
 #include "CTriangleSelector.h"
 #include "COctreeTriangleSelector.h"
+#include "CBVHTriangleSelector.h"
 #include "CTriangleBBSelector.h"
 #include "CMetaTriangleSelector.h"
 #include "CTerrainTriangleSelector.h"
@@ -192,10 +203,11 @@ namespace scene
 
 //! constructor
 CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
-		gui::ICursorControl* cursorControl, IMeshCache* cache,
+		gui::ICursorControl* cursorControl, CMeshCache* cache,
 		gui::IGUIEnvironment* gui)
 : ISceneNode(0, 0), Driver(driver), FileSystem(fs), GUIEnvironment(gui),
 	CursorControl(cursorControl), CollisionManager(0),
+	AnimateTimeMs(0), ThreadPool(0), ThreadPoolSize(0), AsyncLoader(0),
 	ActiveCamera(0), ShadowColor(150,0,0,0), AmbientLight(0,0,0,0), Parameters(0),
 	MeshCache(cache), CurrentRenderPass(ESNRP_NONE), LightManager(0),
 	IRR_XML_FORMAT_SCENE(L"irr_scene"), IRR_XML_FORMAT_NODE(L"node"), IRR_XML_FORMAT_NODE_ATTR_TYPE(L"type")
@@ -230,6 +242,7 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 	Parameters = new io::CAttributes();
 	Parameters->setAttribute(DEBUG_NORMAL_LENGTH, 1.f);
 	Parameters->setAttribute(DEBUG_NORMAL_COLOR, video::SColor(255, 34, 221, 221));
+	Parameters->setAttribute(ASYNC_LOAD_BUDGET, 2);
 
 	// create collision manager
 	CollisionManager = new CSceneCollisionManager(this, Driver);
@@ -285,6 +298,9 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 	#ifdef _IRR_COMPILE_WITH_IRR_MESH_LOADER_
 	MeshLoaderList.push_back(new CIrrMeshFileLoader(this, FileSystem));
 	#endif
+	#ifdef _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+	MeshLoaderList.push_back(new CIrrBinaryMeshFileLoader(this));
+	#endif
 	#ifdef _IRR_COMPILE_WITH_BSP_LOADER_
 	MeshLoaderList.push_back(new CBSPMeshFileLoader(this, FileSystem));
 	#endif
@@ -346,6 +362,13 @@ CSceneManager::~CSceneManager()
 {
 	clearDeletionList();
 
+	if (ThreadPool)
+		ThreadPool->drop();
+
+	// waits for the worker threads, which use the driver
+	if (AsyncLoader)
+		AsyncLoader->drop();
+
 	//! force to remove hardwareTextures from the driver
 	//! because Scenes may hold internally data bounded to sceneNodes
 	//! which may be destroyed twice
@@ -399,6 +422,9 @@ CSceneManager::~CSceneManager()
 	removeAll();
 	removeAnimators();
 
+	// nodes which are still grabbed elsewhere don't keep their entries
+	NodeIndex.clear();
+
 	if (Driver)
 		Driver->drop();
 }
@@ -408,7 +434,10 @@ CSceneManager::~CSceneManager()
 IAnimatedMesh* CSceneManager::getMesh(const io::path& filename, const io::path& alternativeCacheName)
 {
 	io::path cacheName = alternativeCacheName.empty() ? filename : alternativeCacheName;
-	IAnimatedMesh* msh = MeshCache->getMeshByName(cacheName);
+
+	// threads asking for a mesh which is being loaded wait for that load
+	bool load = false;
+	IAnimatedMesh* msh = MeshCache->beginLoad(cacheName, load);
 	if (msh)
 		return msh;
 
@@ -416,12 +445,14 @@ IAnimatedMesh* CSceneManager::getMesh(const io::path& filename, const io::path&
 	if (!file)
 	{
 		os::Printer::log("Could not load mesh, because file could not be opened: ", filename, ELL_ERROR);
-		return 0;
+	}
+	else
+	{
+		msh = getUncachedMesh(file, filename, cacheName);
+		file->drop();
 	}
 
-	msh = getUncachedMesh(file, filename, cacheName);
-
-	file->drop();
+	MeshCache->endLoad(cacheName);
 
 	return msh;
 }
@@ -434,15 +465,44 @@ IAnimatedMesh* CSceneManager::getMesh(io::IReadFile* file)
 		return 0;
 
 	io::path name = file->getFileName();
-	IAnimatedMesh* msh = MeshCache->getMeshByName(name);
+	bool load = false;
+	IAnimatedMesh* msh = MeshCache->beginLoad(name, load);
 	if (msh)
 		return msh;
 
 	msh = getUncachedMesh(file, name, name);
+	MeshCache->endLoad(name);
 
 	return msh;
 }
 
+//! starts loading a mesh in the background
+IAsyncLoadRequest* CSceneManager::getMeshAsync(const io::path& filename, IAsyncLoadCallBack* callBack)
+{
+	if (!AsyncLoader)
+		AsyncLoader = new CAsyncLoader(this);
+
+	return AsyncLoader->loadMesh(filename, callBack);
+}
+
+
+//! starts loading a texture in the background
+IAsyncLoadRequest* CSceneManager::getTextureAsync(const io::path& filename, IAsyncLoadCallBack* callBack)
+{
+	if (!AsyncLoader)
+		AsyncLoader = new CAsyncLoader(this);
+
+	return AsyncLoader->loadTexture(filename, callBack);
+}
+
+
+//! finishes background loads until the time budget is used up
+u32 CSceneManager::updateAsyncLoads(u32 timeBudgetMs)
+{
+	return AsyncLoader ? AsyncLoader->update(timeBudgetMs) : 0;
+}
+
+
 // load and create a mesh which we know already isn't in the cache and put it in there
 IAnimatedMesh* CSceneManager::getUncachedMesh(io::IReadFile* file, const io::path& filename, const io::path& cachename)
 {
@@ -632,6 +692,25 @@ IMeshSceneNode* CSceneManager::addMeshSceneNode(IMesh* mesh, ISceneNode* parent,
 }
 
 
+//! adds a scene node for rendering a static mesh many times
+//! the returned pointer must not be dropped.
+IInstancedMeshSceneNode* CSceneManager::addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, s32 id,
+	const core::vector3df& position, const core::vector3df& rotation,
+	const core::vector3df& scale, bool alsoAddIfMeshPointerZero)
+{
+	if (!alsoAddIfMeshPointerZero && !mesh)
+		return 0;
+
+	if (!parent)
+		parent = this;
+
+	IInstancedMeshSceneNode* node = new CInstancedMeshSceneNode(mesh, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+}
+
+
 //! Adds a scene node for rendering a animated water surface mesh.
 ISceneNode* CSceneManager::addWaterSurfaceSceneNode(IMesh* mesh, f32 waveHeight, f32 waveSpeed, f32 waveLength,
 	ISceneNode* parent, s32 id, const core::vector3df& position,
@@ -1199,9 +1278,14 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 	// can be seen by a bounding box ?
 	if (!result && (node->getAutomaticCulling() & scene::EAC_BOX))
 	{
-		core::aabbox3d<f32> tbox = node->getBoundingBox();
-		node->getAbsoluteTransformation().transformBoxEx(tbox);
-		result = !(tbox.intersectsWithBox(cam->getViewFrustum()->getBoundingBox() ));
+		// the spatial index already tested the nodes which didn't move since drawAll
+		const core::aabbox3d<f32>& frustumBox = cam->getViewFrustum()->getBoundingBox();
+		if (!NodeIndex.isOutside(node, frustumBox, result))
+		{
+			core::aabbox3d<f32> tbox = node->getBoundingBox();
+			node->getAbsoluteTransformation().transformBoxEx(tbox);
+			result = !(tbox.intersectsWithBox(frustumBox));
+		}
 	}
 
 	// can be seen by a bounding sphere
@@ -1261,6 +1345,40 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass)
 {
 	IRR_PROFILE(CProfileScope p1(EPID_SM_REGISTER);)
+
+	switch(pass)
+	{
+	case ESNRP_CAMERA:
+	case ESNRP_LIGHT:
+	case ESNRP_SKY_BOX:
+	case ESNRP_NONE:
+		return addNodeForRendering(node, pass, false);
+	default:
+		break;
+	}
+
+	// culled later on the thread pool, see registerPendingNodes()
+	if (ThreadPool)
+	{
+		SPendingNode pending;
+		pending.Node = node;
+		pending.Pass = pass;
+
+		// the occlusion queries of the driver are not thread safe
+		pending.Tested = (node->getAutomaticCulling() & EAC_OCC_QUERY) != 0;
+		pending.Culled = pending.Tested && isCulled(node);
+
+		PendingNodeList.push_back(pending);
+		return 1;
+	}
+
+	return addNodeForRendering(node, pass, isCulled(node));
+}
+
+
+//! adds a node to the list of a render pass, culling already done
+u32 CSceneManager::addNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass, bool culled)
+{
 	u32 taken = 0;
 
 	switch(pass)
@@ -1299,28 +1417,28 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 		taken = 1;
 		break;
 	case ESNRP_SOLID:
-		if (!isCulled(node))
+		if (!culled)
 		{
-			SolidNodeList.push_back(node);
+			SolidNodeList.push_back(DefaultNodeEntry(node, pass, camWorldPos));
 			taken = 1;
 		}
 		break;
 	case ESNRP_TRANSPARENT:
-		if (!isCulled(node))
+		if (!culled)
 		{
 			TransparentNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
 			taken = 1;
 		}
 		break;
 	case ESNRP_TRANSPARENT_EFFECT:
-		if (!isCulled(node))
+		if (!culled)
 		{
 			TransparentEffectNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
 			taken = 1;
 		}
 		break;
 	case ESNRP_AUTOMATIC:
-		if (!isCulled(node))
+		if (!culled)
 		{
 			const u32 count = node->getMaterialCount();
 
@@ -1342,13 +1460,13 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 			// not transparent, register as solid
 			if (!taken)
 			{
-				SolidNodeList.push_back(node);
+				SolidNodeList.push_back(DefaultNodeEntry(node, ESNRP_SOLID, camWorldPos));
 				taken = 1;
 			}
 		}
 		break;
 	case ESNRP_SHADOW:
-		if (!isCulled(node))
+		if (!culled)
 		{
 			ShadowNodeList.push_back(node);
 			taken = 1;
@@ -1373,6 +1491,157 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 	return taken;
 }
 
+
+//! stable radix sort of the render list entries on their Key
+template <class T>
+static void radixSort(core::array<T>& list, core::array<T>& buffer)
+{
+	const u32 size = list.size();
+	if (size < 2)
+		return;
+
+	// histograms of all 8 digits in one pass
+	u32 count[8][256];
+	memset(count, 0, sizeof(count));
+
+	u32 i;
+	u32 digit;
+	for (i = 0; i != size; ++i)
+	{
+		const u64 key = list[i].Key;
+		for (digit = 0; digit != 8; ++digit)
+			count[digit][(key >> (digit * 8)) & 0xFF] += 1;
+	}
+
+	buffer.set_used(size);
+	T* source = list.pointer();
+	T* dest = buffer.pointer();
+
+	for (digit = 0; digit != 8; ++digit)
+	{
+		const u32 shift = digit * 8;
+		u32* offset = count[digit];
+
+		// all keys have the same value in this digit
+		if (offset[(source[0].Key >> shift) & 0xFF] == size)
+			continue;
+
+		u32 sum = 0;
+		for (i = 0; i != 256; ++i)
+		{
+			const u32 c = offset[i];
+			offset[i] = sum;
+			sum += c;
+		}
+
+		for (i = 0; i != size; ++i)
+			dest[offset[(source[i].Key >> shift) & 0xFF]++] = source[i];
+
+		T* swap = source;
+		source = dest;
+		dest = swap;
+	}
+
+	if (source != list.pointer())
+		list.swap(buffer);
+}
+
+
+//! nodes culled by one task of the thread pool
+#define SCENE_CULL_CHUNK 256
+
+void CSceneManager::cullNodesTask(void* sceneManager, u32 index)
+{
+	CSceneManager* smgr = (CSceneManager*) sceneManager;
+	const u32 end = core::min_(index * SCENE_CULL_CHUNK + SCENE_CULL_CHUNK, smgr->PendingNodeList.size());
+
+	for (u32 i = index * SCENE_CULL_CHUNK; i < end; ++i)
+	{
+		SPendingNode& pending = smgr->PendingNodeList[i];
+		if (!pending.Tested)
+			pending.Culled = smgr->isCulled(pending.Node);
+	}
+}
+
+
+//! culls the nodes registered with the thread pool and adds them to the render lists
+void CSceneManager::registerPendingNodes()
+{
+	if (PendingNodeList.empty())
+		return;
+
+	IRR_PROFILE(CProfileScope p1(EPID_SM_REGISTER);)
+
+	const u32 chunks = (PendingNodeList.size() + SCENE_CULL_CHUNK - 1) / SCENE_CULL_CHUNK;
+	u32 i;
+	if (ThreadPool)
+		ThreadPool->run(cullNodesTask, this, chunks);
+	else
+	{
+		for (i = 0; i != chunks; ++i)
+			cullNodesTask(this, i);
+	}
+
+	// same order as without threads
+	for (i = 0; i != PendingNodeList.size(); ++i)
+		addNodeForRendering(PendingNodeList[i].Node, PendingNodeList[i].Pass, PendingNodeList[i].Culled);
+
+	PendingNodeList.set_used(0);
+}
+
+
+void CSceneManager::animateNodesTask(void* sceneManager, u32 index)
+{
+	CSceneManager* smgr = (CSceneManager*) sceneManager;
+	smgr->AnimateNodeList[index]->OnAnimate(smgr->AnimateTimeMs);
+}
+
+
+//! animates the children of the root node on the thread pool
+void CSceneManager::animateParallel(u32 timeMs)
+{
+	if (!IsVisible)
+		return;
+
+	// same as ISceneNode::OnAnimate
+	ISceneNodeAnimatorList::Iterator ait = Animators.begin();
+	while (ait != Animators.end())
+	{
+		ISceneNodeAnimator* anim = *ait;
+		++ait;
+		if (anim->isEnabled())
+			anim->animateNode(this, timeMs);
+	}
+
+	updateAbsolutePosition();
+
+	ISceneNodeList::Iterator it = Children.begin();
+	for (; it != Children.end(); ++it)
+		AnimateNodeList.push_back(*it);
+
+	AnimateTimeMs = timeMs;
+	ThreadPool->run(animateNodesTask, this, AnimateNodeList.size());
+	AnimateNodeList.set_used(0);
+}
+
+
+//! creates or removes the thread pool for the PARALLEL_SCENE_THREADS parameter
+void CSceneManager::updateThreadPool()
+{
+	const s32 threads = Parameters->getAttributeAsInt(PARALLEL_SCENE_THREADS);
+	if (threads < 0 || (u32)threads == ThreadPoolSize)
+		return;
+
+	if (ThreadPool)
+		ThreadPool->drop();
+	ThreadPool = 0;
+
+	ThreadPoolSize = threads;
+	if (ThreadPoolSize)
+		ThreadPool = new CThreadPool(ThreadPoolSize);
+}
+
+
 void CSceneManager::clearAllRegisteredNodesForRendering()
 {
 	CameraList.clear();
@@ -1382,6 +1651,7 @@ void CSceneManager::clearAllRegisteredNodesForRendering()
 	TransparentNodeList.clear();
 	TransparentEffectNodeList.clear();
 	ShadowNodeList.clear();
+	PendingNodeList.clear();
 }
 
 //! This method is called just before the rendering process of the whole scene.
@@ -1393,6 +1663,9 @@ void CSceneManager::drawAll()
 	if (!Driver)
 		return;
 
+	if (AsyncLoader)
+		AsyncLoader->update((u32)core::max_(Parameters->getAttributeAsInt(ASYNC_LOAD_BUDGET), 0));
+
 #ifdef _IRR_SCENEMANAGER_DEBUG
 	// reset attributes
 	Parameters->setAttribute("culled", 0);
@@ -1414,9 +1687,14 @@ void CSceneManager::drawAll()
 	// TODO: This should not use an attribute here but a real parameter when necessary (too slow!)
 	Driver->setAllowZWriteOnTransparent(Parameters->getAttributeAsBool(ALLOW_ZWRITE_ON_TRANSPARENT));
 
+	updateThreadPool();
+
 	// do animations and other stuff.
 	IRR_PROFILE(getProfiler().start(EPID_SM_ANIMATE));
-	OnAnimate(os::Timer::getTime());
+	if (ThreadPool && Parameters->getAttributeAsBool(PARALLEL_SCENE_ANIMATION))
+		animateParallel(os::Timer::getTime());
+	else
+		OnAnimate(os::Timer::getTime());
 	IRR_PROFILE(getProfiler().stop(EPID_SM_ANIMATE));
 
 	/*!
@@ -1429,11 +1707,17 @@ void CSceneManager::drawAll()
 	{
 		ActiveCamera->render();
 		camWorldPos = ActiveCamera->getAbsolutePosition();
+
+		// find the nodes which can be visible in the spatial index, so
+		// isCulled doesn't have to transform their bounding boxes again
+		NodeIndex.update(this);
+		NodeIndex.markVisible(ActiveCamera->getViewFrustum()->getBoundingBox());
 	}
 	IRR_PROFILE(getProfiler().stop(EPID_SM_RENDER_CAMERAS));
 
 	// let all nodes register themselves
 	OnRegisterSceneNode();
+	registerPendingNodes();
 
 	if (LightManager)
 		LightManager->OnPreRender(LightList);
@@ -1537,7 +1821,7 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_SOLID;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
-		SolidNodeList.sort(); // sort by textures
+		radixSort(SolidNodeList, SolidNodeSortBuffer); // sort by material and textures, then front to back
 
 		if (LightManager)
 		{
@@ -1604,7 +1888,7 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_TRANSPARENT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
-		TransparentNodeList.sort(); // sort by distance from camera
+		radixSort(TransparentNodeList, TransparentNodeSortBuffer); // sort by distance from camera
 		if (LightManager)
 		{
 			LightManager->OnRenderPassPreRender(CurrentRenderPass);
@@ -1638,7 +1922,7 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_TRANSPARENT_EFFECT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
-		TransparentEffectNodeList.sort(); // sort by distance from camera
+		radixSort(TransparentEffectNodeList, TransparentNodeSortBuffer); // sort by distance from camera
 
 		if (LightManager)
 		{
@@ -1909,6 +2193,38 @@ ITriangleSelector* CSceneManager::createOctreeTriangleSelector(IMeshBuffer* mesh
 	return new COctreeTriangleSelector(meshBuffer, materialIndex, node, minimalPolysPerNode);
 }
 
+
+//! Creates a ITriangleSelector with a bounding volume hierarchy, based on a mesh.
+ITriangleSelector* CSceneManager::createBVHTriangleSelector(IMesh* mesh,
+							ISceneNode* node, bool separateMeshbuffers)
+{
+	if (!mesh)
+		return 0;
+
+	return new CBVHTriangleSelector(mesh, node, separateMeshbuffers);
+}
+
+
+//! Creates a ITriangleSelector with a bounding volume hierarchy, based on a meshbuffer.
+ITriangleSelector* CSceneManager::createBVHTriangleSelector(const IMeshBuffer* meshBuffer, irr::u32 materialIndex,
+			ISceneNode* node)
+{
+	if (!meshBuffer)
+		return 0;
+
+	return new CBVHTriangleSelector(meshBuffer, materialIndex, node);
+}
+
+
+//! Creates a ITriangleSelector with a bounding volume hierarchy, refit to the frames of an animated node.
+ITriangleSelector* CSceneManager::createBVHTriangleSelector(IAnimatedMeshSceneNode* node, bool separateMeshbuffers)
+{
+	if (!node || !node->getMesh())
+		return 0;
+
+	return new CBVHTriangleSelector(node, separateMeshbuffers);
+}
+
 //! Creates a meta triangle selector.
 IMetaTriangleSelector* CSceneManager::createMetaTriangleSelector()
 {
@@ -1931,6 +2247,8 @@ void CSceneManager::addToDeletionQueue(ISceneNode* node)
 	if (!node)
 		return;
 
+	// animators may call this from the threads of animateParallel()
+	CMutexLock lock(DeletionMutex);
 	node->grab();
 	DeletionList.push_back(node);
 }
@@ -2043,6 +2361,52 @@ void CSceneManager::getSceneNodesFromType(ESCENE_NODE_TYPE type, core::array<sce
 }
 
 
+//! returns scene nodes whose transformed bounding box intersects a box
+void CSceneManager::getSceneNodesFromBox(const core::aabbox3df& box, core::array<scene::ISceneNode*>& outNodes)
+{
+	NodeIndex.update(this);
+	NodeIndex.getNodes(box, outNodes);
+}
+
+
+//! returns scene nodes whose transformed bounding box intersects a sphere
+void CSceneManager::getSceneNodesFromSphere(const core::vector3df& center, f32 radius, core::array<scene::ISceneNode*>& outNodes)
+{
+	NodeIndex.update(this);
+	NodeIndex.getNodes(center, radius, outNodes);
+}
+
+
+//! returns scene nodes whose transformed bounding box may be inside a view frustum
+void CSceneManager::getSceneNodesFromFrustum(const SViewFrustum& frustum, core::array<scene::ISceneNode*>& outNodes)
+{
+	NodeIndex.update(this);
+	NodeIndex.getNodes(frustum, outNodes);
+}
+
+
+//! returns scene nodes whose transformed bounding box intersects a line
+void CSceneManager::getSceneNodesFromLine(const core::line3df& line, core::array<scene::ISceneNode*>& outNodes)
+{
+	NodeIndex.update(this);
+	NodeIndex.getNodes(line, outNodes);
+}
+
+
+//! tells the spatial index that the bounding box of a node may have changed
+void CSceneManager::updateSceneNodeIndex(ISceneNode* node)
+{
+	NodeIndex.markDirty(node);
+}
+
+
+//! removes a node from the spatial index
+void CSceneManager::removeFromSceneNodeIndex(ISceneNode* node)
+{
+	NodeIndex.remove(node);
+}
+
+
 //! Posts an input event to the environment. Usually you do not have to
 //! use this method, it is used by the internal engine.
 bool CSceneManager::postEventFromUser(const SEvent& event)
@@ -2584,6 +2948,13 @@ IMeshWriter* CSceneManager::createMeshWriter(EMESH_WRITER_TYPE type)
 #else
 		return 0;
 #endif
+
+	case EMWT_IRR_BINARY_MESH:
+#ifdef _IRR_COMPILE_WITH_IRR_BINARY_WRITER_
+		return new CIrrBinaryMeshWriter(Driver);
+#else
+		return 0;
+#endif
 	}
 
 	return 0;
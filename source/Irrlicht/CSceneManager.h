@@ -13,6 +13,8 @@
 #include "IMeshLoader.h"
 #include "CAttributes.h"
 #include "ILightManager.h"
+#include "CThreadPool.h"
+#include "CSceneNodeIndex.h"
 
 namespace irr
 {
@@ -23,8 +25,9 @@ namespace io
 }
 namespace scene
 {
-	class IMeshCache;
+	class CMeshCache;
 	class IGeometryCreator;
+	class CAsyncLoader;
 
 	/*!
 		The Scene Manager manages scene nodes, mesh resources, cameras and all the other stuff.
@@ -35,7 +38,7 @@ namespace scene
 
 		//! constructor
 		CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
-			gui::ICursorControl* cursorControl, IMeshCache* cache = 0,
+			gui::ICursorControl* cursorControl, CMeshCache* cache = 0,
 			gui::IGUIEnvironment *guiEnvironment = 0);
 
 		//! destructor
@@ -47,6 +50,15 @@ namespace scene
 		//! gets an animateable mesh. loads it if needed. returned pointer must not be dropped.
 		virtual IAnimatedMesh* getMesh(io::IReadFile* file) _IRR_OVERRIDE_;
 
+		//! starts loading a mesh in the background
+		virtual IAsyncLoadRequest* getMeshAsync(const io::path& filename, IAsyncLoadCallBack* callBack=0) _IRR_OVERRIDE_;
+
+		//! starts loading a texture in the background
+		virtual IAsyncLoadRequest* getTextureAsync(const io::path& filename, IAsyncLoadCallBack* callBack=0) _IRR_OVERRIDE_;
+
+		//! finishes background loads until the time budget is used up
+		virtual u32 updateAsyncLoads(u32 timeBudgetMs) _IRR_OVERRIDE_;
+
 		//! Returns an interface to the mesh cache which is shared between all existing scene managers.
 		virtual IMeshCache* getMeshCache() _IRR_OVERRIDE_;
 
@@ -97,6 +109,14 @@ namespace scene
 			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
 			bool alsoAddIfMeshPointerZero=false) _IRR_OVERRIDE_;
 
+		//! adds a scene node for rendering a static mesh many times
+		//! the returned pointer must not be dropped.
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			bool alsoAddIfMeshPointerZero=false) _IRR_OVERRIDE_;
+
 		//! Adds a scene node for rendering a animated water surface mesh.
 		virtual ISceneNode* addWaterSurfaceSceneNode(IMesh* mesh, f32 waveHeight, f32 waveSpeed, f32 wlength, ISceneNode* parent=0, s32 id=-1,
 			const core::vector3df& position = core::vector3df(0,0,0),
@@ -366,6 +386,17 @@ namespace scene
 		virtual ITriangleSelector* createOctreeTriangleSelector(IMeshBuffer* meshBuffer, irr::u32 materialIndex,
 			ISceneNode* node, s32 minimalPolysPerNode=32) _IRR_OVERRIDE_;
 
+		//! Creates a ITriangleSelector with a bounding volume hierarchy, based on a mesh.
+		virtual ITriangleSelector* createBVHTriangleSelector(IMesh* mesh,
+			ISceneNode* node, bool separateMeshbuffers) _IRR_OVERRIDE_;
+
+		//! Creates a ITriangleSelector with a bounding volume hierarchy, based on a meshbuffer.
+		virtual ITriangleSelector* createBVHTriangleSelector(const IMeshBuffer* meshBuffer, irr::u32 materialIndex,
+			ISceneNode* node) _IRR_OVERRIDE_;
+
+		//! Creates a ITriangleSelector with a bounding volume hierarchy, refit to the frames of an animated node.
+		virtual ITriangleSelector* createBVHTriangleSelector(IAnimatedMeshSceneNode* node, bool separateMeshbuffers) _IRR_OVERRIDE_;
+
 		//! Creates a simple dynamic ITriangleSelector, based on a axis aligned bounding box.
 		virtual ITriangleSelector* createTriangleSelectorFromBoundingBox(
 			ISceneNode* node) _IRR_OVERRIDE_;
@@ -424,6 +455,24 @@ namespace scene
 		//! returns scene nodes by type.
 		virtual void getSceneNodesFromType(ESCENE_NODE_TYPE type, core::array<scene::ISceneNode*>& outNodes, ISceneNode* start=0) _IRR_OVERRIDE_;
 
+		//! returns scene nodes whose transformed bounding box intersects a box
+		virtual void getSceneNodesFromBox(const core::aabbox3df& box, core::array<scene::ISceneNode*>& outNodes) _IRR_OVERRIDE_;
+
+		//! returns scene nodes whose transformed bounding box intersects a sphere
+		virtual void getSceneNodesFromSphere(const core::vector3df& center, f32 radius, core::array<scene::ISceneNode*>& outNodes) _IRR_OVERRIDE_;
+
+		//! returns scene nodes whose transformed bounding box may be inside a view frustum
+		virtual void getSceneNodesFromFrustum(const SViewFrustum& frustum, core::array<scene::ISceneNode*>& outNodes) _IRR_OVERRIDE_;
+
+		//! returns scene nodes whose transformed bounding box intersects a line
+		virtual void getSceneNodesFromLine(const core::line3df& line, core::array<scene::ISceneNode*>& outNodes) _IRR_OVERRIDE_;
+
+		//! tells the spatial index that the bounding box of a node may have changed
+		virtual void updateSceneNodeIndex(ISceneNode* node) _IRR_OVERRIDE_;
+
+		//! removes a node from the spatial index
+		virtual void removeFromSceneNodeIndex(ISceneNode* node) _IRR_OVERRIDE_;
+
 		//! Posts an input event to the environment. Usually you do not have to
 		//! use this method, it is used by the internal engine.
 		virtual bool postEventFromUser(const SEvent& event) _IRR_OVERRIDE_;
@@ -540,45 +589,78 @@ namespace scene
 		//! clears the deletion list
 		void clearDeletionList();
 
+		//! adds a node to the list of a render pass, culling already done
+		u32 addNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass, bool culled);
+
+		//! creates or removes the thread pool for the PARALLEL_SCENE_THREADS parameter
+		void updateThreadPool();
+
+		//! animates the children of the root node on the thread pool
+		void animateParallel(u32 timeMs);
+
+		//! culls the nodes registered with the thread pool and adds them to the render lists
+		void registerPendingNodes();
+
+		static void animateNodesTask(void* sceneManager, u32 index);
+		static void cullNodesTask(void* sceneManager, u32 index);
+
 		//! writes a scene node
 		void writeSceneNode(io::IXMLWriter* writer, ISceneNode* node, ISceneUserDataSerializer* userDataSerializer, const fschar_t* currentPath=0, bool init=false);
 
+		//! sort on render pass, material type, textures and distance to camera
+		/** The Key is sorted ascending by radixSort(). Only the first material
+		of a node is used, as nodes render all their mesh buffers at once. */
 		struct DefaultNodeEntry
 		{
-			DefaultNodeEntry(ISceneNode* n) :
-				Node(n), TextureValue(0)
-			{
-				if (n->getMaterialCount())
-					TextureValue = (n->getMaterial(0).getTexture(0));
-			}
+			DefaultNodeEntry() : Node(0), Key(0) {}
 
-			bool operator < (const DefaultNodeEntry& other) const
+			DefaultNodeEntry(ISceneNode* n, E_SCENE_NODE_RENDER_PASS pass, const core::vector3df& camera)
+				: Node(n)
 			{
-				return (TextureValue < other.TextureValue);
+				// bits 63-60 pass, 59-48 material type, 47-16 textures, 15-0 distance
+				Key = (u64)(pass & 0xF) << 60;
+
+				if (n->getMaterialCount())
+				{
+					const video::SMaterial& material = n->getMaterial(0);
+					Key |= (u64)(material.MaterialType & 0xFFF) << 48;
+
+					// hash of the texture pointers, equal sets get equal values
+					u32 textures = 2166136261u;
+					for (u32 i=0; i<video::MATERIAL_MAX_TEXTURES_USED; ++i)
+					{
+						textures ^= (u32)(size_t)material.getTexture(i);
+						textures *= 16777619u;
+					}
+					Key |= (u64)textures << 16;
+				}
+
+				// the upper bits of a positive float sort like the float, front to back
+				core::inttofloat distance;
+				distance.f = Node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camera);
+				Key |= distance.u >> 16;
 			}
 
 			ISceneNode* Node;
-			private:
-			void* TextureValue;
+			u64 Key;
 		};
 
 		//! sort on distance (center) to camera
+		/** Back to front, the Key only contains the distance. */
 		struct TransparentNodeEntry
 		{
+			TransparentNodeEntry() : Node(0), Key(0) {}
+
 			TransparentNodeEntry(ISceneNode* n, const core::vector3df& camera)
 				: Node(n)
 			{
-				Distance = Node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camera);
-			}
-
-			bool operator < (const TransparentNodeEntry& other) const
-			{
-				return Distance > other.Distance;
+				core::inttofloat distance;
+				distance.f = Node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camera);
+				Key = ~distance.u;
 			}
 
 			ISceneNode* Node;
-			private:
-				f64 Distance;
+			u64 Key;
 		};
 
 		//! sort on distance (sphere) to camera
@@ -630,6 +712,29 @@ namespace scene
 		core::array<DefaultNodeEntry> SolidNodeList;
 		core::array<TransparentNodeEntry> TransparentNodeList;
 		core::array<TransparentNodeEntry> TransparentEffectNodeList;
+		core::array<DefaultNodeEntry> SolidNodeSortBuffer;
+		core::array<TransparentNodeEntry> TransparentNodeSortBuffer;
+
+		//! nodes registered with the thread pool, culled after the registration
+		struct SPendingNode
+		{
+			ISceneNode* Node;
+			E_SCENE_NODE_RENDER_PASS Pass;
+			bool Tested;
+			bool Culled;
+		};
+		core::array<SPendingNode> PendingNodeList;
+		core::array<ISceneNode*> AnimateNodeList;
+		u32 AnimateTimeMs;
+		CThreadPool* ThreadPool;
+		u32 ThreadPoolSize;
+		CMutex DeletionMutex;
+
+		//! transformed bounding boxes of all nodes below the root
+		CSceneNodeIndex NodeIndex;
+
+		//! created by the first getMeshAsync or getTextureAsync call
+		CAsyncLoader* AsyncLoader;
 
 		core::array<IMeshLoader*> MeshLoaderList;
 		core::array<ISceneLoader*> SceneLoaderList;
@@ -649,7 +754,7 @@ namespace scene
 		io::CAttributes* Parameters;
 
 		//! Mesh cache
-		IMeshCache* MeshCache;
+		CMeshCache* MeshCache;
 
 		E_SCENE_NODE_RENDER_PASS CurrentRenderPass;
 
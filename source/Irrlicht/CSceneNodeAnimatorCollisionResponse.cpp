@@ -25,7 +25,7 @@ CSceneNodeAnimatorCollisionResponse::CSceneNodeAnimatorCollisionResponse(
 	World(world), Object(object), SceneManager(scenemanager), LastTime(0),
 	SlidingSpeed(slidingSpeed), CollisionNode(0), CollisionCallback(0),
 	Falling(false), IsCamera(false), AnimateCameraTarget(true), CollisionOccurred(false),
-	FirstUpdate(true)
+	FirstUpdate(true), CacheTriangles(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CSceneNodeAnimatorCollisionResponse");
@@ -124,6 +124,7 @@ void CSceneNodeAnimatorCollisionResponse::setWorld(ITriangleSelector* newWorld)
 		World->drop();
 
 	World = newWorld;
+	WorldTriangles.invalidate();
 
 	FirstUpdate = true;
 }
@@ -137,6 +138,23 @@ ITriangleSelector* CSceneNodeAnimatorCollisionResponse::getWorld() const
 }
 
 
+//! Keep the triangles of the world near the node between frames
+void CSceneNodeAnimatorCollisionResponse::setCacheTriangles(bool enable)
+{
+	CacheTriangles = enable;
+	// gather a radius more on all sides, the node can move that far before it's needed again
+	WorldTriangles.Margin = enable ? 1.f : 0.f;
+	WorldTriangles.invalidate();
+}
+
+
+//! Are the triangles of the world kept between frames?
+bool CSceneNodeAnimatorCollisionResponse::getCacheTriangles() const
+{
+	return CacheTriangles;
+}
+
+
 void CSceneNodeAnimatorCollisionResponse::animateNode(ISceneNode* node, u32 timeMs)
 {
 	CollisionOccurred = false;
@@ -183,12 +201,28 @@ void CSceneNodeAnimatorCollisionResponse::animateNode(ISceneNode* node, u32 time
 	{
 		// TODO: divide SlidingSpeed by frame time
 
-		bool f = false;
-		CollisionResultPosition
-			= SceneManager->getSceneCollisionManager()->getCollisionResultPosition(
-				World, LastPosition-Translation,
-				Radius, vel, CollisionTriangle, CollisionPoint, f,
-				CollisionNode, SlidingSpeed, FallingVelocity*diffSec);
+		SCollisionEllipsoid ellipsoid;
+		ellipsoid.Selector = World;
+		ellipsoid.Position = LastPosition-Translation;
+		ellipsoid.Radius = Radius;
+		ellipsoid.Velocity = vel;
+		ellipsoid.Gravity = FallingVelocity*diffSec;
+		ellipsoid.SlidingSpeed = SlidingSpeed;
+		ellipsoid.Triangle = CollisionTriangle;
+
+		// each animator has its own triangles, so animators can be
+		// animated on several threads, see PARALLEL_SCENE_ANIMATION
+		if (!CacheTriangles)
+			WorldTriangles.invalidate();
+		ellipsoid.Cache = &WorldTriangles;
+
+		SceneManager->getSceneCollisionManager()->getCollisionResultPositions(&ellipsoid, 1);
+
+		CollisionResultPosition = ellipsoid.ResultPosition;
+		CollisionTriangle = ellipsoid.Triangle;
+		CollisionPoint = ellipsoid.HitPosition;
+		CollisionNode = ellipsoid.Node;
+		const bool f = ellipsoid.Falling;
 
 		CollisionOccurred = (CollisionTriangle != RefTriangle);
 
@@ -252,6 +286,7 @@ void CSceneNodeAnimatorCollisionResponse::serializeAttributes(io::IAttributes* o
 	out->addVector3d("Gravity", Gravity);
 	out->addVector3d("Translation", Translation);
 	out->addBool("AnimateCameraTarget", AnimateCameraTarget);
+	out->addBool("CacheTriangles", CacheTriangles);
 }
 
 
@@ -264,6 +299,7 @@ void CSceneNodeAnimatorCollisionResponse::deserializeAttributes(io::IAttributes*
 	Gravity = in->getAttributeAsVector3d("Gravity", Gravity);
 	Translation = in->getAttributeAsVector3d("Translation", Translation);
 	AnimateCameraTarget = in->getAttributeAsBool("AnimateCameraTarget", AnimateCameraTarget);
+	setCacheTriangles(in->getAttributeAsBool("CacheTriangles", CacheTriangles));
 }
 
 
@@ -275,6 +311,7 @@ ISceneNodeAnimator* CSceneNodeAnimatorCollisionResponse::createClone(ISceneNode*
 		new CSceneNodeAnimatorCollisionResponse(newManager, World, Object, Radius,
 				Gravity, Translation, SlidingSpeed);
 	newAnimator->cloneMembers(this);
+	newAnimator->setCacheTriangles(CacheTriangles);
 	return newAnimator;
 }
 
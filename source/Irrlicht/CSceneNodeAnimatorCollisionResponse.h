@@ -6,6 +6,7 @@
 #define __C_SCENE_NODE_ANIMATOR_COLLISION_RESPONSE_H_INCLUDED__
 
 #include "ISceneNodeAnimatorCollisionResponse.h"
+#include "ITriangleSelector.h"
 
 namespace irr
 {
@@ -75,6 +76,12 @@ namespace scene
 		//! collision detection.
 		virtual ITriangleSelector* getWorld() const _IRR_OVERRIDE_;
 
+		//! Keep the triangles of the world near the node between frames
+		virtual void setCacheTriangles(bool enable) _IRR_OVERRIDE_;
+
+		//! Are the triangles of the world kept between frames?
+		virtual bool getCacheTriangles() const _IRR_OVERRIDE_;
+
 		//! animates a scene node
 		virtual void animateNode(ISceneNode* node, u32 timeMs) _IRR_OVERRIDE_;
 
@@ -132,6 +139,7 @@ namespace scene
 		core::triangle3df RefTriangle;
 
 		ITriangleSelector* World;
+		SCollisionTriangleCache WorldTriangles;
 		ISceneNode* Object;
 		ISceneManager* SceneManager;
 		u32 LastTime;
@@ -148,6 +156,7 @@ namespace scene
 		bool AnimateCameraTarget;
 		bool CollisionOccurred;
 		bool FirstUpdate;
+		bool CacheTriangles;
 	};
 
 } // end namespace scene
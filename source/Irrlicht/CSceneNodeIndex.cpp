@@ -0,0 +1,539 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneNodeIndex.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! leaves are larger than the node by this part of its size on each side
+	const f32 LeafMargin = 0.1f;
+
+	//! the tree stays balanced, this is enough for far more nodes than memory holds
+	const u32 MaxStackSize = 128;
+
+	// the entry number a node keeps is shifted left, the lowest bit marks dirty nodes
+	inline s32 encodeEntry(u32 entry, bool dirty)
+	{
+		return (s32)((entry << 1) | (dirty ? 1 : 0));
+	}
+
+	inline bool isDirty(s32 value)
+	{
+		return value >= 0 && (value & 1);
+	}
+
+	//! half the surface area of a box
+	inline f32 getArea(const core::aabbox3df& box)
+	{
+		const core::vector3df e = box.getExtent();
+		return e.X * e.Y + e.Y * e.Z + e.Z * e.X;
+	}
+
+	inline core::aabbox3df getUnion(const core::aabbox3df& a, const core::aabbox3df& b)
+	{
+		core::aabbox3df box(a);
+		box.addInternalBox(b);
+		return box;
+	}
+
+	struct SBoxTest
+	{
+		SBoxTest(const core::aabbox3df& box) : Box(box) {}
+
+		bool operator()(const core::aabbox3df& box) const
+		{
+			return Box.intersectsWithBox(box);
+		}
+
+		const core::aabbox3df& Box;
+	};
+
+	struct SSphereTest
+	{
+		SSphereTest(const core::vector3df& center, f32 radius)
+			: Center(center), RadiusSQ(radius * radius) {}
+
+		bool operator()(const core::aabbox3df& box) const
+		{
+			// distance to the nearest point of the box
+			const core::vector3df nearest(
+				core::clamp(Center.X, box.MinEdge.X, box.MaxEdge.X),
+				core::clamp(Center.Y, box.MinEdge.Y, box.MaxEdge.Y),
+				core::clamp(Center.Z, box.MinEdge.Z, box.MaxEdge.Z));
+			return Center.getDistanceFromSQ(nearest) <= RadiusSQ;
+		}
+
+		core::vector3df Center;
+		f32 RadiusSQ;
+	};
+
+	struct SFrustumTest
+	{
+		SFrustumTest(const SViewFrustum& frustum) : Frustum(frustum) {}
+
+		bool operator()(const core::aabbox3df& box) const
+		{
+			// the planes face outwards, a box is outside if even its
+			// corner furthest behind a plane is in front of it
+			for (u32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+			{
+				const core::plane3df& plane = Frustum.planes[i];
+				const core::vector3df corner(
+					plane.Normal.X > 0.f ? box.MinEdge.X : box.MaxEdge.X,
+					plane.Normal.Y > 0.f ? box.MinEdge.Y : box.MaxEdge.Y,
+					plane.Normal.Z > 0.f ? box.MinEdge.Z : box.MaxEdge.Z);
+				if (plane.Normal.dotProduct(corner) + plane.D > 0.f)
+					return false;
+			}
+			return true;
+		}
+
+		const SViewFrustum& Frustum;
+	};
+
+	struct SLineTest
+	{
+		SLineTest(const core::line3df& line)
+			: Middle(line.getMiddle()), Vector(line.getVector().normalize()),
+			HalfLength(line.getLength() * 0.5f) {}
+
+		bool operator()(const core::aabbox3df& box) const
+		{
+			return box.intersectsWithLine(Middle, Vector, HalfLength);
+		}
+
+		core::vector3df Middle;
+		core::vector3df Vector;
+		f32 HalfLength;
+	};
+
+	//! finds the root of the tree a scene node is in
+	inline const ISceneNode* getTopNode(const ISceneNode* node)
+	{
+		while (node->getParent())
+			node = node->getParent();
+		return node;
+	}
+
+} // end anonymous namespace
+
+
+CSceneNodeIndex::CSceneNodeIndex()
+: Root(-1), FreeNode(-1), FreeEntry(-1), EntryCount(0), VisibleFrame(0), VisibleValid(false)
+{
+}
+
+
+void CSceneNodeIndex::markDirty(ISceneNode* node)
+{
+	// only the thread animating a node changes its entry number, so
+	// marked nodes can return without the lock
+	const s32 value = node->getSceneNodeIndexEntry();
+	if (isDirty(value) || (value < 0 && !node->getParent()))
+		return;
+
+	CMutexLock lock(Mutex);
+
+	u32 entry;
+	if (value >= 0)
+		entry = (u32)value >> 1;
+	else if (FreeEntry >= 0)
+	{
+		entry = (u32)FreeEntry;
+		FreeEntry = Entries[entry].Leaf;
+	}
+	else
+	{
+		entry = Entries.size();
+		Entries.push_back(SEntry());
+	}
+
+	if (value < 0)
+	{
+		SEntry& e = Entries[entry];
+		e.Node = node;
+		e.Leaf = -1;
+		e.VisibleFrame = 0;
+		++EntryCount;
+	}
+
+	node->setSceneNodeIndexEntry(encodeEntry(entry, true));
+	DirtyEntries.push_back(entry);
+}
+
+
+void CSceneNodeIndex::remove(ISceneNode* node)
+{
+	const s32 value = node->getSceneNodeIndexEntry();
+	if (value < 0)
+		return;
+
+	CMutexLock lock(Mutex);
+	removeEntry((u32)value >> 1);
+}
+
+
+void CSceneNodeIndex::removeEntry(u32 entry)
+{
+	SEntry& e = Entries[entry];
+	if (e.Leaf >= 0)
+	{
+		removeLeaf(e.Leaf);
+		freeNode(e.Leaf);
+	}
+
+	e.Node->setSceneNodeIndexEntry(-1);
+	e.Node = 0;
+	e.Leaf = FreeEntry;
+	FreeEntry = (s32)entry;
+	--EntryCount;
+}
+
+
+void CSceneNodeIndex::clear()
+{
+	CMutexLock lock(Mutex);
+
+	for (u32 i=0; i<Entries.size(); ++i)
+	{
+		if (Entries[i].Node)
+			Entries[i].Node->setSceneNodeIndexEntry(-1);
+	}
+
+	Nodes.clear();
+	Entries.clear();
+	DirtyEntries.clear();
+	Root = -1;
+	FreeNode = -1;
+	FreeEntry = -1;
+	EntryCount = 0;
+	VisibleValid = false;
+}
+
+
+void CSceneNodeIndex::update(const ISceneNode* root)
+{
+	CMutexLock lock(Mutex);
+
+	if (DirtyEntries.empty())
+		return;
+
+	for (u32 i=0; i<DirtyEntries.size(); ++i)
+	{
+		// entries are listed again if they were removed and reused
+		const u32 entry = DirtyEntries[i];
+		ISceneNode* node = Entries[entry].Node;
+		if (!node || node->getSceneNodeIndexEntry() != encodeEntry(entry, true))
+			continue;
+
+		if (getTopNode(node) != root)
+		{
+			removeEntry(entry);
+			continue;
+		}
+
+		node->setSceneNodeIndexEntry(encodeEntry(entry, false));
+		const core::aabbox3df box = node->getTransformedBoundingBox();
+		Entries[entry].Box = box;
+
+		s32 leaf = Entries[entry].Leaf;
+		if (leaf >= 0)
+		{
+			if (box.isFullInside(Nodes[leaf].Box))
+				continue;
+			removeLeaf(leaf);
+		}
+		else
+		{
+			leaf = allocateNode();
+			Nodes[leaf].Entry = entry;
+			Entries[entry].Leaf = leaf;
+		}
+
+		const core::vector3df margin = box.getExtent() * LeafMargin;
+		Nodes[leaf].Box = core::aabbox3df(box.MinEdge - margin, box.MaxEdge + margin);
+		insertLeaf(leaf);
+	}
+
+	DirtyEntries.set_used(0);
+	VisibleValid = false;
+}
+
+
+template <class TTest>
+void CSceneNodeIndex::query(const TTest& test, core::array<ISceneNode*>& outNodes) const
+{
+	CMutexLock lock(Mutex);
+
+	if (Root < 0)
+		return;
+
+	s32 stack[MaxStackSize];
+	u32 stackSize = 0;
+	stack[stackSize++] = Root;
+
+	while (stackSize)
+	{
+		const STreeNode& node = Nodes[stack[--stackSize]];
+		if (!test(node.Box))
+			continue;
+
+		if (node.Child[0] < 0)
+		{
+			const SEntry& entry = Entries[node.Entry];
+			if (test(entry.Box))
+				outNodes.push_back(entry.Node);
+		}
+		else if (stackSize + 2 <= MaxStackSize)
+		{
+			stack[stackSize++] = node.Child[1];
+			stack[stackSize++] = node.Child[0];
+		}
+	}
+}
+
+
+void CSceneNodeIndex::getNodes(const core::aabbox3df& box, core::array<ISceneNode*>& outNodes) const
+{
+	query(SBoxTest(box), outNodes);
+}
+
+
+void CSceneNodeIndex::getNodes(const core::vector3df& center, f32 radius, core::array<ISceneNode*>& outNodes) const
+{
+	query(SSphereTest(center, radius), outNodes);
+}
+
+
+void CSceneNodeIndex::getNodes(const SViewFrustum& frustum, core::array<ISceneNode*>& outNodes) const
+{
+	query(SFrustumTest(frustum), outNodes);
+}
+
+
+void CSceneNodeIndex::getNodes(const core::line3df& line, core::array<ISceneNode*>& outNodes) const
+{
+	query(SLineTest(line), outNodes);
+}
+
+
+void CSceneNodeIndex::markVisible(const core::aabbox3df& frustumBox)
+{
+	core::array<ISceneNode*> visible;
+	getNodes(frustumBox, visible);
+
+	CMutexLock lock(Mutex);
+	++VisibleFrame;
+	for (u32 i=0; i<visible.size(); ++i)
+		Entries[(u32)visible[i]->getSceneNodeIndexEntry() >> 1].VisibleFrame = VisibleFrame;
+
+	VisibleBox = frustumBox;
+	VisibleValid = true;
+}
+
+
+bool CSceneNodeIndex::isOutside(const ISceneNode* node, const core::aabbox3df& frustumBox, bool& outOutside) const
+{
+	// called while the nodes are culled, nothing changes the index then
+	const s32 value = node->getSceneNodeIndexEntry();
+	if (value < 0 || isDirty(value) || !VisibleValid ||
+		VisibleBox.MinEdge != frustumBox.MinEdge || VisibleBox.MaxEdge != frustumBox.MaxEdge)
+		return false;
+
+	outOutside = (Entries[(u32)value >> 1].VisibleFrame != VisibleFrame);
+	return true;
+}
+
+
+s32 CSceneNodeIndex::allocateNode()
+{
+	s32 index = FreeNode;
+	if (index >= 0)
+		FreeNode = Nodes[index].Parent;
+	else
+	{
+		index = (s32)Nodes.size();
+		Nodes.push_back(STreeNode());
+	}
+
+	STreeNode& node = Nodes[index];
+	node.Parent = -1;
+	node.Child[0] = -1;
+	node.Child[1] = -1;
+	node.Height = 0;
+	node.Entry = 0;
+	return index;
+}
+
+
+void CSceneNodeIndex::freeNode(s32 index)
+{
+	Nodes[index].Parent = FreeNode;
+	Nodes[index].Height = -1;
+	FreeNode = index;
+}
+
+
+void CSceneNodeIndex::insertLeaf(s32 leaf)
+{
+	if (Root < 0)
+	{
+		Root = leaf;
+		Nodes[leaf].Parent = -1;
+		return;
+	}
+
+	// descend to the sibling which makes the tree grow least in surface area
+	const core::aabbox3df leafBox = Nodes[leaf].Box;
+	s32 index = Root;
+	while (Nodes[index].Child[0] >= 0)
+	{
+		const STreeNode& node = Nodes[index];
+		const f32 area = getArea(node.Box);
+		const f32 combinedArea = getArea(getUnion(node.Box, leafBox));
+
+		// cost of a new parent for this node and the leaf
+		const f32 cost = 2.f * combinedArea;
+		// cost the boxes above grow by when descending further
+		const f32 inheritedCost = 2.f * (combinedArea - area);
+
+		f32 childCost[2];
+		for (u32 i=0; i<2; ++i)
+		{
+			const STreeNode& child = Nodes[node.Child[i]];
+			childCost[i] = getArea(getUnion(child.Box, leafBox)) + inheritedCost;
+			if (child.Child[0] >= 0)
+				childCost[i] -= getArea(child.Box);
+		}
+
+		if (cost < childCost[0] && cost < childCost[1])
+			break;
+
+		index = node.Child[childCost[0] < childCost[1] ? 0 : 1];
+	}
+
+	const s32 sibling = index;
+	const s32 oldParent = Nodes[sibling].Parent;
+	const s32 newParent = allocateNode();
+
+	STreeNode& parent = Nodes[newParent];
+	parent.Parent = oldParent;
+	parent.Box = getUnion(leafBox, Nodes[sibling].Box);
+	parent.Height = Nodes[sibling].Height + 1;
+	parent.Child[0] = sibling;
+	parent.Child[1] = leaf;
+	Nodes[sibling].Parent = newParent;
+	Nodes[leaf].Parent = newParent;
+
+	if (oldParent >= 0)
+	{
+		STreeNode& node = Nodes[oldParent];
+		node.Child[node.Child[0] == sibling ? 0 : 1] = newParent;
+	}
+	else
+		Root = newParent;
+
+	refit(Nodes[leaf].Parent);
+}
+
+
+void CSceneNodeIndex::removeLeaf(s32 leaf)
+{
+	if (leaf == Root)
+	{
+		Root = -1;
+		return;
+	}
+
+	const s32 parent = Nodes[leaf].Parent;
+	const s32 grandParent = Nodes[parent].Parent;
+	const s32 sibling = Nodes[parent].Child[Nodes[parent].Child[0] == leaf ? 1 : 0];
+
+	// the sibling takes the place of the parent
+	if (grandParent >= 0)
+	{
+		STreeNode& node = Nodes[grandParent];
+		node.Child[node.Child[0] == parent ? 0 : 1] = sibling;
+		Nodes[sibling].Parent = grandParent;
+		freeNode(parent);
+		refit(grandParent);
+	}
+	else
+	{
+		Root = sibling;
+		Nodes[sibling].Parent = -1;
+		freeNode(parent);
+	}
+}
+
+
+void CSceneNodeIndex::refit(s32 index)
+{
+	while (index >= 0)
+	{
+		index = balance(index);
+
+		STreeNode& node = Nodes[index];
+		const STreeNode& child0 = Nodes[node.Child[0]];
+		const STreeNode& child1 = Nodes[node.Child[1]];
+		node.Height = 1 + core::max_(child0.Height, child1.Height);
+		node.Box = getUnion(child0.Box, child1.Box);
+
+		index = node.Parent;
+	}
+}
+
+
+s32 CSceneNodeIndex::balance(s32 a)
+{
+	STreeNode& A = Nodes[a];
+	if (A.Child[0] < 0 || A.Height < 2)
+		return a;
+
+	const s32 heightDifference = Nodes[A.Child[1]].Height - Nodes[A.Child[0]].Height;
+	if (heightDifference >= -1 && heightDifference <= 1)
+		return a;
+
+	// the higher child c takes the place of a, a takes the place of the
+	// lower child of c and c keeps its higher child
+	const u32 up = heightDifference > 1 ? 1 : 0;
+	const s32 b = A.Child[1 - up];
+	const s32 c = A.Child[up];
+	STreeNode& C = Nodes[c];
+	const s32 f = C.Child[0];
+	const s32 g = C.Child[1];
+	const bool keepF = Nodes[f].Height > Nodes[g].Height;
+	const s32 higher = keepF ? f : g;
+	const s32 lower = keepF ? g : f;
+
+	C.Parent = A.Parent;
+	A.Parent = c;
+	if (C.Parent >= 0)
+	{
+		STreeNode& node = Nodes[C.Parent];
+		node.Child[node.Child[0] == a ? 0 : 1] = c;
+	}
+	else
+		Root = c;
+
+	C.Child[0] = a;
+	C.Child[1] = higher;
+	A.Child[up] = lower;
+	Nodes[lower].Parent = a;
+
+	A.Box = getUnion(Nodes[b].Box, Nodes[lower].Box);
+	A.Height = 1 + core::max_(Nodes[b].Height, Nodes[lower].Height);
+	C.Box = getUnion(A.Box, Nodes[higher].Box);
+	C.Height = 1 + core::max_(A.Height, Nodes[higher].Height);
+	return c;
+}
+
+} // end namespace scene
+} // end namespace irr
+
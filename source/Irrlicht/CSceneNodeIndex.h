@@ -0,0 +1,138 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_NODE_INDEX_H_INCLUDED__
+#define __C_SCENE_NODE_INDEX_H_INCLUDED__
+
+#include "ISceneNode.h"
+#include "SViewFrustum.h"
+#include "CThreadPool.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Spatial index over the transformed bounding boxes of the nodes of a scene
+/** The boxes are kept in a dynamic tree of axis aligned boxes, which is
+rebalanced with rotations when leaves are inserted or removed. Leaves hold the
+box of a node grown by a margin, so nodes which move a bit stay in their leaf
+and only the exact box of the node is updated.
+Nodes are marked when their box may have changed, from any thread, and the
+marked nodes are updated by the next call of update(). Each node keeps the
+number of its entry and whether it is marked, see ISceneNode::getSceneNodeIndexEntry(). */
+class CSceneNodeIndex
+{
+public:
+
+	//! constructor
+	CSceneNodeIndex();
+
+	//! marks the box of a node as outdated, adds nodes which aren't indexed yet
+	/** Nodes without parent are never indexed. */
+	void markDirty(ISceneNode* node);
+
+	//! removes a node, but not its children
+	void remove(ISceneNode* node);
+
+	//! removes all nodes
+	void clear();
+
+	//! updates the boxes of all marked nodes
+	/** Nodes which aren't below root any more are removed. */
+	void update(const ISceneNode* root);
+
+	//! appends the nodes whose box intersects a box
+	void getNodes(const core::aabbox3df& box, core::array<ISceneNode*>& outNodes) const;
+
+	//! appends the nodes whose box intersects a sphere
+	void getNodes(const core::vector3df& center, f32 radius, core::array<ISceneNode*>& outNodes) const;
+
+	//! appends the nodes whose box isn't completely outside a plane of a frustum
+	void getNodes(const SViewFrustum& frustum, core::array<ISceneNode*>& outNodes) const;
+
+	//! appends the nodes whose box intersects a line
+	void getNodes(const core::line3df& line, core::array<ISceneNode*>& outNodes) const;
+
+	//! remembers which nodes have a box intersecting the box of the view frustum
+	/** Must be called after update(), the next update which changes
+	anything forgets the visible nodes again. */
+	void markVisible(const core::aabbox3df& frustumBox);
+
+	//! looks up if the box of a node intersected the box given to markVisible()
+	/** \param outOutside Set to true if the box of the node was outside.
+	\return False if the node was marked since or frustumBox isn't the box
+	given to markVisible(), outOutside isn't set then. */
+	bool isOutside(const ISceneNode* node, const core::aabbox3df& frustumBox, bool& outOutside) const;
+
+	//! returns the number of indexed nodes
+	u32 size() const { return EntryCount; }
+
+private:
+
+	struct STreeNode
+	{
+		//! box of the node with margin for leaves, of both children else
+		core::aabbox3df Box;
+		//! next free tree node for unused ones
+		s32 Parent;
+		//! both -1 for leaves
+		s32 Child[2];
+		//! 0 for leaves
+		s32 Height;
+		//! entry of the leaves
+		u32 Entry;
+	};
+
+	struct SEntry
+	{
+		//! 0 for unused entries
+		ISceneNode* Node;
+		//! exact box of the node
+		core::aabbox3df Box;
+		//! -1 until the first update, next free entry for unused entries
+		s32 Leaf;
+		//! last call of markVisible() which found the node
+		u32 VisibleFrame;
+	};
+
+	template <class TTest>
+	void query(const TTest& test, core::array<ISceneNode*>& outNodes) const;
+
+	void removeEntry(u32 entry);
+
+	s32 allocateNode();
+	void freeNode(s32 index);
+
+	void insertLeaf(s32 leaf);
+	void removeLeaf(s32 leaf);
+
+	//! walks up from a node and refits the boxes
+	void refit(s32 index);
+
+	//! rotates a node whose children differ more than 1 in height
+	/** \return The node now in the place of index. */
+	s32 balance(s32 index);
+
+	core::array<STreeNode> Nodes;
+	core::array<SEntry> Entries;
+	core::array<u32> DirtyEntries;
+	s32 Root;
+	s32 FreeNode;
+	s32 FreeEntry;
+	u32 EntryCount;
+
+	core::aabbox3df VisibleBox;
+	u32 VisibleFrame;
+	bool VisibleValid;
+
+	//! nodes may be marked while they are animated on several threads
+	mutable CMutex Mutex;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -10,8 +10,64 @@
 #include "IAnimatedMeshSceneNode.h"
 #include "os.h"
 
+// the joint matrices are blended with SSE, which every x86 cpu with SSE2 has
+#if (defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(NO_IRR_SKINNING_SSE_)
+	#define _IRR_SKINNING_SSE_
+	#include <xmmintrin.h>
+#endif
+
 namespace
 {
+	// Returns the index of the first key at or after frame, or -1.
+	// The keys next to the hint are tested first, as animations mostly move forward.
+	template <class T> // T = objects containing a "frame" variable
+	irr::s32 findKey(const irr::core::array<T>& keys, irr::f32 frame, irr::s32& hint)
+	{
+		const irr::s32 size = (irr::s32)keys.size();
+		if (hint>=0 && hint<size)
+		{
+			if (hint>0 && keys[hint].frame>=frame && keys[hint-1].frame<frame)
+				return hint;
+			if (hint+1<size && keys[hint+1].frame>=frame && keys[hint].frame<frame)
+				return ++hint;
+		}
+
+		// the keys are sorted by frame
+		irr::s32 first = 0;
+		irr::s32 last = size;
+		while (first<last)
+		{
+			const irr::s32 mid = (first+last)/2;
+			if (keys[mid].frame < frame)
+				first = mid+1;
+			else
+				last = mid;
+		}
+		if (first==size)
+			return -1;
+
+		hint = first;
+		return first;
+	}
+
+	// one joint influence of a vertex, sorted to build the skin vertices
+	struct SSkinWeightRef
+	{
+		irr::u32 Buffer;
+		irr::u32 Vertex;
+		irr::u32 Joint;
+		irr::f32 Weight;
+
+		bool operator<(const SSkinWeightRef& other) const
+		{
+			if (Buffer != other.Buffer)
+				return Buffer < other.Buffer;
+			if (Vertex != other.Vertex)
+				return Vertex < other.Vertex;
+			return Joint < other.Joint;
+		}
+	};
+
 	// Frames must always be increasing, so we remove objects where this isn't the case
 	// return number of kicked keys
 	template <class T> // T = objects containing a "frame" variable
@@ -92,7 +148,9 @@ namespace scene
 
 //! constructor
 CSkinnedMesh::CSkinnedMesh()
-: SkinningBuffers(0), EndFrame(0.f), FramesPerSecond(25.f),
+: SkinningBuffers(0), CompressedSamplesPerFrame(0.f), CompressedSampleCount(0),
+	PoseCacheSize(0), PoseCacheTime(0), PoseInBuffers(-1),
+	EndFrame(0.f), FramesPerSecond(25.f),
 	LastAnimatedFrame(-1), SkinnedLastFrame(false),
 	InterpolationMode(EIM_LINEAR),
 	HasAnimation(false), PreparedForSkinning(false),
@@ -117,6 +175,8 @@ CSkinnedMesh::~CSkinnedMesh()
 		if (LocalBuffers[j])
 			LocalBuffers[j]->drop();
 	}
+
+	clearPoseCache();
 }
 
 
@@ -166,6 +226,27 @@ IMesh* CSkinnedMesh::getMesh(s32 frame, s32 detailLevel, s32 startFrameLoop, s32
 //! Animates this mesh's joints based on frame input
 //! blend: {0-old position, 1-New position}
 void CSkinnedMesh::animateMesh(f32 frame, f32 blend)
+{
+	animateJoints(frame, blend, 0);
+}
+
+
+//! Animates the joints with key positions owned by the caller
+void CSkinnedMesh::animateMesh(f32 frame, f32 blend, core::array<s32>& cursors)
+{
+	if (cursors.size() != AllJoints.size()*3)
+	{
+		cursors.set_used(AllJoints.size()*3);
+		for (u32 i=0; i<cursors.size(); ++i)
+			cursors[i] = -1;
+	}
+
+	animateJoints(frame, blend, cursors.pointer());
+}
+
+
+//! Animates the joints, with the hints stored in the joints if cursors is 0
+void CSkinnedMesh::animateJoints(f32 frame, f32 blend, s32* cursors)
 {
 	if (!HasAnimation || LastAnimatedFrame==frame)
 		return;
@@ -191,10 +272,18 @@ void CSkinnedMesh::animateMesh(f32 frame, f32 blend)
 		core::vector3df scale = oldScale;
 		core::quaternion rotation = oldRotation;
 
-		getFrameData(frame, joint,
-				position, joint->positionHint,
-				scale, joint->scaleHint,
-				rotation, joint->rotationHint);
+		if (CompressedTracks.size() && joint->UseAnimationFrom==joint)
+			getCompressedFrameData(frame, CompressedTracks[i], position, scale, rotation);
+		else if (cursors)
+			getFrameData(frame, joint,
+					position, cursors[i*3],
+					scale, cursors[i*3+1],
+					rotation, cursors[i*3+2]);
+		else
+			getFrameData(frame, joint,
+					position, joint->positionHint,
+					scale, joint->scaleHint,
+					rotation, joint->rotationHint);
 
 		if (blend==1.0f)
 		{
@@ -323,197 +412,350 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 				core::vector3df &scale, s32 &scaleHint,
 				core::quaternion &rotation, s32 &rotationHint)
 {
-	s32 foundPositionIndex = -1;
-	s32 foundScaleIndex = -1;
-	s32 foundRotationIndex = -1;
+	if (!joint->UseAnimationFrom)
+		return;
 
-	if (joint->UseAnimationFrom)
+	const core::array<SPositionKey> &PositionKeys=joint->UseAnimationFrom->PositionKeys;
+	const core::array<SScaleKey> &ScaleKeys=joint->UseAnimationFrom->ScaleKeys;
+	const core::array<SRotationKey> &RotationKeys=joint->UseAnimationFrom->RotationKeys;
+
+	if (PositionKeys.size())
 	{
-		const core::array<SPositionKey> &PositionKeys=joint->UseAnimationFrom->PositionKeys;
-		const core::array<SScaleKey> &ScaleKeys=joint->UseAnimationFrom->ScaleKeys;
-		const core::array<SRotationKey> &RotationKeys=joint->UseAnimationFrom->RotationKeys;
+		const s32 foundPositionIndex = findKey(PositionKeys, frame, positionHint);
 
-		if (PositionKeys.size())
+		//Do interpolation...
+		if (foundPositionIndex!=-1)
 		{
-			foundPositionIndex = -1;
-
-			//Test the Hints...
-			if (positionHint>=0 && (u32)positionHint < PositionKeys.size())
+			if (InterpolationMode==EIM_CONSTANT || foundPositionIndex==0)
 			{
-				//check this hint
-				if (positionHint>0 && PositionKeys[positionHint].frame>=frame && PositionKeys[positionHint-1].frame<frame )
-					foundPositionIndex=positionHint;
-				else if (positionHint+1 < (s32)PositionKeys.size())
-				{
-					//check the next index
-					if ( PositionKeys[positionHint+1].frame>=frame &&
-							PositionKeys[positionHint+0].frame<frame)
-					{
-						positionHint++;
-						foundPositionIndex=positionHint;
-					}
-				}
+				position = PositionKeys[foundPositionIndex].position;
 			}
-
-			//The hint test failed, do a full scan...
-			if (foundPositionIndex==-1)
+			else if (InterpolationMode==EIM_LINEAR)
 			{
-				for (u32 i=0; i<PositionKeys.size(); ++i)
-				{
-					if (PositionKeys[i].frame >= frame) //Keys should to be sorted by frame
-					{
-						foundPositionIndex=i;
-						positionHint=i;
-						break;
-					}
-				}
+				const SPositionKey& KeyA = PositionKeys[foundPositionIndex];
+				const SPositionKey& KeyB = PositionKeys[foundPositionIndex-1];
+
+				const f32 fd1 = frame - KeyA.frame;
+				const f32 fd2 = KeyB.frame - frame;
+				position = ((KeyB.position-KeyA.position)/(fd1+fd2))*fd1 + KeyA.position;
 			}
+		}
+	}
+
+	//------------------------------------------------------------
 
-			//Do interpolation...
-			if (foundPositionIndex!=-1)
+	if (ScaleKeys.size())
+	{
+		const s32 foundScaleIndex = findKey(ScaleKeys, frame, scaleHint);
+
+		//Do interpolation...
+		if (foundScaleIndex!=-1)
+		{
+			if (InterpolationMode==EIM_CONSTANT || foundScaleIndex==0)
 			{
-				if (InterpolationMode==EIM_CONSTANT || foundPositionIndex==0)
-				{
-					position = PositionKeys[foundPositionIndex].position;
-				}
-				else if (InterpolationMode==EIM_LINEAR)
-				{
-					const SPositionKey& KeyA = PositionKeys[foundPositionIndex];
-					const SPositionKey& KeyB = PositionKeys[foundPositionIndex-1];
+				scale = ScaleKeys[foundScaleIndex].scale;
+			}
+			else if (InterpolationMode==EIM_LINEAR)
+			{
+				const SScaleKey& KeyA = ScaleKeys[foundScaleIndex];
+				const SScaleKey& KeyB = ScaleKeys[foundScaleIndex-1];
 
-					const f32 fd1 = frame - KeyA.frame;
-					const f32 fd2 = KeyB.frame - frame;
-					position = ((KeyB.position-KeyA.position)/(fd1+fd2))*fd1 + KeyA.position;
-				}
+				const f32 fd1 = frame - KeyA.frame;
+				const f32 fd2 = KeyB.frame - frame;
+				scale = ((KeyB.scale-KeyA.scale)/(fd1+fd2))*fd1 + KeyA.scale;
 			}
 		}
+	}
 
-		//------------------------------------------------------------
+	//-------------------------------------------------------------
 
-		if (ScaleKeys.size())
-		{
-			foundScaleIndex = -1;
+	if (RotationKeys.size())
+	{
+		const s32 foundRotationIndex = findKey(RotationKeys, frame, rotationHint);
 
-			//Test the Hints...
-			if (scaleHint>=0 && (u32)scaleHint < ScaleKeys.size())
+		//Do interpolation...
+		if (foundRotationIndex!=-1)
+		{
+			if (InterpolationMode==EIM_CONSTANT || foundRotationIndex==0)
 			{
-				//check this hint
-				if (scaleHint>0 && ScaleKeys[scaleHint].frame>=frame && ScaleKeys[scaleHint-1].frame<frame )
-					foundScaleIndex=scaleHint;
-				else if (scaleHint+1 < (s32)ScaleKeys.size())
-				{
-					//check the next index
-					if ( ScaleKeys[scaleHint+1].frame>=frame &&
-							ScaleKeys[scaleHint+0].frame<frame)
-					{
-						scaleHint++;
-						foundScaleIndex=scaleHint;
-					}
-				}
+				rotation = RotationKeys[foundRotationIndex].rotation;
 			}
+			else if (InterpolationMode==EIM_LINEAR)
+			{
+				const SRotationKey& KeyA = RotationKeys[foundRotationIndex];
+				const SRotationKey& KeyB = RotationKeys[foundRotationIndex-1];
 
+				const f32 fd1 = frame - KeyA.frame;
+				const f32 fd2 = KeyB.frame - frame;
+				const f32 t = fd1/(fd1+fd2);
 
-			//The hint test failed, do a full scan...
-			if (foundScaleIndex==-1)
-			{
-				for (u32 i=0; i<ScaleKeys.size(); ++i)
-				{
-					if (ScaleKeys[i].frame >= frame) //Keys should to be sorted by frame
-					{
-						foundScaleIndex=i;
-						scaleHint=i;
-						break;
-					}
-				}
+				/*
+				f32 t = 0;
+				if (KeyA.frame!=KeyB.frame)
+					t = (frame-KeyA.frame) / (KeyB.frame - KeyA.frame);
+				*/
+
+				rotation.slerp(KeyA.rotation, KeyB.rotation, t);
 			}
+		}
+	}
+}
 
-			//Do interpolation...
-			if (foundScaleIndex!=-1)
-			{
-				if (InterpolationMode==EIM_CONSTANT || foundScaleIndex==0)
-				{
-					scale = ScaleKeys[foundScaleIndex].scale;
-				}
-				else if (InterpolationMode==EIM_LINEAR)
-				{
-					const SScaleKey& KeyA = ScaleKeys[foundScaleIndex];
-					const SScaleKey& KeyB = ScaleKeys[foundScaleIndex-1];
 
-					const f32 fd1 = frame - KeyA.frame;
-					const f32 fd2 = KeyB.frame - frame;
-					scale = ((KeyB.scale-KeyA.scale)/(fd1+fd2))*fd1 + KeyA.scale;
-				}
-			}
+//! Samples the compressed animation of a joint
+void CSkinnedMesh::getCompressedFrameData(f32 frame, const SCompressedTrack& track,
+				core::vector3df &position, core::vector3df &scale,
+				core::quaternion &rotation) const
+{
+	const f32 t = core::clamp(frame*CompressedSamplesPerFrame, 0.f, (f32)(CompressedSampleCount-1));
+	u32 a = (u32)t;
+	f32 d = t - (f32)a;
+	const u32 b = core::min_(a+1, CompressedSampleCount-1);
+
+	if (InterpolationMode==EIM_CONSTANT)
+	{
+		// like the keys, use the next sample
+		if (d > 0.f)
+			a = b;
+		d = 0.f;
+	}
+
+	if (track.Position.Count==1)
+		position = CompressedVectors[track.Position.Start];
+	else if (track.Position.Count)
+		position = core::lerp(CompressedVectors[track.Position.Start+a],
+				CompressedVectors[track.Position.Start+b], d);
+
+	if (track.Scale.Count==1)
+		scale = CompressedVectors[track.Scale.Start];
+	else if (track.Scale.Count)
+		scale = core::lerp(CompressedVectors[track.Scale.Start+a],
+				CompressedVectors[track.Scale.Start+b], d);
+
+	if (track.Rotation.Count==1)
+		rotation = getCompressedRotation(track.Rotation.Start);
+	else if (track.Rotation.Count)
+	{
+		if (d > 0.f)
+			rotation.slerp(getCompressedRotation(track.Rotation.Start+a),
+					getCompressedRotation(track.Rotation.Start+b), d);
+		else
+			rotation = getCompressedRotation(track.Rotation.Start+a);
+	}
+}
+
+
+core::quaternion CSkinnedMesh::getCompressedRotation(u32 index) const
+{
+	const SCompressedRotation& r = CompressedRotations[index];
+	core::quaternion q(r.X/32767.f, r.Y/32767.f, r.Z/32767.f, r.W/32767.f);
+	return q.normalize();
+}
+
+
+//! Replaces the animation keys by samples taken at a fixed rate
+void CSkinnedMesh::compressAnimation(f32 framesPerSample)
+{
+	if (!HasAnimation || framesPerSample <= 0.f)
+		return;
+
+	if (CompressedTracks.size())
+	{
+		os::Printer::log("Skinned Mesh: Animation is already compressed", ELL_WARNING);
+		return;
+	}
+
+	CompressedSampleCount = (u32)core::ceil32(EndFrame/framesPerSample)+1;
+	CompressedSamplesPerFrame = 1.f/framesPerSample;
+	CompressedTracks.set_used(AllJoints.size());
+
+	core::array<core::vector3df> positions;
+	core::array<core::vector3df> scales;
+	core::array<SCompressedRotation> rotations;
+	positions.set_used(CompressedSampleCount);
+	scales.set_used(CompressedSampleCount);
+	rotations.set_used(CompressedSampleCount);
+
+	u32 i, n;
+	for (i=0; i<AllJoints.size(); ++i)
+	{
+		SJoint* joint = AllJoints[i];
+		SCompressedTrack& track = CompressedTracks[i];
+		track = SCompressedTrack();
+
+		// joints using the animation of another mesh keep looking up its keys
+		if (joint->UseAnimationFrom != joint)
+			continue;
+
+		s32 positionHint = -1;
+		s32 scaleHint = -1;
+		s32 rotationHint = -1;
+		for (n=0; n<CompressedSampleCount; ++n)
+		{
+			core::quaternion rotation;
+			getFrameData(core::min_((f32)n*framesPerSample, EndFrame), joint,
+					positions[n], positionHint, scales[n], scaleHint,
+					rotation, rotationHint);
+
+			rotation.normalize();
+			rotations[n].X = (s16)core::round32(rotation.X*32767.f);
+			rotations[n].Y = (s16)core::round32(rotation.Y*32767.f);
+			rotations[n].Z = (s16)core::round32(rotation.Z*32767.f);
+			rotations[n].W = (s16)core::round32(rotation.W*32767.f);
 		}
 
-		//-------------------------------------------------------------
+		// store one sample for tracks which don't change
+		const core::array<core::vector3df>* samples[2] = { &positions, &scales };
+		SCompressedChannel* channels[2] = { &track.Position, &track.Scale };
+		const bool animated[2] = { joint->PositionKeys.size() != 0, joint->ScaleKeys.size() != 0 };
+		for (u32 c=0; c<2; ++c)
+		{
+			if (!animated[c])
+				continue;
+
+			const core::array<core::vector3df>& vectors = *samples[c];
+			bool constant = true;
+			for (n=1; n<vectors.size() && constant; ++n)
+				constant = vectors[n].equals(vectors[0]);
+
+			channels[c]->Start = CompressedVectors.size();
+			channels[c]->Count = constant ? 1 : vectors.size();
+			for (n=0; n<channels[c]->Count; ++n)
+				CompressedVectors.push_back(vectors[n]);
+		}
 
-		if (RotationKeys.size())
+		if (joint->RotationKeys.size())
 		{
-			foundRotationIndex = -1;
+			bool constant = true;
+			for (n=1; n<rotations.size() && constant; ++n)
+				constant = rotations[n].X==rotations[0].X && rotations[n].Y==rotations[0].Y &&
+					rotations[n].Z==rotations[0].Z && rotations[n].W==rotations[0].W;
+
+			track.Rotation.Start = CompressedRotations.size();
+			track.Rotation.Count = constant ? 1 : rotations.size();
+			for (n=0; n<track.Rotation.Count; ++n)
+				CompressedRotations.push_back(rotations[n]);
+		}
 
-			//Test the Hints...
-			if (rotationHint>=0 && (u32)rotationHint < RotationKeys.size())
-			{
-				//check this hint
-				if (rotationHint>0 && RotationKeys[rotationHint].frame>=frame && RotationKeys[rotationHint-1].frame<frame )
-					foundRotationIndex=rotationHint;
-				else if (rotationHint+1 < (s32)RotationKeys.size())
-				{
-					//check the next index
-					if ( RotationKeys[rotationHint+1].frame>=frame &&
-							RotationKeys[rotationHint+0].frame<frame)
-					{
-						rotationHint++;
-						foundRotationIndex=rotationHint;
-					}
-				}
-			}
+		// the first and last keys still define the length and which channels are animated
+		if (joint->PositionKeys.size() > 2)
+			joint->PositionKeys.erase(1, (s32)joint->PositionKeys.size()-2);
+		if (joint->ScaleKeys.size() > 2)
+			joint->ScaleKeys.erase(1, (s32)joint->ScaleKeys.size()-2);
+		if (joint->RotationKeys.size() > 2)
+			joint->RotationKeys.erase(1, (s32)joint->RotationKeys.size()-2);
+		joint->PositionKeys.reallocate(joint->PositionKeys.size());
+		joint->ScaleKeys.reallocate(joint->ScaleKeys.size());
+		joint->RotationKeys.reallocate(joint->RotationKeys.size());
+		joint->positionHint = joint->scaleHint = joint->rotationHint = -1;
+	}
 
+	// animate again with the samples
+	LastAnimatedFrame = -1;
+	clearPoseCache();
+}
 
-			//The hint test failed, do a full scan...
-			if (foundRotationIndex==-1)
-			{
-				for (u32 i=0; i<RotationKeys.size(); ++i)
-				{
-					if (RotationKeys[i].frame >= frame) //Keys should be sorted by frame
-					{
-						foundRotationIndex=i;
-						rotationHint=i;
-						break;
-					}
-				}
-			}
 
-			//Do interpolation...
-			if (foundRotationIndex!=-1)
-			{
-				if (InterpolationMode==EIM_CONSTANT || foundRotationIndex==0)
-				{
-					rotation = RotationKeys[foundRotationIndex].rotation;
-				}
-				else if (InterpolationMode==EIM_LINEAR)
-				{
-					const SRotationKey& KeyA = RotationKeys[foundRotationIndex];
-					const SRotationKey& KeyB = RotationKeys[foundRotationIndex-1];
+//! Keeps the skinned vertices of the last animated frames for animated mesh scene nodes
+void CSkinnedMesh::setPoseCacheSize(u32 poses)
+{
+	clearPoseCache();
+	PoseCacheSize = poses;
+}
 
-					const f32 fd1 = frame - KeyA.frame;
-					const f32 fd2 = KeyB.frame - frame;
-					const f32 t = fd1/(fd1+fd2);
 
-					/*
-					f32 t = 0;
-					if (KeyA.frame!=KeyB.frame)
-						t = (frame-KeyA.frame) / (KeyB.frame - KeyA.frame);
-					*/
+//! Skins the mesh buffers for a frame with the vertices from the pose cache
+IMesh* CSkinnedMesh::getCachedPose(f32 frame, core::array<s32>& cursors)
+{
+	if (!PoseCacheSize || !HasAnimation)
+		return 0;
 
-					rotation.slerp(KeyA.rotation, KeyB.rotation, t);
-				}
-			}
+	++PoseCacheTime;
+
+	u32 i;
+	for (i=0; i<PoseCache.size(); ++i)
+	{
+		if (PoseCache[i].Frame != frame)
+			continue;
+
+		SCachedPose& pose = PoseCache[i];
+		pose.LastUsed = PoseCacheTime;
+
+		// nodes drawn one after another at the same frame skip the copy
+		if (PoseInBuffers == (s32)i)
+			return this;
+
+		u32 offset = 0;
+		for (u32 j=0; j<LocalBuffers.size(); ++j)
+		{
+			SSkinMeshBuffer* buffer = LocalBuffers[j];
+			const u32 size = buffer->getVertexCount() * video::getVertexPitchFromType(buffer->VertexType);
+			if (size)
+				memcpy(buffer->getVertices(), &pose.Vertices[offset], size);
+			offset += size;
+
+			buffer->Transformation = pose.Transformations[j];
+			buffer->BoundingBox = pose.BufferBoxes[j];
+			buffer->BoundingBoxNeedsRecalculated = false;
+			buffer->setDirty(EBT_VERTEX);
 		}
+		BoundingBox = pose.BoundingBox;
+
+		// the joints are still at the last animated frame
+		LastAnimatedFrame = -1;
+		SkinnedLastFrame = false;
+		PoseInBuffers = i;
+		return this;
+	}
+
+	animateMesh(frame, 1.f, cursors);
+	skinMesh();
+
+	// replace the pose which wasn't used for the longest time
+	u32 slot = PoseCache.size();
+	if (slot < PoseCacheSize)
+		PoseCache.push_back(SCachedPose());
+	else
+	{
+		slot = 0;
+		for (i=1; i<PoseCache.size(); ++i)
+			if (PoseCache[i].LastUsed < PoseCache[slot].LastUsed)
+				slot = i;
+	}
+
+	SCachedPose& pose = PoseCache[slot];
+	pose.Frame = frame;
+	pose.LastUsed = PoseCacheTime;
+	pose.Vertices.set_used(0);
+	pose.Transformations.set_used(LocalBuffers.size());
+	pose.BufferBoxes.set_used(LocalBuffers.size());
+
+	for (i=0; i<LocalBuffers.size(); ++i)
+	{
+		const SSkinMeshBuffer* source = LocalBuffers[i];
+		const u32 size = source->getVertexCount() * video::getVertexPitchFromType(source->VertexType);
+		const u32 offset = pose.Vertices.size();
+		pose.Vertices.set_used(offset + size);
+		if (size)
+			memcpy(&pose.Vertices[offset], source->getVertices(), size);
+
+		pose.Transformations[i] = source->Transformation;
+		pose.BufferBoxes[i] = source->BoundingBox;
 	}
+	pose.BoundingBox = BoundingBox;
+	PoseInBuffers = slot;
+
+	return this;
 }
 
+
+void CSkinnedMesh::clearPoseCache()
+{
+	PoseCache.clear();
+	PoseInBuffers = -1;
+}
+
+
 //--------------------------------------------------------------------------
 //				Software Skinning
 //--------------------------------------------------------------------------
@@ -530,6 +772,7 @@ void CSkinnedMesh::skinMesh()
 	//-----------------
 
 	SkinnedLastFrame=true;
+	PoseInBuffers=-1;
 	if (!HardwareSkinning)
 	{
 		//Software skin....
@@ -545,14 +788,12 @@ void CSkinnedMesh::skinMesh()
 			}
 		}
 
-		//clear skinning helper array
-		for (i=0; i<Vertices_Moved.size(); ++i)
-			for (u32 j=0; j<Vertices_Moved[i].size(); ++j)
-				Vertices_Moved[i][j]=false;
+		//the pull of each joint on its vertices
+		SkinMatrices.set_used(AllJoints.size());
+		for (i=0; i<AllJoints.size(); ++i)
+			SkinMatrices[i].setbyproduct(AllJoints[i]->GlobalAnimatedMatrix, AllJoints[i]->GlobalInversedMatrix);
 
-		//skin starting with the root joints
-		for (i=0; i<RootJoints.size(); ++i)
-			skinJoint(RootJoints[i], 0);
+		skinVertices();
 
 		for (i=0; i<SkinningBuffers->size(); ++i)
 			(*SkinningBuffers)[i]->setDirty(EBT_VERTEX);
@@ -561,57 +802,150 @@ void CSkinnedMesh::skinMesh()
 }
 
 
-void CSkinnedMesh::skinJoint(SJoint *joint, SJoint *parentJoint)
+//! Flattens the joint weights into SkinVertices
+/** Called once the weights are normalized. The influences of a vertex are
+stored next to each other, so skinning runs through one array instead of
+visiting each vertex from every joint pulling on it. */
+void CSkinnedMesh::buildSkinVertices()
 {
-	if (joint->Weights.size())
+	SkinVertices.clear();
+
+	core::array<SSkinWeightRef> refs;
+	u32 i;
+	for (i=0; i<AllJoints.size(); ++i)
 	{
-		//Find this joints pull on vertices...
-		core::matrix4 jointVertexPull(core::matrix4::EM4CONST_NOTHING);
-		jointVertexPull.setbyproduct(joint->GlobalAnimatedMatrix, joint->GlobalInversedMatrix);
+		const SJoint* joint = AllJoints[i];
+		for (u32 j=0; j<joint->Weights.size(); ++j)
+		{
+			SSkinWeightRef ref;
+			ref.Buffer = joint->Weights[j].buffer_id;
+			ref.Vertex = joint->Weights[j].vertex_id;
+			ref.Joint = i;
+			ref.Weight = joint->Weights[j].strength;
+			refs.push_back(ref);
+		}
+	}
+	refs.sort();
 
-		core::vector3df thisVertexMove, thisNormalMove;
+	SkinVertices.reallocate(refs.size());
+	for (i=0; i<refs.size(); )
+	{
+		// all influences of this vertex
+		u32 end = i+1;
+		while (end<refs.size() && refs[end].Buffer==refs[i].Buffer && refs[end].Vertex==refs[i].Vertex)
+			++end;
 
-		core::array<scene::SSkinMeshBuffer*> &buffersUsed=*SkinningBuffers;
+		const video::S3DVertex* vertex = LocalBuffers[refs[i].Buffer]->getVertex(refs[i].Vertex);
 
-		//Skin Vertices Positions and Normals...
-		for (u32 i=0; i<joint->Weights.size(); ++i)
+		for (; i<end; i+=4)
 		{
-			SWeight& weight = joint->Weights[i];
+			SSkinVertex skin;
+			skin.Count = (u8)core::min_(end-i, 4u);
+			for (u32 n=0; n<4; ++n)
+			{
+				skin.Joint[n] = n<skin.Count ? refs[i+n].Joint : 0;
+				skin.Weight[n] = n<skin.Count ? refs[i+n].Weight : 0.f;
+			}
+			skin.StaticPos = vertex->Pos;
+			skin.StaticNormal = vertex->Normal;
+			skin.Vertex = refs[i].Vertex;
+			skin.Buffer = (u16)refs[i].Buffer;
+			skin.Last = (i+4 >= end);
+			SkinVertices.push_back(skin);
+		}
+		i = end;
+	}
+}
 
-			// Pull this vertex...
-			jointVertexPull.transformVect(thisVertexMove, weight.StaticPos);
 
-			if (AnimateNormals)
-				jointVertexPull.rotateVect(thisNormalMove, weight.StaticNormal);
+//! Moves the vertices of the skinning buffers with SkinMatrices
+/** The matrices of the joints pulling a vertex are blended by their weights,
+and the static position and normal are transformed once by the blended matrix. */
+void CSkinnedMesh::skinVertices()
+{
+	core::array<SSkinMeshBuffer*>& buffersUsed = *SkinningBuffers;
 
-			if (! (*(weight.Moved)) )
-			{
-				*(weight.Moved) = true;
+	u8* vertices = 0;
+	u32 pitch = 0;
+	u32 buffer = 0xFFFFFFFF;
 
-				buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Pos = thisVertexMove * weight.strength;
+#ifdef _IRR_SKINNING_SSE_
+	__m128 c0 = _mm_setzero_ps();
+	__m128 c1 = c0, c2 = c0, c3 = c0;
+	f32 out[4];
+#else
+	f32 m[16] = {0};
+#endif
 
-				if (AnimateNormals)
-					buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Normal = thisNormalMove * weight.strength;
+	for (u32 i=0; i<SkinVertices.size(); ++i)
+	{
+		const SSkinVertex& skin = SkinVertices[i];
 
-				//*(weight._Pos) = thisVertexMove * weight.strength;
-			}
-			else
-			{
-				buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Pos += thisVertexMove * weight.strength;
+		if (skin.Buffer != buffer)
+		{
+			buffer = skin.Buffer;
+			vertices = (u8*)buffersUsed[buffer]->getVertices();
+			pitch = video::getVertexPitchFromType(buffersUsed[buffer]->getVertexType());
+			buffersUsed[buffer]->boundingBoxNeedsRecalculated();
+		}
 
-				if (AnimateNormals)
-					buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Normal += thisNormalMove * weight.strength;
+		// blend the matrices
+		for (u32 n=0; n<skin.Count; ++n)
+		{
+			const f32* joint = SkinMatrices[skin.Joint[n]].pointer();
+#ifdef _IRR_SKINNING_SSE_
+			const __m128 w = _mm_set1_ps(skin.Weight[n]);
+			c0 = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(joint), w));
+			c1 = _mm_add_ps(c1, _mm_mul_ps(_mm_loadu_ps(joint+4), w));
+			c2 = _mm_add_ps(c2, _mm_mul_ps(_mm_loadu_ps(joint+8), w));
+			c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(joint+12), w));
+#else
+			const f32 w = skin.Weight[n];
+			for (u32 k=0; k<16; ++k)
+				m[k] += joint[k] * w;
+#endif
+		}
 
-				//*(weight._Pos) += thisVertexMove * weight.strength;
-			}
+		if (!skin.Last)
+			continue;
+
+		video::S3DVertex* vertex = (video::S3DVertex*)(vertices + skin.Vertex*pitch);
+
+#ifdef _IRR_SKINNING_SSE_
+		__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(skin.StaticPos.X)),
+				_mm_mul_ps(c1, _mm_set1_ps(skin.StaticPos.Y))),
+				_mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(skin.StaticPos.Z)), c3));
+		_mm_storeu_ps(out, r);
+		vertex->Pos.set(out[0], out[1], out[2]);
 
-			buffersUsed[weight.buffer_id]->boundingBoxNeedsRecalculated();
+		if (AnimateNormals)
+		{
+			r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(skin.StaticNormal.X)),
+					_mm_mul_ps(c1, _mm_set1_ps(skin.StaticNormal.Y))),
+					_mm_mul_ps(c2, _mm_set1_ps(skin.StaticNormal.Z)));
+			_mm_storeu_ps(out, r);
+			vertex->Normal.set(out[0], out[1], out[2]);
 		}
-	}
 
-	//Skin all children
-	for (u32 j=0; j<joint->Children.size(); ++j)
-		skinJoint(joint->Children[j], joint);
+		c0 = c1 = c2 = c3 = _mm_setzero_ps();
+#else
+		const core::vector3df& p = skin.StaticPos;
+		vertex->Pos.set((m[0]*p.X + m[4]*p.Y) + (m[8]*p.Z + m[12]),
+				(m[1]*p.X + m[5]*p.Y) + (m[9]*p.Z + m[13]),
+				(m[2]*p.X + m[6]*p.Y) + (m[10]*p.Z + m[14]));
+
+		if (AnimateNormals)
+		{
+			const core::vector3df& n = skin.StaticNormal;
+			vertex->Normal.set((m[0]*n.X + m[4]*n.Y) + m[8]*n.Z,
+					(m[1]*n.X + m[5]*n.Y) + m[9]*n.Z,
+					(m[2]*n.X + m[6]*n.Y) + m[10]*n.Z);
+		}
+
+		for (u32 k=0; k<16; ++k)
+			m[k] = 0.f;
+#endif
+	}
 }
 
 
@@ -723,6 +1057,8 @@ bool CSkinnedMesh::useAnimationFrom(const ISkinnedMesh *mesh)
 {
 	bool unmatched=false;
 
+	clearPoseCache();
+
 	for(u32 i=0;i<AllJoints.size();++i)
 	{
 		SJoint *joint=AllJoints[i];
@@ -757,6 +1093,7 @@ bool CSkinnedMesh::useAnimationFrom(const ISkinnedMesh *mesh)
 void CSkinnedMesh::updateNormalsWhenAnimating(bool on)
 {
 	AnimateNormals = on;
+	clearPoseCache();
 }
 
 
@@ -764,6 +1101,7 @@ void CSkinnedMesh::updateNormalsWhenAnimating(bool on)
 void CSkinnedMesh::setInterpolationMode(E_INTERPOLATION_MODE mode)
 {
 	InterpolationMode = mode;
+	clearPoseCache();
 }
 
 
@@ -925,12 +1263,6 @@ void CSkinnedMesh::checkForAnimation()
 			}
 		}
 
-		//An array used in skinning
-
-		for (i=0; i<Vertices_Moved.size(); ++i)
-			for (j=0; j<Vertices_Moved[i].size(); ++j)
-				Vertices_Moved[i][j] = false;
-
 		// For skinning: cache weight values for speed
 
 		for (i=0; i<AllJoints.size(); ++i)
@@ -941,7 +1273,6 @@ void CSkinnedMesh::checkForAnimation()
 				const u16 buffer_id=joint->Weights[j].buffer_id;
 				const u32 vertex_id=joint->Weights[j].vertex_id;
 
-				joint->Weights[j].Moved = &Vertices_Moved[buffer_id] [vertex_id];
 				joint->Weights[j].StaticPos = LocalBuffers[buffer_id]->getVertex(vertex_id)->Pos;
 				joint->Weights[j].StaticNormal = LocalBuffers[buffer_id]->getVertex(vertex_id)->Normal;
 
@@ -951,6 +1282,8 @@ void CSkinnedMesh::checkForAnimation()
 
 		// normalize weights
 		normalizeWeights();
+
+		buildSkinVertices();
 	}
 	SkinnedLastFrame=false;
 }
@@ -961,6 +1294,8 @@ void CSkinnedMesh::finalize()
 	os::Printer::log("Skinned Mesh - finalize", ELL_DEBUG);
 	u32 i;
 
+	clearPoseCache();
+
 	// Make sure we recalc the next frame
 	LastAnimatedFrame=-1;
 	SkinnedLastFrame=false;
@@ -1005,14 +1340,6 @@ void CSkinnedMesh::finalize()
 		AllJoints[i]->UseAnimationFrom=AllJoints[i];
 	}
 
-	//Set array sizes...
-
-	for (i=0; i<LocalBuffers.size(); ++i)
-	{
-		Vertices_Moved.push_back( core::array<bool>() );
-		Vertices_Moved[i].set_used(LocalBuffers[i]->getVertexCount());
-	}
-
 	checkForAnimation();
 
 	if (HasAnimation)
@@ -1414,6 +1741,8 @@ void CSkinnedMesh::addJoints(core::array<IBoneSceneNode*> &jointChildSceneNodes,
 
 void CSkinnedMesh::convertMeshToTangents()
 {
+	clearPoseCache();
+
 	// now calculate tangents
 	for (u32 b=0; b < LocalBuffers.size(); ++b)
 	{
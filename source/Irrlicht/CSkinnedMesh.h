@@ -13,6 +13,7 @@
 #include "irrString.h"
 #include "matrix4.h"
 #include "quaternion.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -21,6 +22,7 @@ namespace scene
 
 	class IAnimatedMeshSceneNode;
 	class IBoneSceneNode;
+	struct SMesh;
 
 	class CSkinnedMesh: public ISkinnedMesh
 	{
@@ -113,6 +115,24 @@ namespace scene
 		//! (This feature is not implemented in irrlicht yet)
 		virtual bool setHardwareSkinning(bool on) _IRR_OVERRIDE_;
 
+		//! Replaces the animation keys by samples taken at a fixed rate
+		virtual void compressAnimation(f32 framesPerSample=1.f) _IRR_OVERRIDE_;
+
+		//! Keeps the skinned vertices of the last animated frames for animated mesh scene nodes
+		virtual void setPoseCacheSize(u32 poses) _IRR_OVERRIDE_;
+
+		//! Skins the mesh buffers for a frame with the vertices from the pose cache
+		/** Animates and skins the mesh if the frame is not cached yet.
+		The skinning mutex must be locked until the mesh is drawn.
+		\return This mesh, or 0 if the cache is disabled. */
+		IMesh* getCachedPose(f32 frame, core::array<s32>& cursors);
+
+		//! Animates the joints with key positions owned by the caller
+		/** Nodes sharing this mesh each keep their own cursors, instead
+		of resetting the hints stored in the joints for each other.
+		\param cursors Three entries per joint, resized as needed. */
+		void animateMesh(f32 frame, f32 blend, core::array<s32>& cursors);
+
 		//Interface for the mesh loaders (finalize should lock these functions, and they should have some prefix like loader_
 		//these functions will use the needed arrays, set values, etc to help the loaders
 
@@ -160,6 +180,10 @@ namespace scene
 				IAnimatedMeshSceneNode* node,
 				ISceneManager* smgr);
 
+		//! Mutex locked by animated mesh scene nodes while they animate and skin this mesh
+		/** Several nodes sharing this mesh can be animated on different threads. */
+		CMutex& getSkinningMutex() { return SkinningMutex; }
+
 private:
 		void checkForAnimation();
 
@@ -169,14 +193,53 @@ private:
 
 		void buildAllGlobalAnimatedMatrices(SJoint *Joint=0, SJoint *ParentJoint=0);
 
+		void animateJoints(f32 frame, f32 blend, s32* cursors);
+
 		void getFrameData(f32 frame, SJoint *Node,
 				core::vector3df &position, s32 &positionHint,
 				core::vector3df &scale, s32 &scaleHint,
 				core::quaternion &rotation, s32 &rotationHint);
 
+		//! A joint channel of the compressed animation
+		struct SCompressedChannel
+		{
+			SCompressedChannel() : Start(0), Count(0) {}
+
+			//! First sample in CompressedVectors or CompressedRotations
+			u32 Start;
+			//! Either 0 (not animated), 1 (constant) or CompressedSampleCount
+			u32 Count;
+		};
+
+		//! The compressed animation of a joint
+		struct SCompressedTrack
+		{
+			SCompressedChannel Position;
+			SCompressedChannel Scale;
+			SCompressedChannel Rotation;
+		};
+
+		//! A quaternion quantized to 16 bit per component
+		struct SCompressedRotation
+		{
+			s16 X, Y, Z, W;
+		};
+
+		void getCompressedFrameData(f32 frame, const SCompressedTrack& track,
+				core::vector3df &position, core::vector3df &scale,
+				core::quaternion &rotation) const;
+
+		core::quaternion getCompressedRotation(u32 index) const;
+
+		void clearPoseCache();
+
 		void calculateGlobalMatrices(SJoint *Joint,SJoint *ParentJoint);
 
-		void skinJoint(SJoint *Joint, SJoint *ParentJoint);
+		//! Flattens the joint weights into SkinVertices
+		void buildSkinVertices();
+
+		//! Moves the vertices of the skinning buffers with SkinMatrices
+		void skinVertices();
 
 		void calculateTangents(core::vector3df& normal,
 			core::vector3df& tangent, core::vector3df& binormal,
@@ -190,7 +253,56 @@ private:
 		core::array<SJoint*> AllJoints;
 		core::array<SJoint*> RootJoints;
 
-		core::array< core::array<bool> > Vertices_Moved;
+		//! Up to 4 joint influences of a vertex
+		/** Vertices with more influences use several consecutive entries,
+		the vertex is written with the last one. */
+		struct SSkinVertex
+		{
+			u32 Joint[4];
+			f32 Weight[4];
+			core::vector3df StaticPos;
+			core::vector3df StaticNormal;
+			u32 Vertex;
+			u16 Buffer;
+			u8 Count;
+			bool Last;
+		};
+
+		//! All skinned vertices sorted by buffer and vertex
+		core::array<SSkinVertex> SkinVertices;
+		//! Matrices moving the static vertices with the joints, same index as AllJoints
+		core::array<core::matrix4> SkinMatrices;
+
+		CMutex SkinningMutex;
+
+		//! Compressed animation, same index as AllJoints, empty if not compressed
+		core::array<SCompressedTrack> CompressedTracks;
+		core::array<core::vector3df> CompressedVectors;
+		core::array<SCompressedRotation> CompressedRotations;
+		f32 CompressedSamplesPerFrame;
+		u32 CompressedSampleCount;
+
+		//! The skinned vertices of the mesh buffers at one frame
+		/** The materials stay in the buffers, so changing them
+		affects the cached frames as well. */
+		struct SCachedPose
+		{
+			SCachedPose() : Frame(0.f), LastUsed(0) {}
+
+			f32 Frame;
+			u32 LastUsed;
+			//! Vertices of all buffers, one buffer after the other
+			core::array<u8> Vertices;
+			//! Joint transformations and boxes, same index as LocalBuffers
+			core::array<core::matrix4> Transformations;
+			core::array<core::aabbox3df> BufferBoxes;
+			core::aabbox3df BoundingBox;
+		};
+		core::array<SCachedPose> PoseCache;
+		u32 PoseCacheSize;
+		u32 PoseCacheTime;
+		//! The pose the mesh buffers hold, -1 if they are skinned otherwise
+		s32 PoseInBuffers;
 
 		core::aabbox3d<f32> BoundingBox;
 
@@ -13,10 +13,17 @@
 #include "S3DVertex.h"
 #include "S4DVertex.h"
 #include "CBlit.h"
+#include "CBurningShader_SIMD.h"
 
 
 #define MAT_TEXTURE(tex) ( (video::CSoftwareTexture2*) Material.org.getTexture ( tex ) )
 
+//! height of the horizontal bands of the binning rasterizer
+#define BIN_BAND_HEIGHT 32
+
+//! binned triangles are rasterized at the latest when this count is reached
+#define BIN_MAX_TRIANGLES 16384
+
 
 namespace irr
 {
@@ -28,6 +35,8 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 : CNullDriver(io, params.WindowSize), BackBuffer(0), Presenter(presenter),
 	WindowId(0), SceneSourceRect(0),
 	RenderTargetTexture(0), RenderTargetSurface(0), CurrentShader(0),
+	CurrentShaderType(ETR_INVALID), DepthReject(false), DepthOccluder(false),
+	ThreadPool(0), BinStateDirty(true),
 	 DepthBuffer(0), StencilBuffer ( 0 ),
 	 CurrentOut ( 16 * 2, 256 ), Temp ( 16 * 2, 256 )
 {
@@ -58,38 +67,24 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 	DriverAttributes->setAttribute("Version", 49);
 
 	// create triangle renderers
+	createShaders(BurningShader);
 
-	irr::memset32 ( BurningShader, 0, sizeof ( BurningShader ) );
-	//BurningShader[ETR_FLAT] = createTRFlat2(DepthBuffer);
-	//BurningShader[ETR_FLAT_WIRE] = createTRFlatWire2(DepthBuffer);
-	BurningShader[ETR_GOURAUD] = createTriangleRendererGouraud2(this);
-	BurningShader[ETR_GOURAUD_ALPHA] = createTriangleRendererGouraudAlpha2(this );
-	BurningShader[ETR_GOURAUD_ALPHA_NOZ] = createTRGouraudAlphaNoZ2(this );
-	//BurningShader[ETR_GOURAUD_WIRE] = createTriangleRendererGouraudWire2(DepthBuffer);
-	//BurningShader[ETR_TEXTURE_FLAT] = createTriangleRendererTextureFlat2(DepthBuffer);
-	//BurningShader[ETR_TEXTURE_FLAT_WIRE] = createTriangleRendererTextureFlatWire2(DepthBuffer);
-	BurningShader[ETR_TEXTURE_GOURAUD] = createTriangleRendererTextureGouraud2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M1] = createTriangleRendererTextureLightMap2_M1(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M2] = createTriangleRendererTextureLightMap2_M2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M4] = createTriangleRendererGTextureLightMap2_M4(this);
-	BurningShader[ETR_TEXTURE_LIGHTMAP_M4] = createTriangleRendererTextureLightMap2_M4(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD] = createTriangleRendererTextureLightMap2_Add(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_DETAIL_MAP] = createTriangleRendererTextureDetailMap2(this);
-
-	BurningShader[ETR_TEXTURE_GOURAUD_WIRE] = createTriangleRendererTextureGouraudWire2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_NOZ] = createTRTextureGouraudNoZ2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ADD] = createTRTextureGouraudAdd2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ADD_NO_Z] = createTRTextureGouraudAddNoZ2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_VERTEX_ALPHA] = createTriangleRendererTextureVertexAlpha2 ( this );
-
-	BurningShader[ETR_TEXTURE_GOURAUD_ALPHA] = createTRTextureGouraudAlpha(this );
-	BurningShader[ETR_TEXTURE_GOURAUD_ALPHA_NOZ] = createTRTextureGouraudAlphaNoZ( this );
-
-	BurningShader[ETR_NORMAL_MAP_SOLID] = createTRNormalMap ( this );
-	BurningShader[ETR_STENCIL_SHADOW] = createTRStencilShadow ( this );
-	BurningShader[ETR_TEXTURE_BLEND] = createTRTextureBlend( this );
-
-	BurningShader[ETR_REFERENCE] = createTriangleRendererReference ( this );
+	// each thread of the binning rasterizer needs its own renderers
+	if ( params.WorkerThreads > 1 )
+	{
+		ThreadPool = new CThreadPool(params.WorkerThreads);
+		if ( ThreadPool->getThreadCount() > 1 )
+		{
+			BinShader.set_used(ThreadPool->getThreadCount() * ETR2_COUNT);
+			for ( u32 i = 0; i < ThreadPool->getThreadCount(); ++i )
+				createShaders(BinShader.pointer() + i * ETR2_COUNT);
+		}
+		else
+		{
+			ThreadPool->drop();
+			ThreadPool = 0;
+		}
+	}
 
 
 	// add the same renderer for all solid types
@@ -141,6 +136,8 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 //! destructor
 CBurningVideoDriver::~CBurningVideoDriver()
 {
+	flushBins();
+
 	// delete Backbuffer
 	if (BackBuffer)
 		BackBuffer->drop();
@@ -153,6 +150,15 @@ CBurningVideoDriver::~CBurningVideoDriver()
 			BurningShader[i]->drop();
 	}
 
+	for (u32 i=0; i<BinShader.size(); ++i)
+	{
+		if (BinShader[i])
+			BinShader[i]->drop();
+	}
+
+	if (ThreadPool)
+		ThreadPool->drop();
+
 	// delete Additional buffer
 	if (StencilBuffer)
 		StencilBuffer->drop();
@@ -168,6 +174,45 @@ CBurningVideoDriver::~CBurningVideoDriver()
 }
 
 
+//! creates one set of triangle renderers
+void CBurningVideoDriver::createShaders(IBurningShader** shader)
+{
+	for ( u32 i = 0; i != ETR2_COUNT; ++i )
+		shader[i] = 0;
+
+	//shader[ETR_FLAT] = createTRFlat2(DepthBuffer);
+	//shader[ETR_FLAT_WIRE] = createTRFlatWire2(DepthBuffer);
+	shader[ETR_GOURAUD] = createTriangleRendererGouraud2(this);
+	shader[ETR_GOURAUD_ALPHA] = createTriangleRendererGouraudAlpha2(this );
+	shader[ETR_GOURAUD_ALPHA_NOZ] = createTRGouraudAlphaNoZ2(this );
+	//shader[ETR_GOURAUD_WIRE] = createTriangleRendererGouraudWire2(DepthBuffer);
+	//shader[ETR_TEXTURE_FLAT] = createTriangleRendererTextureFlat2(DepthBuffer);
+	//shader[ETR_TEXTURE_FLAT_WIRE] = createTriangleRendererTextureFlatWire2(DepthBuffer);
+	shader[ETR_TEXTURE_GOURAUD] = createTriangleRendererTextureGouraud2(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M1] = createTriangleRendererTextureLightMap2_M1(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M2] = createTriangleRendererTextureLightMap2_M2(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M4] = createTriangleRendererGTextureLightMap2_M4(this);
+	shader[ETR_TEXTURE_LIGHTMAP_M4] = createTriangleRendererTextureLightMap2_M4(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD] = createTriangleRendererTextureLightMap2_Add(this);
+	shader[ETR_TEXTURE_GOURAUD_DETAIL_MAP] = createTriangleRendererTextureDetailMap2(this);
+
+	shader[ETR_TEXTURE_GOURAUD_WIRE] = createTriangleRendererTextureGouraudWire2(this);
+	shader[ETR_TEXTURE_GOURAUD_NOZ] = createTRTextureGouraudNoZ2(this);
+	shader[ETR_TEXTURE_GOURAUD_ADD] = createTRTextureGouraudAdd2(this);
+	shader[ETR_TEXTURE_GOURAUD_ADD_NO_Z] = createTRTextureGouraudAddNoZ2(this);
+	shader[ETR_TEXTURE_GOURAUD_VERTEX_ALPHA] = createTriangleRendererTextureVertexAlpha2 ( this );
+
+	shader[ETR_TEXTURE_GOURAUD_ALPHA] = createTRTextureGouraudAlpha(this );
+	shader[ETR_TEXTURE_GOURAUD_ALPHA_NOZ] = createTRTextureGouraudAlphaNoZ( this );
+
+	shader[ETR_NORMAL_MAP_SOLID] = createTRNormalMap ( this );
+	shader[ETR_STENCIL_SHADOW] = createTRStencilShadow ( this );
+	shader[ETR_TEXTURE_BLEND] = createTRTextureBlend( this );
+
+	shader[ETR_REFERENCE] = createTriangleRendererReference ( this );
+}
+
+
 /*!
 	selects the right triangle renderer based on the render states.
 */
@@ -280,6 +325,47 @@ void CBurningVideoDriver::setCurrentShader()
 
 	// switchToTriangleRenderer
 	CurrentShader = BurningShader[shader];
+	CurrentShaderType = shader;
+	BinStateDirty = true;
+
+	// shaders usable with the coarse depth blocks, see drawTriangle
+	DepthReject = false;
+	DepthOccluder = false;
+#ifdef SOFTWARE_DRIVER_2_USE_WBUFFER
+	switch ( shader )
+	{
+		case ETR_GOURAUD:
+		case ETR_GOURAUD_ALPHA:
+		case ETR_TEXTURE_GOURAUD:
+		case ETR_TEXTURE_GOURAUD_ADD:
+		case ETR_TEXTURE_GOURAUD_LIGHTMAP_M1:
+		case ETR_TEXTURE_GOURAUD_LIGHTMAP_M2:
+		case ETR_TEXTURE_GOURAUD_LIGHTMAP_M4:
+		case ETR_TEXTURE_LIGHTMAP_M4:
+		case ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD:
+		case ETR_TEXTURE_GOURAUD_DETAIL_MAP:
+		case ETR_NORMAL_MAP_SOLID:
+			DepthReject = true;
+			DepthOccluder = true;
+			break;
+
+		// no depth write or alpha test
+		case ETR_TEXTURE_GOURAUD_ADD_NO_Z:
+		case ETR_TEXTURE_GOURAUD_VERTEX_ALPHA:
+		case ETR_TEXTURE_GOURAUD_ALPHA:
+		case ETR_TEXTURE_GOURAUD_ALPHA_NOZ:
+			DepthReject = true;
+			break;
+
+		case ETR_TEXTURE_BLEND:
+			DepthReject = Material.org.ZBuffer == ECFN_LESSEQUAL ||
+					Material.org.ZBuffer == ECFN_EQUAL;
+			break;
+
+		default:
+			break;
+	}
+#endif
 	if ( CurrentShader )
 	{
 		CurrentShader->setZCompareFunc ( Material.org.ZBuffer );
@@ -325,6 +411,7 @@ bool CBurningVideoDriver::queryFeature(E_VIDEO_DRIVER_FEATURE feature) const
 	case EVDF_MULTITEXTURE:
 	case EVDF_HARDWARE_TL:
 	case EVDF_TEXTURE_NSQUARE:
+	case EVDF_TEXTURE_COMPRESSED_DXT:
 		return true;
 
 	default:
@@ -404,6 +491,8 @@ bool CBurningVideoDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clear
 
 bool CBurningVideoDriver::endScene()
 {
+	flushBins();
+
 	CNullDriver::endScene();
 
 	return Presenter->present(BackBuffer, WindowId, SceneSourceRect);
@@ -417,6 +506,8 @@ bool CBurningVideoDriver::setRenderTargetEx(IRenderTarget* target, u16 clearFlag
 		return false;
 	}
 
+	flushBins();
+
 	if (RenderTargetTexture)
 		RenderTargetTexture->drop();
 
@@ -478,6 +569,8 @@ void CBurningVideoDriver::setViewPort(const core::rect<s32>& area)
 
 	if (CurrentShader)
 		CurrentShader->setRenderTarget(RenderTargetSurface, ViewPort);
+
+	BinStateDirty = true;
 }
 
 /*
@@ -876,11 +969,8 @@ const SVSize CBurningVideoDriver::vSize[] =
 */
 void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 destIndex)
 {
-	u8 * source;
 	s4DVertex *dest;
 
-	source = (u8*) VertexCache.vertices + ( sourceIndex * vSize[VertexCache.vType].Pitch );
-
 	// it's a look ahead so we never hit it..
 	// but give priority...
 	//VertexCache.info[ destIndex ].hit = hitCount;
@@ -892,9 +982,26 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 	// destination Vertex
 	dest = (s4DVertex *) ( (u8*) VertexCache.mem.data + ( destIndex << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
 
+	VertexCache_transform ( dest, sourceIndex, 0 );
+}
+
+
+/*!
+	transform, light and clip test one vertex into dest.
+	pos is the already transformed position or 0
+*/
+void CBurningVideoDriver::VertexCache_transform ( s4DVertex *dest, const u32 sourceIndex, const sVec4 *pos )
+{
+	u8 * source;
+
+	source = (u8*) VertexCache.vertices + ( sourceIndex * vSize[VertexCache.vType].Pitch );
+
 	// transform Model * World * Camera * Projection * NDCSpace matrix
 	const S3DVertex *base = ((S3DVertex*) source );
-	Transformation [ ETS_CURRENT].transformVect ( &dest->Pos.x, base->Pos );
+	if ( pos )
+		dest->Pos = *pos;
+	else
+		Transformation [ ETS_CURRENT].transformVect ( &dest->Pos.x, base->Pos );
 
 	//mhm ;-) maybe no goto
 	if ( VertexCache.vType == 4 ) goto clipandproject;
@@ -1322,6 +1429,110 @@ REALINLINE void CBurningVideoDriver::VertexCache_get(const s4DVertex ** face)
 	VertexCache.indicesRun += VertexCache.primitivePitch;
 }
 
+/*!
+	Transforms all vertices in the index range of the primitives at once.
+	The positions are multiplied with the matrix as structure of arrays,
+	several vertices at a time. Sparse index lists, like the ones of
+	octree nodes, stay with the cache.
+*/
+bool CBurningVideoDriver::VertexCache_batch ()
+{
+	VertexCache.batch = false;
+
+	if ( VertexCache.iType != 1 && VertexCache.iType != 2 )
+		return false;
+
+	if ( VertexCache.pType != scene::EPT_TRIANGLES &&
+		VertexCache.pType != scene::EPT_TRIANGLE_STRIP &&
+		VertexCache.pType != scene::EPT_TRIANGLE_FAN )
+		return false;
+
+	if ( 0 == VertexCache.indexCount )
+		return false;
+
+	u32 minIndex = 0xFFFFFFFF;
+	u32 maxIndex = 0;
+	u32 i;
+
+	if ( VertexCache.iType == 1 )
+	{
+		const u16 *p = (const u16 *) VertexCache.indices;
+		for ( i = 0; i != VertexCache.indexCount; ++i )
+		{
+			minIndex = core::min_ ( minIndex, (u32) p[i] );
+			maxIndex = core::max_ ( maxIndex, (u32) p[i] );
+		}
+	}
+	else
+	{
+		const u32 *p = (const u32 *) VertexCache.indices;
+		for ( i = 0; i != VertexCache.indexCount; ++i )
+		{
+			minIndex = core::min_ ( minIndex, p[i] );
+			maxIndex = core::max_ ( maxIndex, p[i] );
+		}
+	}
+
+	const u32 count = maxIndex - minIndex + 1;
+	if ( count > VertexCache.indexCount || count > VERTEXBATCH_MAX || maxIndex >= VertexCache.vertexCount )
+		return false;
+
+	// transform Model * World * Camera * Projection * NDCSpace matrix
+	BatchPos.set_used ( count * 4 );
+	f32 *x = BatchPos.pointer();
+	f32 *y = x + count;
+	f32 *z = y + count;
+	f32 *w = z + count;
+
+	const u32 pitch = vSize[VertexCache.vType].Pitch;
+	burningTransformVertices ( x, y, z, w, (const u8*) VertexCache.vertices + minIndex * pitch, pitch, count,
+								Transformation [ ETS_CURRENT ] );
+
+	// light, texture transform and clip test
+	VertexCache.batchMem.reallocate ( count * 2 );
+
+	sVec4 pos;
+	for ( i = 0; i != count; ++i )
+	{
+		pos.set ( x[i], y[i], z[i], w[i] );
+		VertexCache_transform ( (s4DVertex *) ( (u8*) VertexCache.batchMem.data + ( i << ( SIZEOF_SVERTEX_LOG2 + 1 ) ) ),
+								minIndex + i, &pos );
+	}
+
+	VertexCache.batch = true;
+	VertexCache.batchBase = minIndex;
+	return true;
+}
+
+/*!
+	primitive from the transformed batch
+*/
+REALINLINE void CBurningVideoDriver::VertexCache_getbatch ( const s4DVertex ** face )
+{
+	const u32 i0 = core::if_c_a_else_0 ( VertexCache.pType != scene::EPT_TRIANGLE_FAN, VertexCache.indicesRun );
+
+	u32 index[3];
+	if ( VertexCache.iType == 1 )
+	{
+		const u16 *p = (const u16 *) VertexCache.indices;
+		index[0] = p[ i0 ];
+		index[1] = p[ VertexCache.indicesRun + 1];
+		index[2] = p[ VertexCache.indicesRun + 2];
+	}
+	else
+	{
+		const u32 *p = (const u32 *) VertexCache.indices;
+		index[0] = p[ i0 ];
+		index[1] = p[ VertexCache.indicesRun + 1];
+		index[2] = p[ VertexCache.indicesRun + 2];
+	}
+
+	for ( u32 i = 0; i != 3; ++i )
+		face[i] = (const s4DVertex *) ( (u8*) VertexCache.batchMem.data + ( ( index[i] - VertexCache.batchBase ) << ( SIZEOF_SVERTEX_LOG2 + 1 ) ) );
+
+	VertexCache.indicesRun += VertexCache.primitivePitch;
+}
+
 /*!
 */
 REALINLINE void CBurningVideoDriver::VertexCache_getbypass ( s4DVertex ** face )
@@ -1365,6 +1576,7 @@ void CBurningVideoDriver::VertexCache_reset ( const void* vertices, u32 vertexCo
 	VertexCache.indices = indices;
 	VertexCache.indicesIndex = 0;
 	VertexCache.indicesRun = 0;
+	VertexCache.batch = false;
 
 	if ( Material.org.MaterialType == video::EMT_REFLECTION_2_LAYER )
 		VertexCache.vType = 3;
@@ -1456,6 +1668,7 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 		return;
 
 	VertexCache_reset ( vertices, vertexCount, indexList, primitiveCount, vType, pType, iType );
+	VertexCache_batch ();
 
 	const s4DVertex * face[3];
 
@@ -1468,7 +1681,10 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 
 	for ( i = 0; i < (u32) primitiveCount; ++i )
 	{
-		VertexCache_get(face);
+		if ( VertexCache.batch )
+			VertexCache_getbatch(face);
+		else
+			VertexCache_get(face);
 
 		// if fully outside or outside on same side
 		if ( ( (face[0]->flag | face[1]->flag | face[2]->flag) & VERTEX4D_CLIPMASK )
@@ -1502,7 +1718,7 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 			}
 
 			// rasterize
-			CurrentShader->drawTriangle ( face[0] + 1, face[1] + 1, face[2] + 1 );
+			drawTriangle ( face[0] + 1, face[1] + 1, face[2] + 1 );
 			continue;
 		}
 
@@ -1556,7 +1772,7 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 		for ( g = 0; g <= vOut - 6; g += 2 )
 		{
 			// rasterize
-			CurrentShader->drawTriangle ( CurrentOut.data + 0 + 1,
+			drawTriangle ( CurrentOut.data + 0 + 1,
 							CurrentOut.data + g + 3,
 							CurrentOut.data + g + 5);
 		}
@@ -1576,6 +1792,168 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 }
 
 
+//! passes a triangle to the current shader or to the bins
+void CBurningVideoDriver::drawTriangle(const s4DVertex* a, const s4DVertex* b, const s4DVertex* c)
+{
+	// coarse depth test. With bins, the blocks already contain the depth of the
+	// triangles not rasterized yet, which is fine as they are drawn in order.
+	if ( DepthReject && DepthBuffer )
+	{
+		CDepthBuffer* depth = (CDepthBuffer*) DepthBuffer;
+		if ( depth->isOccluded ( a, b, c ) )
+			return;
+
+		if ( DepthOccluder )
+			depth->addOccluder ( a, b, c );
+	}
+
+	if ( 0 == ThreadPool )
+	{
+		CurrentShader->drawTriangle ( a, b, c );
+		return;
+	}
+
+	switch ( CurrentShaderType )
+	{
+		// these write outside of their scanlines or into the stencil buffer
+		case ETR_TEXTURE_GOURAUD_WIRE:
+		case ETR_STENCIL_SHADOW:
+		case ETR_REFERENCE:
+			flushBins();
+			CurrentShader->drawTriangle ( a, b, c );
+			return;
+		default:
+			break;
+	}
+
+	if ( BinTriangles.size() >= BIN_MAX_TRIANGLES )
+		flushBins();
+
+	const sInternalTexture* it = CurrentShader->getTextureParam();
+	u32 m;
+
+	// the state keeps the textures alive until the bins are flushed
+	if ( !BinStateDirty )
+	{
+		const SBinState& last = BinStates.getLast();
+		for ( m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+			if ( last.Texture[m] != it[m].Texture )
+				BinStateDirty = true;
+	}
+
+	if ( BinStateDirty )
+	{
+		SBinState state;
+		state.Shader = CurrentShaderType;
+		state.ZCompareFunc = Material.org.ZBuffer;
+		state.Param = Material.org.MaterialTypeParam;
+		state.HasParam = CurrentShaderType == ETR_TEXTURE_GOURAUD_ALPHA ||
+				CurrentShaderType == ETR_TEXTURE_GOURAUD_ALPHA_NOZ ||
+				CurrentShaderType == ETR_TEXTURE_BLEND;
+
+		for ( m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+		{
+			state.Texture[m] = it[m].Texture;
+			if ( state.Texture[m] )
+				state.Texture[m]->grab();
+		}
+
+		BinStates.push_back(state);
+		BinStateDirty = false;
+	}
+
+	BinTriangles.set_used(BinTriangles.size() + 1);
+	SBinTriangle& tri = BinTriangles.getLast();
+
+	tri.Vertex[0] = *a;
+	tri.Vertex[1] = *b;
+	tri.Vertex[2] = *c;
+	for ( m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+		tri.IT[m] = it[m];
+	tri.State = BinStates.size() - 1;
+
+	// same scanline range as the shaders
+	tri.YStart = core::ceil32 ( core::min_ ( a->Pos.y, b->Pos.y, c->Pos.y ) );
+	tri.YEnd = core::ceil32 ( core::max_ ( a->Pos.y, b->Pos.y, c->Pos.y ) ) - 1;
+}
+
+
+//! rasterizes all binned triangles
+void CBurningVideoDriver::flushBins()
+{
+	if ( BinTriangles.empty() )
+		return;
+
+	// reference counting is not thread safe, so bind the target here
+	u32 i;
+	for ( i = 0; i != BinShader.size(); ++i )
+	{
+		if ( BinShader[i] )
+			BinShader[i]->setRenderTarget(RenderTargetSurface, ViewPort);
+	}
+
+	ThreadPool->run(rasterizeBinsTask, this, ThreadPool->getThreadCount());
+
+	BinTriangles.set_used(0);
+
+	for ( i = 0; i != BinStates.size(); ++i )
+	{
+		for ( u32 m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+		{
+			if ( BinStates[i].Texture[m] )
+				BinStates[i].Texture[m]->drop();
+		}
+	}
+	BinStates.set_used(0);
+	BinStateDirty = true;
+}
+
+
+void CBurningVideoDriver::rasterizeBinsTask(void* driver, u32 thread)
+{
+	((CBurningVideoDriver*) driver)->rasterizeBins(thread);
+}
+
+
+//! rasterizes the bands of one thread
+void CBurningVideoDriver::rasterizeBins(u32 thread)
+{
+	const s32 step = ThreadPool->getThreadCount() * BIN_BAND_HEIGHT;
+	const s32 height = RenderTargetSize.Height;
+	IBurningShader** shader = BinShader.pointer() + thread * ETR2_COUNT;
+
+	for ( s32 y0 = thread * BIN_BAND_HEIGHT; y0 < height; y0 += step )
+	{
+		const s32 y1 = y0 + BIN_BAND_HEIGHT;
+		IBurningShader* render = 0;
+		u32 state = 0xFFFFFFFF;
+
+		for ( u32 i = 0; i != BinTriangles.size(); ++i )
+		{
+			const SBinTriangle& tri = BinTriangles[i];
+			if ( tri.YEnd < y0 || tri.YStart >= y1 )
+				continue;
+
+			// same order as setCurrentShader
+			if ( tri.State != state )
+			{
+				state = tri.State;
+				const SBinState& s = BinStates[state];
+
+				render = shader[s.Shader];
+				render->setZCompareFunc ( s.ZCompareFunc );
+				if ( s.HasParam )
+					render->setParam ( 0, s.Param );
+				render->setScanlineClip ( y0, y1 );
+			}
+
+			render->copyTextureParam ( tri.IT );
+			render->drawTriangle ( tri.Vertex + 0, tri.Vertex + 1, tri.Vertex + 2 );
+		}
+	}
+}
+
+
 //! Sets the dynamic ambient light color. The default color is
 //! (0,0,0,0) which means it is dark.
 //! \param color: New color of the ambient light.
@@ -1870,6 +2248,8 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 					 const core::rect<s32>* clipRect, SColor color,
 					 bool useAlphaChannelOfTexture)
 {
+	flushBins();
+
 	if (texture)
 	{
 		if (texture->getDriverType() != EDT_BURNINGSVIDEO)
@@ -1908,6 +2288,8 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
 		const video::SColor* const colors, bool useAlphaChannelOfTexture)
 {
+	flushBins();
+
 	if (texture)
 	{
 		if (texture->getDriverType() != EDT_BURNINGSVIDEO)
@@ -1930,6 +2312,7 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<s32>& start,
 					const core::position2d<s32>& end,
 					SColor color)
 {
+	flushBins();
 	drawLine(BackBuffer, start, end, color );
 }
 
@@ -1937,6 +2320,7 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<s32>& start,
 //! Draws a pixel
 void CBurningVideoDriver::drawPixel(u32 x, u32 y, const SColor & color)
 {
+	flushBins();
 	BackBuffer->setPixel(x, y, color, true);
 }
 
@@ -1945,6 +2329,8 @@ void CBurningVideoDriver::drawPixel(u32 x, u32 y, const SColor & color)
 void CBurningVideoDriver::draw2DRectangle(SColor color, const core::rect<s32>& pos,
 									 const core::rect<s32>* clip)
 {
+	flushBins();
+
 	if (clip)
 	{
 		core::rect<s32> p(pos);
@@ -1981,6 +2367,8 @@ void CBurningVideoDriver::OnResize(const core::dimension2d<u32>& size)
 
 	if (ScreenSize != realSize)
 	{
+		flushBins();
+
 		if (ViewPort.getWidth() == (s32)ScreenSize.Width &&
 			ViewPort.getHeight() == (s32)ScreenSize.Height)
 		{
@@ -2017,6 +2405,7 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 	const core::rect<s32>* clip)
 {
 #ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+	flushBins();
 
 	core::rect<s32> pos = position;
 
@@ -2128,6 +2517,8 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 void CBurningVideoDriver::draw3DLine(const core::vector3df& start,
 	const core::vector3df& end, SColor color)
 {
+	flushBins();
+
 	Transformation [ ETS_CURRENT].transformVect ( &CurrentOut.data[0].Pos.x, start );
 	Transformation [ ETS_CURRENT].transformVect ( &CurrentOut.data[2].Pos.x, end );
 
@@ -2229,6 +2620,8 @@ ITexture* CBurningVideoDriver::addRenderTargetTexture(const core::dimension2d<u3
 
 void CBurningVideoDriver::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
 {
+	flushBins();
+
 	if ((flag & ECBF_COLOR) && RenderTargetSurface)
 		RenderTargetSurface->fill(color);
 
@@ -2246,6 +2639,8 @@ IImage* CBurningVideoDriver::createScreenShot(video::ECOLOR_FORMAT format, video
 	if (target != video::ERT_FRAME_BUFFER)
 		return 0;
 
+	flushBins();
+
 	if (BackBuffer)
 	{
 		IImage* tmp = createImage(BackBuffer->getColorFormat(), BackBuffer->getDimension());
@@ -2259,7 +2654,8 @@ IImage* CBurningVideoDriver::createScreenShot(video::ECOLOR_FORMAT format, video
 ITexture* CBurningVideoDriver::createDeviceDependentTexture(const io::path& name, IImage* image)
 {
 	CSoftwareTexture2* texture = new CSoftwareTexture2(image, name, (getTextureCreationFlag(ETCF_CREATE_MIP_MAPS) ? CSoftwareTexture2::GEN_MIPMAP : 0) |
-		(getTextureCreationFlag(ETCF_ALLOW_NON_POWER_2) ? 0 : CSoftwareTexture2::NP2_SIZE));
+		(getTextureCreationFlag(ETCF_ALLOW_NON_POWER_2) ? 0 : CSoftwareTexture2::NP2_SIZE),
+		getMipMapFilter(), getImageThreads());
 
 	return texture;
 }
@@ -2282,7 +2678,12 @@ void CBurningVideoDriver::drawStencilShadowVolume(const core::array<core::vector
 	const u32 count = triangles.size();
 	IBurningShader *shader = BurningShader [ ETR_STENCIL_SHADOW ];
 
+	flushBins();
+
 	CurrentShader = shader;
+	CurrentShaderType = ETR_STENCIL_SHADOW;
+	DepthReject = false;
+	DepthOccluder = false;
 	shader->setRenderTarget(RenderTargetSurface, ViewPort);
 
 	Material.org.MaterialType = video::EMT_SOLID;
@@ -2342,6 +2743,9 @@ void CBurningVideoDriver::drawStencilShadow(bool clearStencilBuffer, video::SCol
 {
 	if (!StencilBuffer)
 		return;
+
+	flushBins();
+
 	// draw a shadow rectangle covering the entire screen using stencil buffer
 	const u32 h = RenderTargetSurface->getDimension().Height;
 	const u32 w = RenderTargetSurface->getDimension().Width;
@@ -12,6 +12,7 @@
 #include "os.h"
 #include "irrString.h"
 #include "SIrrCreationParameters.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -190,9 +191,59 @@ namespace video
 		//! selects the right triangle renderer based on the render states.
 		void setCurrentShader();
 
+		//! creates one set of triangle renderers
+		void createShaders(IBurningShader** shader);
+
 		IBurningShader* CurrentShader;
+		EBurningFFShader CurrentShaderType;
 		IBurningShader* BurningShader[ETR2_COUNT];
 
+		//! the current shader tests with w >= z, so occluded triangles can be skipped
+		bool DepthReject;
+
+		//! the current shader writes the depth of every pixel passing the test
+		bool DepthOccluder;
+
+		//! passes a triangle to the current shader or to the bins
+		void drawTriangle(const s4DVertex* a, const s4DVertex* b, const s4DVertex* c);
+
+		//! rasterizes all binned triangles
+		void flushBins();
+
+		/*
+			Binning rasterizer
+			With more than one worker thread, triangles are collected in a list
+			and rasterized at flush time. Every thread owns its own set of shaders
+			and horizontal bands of the render target, so each pixel is
+			written by one thread only and in submission order.
+		*/
+		struct SBinState
+		{
+			EBurningFFShader Shader;
+			u32 ZCompareFunc;
+			f32 Param;
+			bool HasParam;
+			CSoftwareTexture2* Texture[BURNING_MATERIAL_MAX_TEXTURES];
+		};
+
+		struct SBinTriangle
+		{
+			s4DVertex Vertex[3];
+			sInternalTexture IT[BURNING_MATERIAL_MAX_TEXTURES];
+			u32 State;
+			s32 YStart;
+			s32 YEnd;
+		};
+
+		static void rasterizeBinsTask(void* driver, u32 thread);
+		void rasterizeBins(u32 thread);
+
+		CThreadPool* ThreadPool;
+		core::array<IBurningShader*> BinShader;
+		core::array<SBinState> BinStates;
+		core::array<SBinTriangle> BinTriangles;
+		bool BinStateDirty;
+
 		IDepthBuffer* DepthBuffer;
 		IStencilBuffer* StencilBuffer;
 
@@ -240,8 +291,15 @@ namespace video
 		void VertexCache_getbypass ( s4DVertex ** face );
 
 		void VertexCache_fill ( const u32 sourceIndex,const u32 destIndex );
+		void VertexCache_transform ( s4DVertex *dest, const u32 sourceIndex, const sVec4 *pos );
 		s4DVertex * VertexCache_getVertex ( const u32 sourceIndex );
 
+		bool VertexCache_batch ();
+		void VertexCache_getbatch ( const s4DVertex ** face );
+
+		// transformed positions of a batch, x,y,z and w arrays
+		core::array<f32> BatchPos;
+
 
 		// culling & clipping
 		u32 clipToHyperPlane ( s4DVertex * dest, const s4DVertex * source, u32 inCount, const sVec4 &plane );
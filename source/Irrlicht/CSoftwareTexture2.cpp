@@ -9,6 +9,9 @@
 #include "SoftwareDriver2_helper.h"
 #include "CSoftwareTexture2.h"
 #include "CSoftwareDriver2.h"
+#include "CBlockCompressor.h"
+#include "CImageResampler.h"
+#include "CThreadPool.h"
 #include "os.h"
 
 namespace irr
@@ -17,13 +20,18 @@ namespace video
 {
 
 //! constructor
-CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name, u32 flags)
-	: ITexture(name, ETT_2D), MipMapLOD(0), Flags ( flags ), OriginalFormat(video::ECF_UNKNOWN)
+CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name, u32 flags,
+		E_IMAGE_FILTER mipMapFilter, CThreadPool* imageThreads)
+	: ITexture(name, ETT_2D), MipMapLOD(0), Flags ( flags ), OriginalFormat(video::ECF_UNKNOWN),
+	MipMapFilter(mipMapFilter), ImageThreads(imageThreads)
 {
 	#ifdef _DEBUG
 	setDebugName("CSoftwareTexture2");
 	#endif
 
+	if (ImageThreads)
+		ImageThreads->grab();
+
 #ifndef SOFTWARE_DRIVER_2_MIPMAPPING
 	Flags &= ~GEN_MIPMAP;
 #endif
@@ -33,12 +41,13 @@ CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name, u32 fl
 	IsRenderTarget = (Flags & IS_RENDERTARGET) != 0;
 	
 	memset32 ( MipMap, 0, sizeof ( MipMap ) );
+	memset32 ( Compressed, 0, sizeof ( Compressed ) );
 
 	if (image)
 	{
 		bool IsCompressed = false;
 
-		if (IImage::isCompressedFormat(image->getColorFormat()))
+		if (IImage::isCompressedFormat(image->getColorFormat()) && !CBlockCompressor::isDXTFormat(image->getColorFormat()))
 		{
 			os::Printer::log("Texture compression not available.", ELL_ERROR);
 			IsCompressed = true;
@@ -53,7 +62,14 @@ CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name, u32 fl
 				SOFTWARE_DRIVER_2_TEXTURE_MAXSIZE)
 			);
 
-		if (OriginalSize == optSize)
+		MipMapSize = optSize;
+
+		if (CBlockCompressor::isDXTFormat(OriginalFormat))
+		{
+			// keep the blocks, they are decoded when the level is used first
+			Compressed[0] = new CImage(OriginalFormat, OriginalSize, image->getData(), false);
+		}
+		else if (OriginalSize == optSize)
 		{
 			MipMap[0] = new CImage(BURNINGSHADER_COLOR_FORMAT, image->getDimension());
 
@@ -74,13 +90,13 @@ CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name, u32 fl
 			MipMap[0] = new CImage(BURNINGSHADER_COLOR_FORMAT, optSize);
 
 			if (!IsCompressed)
-				image->copyToScalingBoxFilter ( MipMap[0],0, false );
+				CImageResampler::resample(image, MipMap[0], MipMapFilter, ImageThreads);
 		}
 
-		Size = MipMap[MipMapLOD]->getDimension();
-		Pitch = MipMap[MipMapLOD]->getPitch();
+		Size = MipMapSize;
+		Pitch = MipMapSize.Width * IImage::getBitsPerPixelFromFormat(BURNINGSHADER_COLOR_FORMAT) / 8;
 
-		OrigImageDataSizeInPixels = (f32) 0.3f * MipMap[0]->getImageDataSizeInPixels();
+		OrigImageDataSizeInPixels = (f32) 0.3f * MipMapSize.getArea();
 
 		HasMipMaps = (Flags & GEN_MIPMAP) != 0;
 
@@ -96,7 +112,12 @@ CSoftwareTexture2::~CSoftwareTexture2()
 	{
 		if ( MipMap[i] )
 			MipMap[i]->drop();
+		if ( Compressed[i] )
+			Compressed[i]->drop();
 	}
+
+	if (ImageThreads)
+		ImageThreads->drop();
 }
 
 
@@ -114,29 +135,43 @@ void CSoftwareTexture2::regenerateMipMapLevels(void* data, u32 layer)
 	{
 		if ( MipMap[i] )
 			MipMap[i]->drop();
+		MipMap[i] = 0;
+
+		if ( Compressed[i] )
+			Compressed[i]->drop();
+		Compressed[i] = 0;
 	}
 
+	// the largest level of a DXT texture is only decoded to build the smaller levels
+	CImage* source = MipMap[0];
+	if (source)
+		source->grab();
+	else if (!data)
+		source = createDecompressedImage(0);
+
 	core::dimension2d<u32> newSize;
-	core::dimension2d<u32> origSize = Size;
+	core::dimension2d<u32> origSize = CBlockCompressor::isDXTFormat(OriginalFormat) ? OriginalSize : Size;
 
 	for (i=1; i < SOFTWARE_DRIVER_2_MIPMAPPING_MAX; ++i)
 	{
-		newSize = MipMap[i-1]->getDimension();
-		newSize.Width = core::s32_max ( 1, newSize.Width >> SOFTWARE_DRIVER_2_MIPMAPPING_SCALE );
-		newSize.Height = core::s32_max ( 1, newSize.Height >> SOFTWARE_DRIVER_2_MIPMAPPING_SCALE );
+		newSize = getMipMapSize(i);
 		origSize.Width = core::s32_max(1, origSize.Width >> 1);
 		origSize.Height = core::s32_max(1, origSize.Height >> 1);
 
 		if (data)
 		{
-			if (OriginalFormat != BURNINGSHADER_COLOR_FORMAT)
+			if (CBlockCompressor::isDXTFormat(OriginalFormat))
+			{
+				Compressed[i] = new CImage(OriginalFormat, origSize, data, false);
+			}
+			else if (OriginalFormat != BURNINGSHADER_COLOR_FORMAT)
 			{
 				IImage* tmpImage = new CImage(OriginalFormat, origSize, data, true, false);
 				MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize);
 				if (origSize==newSize)
 					tmpImage->copyTo(MipMap[i]);
 				else
-					tmpImage->copyToScalingBoxFilter(MipMap[i]);
+					CImageResampler::resample(tmpImage, MipMap[i], MipMapFilter, ImageThreads);
 				tmpImage->drop();
 			}
 			else
@@ -147,21 +182,55 @@ void CSoftwareTexture2::regenerateMipMapLevels(void* data, u32 layer)
 				{
 					MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize);
 					IImage* tmpImage = new CImage(BURNINGSHADER_COLOR_FORMAT, origSize, data, true, false);
-					tmpImage->copyToScalingBoxFilter(MipMap[i]);
+					CImageResampler::resample(tmpImage, MipMap[i], MipMapFilter, ImageThreads);
 					tmpImage->drop();
 				}
 			}
-			data = (u8*)data +origSize.getArea()*IImage::getBitsPerPixelFromFormat(OriginalFormat)/8;
+			data = (u8*)data + IImage::getDataSizeFromFormat(OriginalFormat, origSize.Width, origSize.Height);
 		}
 		else
 		{
+			// each level from the level before, which is much less work than from the largest level
 			MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize);
-
-			//static u32 color[] = { 0, 0xFFFF0000, 0xFF00FF00,0xFF0000FF,0xFFFFFF00,0xFFFF00FF,0xFF00FFFF,0xFF0F0F0F };
-			MipMap[i]->fill ( 0 );
-			MipMap[0]->copyToScalingBoxFilter( MipMap[i], 0, false );
+			CImageResampler::resample(i == 1 ? source : MipMap[i - 1], MipMap[i], MipMapFilter, ImageThreads);
 		}
 	}
+
+	if (source)
+		source->drop();
+}
+
+
+//! size of a mip map level
+core::dimension2d<u32> CSoftwareTexture2::getMipMapSize(u32 level) const
+{
+	return core::dimension2d<u32>(
+		core::s32_max ( 1, MipMapSize.Width >> (level * SOFTWARE_DRIVER_2_MIPMAPPING_SCALE) ),
+		core::s32_max ( 1, MipMapSize.Height >> (level * SOFTWARE_DRIVER_2_MIPMAPPING_SCALE) ));
+}
+
+
+//! decodes a DXT mip map level to the shader color format
+CImage* CSoftwareTexture2::createDecompressedImage(u32 level) const
+{
+	const CImage* blocks = Compressed[level];
+	const core::dimension2d<u32> size = getMipMapSize(level);
+
+	CImage* decoded = new CImage(ECF_A8R8G8B8, blocks->getDimension());
+	CBlockCompressor::decompress(blocks->getColorFormat(), blocks->getData(), blocks->getDimension(),
+		decoded->getData(), decoded->getPitch());
+
+	if (BURNINGSHADER_COLOR_FORMAT == ECF_A8R8G8B8 && size == blocks->getDimension())
+		return decoded;
+
+	CImage* image = new CImage(BURNINGSHADER_COLOR_FORMAT, size);
+	if (size == blocks->getDimension())
+		decoded->copyTo(image);
+	else
+		decoded->copyToScalingBoxFilter(image, 0, false);
+	decoded->drop();
+
+	return image;
 }
 
 
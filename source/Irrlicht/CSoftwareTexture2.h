@@ -10,9 +10,13 @@
 #include "ITexture.h"
 #include "IRenderTarget.h"
 #include "CImage.h"
+#include "CBlockCompressor.h"
 
 namespace irr
 {
+
+class CThreadPool;
+
 namespace video
 {
 
@@ -32,7 +36,10 @@ public:
 		IS_RENDERTARGET	= 2,
 		NP2_SIZE	= 4,
 	};
-	CSoftwareTexture2(IImage* surface, const io::path& name, u32 flags);
+	/** \param mipMapFilter Filter for the mip map levels and for resizing the image.
+	\param imageThreads Threads resampling the image, can be 0. */
+	CSoftwareTexture2(IImage* surface, const io::path& name, u32 flags,
+		E_IMAGE_FILTER mipMapFilter = EIF_BOX, CThreadPool* imageThreads = 0);
 
 	//! destructor
 	virtual ~CSoftwareTexture2();
@@ -43,11 +50,11 @@ public:
 		if (Flags & GEN_MIPMAP)
 		{
 			MipMapLOD = mipmapLevel;
-			Size = MipMap[MipMapLOD]->getDimension();
+			Size = getMipMap(MipMapLOD)->getDimension();
 			Pitch = MipMap[MipMapLOD]->getPitch();
 		}
 
-		return MipMap[MipMapLOD]->getData();
+		return getMipMap(MipMapLOD)->getData();
 	}
 
 	//! unlock function
@@ -63,9 +70,9 @@ public:
 	}
 
 	//! returns unoptimized surface
-	virtual CImage* getImage() const
+	virtual CImage* getImage()
 	{
-		return MipMap[0];
+		return getMipMap(0);
 	}
 
 	//! returns texture surface
@@ -77,13 +84,41 @@ public:
 	virtual void regenerateMipMapLevels(void* data = 0, u32 layer = 0) _IRR_OVERRIDE_;
 
 private:
+
+	//! returns a mip map level, DXT levels are decoded when they are used first
+	CImage* getMipMap(u32 level)
+	{
+		if (!MipMap[level])
+		{
+			MipMap[level] = createDecompressedImage(level);
+			Compressed[level]->drop();
+			Compressed[level] = 0;
+		}
+		return MipMap[level];
+	}
+
+	//! size of a mip map level
+	core::dimension2d<u32> getMipMapSize(u32 level) const;
+
+	//! decodes a DXT mip map level to the shader color format
+	CImage* createDecompressedImage(u32 level) const;
+
 	f32 OrigImageDataSizeInPixels;
 
 	CImage * MipMap[SOFTWARE_DRIVER_2_MIPMAPPING_MAX];
 
+	//! DXT blocks of the levels which were not used yet
+	CImage * Compressed[SOFTWARE_DRIVER_2_MIPMAPPING_MAX];
+
+	//! size of the largest mip map level
+	core::dimension2d<u32> MipMapSize;
+
 	u32 MipMapLOD;
 	u32 Flags;
 	ECOLOR_FORMAT OriginalFormat;
+
+	E_IMAGE_FILTER MipMapFilter;
+	CThreadPool* ImageThreads;
 };
 
 /*!
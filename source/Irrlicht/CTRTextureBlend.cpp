@@ -4,6 +4,7 @@
 
 #include "IrrCompileConfig.h"
 #include "IBurningShader.h"
+#include "CBurningShader_SIMD.h"
 
 #ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
 
@@ -108,6 +109,8 @@ private:
 	sScanLineData line;
 
 	u32 ZCompare;
+
+	tBurningSpanFunc SpanDstColorZero;
 };
 
 //! constructor
@@ -119,6 +122,7 @@ CTRTextureBlend::CTRTextureBlend(CBurningVideoDriver* driver)
 	#endif
 
 	ZCompare = 1;
+	SpanDstColorZero = getBurningSpanFunc ( EBSF_BLEND_DST_COLOR_ZERO );
 }
 
 /*!
@@ -1487,6 +1491,25 @@ void CTRTextureBlend::fragment_dst_color_zero ()
 	z = (fp24*) DepthBuffer->lock() + ( line.y * RenderTarget->getDimension().Width ) + xStart;
 #endif
 
+#if defined ( SOFTWARE_DRIVER_2_SIMD ) && defined ( IPOL_C0 )
+	if ( SpanDstColorZero )
+	{
+		sBurningSpan span;
+		span.dst = dst;
+		span.z = z;
+		span.count = dx + 1;
+		span.w = line.w[0];
+		span.slopeW = slopeW;
+		span.t[0] = line.t[0][0];
+		span.slopeT[0] = slopeT[0];
+		span.c = line.c[0][0];
+		span.slopeC = slopeC[0];
+		span.it = IT;
+		span.zCompare = ZCompare;
+		SpanDstColorZero ( span );
+		return;
+	}
+#endif
 
 	f32 iw = FIX_POINT_F32_MUL;
 
@@ -2161,7 +2184,8 @@ void CTRTextureBlend::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const
 #endif
 
 			// render a scanline
-			(this->*fragmentShader) ();
+			if ( line.y >= ScanlineClip[0] && line.y < ScanlineClip[1] )
+				(this->*fragmentShader) ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -2321,7 +2345,8 @@ void CTRTextureBlend::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const
 #endif
 
 			// render a scanline
-			(this->*fragmentShader) ();
+			if ( line.y >= ScanlineClip[0] && line.y < ScanlineClip[1] )
+				(this->*fragmentShader) ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -4,6 +4,7 @@
 
 #include "IrrCompileConfig.h"
 #include "IBurningShader.h"
+#include "CBurningShader_SIMD.h"
 
 #ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
 
@@ -91,6 +92,7 @@ private:
 	sScanConvertData scan;
 	sScanLineData line;
 
+	tBurningSpanFunc SpanFunc;
 };
 
 //! constructor
@@ -100,6 +102,8 @@ CTRTextureGouraud2::CTRTextureGouraud2(CBurningVideoDriver* driver)
 	#ifdef _DEBUG
 	setDebugName("CTRTextureGouraud2");
 	#endif
+
+	SpanFunc = getBurningSpanFunc ( EBSF_TEXTURE_GOURAUD );
 }
 
 
@@ -189,6 +193,25 @@ void CTRTextureGouraud2::scanline_bilinear ()
 	z = (fp24*) DepthBuffer->lock() + ( line.y * RenderTarget->getDimension().Width ) + xStart;
 #endif
 
+#ifdef SOFTWARE_DRIVER_2_SIMD
+	if ( SpanFunc )
+	{
+		sBurningSpan span;
+		span.dst = dst;
+		span.z = z;
+		span.count = dx + 1;
+		span.w = line.w[0];
+		span.slopeW = slopeW;
+		span.t[0] = line.t[0][0];
+		span.slopeT[0] = slopeT[0];
+		span.c = line.c[0][0];
+		span.slopeC = slopeC;
+		span.it = IT;
+		span.zCompare = 1;
+		SpanFunc ( span );
+		return;
+	}
+#endif
 
 	f32 inversew = FIX_POINT_F32_MUL;
 
@@ -449,7 +472,8 @@ void CTRTextureGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,co
 #endif
 
 			// render a scanline
-			scanline_bilinear ();
+			if ( line.y >= ScanlineClip[0] && line.y < ScanlineClip[1] )
+				scanline_bilinear ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -609,7 +633,8 @@ void CTRTextureGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,co
 #endif
 
 			// render a scanline
-			scanline_bilinear ( );
+			if ( line.y >= ScanlineClip[0] && line.y < ScanlineClip[1] )
+				scanline_bilinear ( );
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
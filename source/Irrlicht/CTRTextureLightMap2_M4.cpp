@@ -4,6 +4,7 @@
 
 #include "IrrCompileConfig.h"
 #include "IBurningShader.h"
+#include "CBurningShader_SIMD.h"
 
 #ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
 
@@ -93,9 +94,13 @@ private:
 	void scanline_bilinear ();
 	void scanline_bilinear2_mag ();
 	void scanline_bilinear2_min ();
+	void scanline_simd ( tBurningSpanFunc func, tVideoSample *dst, fp24 *z, s32 count );
 
 	sScanLineData line;
 
+	tBurningSpanFunc SpanMag;
+	tBurningSpanFunc SpanMin;
+
 };
 
 //! constructor
@@ -105,6 +110,29 @@ CTRTextureLightMap2_M4::CTRTextureLightMap2_M4(CBurningVideoDriver* driver)
 	#ifdef _DEBUG
 	setDebugName("CTRTextureLightMap2_M4");
 	#endif
+
+	SpanMag = getBurningSpanFunc ( EBSF_LIGHTMAP_M4_MAG );
+	SpanMin = getBurningSpanFunc ( EBSF_LIGHTMAP_M4_MIN );
+}
+
+/*!
+	rest of the scanline after the lazy setup
+*/
+void CTRTextureLightMap2_M4::scanline_simd ( tBurningSpanFunc func, tVideoSample *dst, fp24 *z, s32 count )
+{
+	sBurningSpan span;
+	span.dst = dst;
+	span.z = z;
+	span.count = count;
+	span.w = line.w[0];
+	span.slopeW = line.w[1];
+	span.t[0] = line.t[0][0];
+	span.slopeT[0] = line.t[0][1];
+	span.t[1] = line.t[1][0];
+	span.slopeT[1] = line.t[1][1];
+	span.it = IT;
+	span.zCompare = 1;
+	func ( span );
 }
 
 /*!
@@ -184,6 +212,13 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_mag ()
 	line.t[0][0] += line.t[0][1] * a;
 	line.t[1][0] += line.t[1][1] * a;
 
+#if defined ( SOFTWARE_DRIVER_2_SIMD ) && defined ( IPOL_W )
+	if ( SpanMag )
+	{
+		scanline_simd ( SpanMag, dst + i, z + i, dx - i + 1 );
+		return;
+	}
+#endif
 
 #ifdef BURNINGVIDEO_RENDERER_FAST
 	u32 dIndex = ( line.y & 3 ) << 2;
@@ -325,6 +360,13 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_min ()
 	line.t[0][0] += line.t[0][1] * a;
 	line.t[1][0] += line.t[1][1] * a;
 
+#if defined ( SOFTWARE_DRIVER_2_SIMD ) && defined ( IPOL_W )
+	if ( SpanMin )
+	{
+		scanline_simd ( SpanMin, dst + i, z + i, dx - i + 1 );
+		return;
+	}
+#endif
 
 	tFixPoint r0, g0, b0;
 	tFixPoint r1, g1, b1;
@@ -550,7 +592,8 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 #endif
 
 			// render a scanline
-			scanline_bilinear2_min ();
+			if ( line.y >= ScanlineClip[0] && line.y < ScanlineClip[1] )
+				scanline_bilinear2_min ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -711,7 +754,8 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 #endif
 
 			// render a scanline
-			scanline_bilinear2_min ();
+			if ( line.y >= ScanlineClip[0] && line.y < ScanlineClip[1] )
+				scanline_bilinear2_min ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -924,7 +968,8 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 #endif
 
 			// render a scanline
-			scanline_bilinear2_mag ();
+			if ( line.y >= ScanlineClip[0] && line.y < ScanlineClip[1] )
+				scanline_bilinear2_mag ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -1085,7 +1130,8 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 #endif
 
 			// render a scanline
-			scanline_bilinear2_mag ();
+			if ( line.y >= ScanlineClip[0] && line.y < ScanlineClip[1] )
+				scanline_bilinear2_mag ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -119,6 +119,9 @@ namespace io
 		//! get the class Type
 		virtual E_FILE_ARCHIVE_TYPE getType() const _IRR_OVERRIDE_ { return EFAT_TAR; }
 
+		//! files are found with findFile, so the file system can index them
+		virtual bool isIndexable(bool& ignorePaths, bool& ignoreCase) const _IRR_OVERRIDE_ { ignorePaths = IgnorePaths; ignoreCase = IgnoreCase; return true; }
+
 		//! return the name (id) of the file Archive
 		virtual const io::path& getArchiveName() const  _IRR_OVERRIDE_ {return Path;}
 
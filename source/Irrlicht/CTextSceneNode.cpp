@@ -290,6 +290,7 @@ void CBillboardTextSceneNode::OnAnimate(u32 timeMs)
 	BBox = Mesh->getBoundingBox();
 	core::matrix4 mat( getAbsoluteTransformation(), core::matrix4::EM4CONST_INVERSE );
 	mat.transformBoxEx(BBox);
+	SceneManager->updateSceneNodeIndex(this);
 }
 
 const core::aabbox3d<f32>& CBillboardTextSceneNode::getTransformedBillboardBoundingBox(const irr::scene::ICameraSceneNode* camera)
@@ -0,0 +1,512 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CThreadPool.h"
+#include "os.h"
+
+#ifdef _IRR_COMPILE_WITH_THREADS_
+	#if defined(_IRR_WINDOWS_API_)
+		#define WIN32_LEAN_AND_MEAN
+		#include <windows.h>
+		#include <process.h>
+	#else
+		#include <pthread.h>
+		#include <unistd.h>
+	#endif
+#endif
+
+namespace irr
+{
+
+#if defined(_IRR_COMPILE_WITH_THREADS_) && defined(_IRR_WINDOWS_API_)
+
+	CMutex::CMutex()
+	{
+		CRITICAL_SECTION* cs = new CRITICAL_SECTION;
+		InitializeCriticalSection(cs);
+		Handle = cs;
+	}
+
+	CMutex::~CMutex()
+	{
+		DeleteCriticalSection((CRITICAL_SECTION*)Handle);
+		delete (CRITICAL_SECTION*)Handle;
+	}
+
+	void CMutex::lock()
+	{
+		EnterCriticalSection((CRITICAL_SECTION*)Handle);
+	}
+
+	void CMutex::unlock()
+	{
+		LeaveCriticalSection((CRITICAL_SECTION*)Handle);
+	}
+
+	CReadWriteMutex::CReadWriteMutex()
+	{
+		SRWLOCK* lock = new SRWLOCK;
+		InitializeSRWLock(lock);
+		Handle = lock;
+	}
+
+	CReadWriteMutex::~CReadWriteMutex()
+	{
+		delete (SRWLOCK*)Handle;
+	}
+
+	void CReadWriteMutex::lockRead()
+	{
+		AcquireSRWLockShared((SRWLOCK*)Handle);
+	}
+
+	void CReadWriteMutex::unlockRead()
+	{
+		ReleaseSRWLockShared((SRWLOCK*)Handle);
+	}
+
+	void CReadWriteMutex::lockWrite()
+	{
+		AcquireSRWLockExclusive((SRWLOCK*)Handle);
+	}
+
+	void CReadWriteMutex::unlockWrite()
+	{
+		ReleaseSRWLockExclusive((SRWLOCK*)Handle);
+	}
+
+	static void* createCondition()
+	{
+		CONDITION_VARIABLE* c = new CONDITION_VARIABLE;
+		InitializeConditionVariable(c);
+		return c;
+	}
+
+	static void destroyCondition(void* c)
+	{
+		delete (CONDITION_VARIABLE*)c;
+	}
+
+	static void waitCondition(void* c, void* mutex)
+	{
+		SleepConditionVariableCS((CONDITION_VARIABLE*)c, (CRITICAL_SECTION*)mutex, INFINITE);
+	}
+
+	static void broadcastCondition(void* c)
+	{
+		WakeAllConditionVariable((CONDITION_VARIABLE*)c);
+	}
+
+	static unsigned __stdcall win32ThreadEntry(void* pool);
+
+	static void* startThread(void* pool)
+	{
+		return (void*)_beginthreadex(0, 0, win32ThreadEntry, pool, 0, 0);
+	}
+
+	static void joinThread(void* thread)
+	{
+		WaitForSingleObject((HANDLE)thread, INFINITE);
+		CloseHandle((HANDLE)thread);
+	}
+
+	// thread local value, set to 1 on the worker threads
+	static DWORD WorkerTlsIndex = TlsAlloc();
+
+	static void markWorkerThread()
+	{
+		TlsSetValue(WorkerTlsIndex, (LPVOID)1);
+	}
+
+	static bool isMarkedWorkerThread()
+	{
+		return TlsGetValue(WorkerTlsIndex) != 0;
+	}
+
+#elif defined(_IRR_COMPILE_WITH_THREADS_)
+
+	CMutex::CMutex()
+	{
+		pthread_mutex_t* m = new pthread_mutex_t;
+		pthread_mutex_init(m, 0);
+		Handle = m;
+	}
+
+	CMutex::~CMutex()
+	{
+		pthread_mutex_destroy((pthread_mutex_t*)Handle);
+		delete (pthread_mutex_t*)Handle;
+	}
+
+	void CMutex::lock()
+	{
+		pthread_mutex_lock((pthread_mutex_t*)Handle);
+	}
+
+	void CMutex::unlock()
+	{
+		pthread_mutex_unlock((pthread_mutex_t*)Handle);
+	}
+
+	CReadWriteMutex::CReadWriteMutex()
+	{
+		pthread_rwlock_t* lock = new pthread_rwlock_t;
+		pthread_rwlock_init(lock, 0);
+		Handle = lock;
+	}
+
+	CReadWriteMutex::~CReadWriteMutex()
+	{
+		pthread_rwlock_destroy((pthread_rwlock_t*)Handle);
+		delete (pthread_rwlock_t*)Handle;
+	}
+
+	void CReadWriteMutex::lockRead()
+	{
+		pthread_rwlock_rdlock((pthread_rwlock_t*)Handle);
+	}
+
+	void CReadWriteMutex::unlockRead()
+	{
+		pthread_rwlock_unlock((pthread_rwlock_t*)Handle);
+	}
+
+	void CReadWriteMutex::lockWrite()
+	{
+		pthread_rwlock_wrlock((pthread_rwlock_t*)Handle);
+	}
+
+	void CReadWriteMutex::unlockWrite()
+	{
+		pthread_rwlock_unlock((pthread_rwlock_t*)Handle);
+	}
+
+	static void* createCondition()
+	{
+		pthread_cond_t* c = new pthread_cond_t;
+		pthread_cond_init(c, 0);
+		return c;
+	}
+
+	static void destroyCondition(void* c)
+	{
+		pthread_cond_destroy((pthread_cond_t*)c);
+		delete (pthread_cond_t*)c;
+	}
+
+	static void waitCondition(void* c, void* mutex)
+	{
+		pthread_cond_wait((pthread_cond_t*)c, (pthread_mutex_t*)mutex);
+	}
+
+	static void broadcastCondition(void* c)
+	{
+		pthread_cond_broadcast((pthread_cond_t*)c);
+	}
+
+	static void* posixThreadEntry(void* pool);
+
+	static void* startThread(void* pool)
+	{
+		pthread_t* thread = new pthread_t;
+		if (pthread_create(thread, 0, posixThreadEntry, pool))
+		{
+			delete thread;
+			return 0;
+		}
+		return thread;
+	}
+
+	static void joinThread(void* thread)
+	{
+		pthread_join(*(pthread_t*)thread, 0);
+		delete (pthread_t*)thread;
+	}
+
+	// thread local value, set to 1 on the worker threads
+	static pthread_key_t WorkerKey;
+	static pthread_once_t WorkerKeyOnce = PTHREAD_ONCE_INIT;
+
+	static void createWorkerKey()
+	{
+		pthread_key_create(&WorkerKey, 0);
+	}
+
+	static void markWorkerThread()
+	{
+		pthread_once(&WorkerKeyOnce, createWorkerKey);
+		pthread_setspecific(WorkerKey, (void*)1);
+	}
+
+	static bool isMarkedWorkerThread()
+	{
+		pthread_once(&WorkerKeyOnce, createWorkerKey);
+		return pthread_getspecific(WorkerKey) != 0;
+	}
+
+#else
+
+	CMutex::CMutex() : Handle(0) {}
+	CMutex::~CMutex() {}
+	void CMutex::lock() {}
+	void CMutex::unlock() {}
+
+	CReadWriteMutex::CReadWriteMutex() : Handle(0) {}
+	CReadWriteMutex::~CReadWriteMutex() {}
+	void CReadWriteMutex::lockRead() {}
+	void CReadWriteMutex::unlockRead() {}
+	void CReadWriteMutex::lockWrite() {}
+	void CReadWriteMutex::unlockWrite() {}
+
+	static void* createCondition() { return 0; }
+	static void destroyCondition(void* c) {}
+	static void waitCondition(void* c, void* mutex) {}
+	static void broadcastCondition(void* c) {}
+	static void* startThread(void* pool) { return 0; }
+	static void joinThread(void* thread) {}
+	static void markWorkerThread() {}
+	static bool isMarkedWorkerThread() { return false; }
+
+#endif
+
+
+CCondition::CCondition()
+	: Handle(createCondition())
+{
+}
+
+
+CCondition::~CCondition()
+{
+	destroyCondition(Handle);
+}
+
+
+void CCondition::wait(CMutex& mutex)
+{
+	waitCondition(Handle, mutex.Handle);
+}
+
+
+void CCondition::broadcast()
+{
+	broadcastCondition(Handle);
+}
+
+
+CThreadPool::CThreadPool(u32 threadCount)
+	: WorkCondition(0), DoneCondition(0), PendingAsync(0), Quit(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CThreadPool");
+	#endif
+
+	if (threadCount == 0)
+		threadCount = getProcessorCount();
+
+	WorkCondition = createCondition();
+	DoneCondition = createCondition();
+
+	for (u32 i = 1; i < threadCount; ++i)
+	{
+		void* thread = startThread(this);
+		if (!thread)
+		{
+			os::Printer::log("Could not create worker thread.", ELL_WARNING);
+			break;
+		}
+		Workers.push_back(thread);
+	}
+}
+
+
+CThreadPool::~CThreadPool()
+{
+	waitIdle();
+
+	Mutex.lock();
+	Quit = true;
+	broadcastCondition(WorkCondition);
+	Mutex.unlock();
+
+	for (u32 i = 0; i < Workers.size(); ++i)
+		joinThread(Workers[i]);
+
+	destroyCondition(WorkCondition);
+	destroyCondition(DoneCondition);
+}
+
+
+bool CThreadPool::claim(SBatch* batch, u32& index)
+{
+	if (batch->Next >= batch->Count)
+		return false;
+
+	index = batch->Next++;
+
+	// fully handed out, no longer visible to the workers
+	if (batch->Next == batch->Count)
+	{
+		const s32 pos = Batches.linear_search(batch);
+		if (pos >= 0)
+			Batches.erase(pos);
+	}
+	return true;
+}
+
+
+bool CThreadPool::finish(SBatch* batch)
+{
+	batch->Done += 1;
+	if (batch->Done != batch->Count)
+		return false;
+
+	if (batch->Async)
+		PendingAsync -= 1;
+	broadcastCondition(DoneCondition);
+	return true;
+}
+
+
+void CThreadPool::run(Task task, void* userData, u32 count)
+{
+	if (count == 0)
+		return;
+
+	if (Workers.empty() || count == 1)
+	{
+		for (u32 i = 0; i < count; ++i)
+			task(userData, i);
+		return;
+	}
+
+	SBatch batch;
+	batch.Function = task;
+	batch.UserData = userData;
+	batch.Count = count;
+	batch.Next = 0;
+	batch.Done = 0;
+	batch.Async = false;
+
+	Mutex.lock();
+	Batches.push_back(&batch);
+	broadcastCondition(WorkCondition);
+
+	// the calling thread only works on its own batch, so nested calls can't block
+	u32 index;
+	while (claim(&batch, index))
+	{
+		Mutex.unlock();
+		task(userData, index);
+		Mutex.lock();
+		finish(&batch);
+	}
+
+	while (batch.Done != batch.Count)
+		waitCondition(DoneCondition, Mutex.Handle);
+	Mutex.unlock();
+}
+
+
+void CThreadPool::enqueue(Task task, void* userData)
+{
+	if (Workers.empty())
+	{
+		task(userData, 0);
+		return;
+	}
+
+	SBatch* batch = new SBatch;
+	batch->Function = task;
+	batch->UserData = userData;
+	batch->Count = 1;
+	batch->Next = 0;
+	batch->Done = 0;
+	batch->Async = true;
+
+	CMutexLock lock(Mutex);
+	PendingAsync += 1;
+	Batches.push_back(batch);
+	broadcastCondition(WorkCondition);
+}
+
+
+void CThreadPool::waitIdle()
+{
+	CMutexLock lock(Mutex);
+	while (PendingAsync)
+		waitCondition(DoneCondition, Mutex.Handle);
+}
+
+
+void CThreadPool::workerLoop()
+{
+	CMutexLock lock(Mutex);
+	for (;;)
+	{
+		while (!Quit && Batches.empty())
+			waitCondition(WorkCondition, Mutex.Handle);
+
+		if (Batches.empty())
+			break;
+
+		SBatch* batch = Batches[0];
+		u32 index = 0;
+		if (!claim(batch, index))
+			continue;
+
+		Mutex.unlock();
+		batch->Function(batch->UserData, index);
+		Mutex.lock();
+
+		// the batches of run() live on the stack of the calling thread
+		if (finish(batch) && batch->Async)
+			delete batch;
+	}
+}
+
+
+#if defined(_IRR_COMPILE_WITH_THREADS_) && defined(_IRR_WINDOWS_API_)
+	static unsigned __stdcall win32ThreadEntry(void* pool)
+	{
+		CThreadPool::threadEntry(pool);
+		return 0;
+	}
+#elif defined(_IRR_COMPILE_WITH_THREADS_)
+	static void* posixThreadEntry(void* pool)
+	{
+		return CThreadPool::threadEntry(pool);
+	}
+#endif
+
+
+void* CThreadPool::threadEntry(void* pool)
+{
+	markWorkerThread();
+	((CThreadPool*)pool)->workerLoop();
+	return 0;
+}
+
+
+bool CThreadPool::isWorkerThread()
+{
+	return isMarkedWorkerThread();
+}
+
+
+u32 CThreadPool::getProcessorCount()
+{
+#if defined(_IRR_COMPILE_WITH_THREADS_) && defined(_IRR_WINDOWS_API_)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 1 ? (u32)info.dwNumberOfProcessors : 1;
+#elif defined(_IRR_COMPILE_WITH_THREADS_) && defined(_SC_NPROCESSORS_ONLN)
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 1 ? (u32)count : 1;
+#else
+	return 1;
+#endif
+}
+
+} // end namespace irr
@@ -0,0 +1,200 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_THREAD_POOL_H_INCLUDED__
+#define __C_THREAD_POOL_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "IReferenceCounted.h"
+#include "irrArray.h"
+
+namespace irr
+{
+
+	//! Simple mutex used by the engine internal worker threads.
+	/** Without _IRR_COMPILE_WITH_THREADS_ all functions are empty. */
+	class CMutex
+	{
+	public:
+		CMutex();
+		~CMutex();
+
+		void lock();
+		void unlock();
+
+	private:
+		// no copy
+		CMutex(const CMutex& other);
+		CMutex& operator=(const CMutex& other);
+
+		friend class CThreadPool;
+		friend class CCondition;
+		void* Handle;
+	};
+
+	//! Locks a mutex for the lifetime of this object.
+	class CMutexLock
+	{
+	public:
+		CMutexLock(CMutex& mutex) : Mutex(mutex) { Mutex.lock(); }
+		~CMutexLock() { Mutex.unlock(); }
+
+	private:
+		CMutexLock& operator=(const CMutexLock& other);
+		CMutex& Mutex;
+	};
+
+
+	//! Condition variable used together with a CMutex.
+	class CCondition
+	{
+	public:
+		CCondition();
+		~CCondition();
+
+		//! Unlocks the mutex, waits for broadcast() and locks the mutex again.
+		/** The mutex must be locked by the calling thread. Wake ups can be
+		spurious, so check the waited for state again after this returns. */
+		void wait(CMutex& mutex);
+
+		//! Wakes all threads waiting for this condition.
+		void broadcast();
+
+	private:
+		// no copy
+		CCondition(const CCondition& other);
+		CCondition& operator=(const CCondition& other);
+
+		void* Handle;
+	};
+
+
+	//! Mutex which can be locked by several readers or one writer at a time.
+	/** Without _IRR_COMPILE_WITH_THREADS_ all functions are empty. */
+	class CReadWriteMutex
+	{
+	public:
+		CReadWriteMutex();
+		~CReadWriteMutex();
+
+		void lockRead();
+		void unlockRead();
+		void lockWrite();
+		void unlockWrite();
+
+	private:
+		// no copy
+		CReadWriteMutex(const CReadWriteMutex& other);
+		CReadWriteMutex& operator=(const CReadWriteMutex& other);
+
+		void* Handle;
+	};
+
+	//! Locks a reader writer mutex for reading for the lifetime of this object.
+	class CReadLock
+	{
+	public:
+		CReadLock(CReadWriteMutex& mutex) : Mutex(mutex) { Mutex.lockRead(); }
+		~CReadLock() { Mutex.unlockRead(); }
+
+	private:
+		CReadLock& operator=(const CReadLock& other);
+		CReadWriteMutex& Mutex;
+	};
+
+	//! Locks a reader writer mutex for writing for the lifetime of this object.
+	class CWriteLock
+	{
+	public:
+		CWriteLock(CReadWriteMutex& mutex) : Mutex(mutex) { Mutex.lockWrite(); }
+		~CWriteLock() { Mutex.unlockWrite(); }
+
+	private:
+		CWriteLock& operator=(const CWriteLock& other);
+		CReadWriteMutex& Mutex;
+	};
+
+
+	//! Pool of worker threads for engine internal tasks.
+	/** Work is handed out as tasks, a task is a function pointer with a
+	user pointer and an index. The thread calling run() takes part in the
+	work, so a pool for n threads starts n-1 additional threads.
+	Note that IReferenceCounted::grab() and drop() are not thread safe, so tasks
+	must not change reference counts of shared objects. */
+	class CThreadPool : public virtual IReferenceCounted
+	{
+	public:
+
+		//! Function executed by the pool.
+		/** \param userData Pointer passed to run() or enqueue().
+		\param index Index of the work item, 0 to count-1. */
+		typedef void (*Task)(void* userData, u32 index);
+
+		//! Constructor
+		/** \param threadCount Number of threads working on a run() call,
+		including the calling thread. 0 uses one thread per processor. */
+		CThreadPool(u32 threadCount);
+
+		//! Destructor, waits for all queued tasks to finish.
+		virtual ~CThreadPool();
+
+		//! Calls task for each index from 0 to count-1 and waits until all are done.
+		/** The order in which indices are processed is undefined. It is safe to
+		call run() again from inside a task. */
+		void run(Task task, void* userData, u32 count);
+
+		//! Queues a single call of task(userData, 0) and returns immediately.
+		/** Without worker threads the task is executed before this returns. */
+		void enqueue(Task task, void* userData);
+
+		//! Waits until all tasks queued with enqueue() have finished.
+		void waitIdle();
+
+		//! Number of threads taking part in a run() call.
+		u32 getThreadCount() const { return Workers.size() + 1; }
+
+		//! Number of processors of the system.
+		static u32 getProcessorCount();
+
+		//! True if called on a worker thread of any pool.
+		/** The thread calling run() is not a worker thread. */
+		static bool isWorkerThread();
+
+		//! Entry function of the worker threads, only for internal use.
+		static void* threadEntry(void* pool);
+
+	private:
+
+		struct SBatch
+		{
+			Task Function;
+			void* UserData;
+			u32 Count;
+			u32 Next;
+			u32 Done;
+			bool Async;
+		};
+
+		//! claims the next index of a batch, mutex must be locked
+		bool claim(SBatch* batch, u32& index);
+
+		//! marks an index of a batch as finished, mutex must be locked
+		/** \return True if it was the last index of the batch. Batches of
+		enqueue() have to be deleted by the caller then. */
+		bool finish(SBatch* batch);
+
+		void workerLoop();
+
+		CMutex Mutex;
+		void* WorkCondition;
+		void* DoneCondition;
+		core::array<SBatch*> Batches;
+		core::array<void*> Workers;
+		u32 PendingAsync;
+		bool Quit;
+	};
+
+} // end namespace irr
+
+#endif // __C_THREAD_POOL_H_INCLUDED__
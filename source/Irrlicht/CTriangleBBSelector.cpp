@@ -80,6 +80,9 @@ void CTriangleBBSelector::fillTriangles() const
 
 		Triangles[10].set(edges[0], edges[6], edges[2]);
 		Triangles[11].set(edges[0], edges[4], edges[6]);
+
+		// box queries test this before the triangles
+		BoundingBox = box;
 	}
 }
 
@@ -60,7 +60,7 @@ CTriangleSelector::CTriangleSelector(const IMeshBuffer* meshBuffer, irr::u32 mat
 }
 
 CTriangleSelector::CTriangleSelector(IAnimatedMeshSceneNode* node, bool separateMeshbuffers)
-: SceneNode(node), AnimatedNode(node), LastMeshFrame(0)
+: SceneNode(node), MeshBuffer(0), MaterialIndex(0), AnimatedNode(node), LastMeshFrame(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CTriangleSelector");
@@ -61,6 +61,11 @@ public:
 	//! Return the scene node associated with a given triangle.
 	virtual ISceneNode* getSceneNodeForTriangle(u32 triangleIndex) const _IRR_OVERRIDE_ { return SceneNode; }
 
+	//! Update the triangle selector, which will only have an effect if it
+	//! was built from an animated mesh and that mesh's frame has changed
+	//! since the last time it was updated.
+	virtual void update(void) const _IRR_OVERRIDE_;
+
 	// Get the number of TriangleSelectors that are part of this one
 	virtual u32 getSelectorCount() const _IRR_OVERRIDE_;
 
@@ -86,11 +91,6 @@ protected:
 	//! Update bounding box from triangles
 	void updateBoundingBox() const;
 
-	//! Update the triangle selector, which will only have an effect if it
-	//! was built from an animated mesh and that mesh's frame has changed
-	//! since the last time it was updated.
-	virtual void update(void) const;
-
 	irr::core::array<SCollisionTriangleRange> BufferRanges;
 
 	ISceneNode* SceneNode;
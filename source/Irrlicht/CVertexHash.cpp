@@ -0,0 +1,148 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CVertexHash.h"
+#include "irrMath.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+
+//! cell coordinate, clamped so that far away or invalid positions still get a cell
+inline s64 toCell(f64 v)
+{
+	if (!(v > -9.0e18))
+		return (s64)-9.0e18;
+	if (!(v < 9.0e18))
+		return (s64)9.0e18;
+	return (s64)floor(v);
+}
+
+} // end anonymous namespace
+
+
+//! constructor
+CVertexHash::CVertexHash(f32 tolerance, f32 extent, u32 sizeHint)
+	: Mask(0), Tolerance(core::max_(tolerance, 0.f)), InvCellSize(0.)
+{
+	if (Tolerance > 0.)
+	{
+		// The range looked at is widened by the rounding error of the float
+		// comparisons (see getCells), cells are at least as large as that
+		// range up to extent, so it never touches more than two per axis.
+		const f64 cellSize = 2. * (Tolerance + (core::abs_((f64)extent) + Tolerance) * FLT_EPSILON);
+		InvCellSize = 1. / cellSize;
+	}
+
+	u32 bucketCount = 16;
+	while (bucketCount < sizeHint)
+		bucketCount <<= 1;
+	Entries.reallocate(sizeHint);
+	rehash(bucketCount);
+}
+
+
+//! adds the position of the next vertex
+u32 CVertexHash::add(const core::vector3df& pos)
+{
+	const u32 index = Entries.size();
+	if (index >= Buckets.size())
+		rehash(Buckets.size() * 2);
+
+	s64 lo[3], hi[3];
+	if (InvCellSize > 0.)
+	{
+		lo[0] = toCell(pos.X * InvCellSize);
+		lo[1] = toCell(pos.Y * InvCellSize);
+		lo[2] = toCell(pos.Z * InvCellSize);
+	}
+	else
+		getCells(pos, lo, hi);
+
+	SEntry entry;
+	entry.Hash = getHash(lo[0], lo[1], lo[2]);
+	entry.Next = Buckets[entry.Hash & Mask];
+	Buckets[entry.Hash & Mask] = index;
+	Entries.push_back(entry);
+	return index;
+}
+
+
+//! removes all vertices
+void CVertexHash::clear()
+{
+	Entries.set_used(0);
+	for (u32 i=0; i<Buckets.size(); ++i)
+		Buckets[i] = EmptySlot;
+}
+
+
+//! gets the range of cells which positions within tolerance can be in
+void CVertexHash::getCells(const core::vector3df& pos, s64* lo, s64* hi) const
+{
+	const f32 coords[3] = { pos.X, pos.Y, pos.Z };
+	for (u32 i=0; i<3; ++i)
+	{
+		if (InvCellSize > 0.)
+		{
+			// core::equals computes a+tolerance in float, which can round up
+			// by half an ulp of a, so positions a bit further away are still
+			// equal. The slack covers that with a margin.
+			const f64 p = coords[i];
+			const f64 slack = Tolerance + (core::abs_(p) + Tolerance) * FLT_EPSILON;
+			lo[i] = toCell((p - slack) * InvCellSize);
+			hi[i] = toCell((p + slack) * InvCellSize);
+		}
+		else
+		{
+			// exact positions, -0 is the same as 0
+			f32 p = coords[i];
+			if (p == 0.f)
+				p = 0.f;
+			lo[i] = hi[i] = IR(p);
+		}
+	}
+}
+
+
+//! hashes the coordinates of a cell
+u32 CVertexHash::getHash(s64 x, s64 y, s64 z)
+{
+	u32 hash = (u32)x * 73856093u ^ (u32)((u64)x >> 32);
+	hash = hash * 16777619u ^ (u32)y * 19349663u ^ (u32)((u64)y >> 32);
+	hash = hash * 16777619u ^ (u32)z * 83492791u ^ (u32)((u64)z >> 32);
+
+	// mix the high bits into the low ones, the table only uses those
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35u;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+
+//! resizes the bucket list and chains all vertices again
+void CVertexHash::rehash(u32 bucketCount)
+{
+	Buckets.set_used(bucketCount);
+	for (u32 i=0; i<bucketCount; ++i)
+		Buckets[i] = EmptySlot;
+	Mask = bucketCount - 1;
+
+	for (u32 i=0; i<Entries.size(); ++i)
+	{
+		const u32 slot = Entries[i].Hash & Mask;
+		Entries[i].Next = Buckets[slot];
+		Buckets[slot] = i;
+	}
+}
+
+} // end namespace scene
+} // end namespace irr
+
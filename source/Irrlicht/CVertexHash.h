@@ -0,0 +1,129 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_VERTEX_HASH_H_INCLUDED__
+#define __C_VERTEX_HASH_H_INCLUDED__
+
+#include "irrArray.h"
+#include "vector3d.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Hash of vertex positions to find equal vertices in constant time.
+/** Positions are sorted into a grid with cells a bit larger than twice the
+tolerance. Positions which are within tolerance of each other are in the same
+or in neighbouring cells, so a lookup only compares the vertices in the (mostly
+eight) cells its tolerance box touches. With tolerance 0 positions are hashed
+by their bits and only vertices with the same position are compared.
+Whether two vertices at close positions are equal, e.g. if their normals and
+texture coordinates have to match as well, is up to the caller. */
+class CVertexHash
+{
+public:
+
+	//! constructor
+	/** \param tolerance Vertices whose positions differ more than this in
+	any coordinate are never equal.
+	\param extent Largest absolute coordinate expected. Keeps the cells from
+	getting much smaller than the float precision of the positions, which
+	would make lookups far from the origin slow.
+	\param sizeHint Number of vertices expected. */
+	CVertexHash(f32 tolerance=0.f, f32 extent=0.f, u32 sizeHint=0);
+
+	//! finds the first added vertex which a predicate takes as equal
+	/** \param pos Position of the vertex looked for.
+	\param equal Called with the index of added vertices close to pos,
+	has to return true when that vertex is equal to the one looked for.
+	\return Lowest index of an equal vertex, or -1 if there is none. */
+	template <class T>
+	s32 find(const core::vector3df& pos, const T& equal) const
+	{
+		s64 lo[3], hi[3];
+		getCells(pos, lo, hi);
+
+		u32 result = EmptySlot;
+		for (s64 z=lo[2]; z<=hi[2]; ++z)
+		for (s64 y=lo[1]; y<=hi[1]; ++y)
+		for (s64 x=lo[0]; x<=hi[0]; ++x)
+		{
+			const u32 hash = getHash(x, y, z);
+			for (u32 i=Buckets[hash & Mask]; i!=EmptySlot; i=Entries[i].Next)
+			{
+				// chains run from the newest to the oldest vertex
+				if (i < result && Entries[i].Hash == hash && equal(i))
+					result = i;
+			}
+		}
+		return result == EmptySlot ? -1 : (s32)result;
+	}
+
+	//! adds the position of the next vertex
+	/** \return Index of the vertex, which counts up from 0. */
+	u32 add(const core::vector3df& pos);
+
+	//! returns the number of added vertices
+	u32 size() const { return Entries.size(); }
+
+	//! removes all vertices
+	void clear();
+
+private:
+
+	static const u32 EmptySlot = 0xffffffff;
+
+	struct SEntry
+	{
+		u32 Hash;
+		u32 Next;
+	};
+
+	//! gets the range of cells which positions within tolerance can be in
+	void getCells(const core::vector3df& pos, s64* lo, s64* hi) const;
+
+	//! hashes the coordinates of a cell
+	static u32 getHash(s64 x, s64 y, s64 z);
+
+	//! resizes the bucket list and chains all vertices again
+	void rehash(u32 bucketCount);
+
+	core::array<SEntry> Entries;
+	core::array<u32> Buckets;
+	u32 Mask;
+	f64 Tolerance;
+	f64 InvCellSize;
+};
+
+
+//! CVertexHash predicate which compares a vertex to those in a list
+template <class T>
+struct SVertexEquals
+{
+	SVertexEquals(const T* vertices, const T& vertex)
+		: Vertices(vertices), Vertex(vertex) {}
+
+	bool operator()(u32 index) const
+	{
+		return Vertices[index] == Vertex;
+	}
+
+	const T* Vertices;
+	const T& Vertex;
+};
+
+//! finds a vertex in an array whose positions were added to a hash in order
+/** \return Index of the first equal vertex, or -1. */
+template <class T>
+inline s32 findVertex(const CVertexHash& hash, const core::array<T>& vertices, const T& vertex)
+{
+	return hash.find(vertex.Pos, SVertexEquals<T>(vertices.const_pointer(), vertex));
+}
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -30,7 +30,7 @@ namespace scene
 //! Constructor
 CXMeshFileLoader::CXMeshFileLoader(scene::ISceneManager* smgr, io::IFileSystem* fs)
 : SceneManager(smgr), FileSystem(fs), AnimatedMesh(0),
-	Buffer(0), P(0), End(0), BinaryNumCount(0), Line(0),
+	Buffer(0), P(0), End(0), DeleteBuffer(false), BinaryNumCount(0), Line(0),
 	CurFrame(0), MajorVersion(0), MinorVersion(0), BinaryFormat(false), FloatSize(0)
 {
 	#ifdef _DEBUG
@@ -97,8 +97,10 @@ IAnimatedMesh* CXMeshFileLoader::createMesh(io::IReadFile* file)
 	CurFrame=0;
 	TemplateMaterials.clear();
 
-	delete [] Buffer;
+	if (DeleteBuffer)
+		delete [] Buffer;
 	Buffer = 0;
+	DeleteBuffer = false;
 
 	for (u32 i=0; i<Meshes.size(); ++i)
 		delete Meshes[i];
@@ -408,13 +410,20 @@ bool CXMeshFileLoader::readFileIntoMemory(io::IReadFile* file)
 		return false;
 	}
 
-	Buffer = new c8[size];
-
-	//! read all into memory
-	if (file->read(Buffer, size) != static_cast<size_t>(size))
+	//! parse files which are in memory already without copying them
+	Buffer = (const c8*)file->getData();
+	if (!Buffer)
 	{
-		os::Printer::log("Could not read from x file.", ELL_WARNING);
-		return false;
+		c8* data = new c8[size];
+		Buffer = data;
+		DeleteBuffer = true;
+
+		//! read all into memory
+		if (file->read(data, size) != static_cast<size_t>(size))
+		{
+			os::Printer::log("Could not read from x file.", ELL_WARNING);
+			return false;
+		}
 	}
 
 	Line = 1;
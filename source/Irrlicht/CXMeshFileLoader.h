@@ -172,9 +172,11 @@ private:
 
 	CSkinnedMesh* AnimatedMesh;
 
-	c8* Buffer;
+	const c8* Buffer;
 	const c8* P;
-	c8* End;
+	const c8* End;
+	// false if Buffer points into the memory of the file
+	bool DeleteBuffer;
 	// counter for number arrays in binary format
 	u32 BinaryNumCount;
 	u32 Line;
@@ -17,6 +17,7 @@ extern "C" void bz_internal_error(int errorCode)
 #include "CFileList.h"
 #include "CReadFile.h"
 #include "coreutil.h"
+#include "CInflateReadFile.h"
 
 #include "IrrCompileConfig.h"
 #ifdef _IRR_COMPILE_WITH_ZLIB_
@@ -53,13 +54,30 @@ namespace io
 
 //! Constructor
 CArchiveLoaderZIP::CArchiveLoaderZIP(io::IFileSystem* fs)
-: FileSystem(fs)
+: FileSystem(fs), DecompressionThreads(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CArchiveLoaderZIP");
 	#endif
 }
 
+//! destructor
+CArchiveLoaderZIP::~CArchiveLoaderZIP()
+{
+	if (DecompressionThreads)
+		DecompressionThreads->drop();
+}
+
+//! returns the threads all archives of this loader decompress files with, created on first use
+CThreadPool* CArchiveLoaderZIP::getDecompressionThreads() const
+{
+	CMutexLock lock(DecompressionThreadsMutex);
+	if (!DecompressionThreads)
+		DecompressionThreads = new CThreadPool(0);
+
+	return DecompressionThreads;
+}
+
 //! returns true if the file maybe is able to be loaded by this class
 bool CArchiveLoaderZIP::isALoadableFileFormat(const io::path& filename) const
 {
@@ -111,7 +129,7 @@ IFileArchive* CArchiveLoaderZIP::createArchive(io::IReadFile* file, bool ignoreC
 
 		bool isGZip = (sig == 0x8b1f);
 
-		archive = new CZipReader(FileSystem, file, ignoreCase, ignorePaths, isGZip);
+		archive = new CZipReader(FileSystem, file, ignoreCase, ignorePaths, isGZip, this);
 	}
 	return archive;
 }
@@ -137,13 +155,18 @@ bool CArchiveLoaderZIP::isALoadableFileFormat(io::IReadFile* file) const
 // zip archive
 // -----------------------------------------------------------------------------
 
-CZipReader::CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool ignorePaths, bool isGZip)
- : CFileList((file ? file->getFileName() : io::path("")), ignoreCase, ignorePaths), FileSystem(fs), File(file), IsGZip(isGZip)
+CZipReader::CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool ignorePaths, bool isGZip,
+		const CArchiveLoaderZIP* loader)
+ : CFileList((file ? file->getFileName() : io::path("")), ignoreCase, ignorePaths), FileSystem(fs), File(file),
+	Loader(loader), IsGZip(isGZip)
 {
 	#ifdef _DEBUG
 	setDebugName("CZipReader");
 	#endif
 
+	if (Loader)
+		Loader->grab();
+
 	if (File)
 	{
 		File->grab();
@@ -162,6 +185,8 @@ CZipReader::~CZipReader()
 {
 	if (File)
 		File->drop();
+	if (Loader)
+		Loader->drop();
 }
 
 
@@ -506,6 +531,253 @@ namespace
 }
 #endif
 
+namespace
+{
+	//! Decompresses the data of an entry, outSize is the expected size and receives the actual size.
+	/** Only uses its parameters, so several entries can be decompressed at the same time. */
+	bool decompress(s16 method, s16 flags, const u8* pcData, u32 decryptedSize, c8* pBuf, u32& uncompressedSize)
+	{
+		switch (method)
+		{
+		#ifdef _IRR_COMPILE_WITH_ZLIB_
+		case 8:
+			{
+				// Setup the inflate stream.
+				z_stream stream;
+				s32 err;
+
+				stream.next_in = (Bytef*)pcData;
+				stream.avail_in = (uInt)decryptedSize;
+				stream.next_out = (Bytef*)pBuf;
+				stream.avail_out = uncompressedSize;
+				stream.zalloc = (alloc_func)0;
+				stream.zfree = (free_func)0;
+
+				// Perform inflation. wbits < 0 indicates no zlib header inside the data.
+				err = inflateInit2(&stream, -MAX_WBITS);
+				if (err == Z_OK)
+				{
+					err = inflate(&stream, Z_FINISH);
+					inflateEnd(&stream);
+					if (err == Z_STREAM_END)
+						err = Z_OK;
+					err = Z_OK;
+					inflateEnd(&stream);
+				}
+				return err == Z_OK;
+			}
+		#endif
+		#ifdef _IRR_COMPILE_WITH_BZIP2_
+		case 12:
+			{
+				bz_stream bz_ctx;
+				memset(&bz_ctx, 0, sizeof(bz_ctx));
+				/* use BZIP2's default memory allocation
+				bz_ctx->bzalloc = NULL;
+				bz_ctx->bzfree  = NULL;
+				bz_ctx->opaque  = NULL;
+				*/
+				int err = BZ2_bzDecompressInit(&bz_ctx, 0, 0); /* decompression */
+				if(err != BZ_OK)
+				{
+					os::Printer::log("bzip2 decompression failed. File cannot be read.", ELL_ERROR);
+					return false;
+				}
+				bz_ctx.next_in = (char*)pcData;
+				bz_ctx.avail_in = decryptedSize;
+				/* pass all input to decompressor */
+				bz_ctx.next_out = pBuf;
+				bz_ctx.avail_out = uncompressedSize;
+				err = BZ2_bzDecompress(&bz_ctx);
+				err = BZ2_bzDecompressEnd(&bz_ctx);
+				return err == BZ_OK;
+			}
+		#endif
+		#ifdef _IRR_COMPILE_WITH_LZMA_
+		case 14:
+			{
+				ELzmaStatus status;
+				SizeT tmpDstSize = uncompressedSize;
+				SizeT tmpSrcSize = decryptedSize;
+
+				unsigned int propSize = (pcData[3]<<8)+pcData[2];
+				int err = LzmaDecode((Byte*)pBuf, &tmpDstSize,
+						pcData+4+propSize, &tmpSrcSize,
+						pcData+4, propSize,
+						flags&0x1?LZMA_FINISH_END:LZMA_FINISH_ANY, &status,
+						&lzmaAlloc);
+				uncompressedSize = tmpDstSize; // may be different to expected value
+				return err == SZ_OK;
+			}
+		#endif
+		default:
+			return false;
+		}
+	}
+
+	//! an entry which is decompressed by one of the threads of createAndOpenFiles
+	struct SDecompressJob
+	{
+		//! index in the list of requested files
+		u32 Request;
+		s16 Method;
+		s16 Flags;
+		const u8* Input;
+		u8* ReadBuffer;
+		u32 InputSize;
+		c8* Output;
+		u32 OutputSize;
+		bool Decompressed;
+	};
+
+	void decompressJob(void* jobs, u32 index)
+	{
+		SDecompressJob& job = ((SDecompressJob*)jobs)[index];
+		job.Decompressed = decompress(job.Method, job.Flags, job.Input, job.InputSize, job.Output, job.OutputSize);
+	}
+}
+
+
+//! returns true if the compression method is compiled in, logs an error otherwise
+bool CZipReader::canDecompress(s16 method)
+{
+	switch (method)
+	{
+	case 8:
+		#ifdef _IRR_COMPILE_WITH_ZLIB_
+		return true;
+		#else
+		return false; // zlib not compiled, we cannot decompress the data.
+		#endif
+	case 12:
+		#ifdef _IRR_COMPILE_WITH_BZIP2_
+		return true;
+		#else
+		os::Printer::log("bzip2 decompression not supported. File cannot be read.", ELL_ERROR);
+		return false;
+		#endif
+	case 14:
+		#ifdef _IRR_COMPILE_WITH_LZMA_
+		return true;
+		#else
+		os::Printer::log("lzma decompression not supported. File cannot be read.", ELL_ERROR);
+		return false;
+		#endif
+	default:
+		return false;
+	}
+}
+
+
+//! returns true if the entry is inflated while it is read instead of when it is opened
+bool CZipReader::isStreamed(const SZipFileEntry& e) const
+{
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+	const long threshold = FileSystem->getStreamingThreshold();
+	return e.header.CompressionMethod == 8 && !(e.header.GeneralBitFlag & ZIP_FILE_ENCRYPTED) &&
+		threshold > 0 && (long)e.header.DataDescriptor.UncompressedSize >= threshold;
+#else
+	return false;
+#endif
+}
+
+
+//! creates a file which inflates a deflated entry while it is read
+IReadFile* CZipReader::createInflateReadFile(u32 index)
+{
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+	const SZipFileEntry &e = FileInfo[Files[index].ID];
+	const u32 compressedSize = e.header.DataDescriptor.CompressedSize;
+
+	CInflateReadFile* file = new CInflateReadFile(File, getMappedData(e.Offset, compressedSize),
+			e.Offset, compressedSize, e.header.DataDescriptor.UncompressedSize, Files[index].FullName);
+	if (file->isOpen())
+		return file;
+
+	file->drop();
+#endif
+	return 0;
+}
+
+
+//! returns the stored data of an entry if the archive is in memory, 0 otherwise
+const u8* CZipReader::getMappedData(long offset, u32 size) const
+{
+	const u8* data = (const u8*)File->getData();
+	if (!data || offset < 0 || offset + (long)size > File->getSize())
+		return 0;
+	return data + offset;
+}
+
+
+//! opens several files, decompresses them in parallel
+void CZipReader::createAndOpenFiles(const core::array<u32>& indices, core::array<IReadFile*>& files)
+{
+	files.set_used(indices.size());
+
+	// the compressed data is read here, only decompression runs on the threads
+	core::array<SDecompressJob> jobs(indices.size());
+	u32 i;
+	for (i=0; i<indices.size(); ++i)
+	{
+		files[i] = 0;
+		if (indices[i] >= Files.size())
+			continue;
+
+		const SZipFileEntry &e = FileInfo[Files[indices[i]].ID];
+		const s16 method = e.header.CompressionMethod;
+		if ((method != 8 && method != 12 && method != 14) || (e.header.GeneralBitFlag & ZIP_FILE_ENCRYPTED) ||
+			isStreamed(e) || !canDecompress(method))
+		{
+			files[i] = createAndOpenFile(indices[i]);
+			continue;
+		}
+
+		SDecompressJob job;
+		job.Request = i;
+		job.Method = method;
+		job.Flags = e.header.GeneralBitFlag;
+		job.InputSize = e.header.DataDescriptor.CompressedSize;
+		job.Input = getMappedData(e.Offset, job.InputSize);
+		job.ReadBuffer = 0;
+		if (!job.Input)
+		{
+			job.ReadBuffer = new u8[job.InputSize];
+			File->seek(e.Offset);
+			File->read(job.ReadBuffer, job.InputSize);
+			job.Input = job.ReadBuffer;
+		}
+		job.OutputSize = e.header.DataDescriptor.UncompressedSize;
+		job.Output = new c8[job.OutputSize];
+		job.Decompressed = false;
+		jobs.push_back(job);
+	}
+
+	if (Loader && jobs.size() > 1)
+		Loader->getDecompressionThreads()->run(decompressJob, jobs.pointer(), jobs.size());
+	else
+	{
+		for (i=0; i<jobs.size(); ++i)
+			decompressJob(jobs.pointer(), i);
+	}
+
+	for (i=0; i<jobs.size(); ++i)
+	{
+		SDecompressJob& job = jobs[i];
+		const io::path& name = Files[indices[job.Request]].FullName;
+		delete [] job.ReadBuffer;
+
+		if (job.Decompressed)
+			files[job.Request] = FileSystem->createMemoryReadFile(job.Output, job.OutputSize, name, true);
+		else
+		{
+			os::Printer::log("Error decompressing", name, ELL_ERROR);
+			delete [] job.Output;
+		}
+	}
+}
+
+
 //! opens a file by index
 IReadFile* CZipReader::createAndOpenFile(u32 index)
 {
@@ -621,155 +893,19 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 				return createLimitReadFile(Files[index].FullName, File, e.Offset, decryptedSize);
 		}
 	case 8:
-		{
-  			#ifdef _IRR_COMPILE_WITH_ZLIB_
-
-			const u32 uncompressedSize = e.header.DataDescriptor.UncompressedSize;
-			c8* pBuf = new c8[ uncompressedSize ];
-			if (!pBuf)
-			{
-				swprintf_irr ( buf, 64, L"Not enough memory for decompressing %s", core::stringw(Files[index].FullName).c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-				if (decrypted)
-					decrypted->drop();
-				return 0;
-			}
-
-			u8 *pcData = decryptedBuf;
-			if (!pcData)
-			{
-				pcData = new u8[decryptedSize];
-				if (!pcData)
-				{
-					swprintf_irr ( buf, 64, L"Not enough memory for decompressing %s", core::stringw(Files[index].FullName).c_str() );
-					os::Printer::log( buf, ELL_ERROR);
-					delete [] pBuf;
-					return 0;
-				}
-
-				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
-			}
-
-			// Setup the inflate stream.
-			z_stream stream;
-			s32 err;
-
-			stream.next_in = (Bytef*)pcData;
-			stream.avail_in = (uInt)decryptedSize;
-			stream.next_out = (Bytef*)pBuf;
-			stream.avail_out = uncompressedSize;
-			stream.zalloc = (alloc_func)0;
-			stream.zfree = (free_func)0;
-
-			// Perform inflation. wbits < 0 indicates no zlib header inside the data.
-			err = inflateInit2(&stream, -MAX_WBITS);
-			if (err == Z_OK)
-			{
-				err = inflate(&stream, Z_FINISH);
-				inflateEnd(&stream);
-				if (err == Z_STREAM_END)
-					err = Z_OK;
-				err = Z_OK;
-				inflateEnd(&stream);
-			}
-
-			if (decrypted)
-				decrypted->drop();
-			else
-				delete[] pcData;
-
-			if (err != Z_OK)
-			{
-				swprintf_irr ( buf, 64, L"Error decompressing %s", core::stringw(Files[index].FullName).c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-				delete [] pBuf;
-				return 0;
-			}
-			else
-				return FileSystem->createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
-
-			#else
-			return 0; // zlib not compiled, we cannot decompress the data.
-			#endif
-		}
 	case 12:
+	case 14:
 		{
-  			#ifdef _IRR_COMPILE_WITH_BZIP2_
-
-			const u32 uncompressedSize = e.header.DataDescriptor.UncompressedSize;
-			c8* pBuf = new c8[ uncompressedSize ];
-			if (!pBuf)
+			if (!canDecompress(actualCompressionMethod))
 			{
-				swprintf_irr ( buf, 64, L"Not enough memory for decompressing %s", core::stringw(Files[index].FullName).c_str() );
-				os::Printer::log( buf, ELL_ERROR);
 				if (decrypted)
 					decrypted->drop();
 				return 0;
 			}
 
-			u8 *pcData = decryptedBuf;
-			if (!pcData)
-			{
-				pcData = new u8[decryptedSize];
-				if (!pcData)
-				{
-					swprintf_irr ( buf, 64, L"Not enough memory for decompressing %s", core::stringw(Files[index].FullName).c_str() );
-					os::Printer::log( buf, ELL_ERROR);
-					delete [] pBuf;
-					return 0;
-				}
-
-				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
-			}
-
-			bz_stream bz_ctx;
-			memset(&bz_ctx, 0, sizeof(bz_ctx));
-			/* use BZIP2's default memory allocation
-			bz_ctx->bzalloc = NULL;
-			bz_ctx->bzfree  = NULL;
-			bz_ctx->opaque  = NULL;
-			*/
-			int err = BZ2_bzDecompressInit(&bz_ctx, 0, 0); /* decompression */
-			if(err != BZ_OK)
-			{
-				os::Printer::log("bzip2 decompression failed. File cannot be read.", ELL_ERROR);
-				return 0;
-			}
-			bz_ctx.next_in = (char*)pcData;
-			bz_ctx.avail_in = decryptedSize;
-			/* pass all input to decompressor */
-			bz_ctx.next_out = pBuf;
-			bz_ctx.avail_out = uncompressedSize;
-			err = BZ2_bzDecompress(&bz_ctx);
-			err = BZ2_bzDecompressEnd(&bz_ctx);
-
-			if (decrypted)
-				decrypted->drop();
-			else
-				delete[] pcData;
-
-			if (err != BZ_OK)
-			{
-				swprintf_irr ( buf, 64, L"Error decompressing %s", core::stringw(Files[index].FullName).c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-				delete [] pBuf;
-				return 0;
-			}
-			else
-				return FileSystem->createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
-
-			#else
-			os::Printer::log("bzip2 decompression not supported. File cannot be read.", ELL_ERROR);
-			return 0;
-			#endif
-		}
-	case 14:
-		{
-  			#ifdef _IRR_COMPILE_WITH_LZMA_
+			// large files are inflated while they are read
+			if (!decrypted && isStreamed(e))
+				return createInflateReadFile(index);
 
 			u32 uncompressedSize = e.header.DataDescriptor.UncompressedSize;
 			c8* pBuf = new c8[ uncompressedSize ];
@@ -782,11 +918,15 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 				return 0;
 			}
 
-			u8 *pcData = decryptedBuf;
+			// decompress straight from the archive when it is in memory
+			const u8 *pcData = decryptedBuf;
+			u8 *readBuf = 0;
+			if (!pcData)
+				pcData = getMappedData(e.Offset, decryptedSize);
 			if (!pcData)
 			{
-				pcData = new u8[decryptedSize];
-				if (!pcData)
+				readBuf = new u8[decryptedSize];
+				if (!readBuf)
 				{
 					swprintf_irr ( buf, 64, L"Not enough memory for decompressing %s", core::stringw(Files[index].FullName).c_str() );
 					os::Printer::log( buf, ELL_ERROR);
@@ -794,41 +934,29 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 					return 0;
 				}
 
-				//memset(pcData, 0, decryptedSize);
+				//memset(readBuf, 0, decryptedSize);
 				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
+				File->read(readBuf, decryptedSize);
+				pcData = readBuf;
 			}
 
-			ELzmaStatus status;
-			SizeT tmpDstSize = uncompressedSize;
-			SizeT tmpSrcSize = decryptedSize;
-
-			unsigned int propSize = (pcData[3]<<8)+pcData[2];
-			int err = LzmaDecode((Byte*)pBuf, &tmpDstSize,
-					pcData+4+propSize, &tmpSrcSize,
-					pcData+4, propSize,
-					e.header.GeneralBitFlag&0x1?LZMA_FINISH_END:LZMA_FINISH_ANY, &status,
-					&lzmaAlloc);
-			uncompressedSize = tmpDstSize; // may be different to expected value
+			const bool decompressed = decompress(actualCompressionMethod, e.header.GeneralBitFlag,
+					pcData, decryptedSize, pBuf, uncompressedSize);
 
 			if (decrypted)
 				decrypted->drop();
 			else
-				delete[] pcData;
+				delete[] readBuf;
 
-			if (err != SZ_OK)
+			if (!decompressed)
 			{
-				os::Printer::log( "Error decompressing", Files[index].FullName, ELL_ERROR);
+				swprintf_irr ( buf, 64, L"Error decompressing %s", core::stringw(Files[index].FullName).c_str() );
+				os::Printer::log( buf, ELL_ERROR);
 				delete [] pBuf;
 				return 0;
 			}
 			else
 				return FileSystem->createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
-
-			#else
-			os::Printer::log("lzma decompression not supported. File cannot be read.", ELL_ERROR);
-			return 0;
-			#endif
 		}
 	case 99:
 		// If we come here with an encrypted file, decryption support is missing
@@ -14,6 +14,7 @@
 #include "irrString.h"
 #include "IFileSystem.h"
 #include "CFileList.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -168,8 +169,16 @@ namespace io
 		//! \return Pointer to the created archive. Returns 0 if loading failed.
 		virtual io::IFileArchive* createArchive(io::IReadFile* file, bool ignoreCase, bool ignorePaths) const _IRR_OVERRIDE_;
 
+		//! destructor
+		virtual ~CArchiveLoaderZIP();
+
+		//! returns the threads all archives of this loader decompress files with, created on first use
+		CThreadPool* getDecompressionThreads() const;
+
 	private:
 		io::IFileSystem* FileSystem;
+		mutable CThreadPool* DecompressionThreads;
+		mutable CMutex DecompressionThreadsMutex;
 	};
 
 /*!
@@ -180,7 +189,9 @@ namespace io
 	public:
 
 		//! constructor
-		CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool ignorePaths, bool isGZip=false);
+		/** \param loader Provides the threads for createAndOpenFiles, files are decompressed one after another if 0. */
+		CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool ignorePaths, bool isGZip=false,
+			const CArchiveLoaderZIP* loader=0);
 
 		//! destructor
 		virtual ~CZipReader();
@@ -191,12 +202,18 @@ namespace io
 		//! opens a file by index
 		virtual IReadFile* createAndOpenFile(u32 index) _IRR_OVERRIDE_;
 
+		//! opens several files by index, compressed files are decompressed in parallel
+		virtual void createAndOpenFiles(const core::array<u32>& indices, core::array<IReadFile*>& files) _IRR_OVERRIDE_;
+
 		//! returns the list of files
 		virtual const IFileList* getFileList() const _IRR_OVERRIDE_;
 
 		//! get the archive type
 		virtual E_FILE_ARCHIVE_TYPE getType() const _IRR_OVERRIDE_;
 
+		//! files are found with findFile, so the file system can index them
+		virtual bool isIndexable(bool& ignorePaths, bool& ignoreCase) const _IRR_OVERRIDE_ { ignorePaths = IgnorePaths; ignoreCase = IgnoreCase; return true; }
+
 		//! return the id of the file Archive
 		virtual const io::path& getArchiveName() const _IRR_OVERRIDE_ {return Path;}
 
@@ -213,8 +230,21 @@ namespace io
 
 		bool scanCentralDirectoryHeader();
 
+		//! returns the stored data of an entry if the archive is in memory, 0 otherwise
+		const u8* getMappedData(long offset, u32 size) const;
+
+		//! returns true if the compression method is compiled in, logs an error otherwise
+		static bool canDecompress(s16 method);
+
+		//! returns true if the entry is inflated while it is read instead of when it is opened
+		bool isStreamed(const SZipFileEntry& e) const;
+
+		//! creates a file which inflates a deflated entry while it is read
+		IReadFile* createInflateReadFile(u32 index);
+
 		io::IFileSystem* FileSystem;
 		IReadFile* File;
+		const CArchiveLoaderZIP* Loader;
 
 		// holds extended info about files
 		core::array<SZipFileEntry> FileInfo;
@@ -35,6 +35,8 @@ namespace video
 
 		Driver = driver;
 		RenderTarget = 0;
+		ScanlineClip[0] = 0;
+		ScanlineClip[1] = 0x7FFFFFFF;
 		ColorMask = COLOR_BRIGHT_WHITE;
 		DepthBuffer = (CDepthBuffer*) driver->getDepthBuffer ();
 		if ( DepthBuffer )
@@ -113,6 +115,20 @@ namespace video
 	}
 
 
+	//! takes over texture state prepared by another shader
+	void IBurningShader::copyTextureParam( const sInternalTexture* it )
+	{
+		for ( u32 i = 0; i != BURNING_MATERIAL_MAX_TEXTURES; ++i )
+		{
+			if ( IT[i].Texture )
+				IT[i].Texture->drop();
+
+			IT[i] = it[i];
+			IT[i].Texture = 0;
+		}
+	}
+
+
 } // end namespace video
 } // end namespace irr
 
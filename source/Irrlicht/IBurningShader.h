@@ -144,6 +144,20 @@ namespace video
 
 		virtual void setMaterial ( const SBurningShaderMaterial &material ) {};
 
+		//! only scanlines y0 <= y < y1 are written by drawTriangle
+		void setScanlineClip ( s32 y0, s32 y1 )
+		{
+			ScanlineClip[0] = y0;
+			ScanlineClip[1] = y1;
+		}
+
+		//! texture state of all stages as set by setTextureParam
+		const sInternalTexture* getTextureParam () const { return IT; }
+
+		//! takes over texture state prepared by another shader
+		/** Textures are neither locked nor grabbed, the caller has to keep them alive. */
+		void copyTextureParam ( const sInternalTexture* it );
+
 	protected:
 
 		CBurningVideoDriver *Driver;
@@ -154,6 +168,7 @@ namespace video
 		tVideoSample ColorMask;
 
 		sInternalTexture IT[ BURNING_MATERIAL_MAX_TEXTURES ];
+		s32 ScanlineClip[2];
 
 		static const tFixPointu dithermask[ 4 * 4];
 	};
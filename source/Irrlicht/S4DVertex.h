@@ -496,7 +496,7 @@ struct s4DVertex
 struct SAlignedVertex
 {
 	SAlignedVertex ( u32 element, u32 aligned )
-		: ElementSize ( element )
+		: ElementSize ( element ), Aligned ( aligned )
 	{
 		u32 byteSize = (ElementSize << SIZEOF_SVERTEX_LOG2 ) + aligned;
 		mem = new u8 [ byteSize ];
@@ -508,9 +508,22 @@ struct SAlignedVertex
 		delete [] mem;
 	}
 
+	// grow to hold at least element vertices, content is lost
+	void reallocate ( u32 element )
+	{
+		if ( element <= ElementSize )
+			return;
+
+		delete [] mem;
+		ElementSize = element;
+		mem = new u8 [ (ElementSize << SIZEOF_SVERTEX_LOG2 ) + Aligned ];
+		data = (s4DVertex*) mem;
+	}
+
 	s4DVertex *data;
 	u8 *mem;
 	u32 ElementSize;
+	u32 Aligned;
 };
 
 
@@ -532,9 +545,10 @@ struct SCacheInfo
 
 #define VERTEXCACHE_ELEMENT	16
 #define VERTEXCACHE_MISS 0xFFFFFFFF
+#define VERTEXBATCH_MAX	65536
 struct SVertexCache
 {
-	SVertexCache (): mem ( VERTEXCACHE_ELEMENT * 2, 128 ) {}
+	SVertexCache (): mem ( VERTEXCACHE_ELEMENT * 2, 128 ), batchMem ( 2, 128 ), batch ( false ), batchBase ( 0 ) {}
 
 	SCacheInfo info[VERTEXCACHE_ELEMENT];
 
@@ -560,6 +574,11 @@ struct SVertexCache
 	u32 pType;		//scene::E_PRIMITIVE_TYPE
 	u32 iType;		//E_INDEX_TYPE iType
 
+	// all vertices in the index range, transformed at once
+	// used instead of the cache lines for dense index lists
+	SAlignedVertex batchMem;
+	bool batch;
+	u32 batchBase;
 };
 
 
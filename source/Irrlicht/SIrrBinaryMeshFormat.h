@@ -0,0 +1,112 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+// Layout of the binary .irrbin mesh files, shared by CIrrBinaryMeshWriter
+// and CIrrBinaryMeshFileLoader.
+
+#ifndef __S_IRR_BINARY_MESH_FORMAT_H_INCLUDED__
+#define __S_IRR_BINARY_MESH_FORMAT_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace scene
+{
+	/*
+	A file starts with SIrrBinaryMeshHeader, followed by BufferCount buffers
+	and then JointCount joints. Each part is a fixed size structure followed
+	by its variable sized data. The vertex, index, key and weight arrays are
+	stored exactly as they are in memory, so loading copies them without
+	looking at single elements. Files are only loaded on machines with the
+	byte order and the structure sizes of the machine which wrote them,
+	convert the original mesh again for other platforms.
+
+	Strings are stored as u32 length followed by the characters without 0.
+	A material is a u32 count followed by pairs of strings, the names and
+	values of the attributes IVideoDriver::createAttributesFromMaterial
+	creates.
+	*/
+
+	//! 'irrb'
+	const u32 IRR_BINARY_MESH_MAGIC = MAKE_IRR_ID('i','r','r','b');
+	//! Increased whenever the layout changes, older files have to be converted again
+	const u16 IRR_BINARY_MESH_VERSION = 1;
+	//! Written as u16, reads 0x0201 on machines with the other byte order
+	const u16 IRR_BINARY_MESH_BYTE_ORDER = 0x0102;
+
+	//! Flags of SIrrBinaryMeshHeader
+	enum E_IRR_BINARY_MESH_FLAGS
+	{
+		//! The file contains a skinned mesh with joints
+		EIBMF_SKINNED = 0x1
+	};
+
+// byte-align structures
+#include "irrpack.h"
+
+	struct SIrrBinaryMeshHeader
+	{
+		u32 Magic;
+		u16 Version;
+		u16 ByteOrder;
+		u32 Flags;
+		u32 BufferCount;
+		u32 JointCount;
+		f32 AnimationSpeed;
+		f32 BoundingBox[6];
+		//! sizes of ISkinnedMesh::SPositionKey, SScaleKey and SRotationKey
+		u16 PositionKeySize;
+		u16 ScaleKeySize;
+		u16 RotationKeySize;
+		u16 Padding;
+	} PACK_STRUCT;
+
+	//! followed by the material, Vertices, Indices
+	struct SIrrBinaryMeshBuffer
+	{
+		u32 VertexType;
+		//! size of one vertex, must match the vertex structure of VertexType
+		u32 VertexSize;
+		u32 VertexCount;
+		u32 IndexType;
+		u32 IndexCount;
+		u32 PrimitiveType;
+		u32 MappingHintVertex;
+		u32 MappingHintIndex;
+		f32 BoundingBox[6];
+	} PACK_STRUCT;
+
+	//! followed by the name, ChildCount u32 joint indices, AttachedMeshCount u32
+	//! buffer indices, the keys and WeightCount SIrrBinaryMeshWeight
+	struct SIrrBinaryMeshJoint
+	{
+		f32 LocalMatrix[16];
+		f32 GlobalInversedMatrix[16];
+		f32 AnimatedPosition[3];
+		f32 AnimatedScale[3];
+		f32 AnimatedRotation[4];
+		u32 ChildCount;
+		u32 AttachedMeshCount;
+		u32 PositionKeyCount;
+		u32 ScaleKeyCount;
+		u32 RotationKeyCount;
+		u32 WeightCount;
+	} PACK_STRUCT;
+
+	struct SIrrBinaryMeshWeight
+	{
+		u32 BufferIndex;
+		u32 VertexIndex;
+		f32 Strength;
+	} PACK_STRUCT;
+
+// Default alignment
+#include "irrunpack.h"
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
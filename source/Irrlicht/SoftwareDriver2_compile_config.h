@@ -93,6 +93,16 @@
 
 #define SOFTWARE_DRIVER_2_MIPMAPPING_SCALE (16/SOFTWARE_DRIVER_2_MIPMAPPING_MAX)
 
+// SIMD span functions for some of the shaders, the instruction set is
+// selected at runtime. Define NO_SOFTWARE_DRIVER_2_SIMD to use only the scalar code.
+#if defined ( BURNINGVIDEO_RENDERER_BEAUTIFUL ) && !defined ( NO_SOFTWARE_DRIVER_2_SIMD )
+	#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+		#if ( defined(_MSC_VER) && _MSC_VER >= 1700 ) || ( defined(__GNUC__) && __GNUC__ >= 5 ) || defined(__clang__)
+			#define SOFTWARE_DRIVER_2_SIMD
+		#endif
+	#endif
+#endif
+
 #ifndef REALINLINE
 	#ifdef _MSC_VER
 		#define REALINLINE __forceinline
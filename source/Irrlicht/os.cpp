@@ -4,6 +4,7 @@
 
 #include "os.h"
 #include "irrString.h"
+#include "CThreadPool.h"
 #include "IrrCompileConfig.h"
 #include "irrMath.h"
 
@@ -33,6 +34,16 @@
 	#define bswap_32(X) ( (((X)&0x000000FF)<<24) | (((X)&0xFF000000) >> 24) | (((X)&0x0000FF00) << 8) | (((X) &0x00FF0000) >> 8))
 #endif
 
+// compilers which can build functions for instruction sets the rest of the engine isn't compiled for
+#if (defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)) && \
+	((defined(_MSC_VER) && _MSC_VER >= 1700) || (defined(__GNUC__) && __GNUC__ >= 5) || defined(__clang__))
+	#define _IRR_DETECT_X86_SIMD_
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#include <immintrin.h>
+	#endif
+#endif
+
 namespace irr
 {
 namespace os
@@ -170,30 +181,92 @@ namespace os
 	// The platform independent implementation of the printer
 	ILogger* Printer::Logger = 0;
 
+	namespace
+	{
+		struct SQueuedMessage
+		{
+			core::stringc Text;
+			core::stringw WideText;
+			core::stringc Hint;
+			ELOG_LEVEL Level;
+			bool Wide;
+			bool HasHint;
+		};
+
+		//! messages of worker threads, protected by QueueMutex
+		core::array<SQueuedMessage> QueuedMessages;
+		CMutex QueueMutex;
+
+		//! queues the message when called on a worker thread, else returns false
+		bool queueMessage(const c8* text, const wchar_t* wideText, const c8* hint, ELOG_LEVEL ll)
+		{
+			if (!CThreadPool::isWorkerThread())
+				return false;
+
+			if (ll < Printer::Logger->getLogLevel())
+				return true;
+
+			SQueuedMessage message;
+			message.Wide = (wideText != 0);
+			if (message.Wide)
+				message.WideText = wideText;
+			else
+				message.Text = text;
+			message.HasHint = (hint != 0);
+			if (message.HasHint)
+				message.Hint = hint;
+			message.Level = ll;
+
+			CMutexLock lock(QueueMutex);
+			QueuedMessages.push_back(message);
+			return true;
+		}
+	} // end anonymous namespace
+
 	void Printer::log(const c8* message, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (Logger && !queueMessage(message, 0, 0, ll))
 			Logger->log(message, ll);
 	}
 
 	void Printer::log(const wchar_t* message, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (Logger && !queueMessage(0, message, 0, ll))
 			Logger->log(message, ll);
 	}
 
 	void Printer::log(const c8* message, const c8* hint, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (Logger && !queueMessage(message, 0, hint, ll))
 			Logger->log(message, hint, ll);
 	}
 
 	void Printer::log(const c8* message, const io::path& hint, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (Logger && !queueMessage(message, 0, hint.c_str(), ll))
 			Logger->log(message, hint.c_str(), ll);
 	}
 
+	void Printer::logQueued()
+	{
+		core::array<SQueuedMessage> messages;
+		{
+			CMutexLock lock(QueueMutex);
+			messages.swap(QueuedMessages);
+		}
+
+		for (u32 i=0; i<messages.size() && Logger; ++i)
+		{
+			const SQueuedMessage& message = messages[i];
+			if (message.Wide)
+				Logger->log(message.WideText.c_str(), message.Level);
+			else if (message.HasHint)
+				Logger->log(message.Text.c_str(), message.Hint.c_str(), message.Level);
+			else
+				Logger->log(message.Text.c_str(), message.Level);
+		}
+	}
+
 	// our Randomizer is not really os specific, so we
 	// code one for all, which should work on every platform the same,
 	// which is desirable.
@@ -347,6 +420,59 @@ namespace os
 		StartRealTime = StaticTime;
 	}
 
+	static CPU::E_SIMD_LEVEL detectSIMDLevel()
+	{
+#if defined(_IRR_DETECT_X86_SIMD_) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		const bool sse2 = (info[3] & (1 << 26)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+
+		bool avx2 = false;
+		if (maxLeaf >= 7)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+
+		// the os has to save the ymm registers
+		if (avx2 && avx && osxsave && (_xgetbv(0) & 6) == 6)
+			return CPU::ESL_AVX2;
+		if (sse2)
+			return CPU::ESL_SSE2;
+#elif defined(_IRR_DETECT_X86_SIMD_)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return CPU::ESL_AVX2;
+		if (__builtin_cpu_supports("sse2"))
+			return CPU::ESL_SSE2;
+#endif
+		return CPU::ESL_NONE;
+	}
+
+	CPU::E_SIMD_LEVEL CPU::getSIMDLevel()
+	{
+		// all threads detect the same, so no locking needed
+		static s32 level = -1;
+		if (level < 0)
+			level = detectSIMDLevel();
+		return (E_SIMD_LEVEL)level;
+	}
+
+	const c8* CPU::getSIMDName(E_SIMD_LEVEL level)
+	{
+		switch (level)
+		{
+			case ESL_AVX2: return "AVX2";
+			case ESL_SSE2: return "SSE2";
+			default: return "none";
+		}
+	}
+
 } // end namespace os
 } // end namespace irr
 
@@ -39,6 +39,12 @@ namespace os
 		static void log(const wchar_t* message, ELOG_LEVEL ll = ELL_INFORMATION);
 		static void log(const c8* message, const c8* hint, ELOG_LEVEL ll = ELL_INFORMATION);
 		static void log(const c8* message, const io::path& hint, ELOG_LEVEL ll = ELL_INFORMATION);
+
+		//! passes the messages logged on worker threads of a CThreadPool to the logger
+		/** The logger calls the event receiver of the user, so messages of
+		worker threads are queued until the main thread calls this. */
+		static void logQueued();
+
 		static ILogger* Logger;
 	};
 
@@ -124,6 +130,25 @@ namespace os
 		static u32 StaticTime;
 	};
 
+	class CPU
+	{
+	public:
+
+		//! SIMD instruction sets, each one includes the ones before
+		enum E_SIMD_LEVEL
+		{
+			ESL_NONE = 0,
+			ESL_SSE2,
+			ESL_AVX2
+		};
+
+		//! returns the best instruction set supported by the cpu and the os, detected on the first call
+		static E_SIMD_LEVEL getSIMDLevel();
+
+		//! returns the name of the instruction set, "none" for ESL_NONE
+		static const c8* getSIMDName(E_SIMD_LEVEL level);
+	};
+
 } // end namespace os
 } // end namespace irr
 
@@ -0,0 +1,113 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+
+/** Tests that animated mesh scene nodes far from the camera update their
+pose less often, and that nodes drawing cached poses of a skinned mesh get
+the same bounding boxes as without the cache. */
+bool animationLOD(void)
+{
+	IrrlichtDevice *device = createDevice(video::EDT_NULL, core::dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	scene::ISceneManager * smgr = device->getSceneManager();
+	ITimer* timer = device->getTimer();
+	timer->stop();
+	timer->setTime(0);
+
+	scene::ISkinnedMesh* mesh = (scene::ISkinnedMesh*)smgr->getMesh("../media/ninja.b3d");
+	if (!mesh)
+	{
+		logTestString("Could not load ninja.\n");
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+	mesh->setPoseCacheSize(4);
+
+	smgr->addCameraSceneNode(0, core::vector3df(0, 0, 0), core::vector3df(0, 0, 100));
+
+	// the far node is more than 60 radii away, so it moves only every fourth frame
+	scene::IAnimatedMeshSceneNode* nearNode = smgr->addAnimatedMeshSceneNode(mesh, 0, -1, core::vector3df(0, 0, 10));
+	scene::IAnimatedMeshSceneNode* farNode = smgr->addAnimatedMeshSceneNode(mesh, 0, -1, core::vector3df(0, 0, 1000));
+	scene::IAnimatedMeshSceneNode* nodes[2] = { nearNode, farNode };
+	for (u32 i=0; i<2; ++i)
+	{
+		nodes[i]->setFrameLoop(1, 14);
+		nodes[i]->setAnimationSpeed(25.f);
+		nodes[i]->setAnimationLOD(20.f, 4);
+	}
+
+	bool result = true;
+	u32 changes[2] = { 0, 0 };
+	core::aabbox3df boxes[2] = { nearNode->getBoundingBox(), farNode->getBoundingBox() };
+	for (u32 frame=1; frame<=12; ++frame)
+	{
+		timer->setTime(frame * 40);
+		smgr->drawAll();
+
+		for (u32 i=0; i<2; ++i)
+		{
+			const core::aabbox3df& box = nodes[i]->getBoundingBox();
+			if (box.MinEdge != boxes[i].MinEdge || box.MaxEdge != boxes[i].MaxEdge)
+				++changes[i];
+			boxes[i] = box;
+		}
+	}
+
+	logTestString("Pose changes near %d, far %d\n", changes[0], changes[1]);
+	if (changes[0] < 10 || changes[1] > 4 || changes[1] < 2)
+		result = false;
+
+	// the cached poses must match the skinned mesh
+	for (u32 i=0; i<2; ++i)
+	{
+		nodes[i]->setAnimationLOD(0.f);
+		nodes[i]->setAnimationSpeed(0.f);
+		nodes[i]->setCurrentFrame(5.f + i*4.f);
+	}
+	smgr->drawAll();
+	for (u32 i=0; i<2; ++i)
+	{
+		mesh->animateMesh(nodes[i]->getFrameNr(), 1.f);
+		mesh->skinMesh();
+		const core::aabbox3df& box = nodes[i]->getBoundingBox();
+		if (box.MinEdge != mesh->getBoundingBox().MinEdge || box.MaxEdge != mesh->getBoundingBox().MaxEdge)
+		{
+			logTestString("Wrong box of cached pose %d\n", i);
+			result = false;
+		}
+	}
+
+	// a cached frame copies its vertices back into the mesh buffers
+	for (u32 i=0; i<2; ++i)
+		nodes[i]->setCurrentFrame(5.f);
+	smgr->drawAll();
+	core::array<core::vector3df> positions;
+	scene::IMeshBuffer* buffer = mesh->getMeshBuffer(0);
+	for (u32 v=0; v<buffer->getVertexCount(); ++v)
+		positions.push_back(buffer->getPosition(v));
+	mesh->animateMesh(5.f, 1.f);
+	mesh->skinMesh();
+	for (u32 v=0; v<buffer->getVertexCount(); ++v)
+	{
+		if (buffer->getPosition(v) != positions[v])
+		{
+			logTestString("Wrong vertex %d of cached pose\n", v);
+			result = false;
+			break;
+		}
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
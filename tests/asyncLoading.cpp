@@ -0,0 +1,216 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+namespace
+{
+
+// finishes all loads, but only one per call to check the budget
+bool waitForLoads(IrrlichtDevice* device, u32 count)
+{
+	ISceneManager* smgr = device->getSceneManager();
+	for (u32 i = 0; i < 10000; ++i)
+	{
+		const u32 pending = smgr->updateAsyncLoads(0);
+		if (pending + 1 < count)
+		{
+			logTestString("More than one load finished with a budget of 0\n");
+			return false;
+		}
+		if (pending == 0)
+			return true;
+		count = pending;
+		device->sleep(1);
+	}
+	logTestString("Loads did not finish\n");
+	return false;
+}
+
+bool sameMesh(IAnimatedMesh* a, IAnimatedMesh* b)
+{
+	if (!a || !b)
+		return false;
+	return a->getFrameCount() == b->getFrameCount() &&
+		a->getMeshBufferCount() == b->getMeshBufferCount() &&
+		a->getBoundingBox() == b->getBoundingBox();
+}
+
+// counts the calls and checks that the loads are done by then
+class CountingCallBack : public IAsyncLoadCallBack
+{
+public:
+	CountingCallBack() : Calls(0), Done(true) {}
+
+	virtual void OnAsyncLoadDone(IAsyncLoadRequest* request)
+	{
+		++Calls;
+		Done &= (request->getState() != EALS_LOADING);
+	}
+
+	u32 Calls;
+	bool Done;
+};
+
+// counts the log messages which arrive outside of updateAsyncLoads
+class LogReceiver : public IEventReceiver
+{
+public:
+	LogReceiver() : InUpdate(false), Messages(0), MessagesOutside(0) {}
+
+	virtual bool OnEvent(const SEvent& event)
+	{
+		if (event.EventType == EET_LOG_TEXT_EVENT)
+		{
+			++Messages;
+			if (!InUpdate)
+				++MessagesOutside;
+		}
+		return false;
+	}
+
+	bool InUpdate;
+	u32 Messages;
+	u32 MessagesOutside;
+};
+
+// callbacks are called once per getMeshAsync call, and the messages of
+// loaders on worker threads are logged on the main thread
+bool callBacksAndLogging()
+{
+	LogReceiver receiver;
+	IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120), 32, false, false, false, &receiver);
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+
+	// the md2 loader runs on the worker thread and warns about the header
+	io::IWriteFile* file = device->getFileSystem()->createAndWriteFile("asyncGarbage.md2");
+	if (!file)
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+	c8 garbage[64];
+	memset(garbage, 0, sizeof(garbage));
+	file->write(garbage, sizeof(garbage));
+	file->drop();
+
+	receiver.Messages = 0;
+	receiver.MessagesOutside = 0;
+
+	CountingCallBack first;
+	CountingCallBack second;
+	smgr->getMeshAsync("media/sydney.md2", &first);
+	smgr->getMeshAsync("media/sydney.md2", &second);
+	smgr->getMeshAsync("asyncGarbage.md2", &first);
+
+	bool result = false;
+	for (u32 i = 0; i < 10000 && !result; ++i)
+	{
+		receiver.InUpdate = true;
+		result = (smgr->updateAsyncLoads(100) == 0);
+		receiver.InUpdate = false;
+		if (!result)
+			device->sleep(1);
+	}
+
+	result &= (first.Calls == 2 && second.Calls == 1);
+	result &= (first.Done && second.Done);
+	result &= (receiver.Messages > 0 && receiver.MessagesOutside == 0);
+	if (!result)
+		logTestString("Callbacks %d %d, %d messages, %d outside of updateAsyncLoads\n",
+			first.Calls, second.Calls, receiver.Messages, receiver.MessagesOutside);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests that meshes and textures loaded with getMeshAsync and getTextureAsync
+are the same as the ones loaded with getMesh and getTexture, and that their
+callbacks and log messages arrive in updateAsyncLoads. */
+bool asyncLoading(void)
+{
+	IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	IVideoDriver* driver = device->getVideoDriver();
+
+	// md2 is loaded on the worker thread, x on the main thread
+	IAsyncLoadRequest* md2 = smgr->getMeshAsync("media/sydney.md2");
+	IAsyncLoadRequest* x = smgr->getMeshAsync("../media/dwarf.x");
+	IAsyncLoadRequest* bmp = smgr->getTextureAsync("media/sydney.bmp");
+	IAsyncLoadRequest* jpg = smgr->getTextureAsync("../media/axe.jpg");
+	IAsyncLoadRequest* missing = smgr->getMeshAsync("media/missing.md2");
+	md2->grab();
+	x->grab();
+	bmp->grab();
+	jpg->grab();
+	missing->grab();
+
+	bool result = (smgr->getMeshAsync("media/sydney.md2") == md2);
+	result &= (md2->getState() == EALS_LOADING && md2->getMesh() == 0);
+	result &= waitForLoads(device, 5);
+
+	result &= (md2->getState() == EALS_FINISHED);
+	result &= (x->getState() == EALS_FINISHED);
+	result &= (bmp->getState() == EALS_FINISHED);
+	result &= (jpg->getState() == EALS_FINISHED);
+	result &= (missing->getState() == EALS_FAILED && missing->getMesh() == 0);
+
+	// the results are in the caches
+	result &= (md2->getMesh() == smgr->getMesh("media/sydney.md2"));
+	result &= (x->getMesh() == smgr->getMesh("../media/dwarf.x"));
+	result &= (bmp->getTexture() && bmp->getTexture() == driver->getTexture("media/sydney.bmp"));
+	result &= (jpg->getTexture() && jpg->getTexture() == driver->getTexture("../media/axe.jpg"));
+
+	// and the same as loading them directly
+	result &= sameMesh(md2->getMesh(), smgr->getMesh("media/sydney.md2", "sydney copy"));
+	result &= sameMesh(x->getMesh(), smgr->getMesh("../media/dwarf.x", "dwarf copy"));
+
+	// textures are named by their absolute path like with getTexture
+	const io::path jpgPath = device->getFileSystem()->getAbsolutePath("../media/axe.jpg");
+	result &= (jpg->getTexture() && jpg->getTexture()->getName().getPath() == jpgPath);
+
+	// cached files finish without loading
+	IAsyncLoadRequest* cached = smgr->getMeshAsync("media/sydney.md2");
+	cached->grab();
+	smgr->drawAll();
+	result &= (cached->getState() == EALS_FINISHED && cached->getMesh() == md2->getMesh());
+	result &= (smgr->updateAsyncLoads(0) == 0);
+
+	if (!result)
+		logTestString("Async loading failed\n");
+
+	cached->drop();
+	md2->drop();
+	x->drop();
+	bmp->drop();
+	jpg->drop();
+	missing->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	result &= callBacksAndLogging();
+
+	return result;
+}
@@ -7,8 +7,8 @@ using namespace irr;
 using namespace scene;
 using namespace video;
 
-/** Tests the Burning Video driver */
-bool burningsVideo(void)
+/** Tests ambient lighting without other lights */
+static bool ambientLighting(void)
 {
     IrrlichtDevice *device = createDevice(video::EDT_BURNINGSVIDEO,
 										core::dimension2du(160,120), 32);
@@ -38,3 +38,85 @@ bool burningsVideo(void)
 
     return result;
 }
+
+
+//! Renders a few frames with the given number of worker threads and returns the last one
+static IImage* renderWithThreads(u32 threads)
+{
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160,120);
+	params.WorkerThreads = threads;
+
+	IrrlichtDevice *device = createDeviceEx(params);
+	if (!device)
+		return 0;
+
+	IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	ISceneNode* node = smgr->addCubeSceneNode(10.f, 0, -1, core::vector3df(0.f, 0.f, 20.f), core::vector3df(30.f, 40.f, 0.f));
+	node->setMaterialTexture(0, driver->getTexture("../media/wall.bmp"));
+	node->setMaterialFlag(video::EMF_LIGHTING, false);
+
+	node = smgr->addSphereSceneNode(6.f, 16, 0, -1, core::vector3df(3.f, 1.f, 15.f));
+	node->setMaterialTexture(0, driver->getTexture("../media/fire.bmp"));
+	node->setMaterialType(video::EMT_TRANSPARENT_ADD_COLOR);
+	node->setMaterialFlag(video::EMF_LIGHTING, false);
+
+	smgr->addCameraSceneNode();
+
+	IImage* screenshot = 0;
+	for (u32 i = 0; i < 3; ++i)
+	{
+		device->run();
+		if (driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(0, 80, 80, 80)))
+		{
+			smgr->drawAll();
+			driver->draw2DRectangle(video::SColor(255, 255, 0, 0), core::recti(5, 5, 20, 20));
+			driver->endScene();
+		}
+	}
+	screenshot = driver->createScreenShot();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return screenshot;
+}
+
+/** The binning rasterizer must give the same image as the serial one */
+static bool binnedRasterizer(void)
+{
+	IImage* serial = renderWithThreads(0);
+	IImage* binned = renderWithThreads(4);
+
+	if (!serial || !binned)
+	{
+		if (serial)
+			serial->drop();
+		if (binned)
+			binned->drop();
+		return true; // No error if device does not exist
+	}
+
+	bool result = serial->getImageDataSizeInBytes() == binned->getImageDataSizeInBytes() &&
+		0 == memcmp(serial->getData(), binned->getData(), serial->getImageDataSizeInBytes());
+
+	if (!result)
+		logTestString("Binned rendering differs from serial rendering.\n");
+
+	serial->drop();
+	binned->drop();
+
+	return result;
+}
+
+/** Tests the Burning Video driver */
+bool burningsVideo(void)
+{
+	bool result = ambientLighting();
+	result &= binnedRasterizer();
+	return result;
+}
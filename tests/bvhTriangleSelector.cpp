@@ -0,0 +1,458 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 Seed = 1;
+
+f32 random(f32 lo, f32 hi)
+{
+	Seed = Seed * 1103515245u + 12345u;
+	return lo + (hi - lo) * ((Seed >> 8) & 0xffff) / 65535.f;
+}
+
+line3df randomLine()
+{
+	const vector3df start(random(-60.f, 60.f), random(-10.f, 60.f), random(-60.f, 60.f));
+	const vector3df target(random(-20.f, 20.f), random(-5.f, 15.f), random(-20.f, 20.f));
+	return line3df(start, start + (target - start) * 2.f);
+}
+
+// a sphere standing in hills, in two meshbuffers
+SMesh* createScene(ISceneManager* smgr)
+{
+	const IGeometryCreator* geom = smgr->getGeometryCreator();
+	IMesh* sphere = geom->createSphereMesh(10.f, 64, 64);
+	IMesh* hills = geom->createHillPlaneMesh(dimension2df(1.f, 1.f), dimension2du(80, 80), 0,
+		4.f, dimension2df(5.f, 5.f), dimension2df(1.f, 1.f));
+
+	SMesh* mesh = new SMesh();
+	mesh->addMeshBuffer(sphere->getMeshBuffer(0));
+	mesh->addMeshBuffer(hills->getMeshBuffer(0));
+	mesh->recalculateBoundingBox();
+	sphere->drop();
+	hills->drop();
+	return mesh;
+}
+
+bool isInside(const SViewFrustum& frustum, const vector3df& p)
+{
+	for (u32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+	{
+		if (frustum.planes[i].classifyPointRelation(p) == ISREL3D_FRONT)
+			return false;
+	}
+	return true;
+}
+
+bool contains(const array<triangle3df>& triangles, s32 count, const triangle3df& tri)
+{
+	for (s32 i=0; i<count; ++i)
+	{
+		if (triangles[i] == tri)
+			return true;
+	}
+	return false;
+}
+
+// hits have to be the same as those of the selector which tests all triangles
+bool compareHits(ISceneCollisionManager* collMgr, ITriangleSelector* bvh, ITriangleSelector* plain)
+{
+	const u32 lineCount = 1000;
+	u32 hits = 0;
+	u32 misses = 0;
+	u32 different = 0;
+	bool result = true;
+
+	for (u32 i=0; i<lineCount; ++i)
+	{
+		const line3df line = randomLine();
+		SCollisionHit bvhHit, plainHit;
+		const bool bvhFound = collMgr->getCollisionPoint(bvhHit, line, bvh);
+		const bool plainFound = collMgr->getCollisionPoint(plainHit, line, plain);
+
+		SCollisionHit anyHit;
+		if (bvh->getCollisionPoint(anyHit, line, true, true) != bvhFound)
+		{
+			logTestString("Any hit and nearest hit disagree\n");
+			result = false;
+		}
+
+		if (bvhFound != plainFound)
+		{
+			// lines grazing an edge may slip through on one side only
+			++different;
+			continue;
+		}
+		if (!bvhFound)
+		{
+			++misses;
+			continue;
+		}
+		++hits;
+
+		const f32 bvhDistance = bvhHit.Intersection.getDistanceFrom(line.start);
+		const f32 plainDistance = plainHit.Intersection.getDistanceFrom(line.start);
+		if (fabs(bvhDistance - plainDistance) > 0.001f * (1.f + plainDistance))
+		{
+			logTestString("Hit at distance %f instead of %f\n", bvhDistance, plainDistance);
+			result = false;
+		}
+		else if (bvhHit.MeshBuffer != plainHit.MeshBuffer || bvhHit.Node != plainHit.Node ||
+			bvhHit.TriangleSelector != bvh)
+		{
+			logTestString("Hit has the wrong meshbuffer, node or selector\n");
+			result = false;
+		}
+		else if (!bvhHit.Triangle.isPointInside(bvhHit.Intersection) &&
+			bvhHit.Triangle.closestPointOnTriangle(bvhHit.Intersection).getDistanceFrom(bvhHit.Intersection) > 0.001f)
+		{
+			logTestString("Hit isn't on the hit triangle\n");
+			result = false;
+		}
+	}
+
+	logTestString("%u hits, %u misses, %u different\n", hits, misses, different);
+	if (different > lineCount / 100 || hits < lineCount / 4)
+		result = false;
+
+	if (!result)
+		logTestString("Collision points of the bvh selector are wrong\n");
+	return result;
+}
+
+// box queries return the same triangles, line and frustum queries at least those hit
+bool compareQueries(ISceneCollisionManager* collMgr, ITriangleSelector* bvh, ITriangleSelector* plain)
+{
+	const s32 size = plain->getTriangleCount();
+	array<triangle3df> bvhTriangles, plainTriangles;
+	bvhTriangles.set_used(size);
+	plainTriangles.set_used(size);
+	bool result = (bvh->getTriangleCount() == size);
+
+	for (u32 i=0; i<50; ++i)
+	{
+		const vector3df center(random(-40.f, 40.f), random(-5.f, 15.f), random(-40.f, 40.f));
+		const vector3df extent(random(0.f, 10.f), random(0.f, 10.f), random(0.f, 10.f));
+		const aabbox3df box(center - extent, center + extent);
+
+		s32 bvhCount, plainCount;
+		array<SCollisionTriangleRange> info;
+		bvh->getTriangles(bvhTriangles.pointer(), size, bvhCount, box, 0, true, &info);
+		plain->getTriangles(plainTriangles.pointer(), size, plainCount, box);
+		if (bvhCount != plainCount)
+		{
+			logTestString("Box query found %d triangles instead of %d\n", bvhCount, plainCount);
+			result = false;
+		}
+
+		// the ranges cover all triangles
+		s32 covered = 0;
+		for (u32 r=0; r<info.size(); ++r)
+		{
+			result &= (info[r].RangeStart == (u32)covered) && info[r].MeshBuffer;
+			covered += info[r].RangeSize;
+		}
+		if (covered != bvhCount)
+		{
+			logTestString("Box query ranges cover %d of %d triangles\n", covered, bvhCount);
+			result = false;
+		}
+	}
+
+	for (u32 i=0; i<200; ++i)
+	{
+		const line3df line = randomLine();
+		SCollisionHit hit;
+		if (!collMgr->getCollisionPoint(hit, line, bvh))
+			continue;
+
+		s32 bvhCount, plainCount;
+		bvh->getTriangles(bvhTriangles.pointer(), size, bvhCount, line);
+		plain->getTriangles(plainTriangles.pointer(), size, plainCount, line);
+		if (bvhCount > plainCount || !contains(bvhTriangles, bvhCount, hit.Triangle))
+		{
+			logTestString("Line query is missing the hit triangle\n");
+			result = false;
+		}
+	}
+
+	matrix4 projection, view;
+	projection.buildProjectionMatrixPerspectiveFovLH(PI / 4.f, 4.f / 3.f, 1.f, 100.f);
+	for (u32 i=0; i<20; ++i)
+	{
+		const vector3df position(random(-50.f, 50.f), random(5.f, 40.f), random(-50.f, 50.f));
+		const vector3df target(random(-10.f, 10.f), 0.f, random(-10.f, 10.f));
+		view.buildCameraLookAtMatrixLH(position, target, vector3df(0.f, 1.f, 0.f));
+		const SViewFrustum frustum(projection * view);
+
+		s32 bvhCount, plainCount;
+		bvh->getTriangles(bvhTriangles.pointer(), size, bvhCount, frustum);
+		plain->getTriangles(plainTriangles.pointer(), size, plainCount, frustum.getBoundingBox());
+		if (bvhCount > plainCount)
+		{
+			logTestString("Frustum query found more triangles than the box around it\n");
+			result = false;
+		}
+
+		// everything seen from the camera is in the frustum
+		for (u32 j=0; j<10; ++j)
+		{
+			const vector3df seen = target + vector3df(random(-2.f, 2.f), random(-2.f, 2.f), random(-2.f, 2.f));
+			SCollisionHit hit;
+			if (collMgr->getCollisionPoint(hit, line3df(position, position + (seen - position) * 2.f), bvh) &&
+				isInside(frustum, hit.Intersection) &&
+				!contains(bvhTriangles, bvhCount, hit.Triangle))
+			{
+				logTestString("Frustum query is missing a visible triangle\n");
+				result = false;
+			}
+		}
+	}
+
+	if (!result)
+		logTestString("Triangle queries of the bvh selector are wrong\n");
+	return result;
+}
+
+// two selectors in a meta selector find the nearest hit of both
+bool metaSelector(ISceneManager* smgr, SMesh* mesh, ISceneNode* node)
+{
+	ISceneNode* other = smgr->addMeshSceneNode(mesh, 0, -1, vector3df(0.f, 0.f, 30.f));
+	ITriangleSelector* nearSelector = smgr->createBVHTriangleSelector(mesh, other);
+	ITriangleSelector* farSelector = smgr->createBVHTriangleSelector(mesh, node);
+	IMetaTriangleSelector* meta = smgr->createMetaTriangleSelector();
+	meta->addTriangleSelector(farSelector);
+	meta->addTriangleSelector(nearSelector);
+	smgr->getRootSceneNode()->updateAbsolutePosition();
+	other->updateAbsolutePosition();
+
+	// the line passes through the sphere of the other node first
+	SCollisionHit hit;
+	const line3df line(vector3df(0.f, 5.f, 100.f), vector3df(0.f, 5.f, -100.f));
+	bool result = meta->isCollisionPointSupported() &&
+		smgr->getSceneCollisionManager()->getCollisionPoint(hit, line, meta) &&
+		hit.Node == other && hit.TriangleSelector == nearSelector &&
+		equals(hit.Intersection.Z, 30.f + sqrtf(75.f), 0.1f);
+
+	meta->drop();
+	farSelector->drop();
+	nearSelector->drop();
+	other->remove();
+
+	if (!result)
+		logTestString("Meta selector of bvh selectors found the wrong hit\n");
+	return result;
+}
+
+// the hierarchy refit to other frames of an animated node finds the same hits and triangles
+bool animatedNode(IrrlichtDevice* device, const io::path& name)
+{
+	ISceneManager* smgr = device->getSceneManager();
+	ISceneCollisionManager* collMgr = smgr->getSceneCollisionManager();
+	IAnimatedMesh* mesh = smgr->getMesh(name);
+	if (!mesh)
+	{
+		logTestString("Can't load %s\n", name.c_str());
+		return false;
+	}
+	IAnimatedMeshSceneNode* node = smgr->addAnimatedMeshSceneNode(mesh);
+	node->setAnimationSpeed(0.f);
+	node->updateAbsolutePosition();
+
+	ITriangleSelector* bvh = smgr->createBVHTriangleSelector(node);
+	ITriangleSelector* plain = smgr->createTriangleSelector(node);
+	const s32 size = plain->getTriangleCount();
+	array<triangle3df> bvhTriangles, plainTriangles;
+	bvhTriangles.set_used(size);
+	plainTriangles.set_used(size);
+	bool result = bvh && bvh->isCollisionPointSupported() && (bvh->getTriangleCount() == size);
+
+	u32 hits = 0;
+	u32 different = 0;
+	const u32 frameCount = mesh->getFrameCount();
+	for (u32 f=0; result && f<6; ++f)
+	{
+		node->setCurrentFrame((f32)(f * (frameCount - 1) / 5));
+
+		// the box around the triangles of this frame
+		s32 count;
+		plain->getTriangles(plainTriangles.pointer(), size, count, 0);
+		aabbox3df box(plainTriangles[0].pointA);
+		for (s32 i=0; i<count; ++i)
+		{
+			box.addInternalPoint(plainTriangles[i].pointA);
+			box.addInternalPoint(plainTriangles[i].pointB);
+			box.addInternalPoint(plainTriangles[i].pointC);
+		}
+		const vector3df extent = box.getExtent();
+		const vector3df center = box.getCenter();
+
+		for (u32 i=0; i<200; ++i)
+		{
+			const vector3df target(center + vector3df(random(-0.4f, 0.4f) * extent.X,
+				random(-0.4f, 0.4f) * extent.Y, random(-0.4f, 0.4f) * extent.Z));
+			const vector3df start = center + vector3df(random(-1.f, 1.f), random(-1.f, 1.f), random(-1.f, 1.f)).normalize() * extent.getLength();
+			const line3df line(start, start + (target - start) * 2.f);
+
+			SCollisionHit bvhHit, plainHit;
+			const bool bvhFound = collMgr->getCollisionPoint(bvhHit, line, bvh);
+			if (bvhFound != collMgr->getCollisionPoint(plainHit, line, plain))
+				++different;
+			else if (bvhFound)
+			{
+				++hits;
+				if (!bvhHit.Intersection.equals(plainHit.Intersection, 0.001f * extent.getLength()))
+				{
+					logTestString("Hit at frame %f of %s is off\n", node->getFrameNr(), name.c_str());
+					result = false;
+				}
+			}
+		}
+
+		for (u32 i=0; i<20; ++i)
+		{
+			const vector3df corner(center + vector3df(random(-0.5f, 0.5f) * extent.X,
+				random(-0.5f, 0.5f) * extent.Y, random(-0.5f, 0.5f) * extent.Z));
+			const aabbox3df query(corner - extent * 0.2f, corner + extent * 0.2f);
+			s32 bvhCount, plainCount;
+			bvh->getTriangles(bvhTriangles.pointer(), size, bvhCount, query);
+			plain->getTriangles(plainTriangles.pointer(), size, plainCount, query);
+			if (bvhCount != plainCount)
+			{
+				logTestString("Box query at frame %f of %s found %d triangles instead of %d\n",
+					node->getFrameNr(), name.c_str(), bvhCount, plainCount);
+				result = false;
+			}
+		}
+	}
+	logTestString("%s: %u hits, %u different\n", name.c_str(), hits, different);
+	result &= (hits > 6 * 200 / 4) && (different <= 6 * 200 / 100);
+
+	// threads querying a meta selector find the hits of the new frame in all its selectors
+	if (bvh)
+	{
+		IMetaTriangleSelector* meta = smgr->createMetaTriangleSelector();
+		meta->addTriangleSelector(plain);
+		meta->addTriangleSelector(bvh);
+		node->setCurrentFrame((f32)(frameCount / 3));
+		const aabbox3df box = node->getTransformedBoundingBox();
+		const f32 length = box.getExtent().getLength();
+		array<line3df> lines;
+		for (u32 i=0; i<200; ++i)
+		{
+			const vector3df start = box.getCenter() + vector3df(random(-1.f, 1.f), random(-1.f, 1.f), random(-1.f, 1.f)).normalize() * length;
+			lines.push_back(line3df(start, box.getCenter() + (box.getCenter() - start)));
+		}
+		SCollisionHit batchHits[200];
+		bool batchFound[200];
+		collMgr->getCollisionPoints(lines.const_pointer(), lines.size(), meta, batchHits, batchFound, false, 4);
+		for (u32 i=0; i<lines.size(); ++i)
+		{
+			SCollisionHit hit;
+			const bool found = collMgr->getCollisionPoint(hit, lines[i], meta);
+			if (found != batchFound[i] ||
+				(found && !hit.Intersection.equals(batchHits[i].Intersection, 0.001f * length)))
+			{
+				logTestString("Threaded lines against animated selectors of %s differ\n", name.c_str());
+				result = false;
+				break;
+			}
+		}
+		meta->drop();
+	}
+
+	// refitting each frame against building a new hierarchy, the query far away only refits
+	const aabbox3df farAway(vector3df(1e6f));
+	u32 start = device->getTimer()->getRealTime();
+	for (u32 f=0; f<frameCount; ++f)
+	{
+		s32 count;
+		node->setCurrentFrame((f32)f);
+		bvh->getTriangles(bvhTriangles.pointer(), size, count, farAway);
+	}
+	const u32 refitTime = device->getTimer()->getRealTime() - start;
+	start = device->getTimer()->getRealTime();
+	for (u32 f=0; f<frameCount; ++f)
+	{
+		node->setCurrentFrame((f32)f);
+		smgr->createBVHTriangleSelector(node)->drop();
+	}
+	logTestString("%u frames of %s refit in %u ms, built in %u ms\n", frameCount, name.c_str(),
+		refitTime, device->getTimer()->getRealTime() - start);
+
+	if (bvh)
+		bvh->drop();
+	plain->drop();
+	node->remove();
+
+	if (!result)
+		logTestString("Refitting the bvh selector to the frames of %s failed\n", name.c_str());
+	return result;
+}
+
+void logTiming(IrrlichtDevice* device, ITriangleSelector* selector, const c8* name)
+{
+	ISceneCollisionManager* collMgr = device->getSceneManager()->getSceneCollisionManager();
+	Seed = 1;
+	u32 hits = 0;
+	const u32 start = device->getTimer()->getRealTime();
+	for (u32 i=0; i<1000; ++i)
+	{
+		SCollisionHit hit;
+		if (collMgr->getCollisionPoint(hit, randomLine(), selector))
+			++hits;
+	}
+	logTestString("1000 lines against the %s selector took %u ms, %u hits\n", name,
+		device->getTimer()->getRealTime() - start, hits);
+}
+
+} // end anonymous namespace
+
+//! Tests the selector with a bounding volume hierarchy against the one which tests all triangles, also for animated nodes
+bool bvhTriangleSelector(void)
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	ISceneCollisionManager* collMgr = smgr->getSceneCollisionManager();
+
+	SMesh* mesh = createScene(smgr);
+	ISceneNode* node = smgr->addMeshSceneNode(mesh, 0, -1, vector3df(5.f, -3.f, 2.f),
+		vector3df(10.f, 30.f, 0.f), vector3df(1.f, 2.f, 1.f));
+	node->updateAbsolutePosition();
+
+	ITriangleSelector* bvh = smgr->createBVHTriangleSelector(mesh, node, true);
+	ITriangleSelector* plain = smgr->createTriangleSelector(mesh, node, true);
+	ITriangleSelector* octree = smgr->createOctreeTriangleSelector(mesh, node);
+
+	bool result = bvh->isCollisionPointSupported() && !plain->isCollisionPointSupported();
+	result &= compareHits(collMgr, bvh, plain);
+	result &= compareQueries(collMgr, bvh, plain);
+	result &= metaSelector(smgr, mesh, node);
+	result &= animatedNode(device, "media/sydney.md2");
+	result &= animatedNode(device, "../media/ninja.b3d");
+
+	logTiming(device, plain, "plain");
+	logTiming(device, octree, "octree");
+	logTiming(device, bvh, "bvh");
+
+	octree->drop();
+	plain->drop();
+	bvh->drop();
+	mesh->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+	return result;
+}
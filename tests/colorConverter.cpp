@@ -0,0 +1,114 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace video;
+
+namespace
+{
+
+// odd length, so the scalar code converts the last pixels
+const s32 PixelCount = 4099;
+
+const ECOLOR_FORMAT Formats[] = { ECF_A1R5G5B5, ECF_R5G6B5, ECF_R8G8B8, ECF_A8R8G8B8 };
+const u32 FormatCount = sizeof(Formats) / sizeof(Formats[0]);
+
+const c8* getFormatName(ECOLOR_FORMAT format)
+{
+	switch (format)
+	{
+		case ECF_A1R5G5B5: return "A1R5G5B5";
+		case ECF_R5G6B5: return "R5G6B5";
+		case ECF_R8G8B8: return "R8G8B8";
+		default: return "A8R8G8B8";
+	}
+}
+
+// pixels per millisecond converted to million pixels per second
+f32 measure(IrrlichtDevice* device, const u8* source, ECOLOR_FORMAT sF, u8* dest, ECOLOR_FORMAT dF)
+{
+	ITimer* timer = device->getTimer();
+	IVideoDriver* driver = device->getVideoDriver();
+
+	u32 runs = 0;
+	const u32 start = timer->getRealTime();
+	u32 time = 0;
+	do
+	{
+		for (u32 i = 0; i < 64; ++i)
+			driver->convertColor(source, sF, PixelCount, dest, dF);
+		runs += 64;
+		time = timer->getRealTime() - start;
+	} while (time < 50);
+
+	return (f32)runs * PixelCount / ((f32)time * 1000.f);
+}
+
+} // end anonymous namespace
+
+/** Tests that converting long runs of pixels, which uses the SIMD kernels
+where the cpu has them, gives the same bytes as converting single pixels
+with the scalar code. Logs the speed of each conversion. */
+bool colorConverter(void)
+{
+	IrrlichtDevice* device = createDevice(EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IVideoDriver* driver = device->getVideoDriver();
+
+	u8* source = new u8[PixelCount * 4];
+	u8* dest = new u8[PixelCount * 4 + 4];
+	u8* reference = new u8[PixelCount * 4];
+
+	srand(42);
+	for (s32 i = 0; i < PixelCount * 4; ++i)
+		source[i] = (u8)(rand() >> 4);
+
+	bool result = true;
+	for (u32 s = 0; s < FormatCount; ++s)
+	{
+		for (u32 d = 0; d < FormatCount; ++d)
+		{
+			const ECOLOR_FORMAT sF = Formats[s];
+			const ECOLOR_FORMAT dF = Formats[d];
+			const u32 sBytes = IImage::getBitsPerPixelFromFormat(sF) / 8;
+			const u32 dBytes = IImage::getBitsPerPixelFromFormat(dF) / 8;
+
+			for (s32 i = 0; i < PixelCount; ++i)
+				driver->convertColor(source + i * sBytes, sF, 1, reference + i * dBytes, dF);
+
+			// the guard bytes behind the pixels must not be written
+			memset(dest, 0xCD, PixelCount * 4 + 4);
+			driver->convertColor(source, sF, PixelCount, dest, dF);
+
+			bool same = memcmp(dest, reference, PixelCount * dBytes) == 0;
+			for (u32 i = PixelCount * dBytes; i < PixelCount * 4 + 4u; ++i)
+				same &= (dest[i] == 0xCD);
+
+			if (!same)
+			{
+				logTestString("Conversion %s to %s differs from single pixel conversion\n",
+					getFormatName(sF), getFormatName(dF));
+				result = false;
+			}
+
+			logTestString("%s to %s: %.1f MPixel/s\n", getFormatName(sF), getFormatName(dF),
+				measure(device, source, sF, dest, dF));
+		}
+	}
+
+	delete [] source;
+	delete [] dest;
+	delete [] reference;
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,239 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 Seed = 1;
+
+f32 random(f32 lo, f32 hi)
+{
+	Seed = Seed * 1103515245u + 12345u;
+	return lo + (hi - lo) * ((Seed >> 8) & 0xffff) / 65535.f;
+}
+
+// a sphere standing in hills
+SMesh* createWorld(ISceneManager* smgr)
+{
+	const IGeometryCreator* geom = smgr->getGeometryCreator();
+	IMesh* sphere = geom->createSphereMesh(10.f, 32, 32);
+	IMesh* hills = geom->createHillPlaneMesh(dimension2df(2.f, 2.f), dimension2du(100, 100), 0,
+		4.f, dimension2df(5.f, 5.f), dimension2df(1.f, 1.f));
+
+	SMesh* mesh = new SMesh();
+	mesh->addMeshBuffer(sphere->getMeshBuffer(0));
+	mesh->addMeshBuffer(hills->getMeshBuffer(0));
+	mesh->recalculateBoundingBox();
+	sphere->drop();
+	hills->drop();
+	return mesh;
+}
+
+void randomEllipsoids(ITriangleSelector* world, array<SCollisionEllipsoid>& ellipsoids, u32 count)
+{
+	ellipsoids.clear();
+	for (u32 i=0; i<count; ++i)
+	{
+		SCollisionEllipsoid ellipsoid;
+		ellipsoid.Selector = world;
+		ellipsoid.Position.set(random(-80.f, 80.f), random(3.f, 15.f), random(-80.f, 80.f));
+		ellipsoid.Radius.set(random(0.5f, 2.f), random(1.f, 3.f), random(0.5f, 2.f));
+		ellipsoid.Velocity.set(random(-5.f, 5.f), random(-1.f, 1.f), random(-5.f, 5.f));
+		ellipsoid.Gravity.set(0.f, random(-10.f, 0.f), 0.f);
+		ellipsoids.push_back(ellipsoid);
+	}
+}
+
+bool sameResult(const SCollisionEllipsoid& a, const SCollisionEllipsoid& b, f32 tolerance)
+{
+	return a.ResultPosition.equals(b.ResultPosition, tolerance) &&
+		a.Falling == b.Falling && a.Node == b.Node &&
+		(tolerance > 0.f || (a.Triangle == b.Triangle && a.HitPosition == b.HitPosition));
+}
+
+// the batch gives the results of single movements, with any number of threads and caches
+bool compareBatch(ISceneCollisionManager* collMgr, ITriangleSelector* world)
+{
+	array<SCollisionEllipsoid> single;
+	randomEllipsoids(world, single, 500);
+
+	u32 collisions = 0;
+	for (u32 i=0; i<single.size(); ++i)
+	{
+		SCollisionEllipsoid& e = single[i];
+		e.Node = 0;
+		const triangle3df noTriangle;
+		e.ResultPosition = collMgr->getCollisionResultPosition(world, e.Position, e.Radius, e.Velocity,
+			e.Triangle, e.HitPosition, e.Falling, e.Node, e.SlidingSpeed, e.Gravity);
+		if (e.Triangle != noTriangle)
+			++collisions;
+	}
+	logTestString("%u of %u ellipsoids collided\n", collisions, single.size());
+	bool result = (collisions > single.size() / 4);
+
+	array<SCollisionTriangleCache> caches(single.size());
+	for (u32 i=0; i<single.size(); ++i)
+		caches.push_back(SCollisionTriangleCache());
+	const u32 threadCounts[] = { 1, 4, 1, 4 };
+	for (u32 run=0; run<4; ++run)
+	{
+		const bool cached = (run >= 2);
+		array<SCollisionEllipsoid> batch(single.size());
+		for (u32 i=0; i<single.size(); ++i)
+		{
+			batch.push_back(single[i]);
+			batch[i].Triangle = triangle3df();
+			batch[i].Node = 0;
+			batch[i].Cache = cached ? &caches[i] : 0;
+			caches[i].Margin = 1.f;
+		}
+
+		// the caches are used a second time by moving again from the same place
+		for (u32 pass=0; pass < (cached ? 2u : 1u); ++pass)
+			collMgr->getCollisionResultPositions(batch.pointer(), batch.size(), threadCounts[run]);
+
+		u32 different = 0;
+		for (u32 i=0; i<single.size(); ++i)
+		{
+			// more triangles in the caches may change the result by rounding
+			if (!sameResult(batch[i], single[i], cached ? 0.001f : 0.f))
+				++different;
+		}
+		if (different)
+		{
+			logTestString("%u ellipsoids differ with %u threads%s\n", different, threadCounts[run],
+				cached ? " and caches" : "");
+			result = false;
+		}
+	}
+
+	if (!result)
+		logTestString("Batch of ellipsoids failed\n");
+	return result;
+}
+
+// characters walking in circles over the hills, each with a collision response animator
+void addWalkers(ISceneManager* smgr, ITriangleSelector* world, array<ISceneNode*>& walkers,
+	u32 count, bool cacheTriangles)
+{
+	Seed = 7;
+	for (u32 i=0; i<count; ++i)
+	{
+		ISceneNode* node = smgr->addEmptySceneNode();
+		node->setPosition(vector3df(random(-80.f, 80.f), 8.f, random(-80.f, 80.f)));
+		ISceneNodeAnimatorCollisionResponse* anim = smgr->createCollisionResponseAnimator(world,
+			node, vector3df(1.f, 2.f, 1.f), vector3df(0.f, -100.f, 0.f));
+		anim->setCacheTriangles(cacheTriangles);
+		node->addAnimator(anim);
+		anim->drop();
+		walkers.push_back(node);
+	}
+}
+
+void walk(IrrlichtDevice* device, const array<ISceneNode*>& walkers, u32 frames)
+{
+	for (u32 frame=0; frame<frames; ++frame)
+	{
+		device->getTimer()->setTime(device->getTimer()->getTime() + 20);
+		for (u32 i=0; i<walkers.size(); ++i)
+		{
+			const f32 angle = (i + frame) * 0.05f;
+			walkers[i]->setPosition(walkers[i]->getPosition() + vector3df(cosf(angle), 0.f, sinf(angle)) * 0.4f);
+		}
+		device->getSceneManager()->drawAll();
+	}
+}
+
+// walkers end at the same places with cached triangles and with parallel animation
+bool compareWalkers(IrrlichtDevice* device, ITriangleSelector* world, u32 count, u32 frames)
+{
+	ISceneManager* smgr = device->getSceneManager();
+	io::IAttributes* parameters = smgr->getParameters();
+	bool result = true;
+
+	array<vector3df> expected;
+	for (u32 run=0; run<3; ++run)
+	{
+		// plain, cached, cached and parallel
+		parameters->setAttribute(PARALLEL_SCENE_THREADS, run == 2 ? 4 : 0);
+		parameters->setAttribute(PARALLEL_SCENE_ANIMATION, run == 2);
+
+		device->getTimer()->setTime(1000);
+		array<ISceneNode*> walkers;
+		addWalkers(smgr, world, walkers, count, run > 0);
+
+		const u32 start = device->getTimer()->getRealTime();
+		walk(device, walkers, frames);
+		const u32 time = device->getTimer()->getRealTime() - start;
+
+		u32 different = 0;
+		for (u32 i=0; i<walkers.size(); ++i)
+		{
+			if (run == 0)
+				expected.push_back(walkers[i]->getPosition());
+			else if (!walkers[i]->getPosition().equals(expected[i], 0.01f))
+				++different;
+			walkers[i]->remove();
+		}
+
+		const c8* const names[] = { "uncached", "cached", "parallel" };
+		logTestString("%u %s walkers took %u ms for %u frames, %u different\n", count, names[run],
+			time, frames, different);
+		result &= (different == 0);
+	}
+
+	parameters->setAttribute(PARALLEL_SCENE_THREADS, 0);
+	parameters->setAttribute(PARALLEL_SCENE_ANIMATION, false);
+
+	// the walkers stand on the hills or the sphere, they didn't fall through
+	f32 lowest = 100.f;
+	for (u32 i=0; i<expected.size(); ++i)
+		lowest = core::min_(lowest, expected[i].Y);
+	logTestString("lowest walker at %f\n", lowest);
+	result &= (lowest > -2.1f && lowest < 5.f);
+
+	if (!result)
+		logTestString("Walkers with collision response animators failed\n");
+	return result;
+}
+
+} // end anonymous namespace
+
+//! Tests moving ellipsoids in batches, with cached triangles and on several threads
+bool ellipsoidCollision(void)
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	device->getTimer()->stop();
+
+	SMesh* mesh = createWorld(smgr);
+	ISceneNode* node = smgr->addMeshSceneNode(mesh);
+	node->updateAbsolutePosition();
+	ITriangleSelector* bvh = smgr->createBVHTriangleSelector(mesh, node);
+	ITriangleSelector* octree = smgr->createOctreeTriangleSelector(mesh, node);
+	ITriangleSelector* plain = smgr->createTriangleSelector(mesh, node);
+
+	bool result = compareBatch(smgr->getSceneCollisionManager(), bvh);
+	result &= compareBatch(smgr->getSceneCollisionManager(), octree);
+	result &= compareWalkers(device, bvh, 500, 50);
+	result &= compareWalkers(device, plain, 100, 50);
+
+	plain->drop();
+	octree->drop();
+	bvh->drop();
+	mesh->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+	return result;
+}
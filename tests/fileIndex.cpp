@@ -0,0 +1,190 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace io;
+
+namespace
+{
+
+// archive which the file system can't index, it has one file
+class CCustomArchive : public IFileArchive
+{
+public:
+	CCustomArchive(IFileSystem* fs) : FileSystem(fs)
+	{
+		List = fs->createEmptyFileList("custom/", true, false);
+		List->addItem("mypath/myfile.txt", 0, 6, false);
+		List->sort();
+	}
+
+	~CCustomArchive()
+	{
+		List->drop();
+	}
+
+	virtual IReadFile* createAndOpenFile(const path& filename)
+	{
+		const s32 index = List->findFile(filename);
+		return index != -1 ? createAndOpenFile(index) : 0;
+	}
+
+	virtual IReadFile* createAndOpenFile(u32 index)
+	{
+		return FileSystem->createMemoryReadFile("custom", 6, List->getFullFileName(index));
+	}
+
+	virtual const IFileList* getFileList() const
+	{
+		return List;
+	}
+
+	virtual const io::path& getArchiveName() const
+	{
+		return List->getPath();
+	}
+
+private:
+	IFileSystem* FileSystem;
+	IFileList* List;
+};
+
+// opens a file and compares its first bytes
+bool hasContent(IFileSystem* fs, const io::path& filename, const c8* content)
+{
+	IReadFile* file = fs->createAndOpenFile(filename);
+	if (!file)
+	{
+		if (content)
+			logTestString("%s not found\n", filename.c_str());
+		return !content;
+	}
+
+	c8 buffer[16] = { 0 };
+	file->read(buffer, core::min_((long)sizeof(buffer) - 1, file->getSize()));
+	file->drop();
+
+	const bool result = content && strcmp(buffer, content) == 0;
+	if (!result)
+		logTestString("%s has the wrong content '%s'\n", filename.c_str(), buffer);
+	return result;
+}
+
+void removeArchives(IFileSystem* fs)
+{
+	while (fs->getFileArchiveCount())
+		fs->removeFileArchive(fs->getFileArchiveCount() - 1);
+}
+
+// archives added first win, also when they are not in the index
+bool testPriority(IFileSystem* fs)
+{
+	bool result = fs->addFileArchive("media/file_with_path.zip", true, false);
+	CCustomArchive* custom = new CCustomArchive(fs);
+	result &= fs->addFileArchive(custom);
+	custom->drop();
+
+	// names are found regardless of case and path separator
+	result &= hasContent(fs, "mypath/myfile.txt", "1est\n");
+	result &= hasContent(fs, "MyPath\\MyFile.TXT", "1est\n");
+	result &= hasContent(fs, "mypath/mypath/myfile.txt", "2est");
+	result &= hasContent(fs, "myfile.txt", 0);
+	result &= fs->existFile("MYPATH/myfile.txt");
+	result &= fs->existFile("mypath/");
+	result &= !fs->existFile("mypath/missing.txt");
+
+	// the archive which is not indexed comes first now
+	result &= fs->moveFileArchive(1, -1);
+	result &= hasContent(fs, "mypath/myfile.txt", "custom");
+	result &= hasContent(fs, "mypath/mypath/myfile.txt", "2est");
+
+	result &= fs->removeFileArchive(custom);
+	result &= hasContent(fs, "mypath/myfile.txt", "1est\n");
+
+	// archives which ignore paths find files by name
+	result &= fs->addFileArchive("media/file_with_path.npk", true, true);
+	result &= hasContent(fs, "test/test.txt", "Hello world!\n");
+	result &= hasContent(fs, "somewhere/else/TEST.txt", "Hello world!\n");
+	result &= fs->existFile("else/test.txt");
+
+	removeArchives(fs);
+	result &= hasContent(fs, "test/test.txt", 0);
+
+	// archives which keep the case of names are not indexed, but still have priority
+	result &= fs->addFileArchive("media/file_with_path.zip", false, false);
+	custom = new CCustomArchive(fs);
+	result &= fs->addFileArchive(custom);
+	custom->drop();
+	result &= hasContent(fs, "mypath/myfile.txt", "1est\n");
+	result &= hasContent(fs, "mypath/mypath/myfile.txt", "2est");
+	removeArchives(fs);
+
+	return result;
+}
+
+// every file of the mounted archives is found
+bool testAllFiles(IrrlichtDevice* device)
+{
+	IFileSystem* fs = device->getFileSystem();
+	const c8* const archives[] = { "media/file_with_path.zip", "media/file_with_path.npk",
+		"media/sample_pakfile.pak", "media/lzmadata.zip", "media/Monty.zip" };
+
+	bool result = true;
+	for (u32 i = 0; i < 5; ++i)
+		result &= fs->addFileArchive(archives[i], true, false);
+
+	u32 count = 0;
+	for (u32 i = 0; i < fs->getFileArchiveCount(); ++i)
+	{
+		const IFileList* list = fs->getFileArchive(i)->getFileList();
+		for (u32 j = 0; j < list->getFileCount(); ++j)
+		{
+			if (list->isDirectory(j))
+				continue;
+			++count;
+			if (!fs->existFile(list->getFullFileName(j)))
+			{
+				logTestString("%s not found\n", list->getFullFileName(j).c_str());
+				result = false;
+			}
+		}
+	}
+
+	// lookups of files in archives and of files on disk which have to miss all archives
+	ITimer* timer = device->getTimer();
+	const u32 start = timer->getRealTime();
+	for (u32 i = 0; i < 10000; ++i)
+	{
+		fs->existFile("tahoma10_.xml");
+		fs->existFile("media/missing.txt");
+	}
+	logTestString("%d files in %d archives, 20000 lookups %d ms\n", count, fs->getFileArchiveCount(),
+		timer->getRealTime() - start);
+
+	removeArchives(fs);
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests that the file index of the file system finds the same files as
+asking the archives in turn, with the same priorities. */
+bool fileIndex(void)
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	bool result = testPriority(device->getFileSystem());
+	result &= testAllFiles(device);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,232 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace video;
+
+namespace
+{
+
+const E_IMAGE_FILTER Filters[] = { EIF_BOX, EIF_BILINEAR, EIF_LANCZOS, EIF_KAISER };
+const c8* const FilterNames[] = { "box", "bilinear", "lanczos", "kaiser" };
+
+// largest difference of a color channel
+u32 difference(const SColor& a, const SColor& b)
+{
+	u32 d = (u32)abs_((s32)a.getAlpha() - (s32)b.getAlpha());
+	d = max_(d, (u32)abs_((s32)a.getRed() - (s32)b.getRed()));
+	d = max_(d, (u32)abs_((s32)a.getGreen() - (s32)b.getGreen()));
+	return max_(d, (u32)abs_((s32)a.getBlue() - (s32)b.getBlue()));
+}
+
+// rounded average of the 2x2 pixels of an image, what a box filter halving the image gives
+SColor average(IImage* image, u32 x, u32 y)
+{
+	u32 sum[4] = { 0, 0, 0, 0 };
+	for (u32 i = 0; i < 4; ++i)
+	{
+		const SColor c = image->getPixel(x * 2 + (i & 1), y * 2 + i / 2);
+		sum[0] += c.getAlpha();
+		sum[1] += c.getRed();
+		sum[2] += c.getGreen();
+		sum[3] += c.getBlue();
+	}
+	return SColor((sum[0] + 2) / 4, (sum[1] + 2) / 4, (sum[2] + 2) / 4, (sum[3] + 2) / 4);
+}
+
+IImage* createNoiseImage(IVideoDriver* driver, const dimension2du& size)
+{
+	IImage* image = driver->createImage(ECF_A8R8G8B8, size);
+	for (u32 y = 0; y < size.Height; ++y)
+	{
+		for (u32 x = 0; x < size.Width; ++x)
+			image->setPixel(x, y, SColor(rand() & 0xFF, rand() & 0xFF, rand() & 0xFF, rand() & 0xFF));
+	}
+	return image;
+}
+
+// a single color stays the same with all filters, scales and formats
+bool testConstantColor(IVideoDriver* driver)
+{
+	const dimension2du sizes[] = { dimension2du(1, 1), dimension2du(7, 3), dimension2du(64, 64), dimension2du(100, 37) };
+	const ECOLOR_FORMAT formats[] = { ECF_A8R8G8B8, ECF_R8G8B8, ECF_R5G6B5 };
+	const SColor color(255, 200, 100, 40);
+
+	bool result = true;
+	for (u32 f = 0; f < 3; ++f)
+	{
+		IImage* source = driver->createImage(formats[f], dimension2du(50, 50));
+		source->fill(color);
+		const SColor expected = source->getPixel(0, 0);
+
+		for (u32 s = 0; s < 4; ++s)
+		{
+			for (u32 i = 0; i < 4; ++i)
+			{
+				IImage* target = driver->createImage(ECF_A8R8G8B8, sizes[s]);
+				source->copyToScalingFiltered(target, Filters[i]);
+
+				u32 d = 0;
+				for (u32 y = 0; y < sizes[s].Height; ++y)
+					for (u32 x = 0; x < sizes[s].Width; ++x)
+						d = max_(d, difference(target->getPixel(x, y), expected));
+
+				if (d > 1)
+				{
+					logTestString("Constant color changed by %d, filter %s, size %dx%d, format %d\n",
+						d, FilterNames[i], sizes[s].Width, sizes[s].Height, formats[f]);
+					result = false;
+				}
+				target->drop();
+			}
+		}
+		source->drop();
+	}
+	return result;
+}
+
+// the box filter averages 2x2 pixels when halving images
+bool testBoxFilter(IVideoDriver* driver)
+{
+	IImage* source = createNoiseImage(driver, dimension2du(66, 34));
+	IImage* target = driver->createImage(ECF_A8R8G8B8, dimension2du(33, 17));
+	source->copyToScalingFiltered(target, EIF_BOX);
+
+	u32 d = 0;
+	for (u32 y = 0; y < 17; ++y)
+		for (u32 x = 0; x < 33; ++x)
+			d = max_(d, difference(target->getPixel(x, y), average(source, x, y)));
+
+	source->drop();
+	target->drop();
+
+	// halves are rounded to even
+	if (d > 1)
+		logTestString("Box filter differs by %d from the average\n", d);
+	return d <= 1;
+}
+
+// all filters reproduce a linear gradient away from the borders
+bool testGradient(IVideoDriver* driver)
+{
+	IImage* source = driver->createImage(ECF_A8R8G8B8, dimension2du(128, 8));
+	for (u32 y = 0; y < 8; ++y)
+		for (u32 x = 0; x < 128; ++x)
+			source->setPixel(x, y, SColor(255, x * 2, 0, 255 - x * 2));
+
+	bool result = true;
+	for (u32 i = 0; i < 4; ++i)
+	{
+		IImage* target = driver->createImage(ECF_A8R8G8B8, dimension2du(48, 8));
+		source->copyToScalingFiltered(target, Filters[i]);
+
+		u32 d = 0;
+		for (u32 x = 4; x < 44; ++x)
+		{
+			// center of the target pixel in source pixels
+			const f32 center = ((f32)x + 0.5f) * 128.f / 48.f - 0.5f;
+			const u32 red = (u32)round32(center * 2.f);
+			d = max_(d, difference(target->getPixel(x, 4), SColor(255, red, 0, 255 - red)));
+		}
+
+		if (d > 2)
+		{
+			logTestString("Gradient differs by %d, filter %s\n", d, FilterNames[i]);
+			result = false;
+		}
+		target->drop();
+	}
+	source->drop();
+	return result;
+}
+
+// the software driver filters the levels with several threads
+bool testMipMaps(IrrlichtDevice* device)
+{
+	IVideoDriver* driver = device->getVideoDriver();
+	IImage* image = createNoiseImage(driver, dimension2du(256, 256));
+
+	driver->setTextureCreationFlag(ETCF_CREATE_MIP_MAPS, true);
+	ITexture* texture = driver->addTexture("noise", image);
+
+	bool result = texture != 0;
+	if (texture)
+	{
+		const u8* data = (const u8*)texture->lock(ETLM_READ_ONLY, 1);
+		if (data && texture->getColorFormat() == ECF_A8R8G8B8 && texture->getSize() == dimension2du(128, 128))
+		{
+			u32 d = 0;
+			for (u32 y = 0; y < 128; ++y)
+			{
+				const u32* line = (const u32*)(data + y * texture->getPitch());
+				for (u32 x = 0; x < 128; ++x)
+					d = max_(d, difference(SColor(line[x]), average(image, x, y)));
+			}
+			if (d > 1)
+			{
+				logTestString("Mip map level differs by %d from the average\n", d);
+				result = false;
+			}
+		}
+		texture->unlock();
+		driver->removeTexture(texture);
+	}
+	image->drop();
+
+	// speed of the old and the new filter
+	ITimer* timer = device->getTimer();
+	IImage* source = createNoiseImage(driver, dimension2du(512, 512));
+	IImage* target = driver->createImage(ECF_A8R8G8B8, dimension2du(256, 256));
+
+	u32 start = timer->getRealTime();
+	for (u32 i = 0; i < 10; ++i)
+		source->copyToScalingBoxFilter(target);
+	const u32 oldTime = timer->getRealTime() - start;
+
+	logTestString("10x 512x512 to 256x256: copyToScalingBoxFilter %d ms\n", oldTime);
+	for (u32 f = 0; f < 4; ++f)
+	{
+		start = timer->getRealTime();
+		for (u32 i = 0; i < 10; ++i)
+			source->copyToScalingFiltered(target, Filters[f]);
+		logTestString("10x 512x512 to 256x256: copyToScalingFiltered %s %d ms\n", FilterNames[f], timer->getRealTime() - start);
+	}
+
+	source->drop();
+	target->drop();
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests the filters of IImage::copyToScalingFiltered and the mip map levels
+the software driver creates with them. */
+bool imageResampler(void)
+{
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_CONSOLE;
+	params.DriverType = EDT_BURNINGSVIDEO;
+	params.WindowSize = dimension2du(160, 120);
+
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return true; // software driver not compiled in
+
+	IVideoDriver* driver = device->getVideoDriver();
+	srand(7);
+
+	bool result = testConstantColor(driver);
+	result &= testBoxFilter(driver);
+	result &= testGradient(driver);
+	result &= testMipMaps(device);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
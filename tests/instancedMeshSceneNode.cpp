@@ -0,0 +1,113 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+namespace
+{
+
+u32 drawFrame(IVideoDriver* driver, ISceneManager* smgr)
+{
+	driver->beginScene(true, true, SColor(255,0,0,0));
+	smgr->drawAll();
+	driver->endScene();
+	return driver->getPrimitiveCountDrawn();
+}
+
+} // end anonymous namespace
+
+/** Tests that an instanced mesh scene node culls and draws the same instances
+as one mesh scene node per instance. */
+bool instancedMeshSceneNode(void)
+{
+	IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* single = device->getSceneManager();
+	ISceneManager* instanced = single->createNewSceneManager(false);
+
+	IMesh* cube = single->getGeometryCreator()->createCubeMesh(vector3df(2.f, 2.f, 2.f));
+	const u32 cubePrimitives = cube->getMeshBuffer(0)->getPrimitiveCount();
+
+	single->addCameraSceneNode(0, vector3df(0, 0, 0), vector3df(0, 0, 100));
+	instanced->addCameraSceneNode(0, vector3df(0, 0, 0), vector3df(0, 0, 100));
+
+	IInstancedMeshSceneNode* node = instanced->addInstancedMeshSceneNode(cube, 0, -1, vector3df(5.f, 0, 0));
+	assert_log(node && node->getType() == ESNT_INSTANCED_MESH);
+	if (!node)
+	{
+		cube->drop();
+		instanced->drop();
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	// a grid around the camera, half of it behind the camera
+	for (s32 i = 0; i < 400; ++i)
+	{
+		matrix4 transform;
+		transform.setTranslation(vector3df((f32)(i % 20) * 10.f - 100.f, (f32)(i % 7) * 5.f - 15.f, (f32)(i / 20) * 20.f - 200.f));
+		transform.setScale(1.f + (f32)(i % 3));
+
+		node->addInstance(transform, SColor(255, i % 256, 255 - i % 256, 0));
+
+		IMeshSceneNode* meshNode = single->addMeshSceneNode(cube);
+		meshNode->setPosition(transform.getTranslation() + vector3df(5.f, 0, 0));
+		meshNode->setScale(transform.getScale());
+		meshNode->setAutomaticCulling(EAC_FRUSTUM_BOX);
+	}
+	cube->drop();
+
+	bool result = true;
+
+	const u32 singleCount = drawFrame(driver, single);
+	const u32 instancedCount = drawFrame(driver, instanced);
+	if (singleCount != instancedCount || node->getVisibleInstanceCount() * cubePrimitives != instancedCount)
+	{
+		logTestString("Instanced node drew %d primitives of %d instances, mesh nodes %d\n",
+			instancedCount, node->getVisibleInstanceCount(), singleCount);
+		result = false;
+	}
+
+	if (node->getVisibleInstanceCount() == 0 || node->getVisibleInstanceCount() >= node->getInstanceCount())
+	{
+		logTestString("Culling failed, %d of %d instances visible\n",
+			node->getVisibleInstanceCount(), node->getInstanceCount());
+		result = false;
+	}
+
+	// move all instances in front of the camera
+	for (u32 i = 0; i < node->getInstanceCount(); ++i)
+	{
+		matrix4 transform = node->getInstanceTransform(i);
+		transform.setTranslation(vector3df(0, 0, 50.f + (f32)i));
+		node->setInstance(i, transform, node->getInstanceColor(i));
+	}
+	drawFrame(driver, instanced);
+	result &= (node->getVisibleInstanceCount() == 400);
+
+	node->removeInstance(0);
+	node->removeInstance(node->getInstanceCount() - 1);
+	result &= (node->getInstanceCount() == 398);
+	result &= (drawFrame(driver, instanced) == 398 * cubePrimitives);
+
+	node->clearInstances();
+	result &= (drawFrame(driver, instanced) == 0);
+
+	instanced->drop();
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
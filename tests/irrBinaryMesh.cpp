@@ -0,0 +1,236 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+const c8* const StaticFileName = "irrBinaryMesh_static.irrbin";
+const c8* const SkinnedFileName = "irrBinaryMesh_skinned.irrbin";
+
+bool writeMesh(ISceneManager* smgr, IMesh* mesh, const io::path& name)
+{
+	IMeshWriter* writer = smgr->createMeshWriter(EMWT_IRR_BINARY_MESH);
+	io::IWriteFile* file = smgr->getFileSystem()->createAndWriteFile(name);
+	const bool result = writer && file && writer->writeMesh(file, mesh);
+	if (file)
+		file->drop();
+	if (writer)
+		writer->drop();
+	return result;
+}
+
+// the buffers must have the same vertices, indices and materials
+bool sameBuffers(IMesh* a, IMesh* b)
+{
+	if (a->getMeshBufferCount() != b->getMeshBufferCount())
+		return false;
+
+	for (u32 i = 0; i < a->getMeshBufferCount(); ++i)
+	{
+		const IMeshBuffer* ba = a->getMeshBuffer(i);
+		const IMeshBuffer* bb = b->getMeshBuffer(i);
+		if (ba->getVertexType() != bb->getVertexType() || ba->getVertexCount() != bb->getVertexCount() ||
+			ba->getIndexType() != bb->getIndexType() || ba->getIndexCount() != bb->getIndexCount())
+			return false;
+
+		const u32 indexSize = ba->getIndexType() == video::EIT_32BIT ? 4 : 2;
+		if (memcmp(ba->getVertices(), bb->getVertices(), ba->getVertexCount() * video::getVertexPitchFromType(ba->getVertexType())) ||
+			memcmp(ba->getIndices(), bb->getIndices(), ba->getIndexCount() * indexSize))
+			return false;
+
+		const video::SMaterial& ma = ba->getMaterial();
+		const video::SMaterial& mb = bb->getMaterial();
+		if (ma.MaterialType != mb.MaterialType || ma.DiffuseColor != mb.DiffuseColor ||
+			ma.Lighting != mb.Lighting || ma.getTexture(0) != mb.getTexture(0))
+			return false;
+	}
+	return true;
+}
+
+// a static mesh keeps its buffers
+bool testStaticMesh(ISceneManager* smgr)
+{
+	IAnimatedMesh* mesh = smgr->getMesh("../media/room.3ds");
+	if (!mesh || !writeMesh(smgr, mesh->getMesh(0), StaticFileName))
+	{
+		logTestString("Could not write static binary mesh\n");
+		return false;
+	}
+
+	IAnimatedMesh* loaded = smgr->getMesh(StaticFileName);
+	bool result = loaded && sameBuffers(mesh->getMesh(0), loaded->getMesh(0)) &&
+		loaded->getBoundingBox() == mesh->getMesh(0)->getBoundingBox();
+	if (!result)
+		logTestString("Static binary mesh differs from the original\n");
+
+	if (loaded)
+		smgr->getMeshCache()->removeMesh(loaded);
+	return result;
+}
+
+// a skinned mesh keeps its joints and animates the same
+bool testSkinnedMesh(ISceneManager* smgr)
+{
+	ISkinnedMesh* mesh = (ISkinnedMesh*)smgr->getMesh("../media/ninja.b3d");
+	if (!mesh || !writeMesh(smgr, mesh, SkinnedFileName))
+	{
+		logTestString("Could not write skinned binary mesh\n");
+		return false;
+	}
+
+	IAnimatedMesh* loaded = smgr->getMesh(SkinnedFileName);
+	bool result = loaded && loaded->getMeshType() == EAMT_SKINNED && sameBuffers(mesh, loaded);
+	if (result)
+	{
+		ISkinnedMesh* skinned = (ISkinnedMesh*)loaded;
+		result &= skinned->getJointCount() == mesh->getJointCount();
+		result &= skinned->getFrameCount() == mesh->getFrameCount();
+		result &= skinned->getAnimationSpeed() == mesh->getAnimationSpeed();
+		for (u32 i = 0; result && i < mesh->getJointCount(); ++i)
+		{
+			const ISkinnedMesh::SJoint* a = mesh->getAllJoints()[i];
+			const ISkinnedMesh::SJoint* b = skinned->getAllJoints()[i];
+			result &= a->Name == b->Name && a->Children.size() == b->Children.size() &&
+				a->PositionKeys.size() == b->PositionKeys.size() && a->RotationKeys.size() == b->RotationKeys.size() &&
+				a->Weights.size() == b->Weights.size();
+		}
+
+		// the same frame skins the vertices to the same positions
+		IMesh* frame = mesh->getMesh(12);
+		IMesh* loadedFrame = loaded->getMesh(12);
+		for (u32 i = 0; result && i < frame->getMeshBufferCount(); ++i)
+		{
+			const IMeshBuffer* a = frame->getMeshBuffer(i);
+			const IMeshBuffer* b = loadedFrame->getMeshBuffer(i);
+			for (u32 v = 0; result && v < a->getVertexCount(); ++v)
+				result &= a->getPosition(v).equals(b->getPosition(v), 0.001f);
+		}
+	}
+
+	if (!result)
+		logTestString("Skinned binary mesh differs from the original\n");
+
+	if (loaded)
+		smgr->getMeshCache()->removeMesh(loaded);
+	return result;
+}
+
+// broken files are rejected
+bool testBrokenFiles(ISceneManager* smgr)
+{
+	io::IFileSystem* fs = smgr->getFileSystem();
+	io::IReadFile* file = fs->createAndOpenFile(SkinnedFileName);
+	if (!file)
+		return false;
+
+	const long size = file->getSize();
+	c8* data = new c8[size];
+	file->read(data, size);
+	file->drop();
+
+	bool result = true;
+	const long sizes[] = { 8, 60, size / 3, size - 1 };
+	for (u32 i = 0; i < 4; ++i)
+	{
+		io::IReadFile* truncated = fs->createMemoryReadFile(data, sizes[i], "truncated.irrbin", false);
+		IAnimatedMesh* mesh = smgr->getMesh(truncated);
+		truncated->drop();
+		if (mesh)
+		{
+			logTestString("Truncated binary mesh of %d bytes was loaded\n", sizes[i]);
+			smgr->getMeshCache()->removeMesh(mesh);
+			result = false;
+		}
+	}
+
+	// counts whose sizes overflow or don't fit in the file are rejected,
+	// the vertex count of the first buffer and the joint count of the header
+	const u32 offsets[] = { 64, 16 };
+	const u32 counts[] = { 0x40000001, 0x10000000 };
+	for (u32 i = 0; i < 2; ++i)
+	{
+		c8* crafted = new c8[size];
+		memcpy(crafted, data, size);
+		memcpy(crafted + offsets[i], &counts[i], sizeof(u32));
+		io::IReadFile* file = fs->createMemoryReadFile(crafted, size, "crafted.irrbin", true);
+		IAnimatedMesh* mesh = smgr->getMesh(file);
+		file->drop();
+		if (mesh)
+		{
+			logTestString("Binary mesh with a count of %u at %u was loaded\n", counts[i], offsets[i]);
+			smgr->getMeshCache()->removeMesh(mesh);
+			result = false;
+		}
+	}
+
+	// files of other versions are rejected
+	data[4] = 99;
+	io::IReadFile* other = fs->createMemoryReadFile(data, size, "version.irrbin", false);
+	IAnimatedMesh* mesh = smgr->getMesh(other);
+	other->drop();
+	if (mesh)
+	{
+		smgr->getMeshCache()->removeMesh(mesh);
+		result = false;
+	}
+
+	delete [] data;
+	return result;
+}
+
+// speed of the text and the binary format
+void logLoadTimes(IrrlichtDevice* device)
+{
+	ISceneManager* smgr = device->getSceneManager();
+	ITimer* timer = device->getTimer();
+	const c8* const name = "../media/dwarf.x";
+
+	IAnimatedMesh* mesh = smgr->getMesh(name);
+	if (!mesh || !writeMesh(smgr, mesh, SkinnedFileName))
+		return;
+	smgr->getMeshCache()->removeMesh(mesh);
+
+	u32 start = timer->getRealTime();
+	for (u32 i = 0; i < 10; ++i)
+		smgr->getMeshCache()->removeMesh(smgr->getMesh(name));
+	const u32 textTime = timer->getRealTime() - start;
+
+	start = timer->getRealTime();
+	for (u32 i = 0; i < 10; ++i)
+		smgr->getMeshCache()->removeMesh(smgr->getMesh(SkinnedFileName));
+	logTestString("10x dwarf: .x %d ms, .irrbin %d ms\n", textTime, timer->getRealTime() - start);
+}
+
+} // end anonymous namespace
+
+/** Tests the binary .irrbin mesh writer and loader with a static and a
+skinned mesh, and broken files. */
+bool irrBinaryMesh(void)
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+
+	bool result = testStaticMesh(smgr);
+	result &= testSkinnedMesh(smgr);
+	result &= testBrokenFiles(smgr);
+	logLoadTimes(device);
+
+	remove(StaticFileName);
+	remove(SkinnedFileName);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
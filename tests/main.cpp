@@ -83,6 +83,8 @@ int main(int argumentCount, char * arguments[])
 	TEST(removeCustomAnimator);
 	TEST(sceneCollisionManager);
 	TEST(sceneNodeAnimator);
+	TEST(sceneTraversal);
+	TEST(instancedMeshSceneNode);
 	TEST(meshLoaders);
 	TEST(testTimer);
 	TEST(testCoreutil);
@@ -99,6 +101,22 @@ int main(int argumentCount, char * arguments[])
 	TEST(md2Animation);
 	TEST(meshTransform);
 	TEST(skinnedMesh);
+	TEST(animationLOD);
+	TEST(skinnedMeshCompression);
+	TEST(skinnedMeshThreads);
+	TEST(asyncLoading);
+	TEST(resourceCaches);
+	TEST(textureCompression);
+	TEST(colorConverter);
+	TEST(imageResampler);
+	TEST(mappedFile);
+	TEST(fileIndex);
+	TEST(zipStreaming);
+	TEST(irrBinaryMesh);
+	TEST(vertexWelding);
+	TEST(bvhTriangleSelector);
+	TEST(sceneNodeIndex);
+	TEST(ellipsoidCollision);
 	TEST(testGeometryCreator);
 	TEST(writeImageToFile);
 	TEST(ioScene);
@@ -0,0 +1,162 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace io;
+
+namespace
+{
+
+const c8* const ObjFileName = "mappedFile.obj";
+
+// reads a file completely with read()
+core::array<c8> readAll(IReadFile* file)
+{
+	core::array<c8> data;
+	data.set_used(file->getSize());
+	file->seek(0);
+	if (file->getSize() && file->read(data.pointer(), file->getSize()) != (size_t)file->getSize())
+		data.clear();
+	return data;
+}
+
+// opens a file mapped and not mapped, the contents must be the same
+bool compareFile(IFileSystem* fs, const io::path& name, bool expectData)
+{
+	fs->setFileMappingThreshold(0);
+	IReadFile* file = fs->createAndOpenFile(name);
+	fs->setFileMappingThreshold(1);
+	IReadFile* mapped = fs->createAndOpenFile(name);
+	if (!file || !mapped)
+	{
+		logTestString("Could not open %s\n", name.c_str());
+		if (file)
+			file->drop();
+		if (mapped)
+			mapped->drop();
+		return false;
+	}
+
+	const core::array<c8> expected = readAll(file);
+	bool result = readAll(mapped) == expected && mapped->getSize() == file->getSize();
+
+	const c8* data = (const c8*)mapped->getData();
+	if (expectData && !data)
+	{
+		logTestString("%s is not in memory\n", name.c_str());
+		result = false;
+	}
+	if (data && memcmp(data, expected.const_pointer(), expected.size()) != 0)
+		result = false;
+
+	// reads past the end stop at the end
+	if (mapped->getSize() > 2)
+	{
+		c8 tail[4];
+		result &= mapped->seek(-2, true);
+		result &= mapped->getPos() == mapped->getSize() - 2;
+		result &= mapped->read(tail, 4) == 2;
+		result &= tail[1] == expected.getLast();
+		result &= mapped->read(tail, 4) == 0;
+	}
+
+	if (!result)
+		logTestString("Mapped %s differs from the file\n", name.c_str());
+
+	file->drop();
+	mapped->drop();
+	return result;
+}
+
+// the loaders parse mapped files in place
+bool compareMesh(scene::ISceneManager* smgr, const io::path& name)
+{
+	IFileSystem* fs = smgr->getFileSystem();
+
+	fs->setFileMappingThreshold(1);
+	scene::IAnimatedMesh* mesh = smgr->getMesh(name);
+	u32 mappedVertices = 0;
+	u32 mappedBuffers = 0;
+	if (mesh)
+	{
+		mappedBuffers = mesh->getMeshBufferCount();
+		for (u32 i = 0; i < mappedBuffers; ++i)
+			mappedVertices += mesh->getMeshBuffer(i)->getVertexCount();
+		smgr->getMeshCache()->removeMesh(mesh);
+	}
+
+	fs->setFileMappingThreshold(0);
+	mesh = smgr->getMesh(name);
+	bool result = mesh != 0 && mappedBuffers != 0;
+	if (mesh)
+	{
+		u32 vertices = 0;
+		for (u32 i = 0; i < mesh->getMeshBufferCount(); ++i)
+			vertices += mesh->getMeshBuffer(i)->getVertexCount();
+		result &= mesh->getMeshBufferCount() == mappedBuffers && vertices == mappedVertices;
+		smgr->getMeshCache()->removeMesh(mesh);
+	}
+
+	if (!result)
+		logTestString("Mesh %s loaded from a mapped file differs\n", name.c_str());
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests files which IFileSystem maps into memory: plain files, stored and
+compressed entries of mapped archives, and the loaders which use the
+contents of mapped files without copying them. */
+bool mappedFile(void)
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IFileSystem* fs = device->getFileSystem();
+	scene::ISceneManager* smgr = device->getSceneManager();
+
+	bool result = fs->getFileMappingThreshold() == 0;
+	result &= compareFile(fs, "media/file_with_path.zip", true);
+	result &= compareFile(fs, "../media/dwarf.x", true);
+
+	// small files are still read with stdio
+	fs->setFileMappingThreshold(1 << 30);
+	IReadFile* file = fs->createAndOpenFile("media/file_with_path.zip");
+	result &= file && !file->getData();
+	if (file)
+		file->drop();
+
+	// stored entries are slices of the mapped archive, deflated ones are inflated from it
+	fs->setFileMappingThreshold(1);
+	result &= fs->addFileArchive("media/file_with_path.zip", true, false);
+	result &= fs->addFileArchive("media/Monty.zip", true, false);
+	result &= compareFile(fs, "mypath/myfile.txt", true);
+	result &= compareFile(fs, "test/test.txt", true);
+	result &= compareFile(fs, "monty/Monty.kart", false);
+	while (fs->getFileArchiveCount())
+		fs->removeFileArchive(fs->getFileArchiveCount() - 1);
+
+	IWriteFile* obj = fs->createAndWriteFile(ObjFileName);
+	if (obj)
+	{
+		const c8 quad[] = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nf 1/1 2/2 3/3 4/4\n";
+		obj->write(quad, sizeof(quad) - 1);
+		obj->drop();
+		result &= compareMesh(smgr, ObjFileName);
+		remove(ObjFileName);
+	}
+	result &= compareMesh(smgr, "../media/dwarf.x");
+
+	fs->setFileMappingThreshold(0);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,162 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+namespace
+{
+
+// loads the same mesh and texture from every node it animates
+class CLoadingAnimator : public ISceneNodeAnimator
+{
+public:
+	CLoadingAnimator(array<IAnimatedMesh*>& meshes, array<ITexture*>& textures)
+		: Meshes(meshes), Textures(textures) {}
+
+	virtual void animateNode(ISceneNode* node, u32 timeMs)
+	{
+		ISceneManager* smgr = node->getSceneManager();
+		Meshes[node->getID()] = smgr->getMesh("media/sydney.md2");
+		Textures[node->getID()] = smgr->getVideoDriver()->getTexture("media/sydney.bmp");
+	}
+
+	virtual ISceneNodeAnimator* createClone(ISceneNode* node, ISceneManager* newManager=0)
+	{
+		return 0;
+	}
+
+private:
+	array<IAnimatedMesh*>& Meshes;
+	array<ITexture*>& Textures;
+};
+
+bool testMeshCache(ISceneManager* smgr)
+{
+	IMeshCache* cache = smgr->getMeshCache();
+	const u32 count = cache->getMeshCount();
+
+	array<IAnimatedMesh*> meshes;
+	for (u32 i = 0; i < 200; ++i)
+	{
+		SAnimatedMesh* mesh = new SAnimatedMesh();
+		cache->addMesh(stringc("Meshes\\Mesh") + stringc(i) + ".X", mesh);
+		meshes.push_back(mesh);
+		mesh->drop();
+	}
+
+	bool result = (cache->getMeshCount() == count + 200);
+
+	// names are case insensitive and use / or \ for directories
+	for (u32 i = 0; i < 200; ++i)
+		result &= (cache->getMeshByName(stringc("meshes/mesh") + stringc(i) + ".x") == meshes[i]);
+	result &= (cache->getMeshByName("meshes/mesh200.x") == 0);
+
+	result &= cache->renameMesh(meshes[10], "renamed.x");
+	result &= (cache->getMeshByName("meshes/mesh10.x") == 0);
+	result &= (cache->getMeshByName("RENAMED.X") == meshes[10]);
+
+	for (u32 i = 0; i < 200; i += 2)
+		cache->removeMesh(meshes[i]);
+	result &= (cache->getMeshCount() == count + 100);
+	result &= (cache->getMeshByName("renamed.x") == 0);
+	result &= (cache->getMeshByName("meshes/mesh11.x") == meshes[11]);
+
+	// only the cache holds the meshes
+	cache->clearUnusedMeshes();
+	result &= (cache->getMeshByName("meshes/mesh11.x") == 0);
+
+	if (!result)
+		logTestString("Mesh cache failed\n");
+	return result;
+}
+
+bool testTextureCache(IVideoDriver* driver)
+{
+	const u32 count = driver->getTextureCount();
+	IImage* image = driver->createImage(ECF_A8R8G8B8, dimension2du(4, 4));
+
+	array<ITexture*> textures;
+	for (u32 i = 0; i < 200; ++i)
+		textures.push_back(driver->addTexture(stringc("Textures\\Texture") + stringc(i), image));
+	image->drop();
+
+	bool result = (driver->getTextureCount() == count + 200);
+	for (u32 i = 0; i < 200; ++i)
+		result &= (textures[i] && driver->findTexture(stringc("textures/texture") + stringc(i)) == textures[i]);
+	result &= (driver->findTexture("textures/texture200") == 0);
+
+	driver->renameTexture(textures[5], "renamed");
+	result &= (driver->findTexture("textures/texture5") == 0);
+	result &= (driver->findTexture("Renamed") == textures[5]);
+
+	for (u32 i = 0; i < 200; ++i)
+		driver->removeTexture(textures[i]);
+	result &= (driver->getTextureCount() == count);
+	result &= (driver->findTexture("renamed") == 0);
+
+	if (!result)
+		logTestString("Texture cache failed\n");
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests the hashed mesh and texture caches, and that threads loading the
+same file share one load. */
+bool resourceCaches(void)
+{
+	IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	IVideoDriver* driver = device->getVideoDriver();
+
+	bool result = testMeshCache(smgr);
+	result &= testTextureCache(driver);
+
+	// load from the animation threads
+	smgr->getParameters()->setAttribute(PARALLEL_SCENE_THREADS, 4);
+	smgr->getParameters()->setAttribute(PARALLEL_SCENE_ANIMATION, true);
+	smgr->addCameraSceneNode();
+
+	array<IAnimatedMesh*> meshes;
+	array<ITexture*> textures;
+	meshes.set_used(64);
+	textures.set_used(64);
+	CLoadingAnimator* animator = new CLoadingAnimator(meshes, textures);
+	for (s32 i = 0; i < 64; ++i)
+		smgr->addEmptySceneNode(0, i)->addAnimator(animator);
+	animator->drop();
+
+	const u32 meshCount = smgr->getMeshCache()->getMeshCount();
+	const u32 textureCount = driver->getTextureCount();
+
+	driver->beginScene(true, true, SColor(255,0,0,0));
+	smgr->drawAll();
+	driver->endScene();
+
+	// loaded once
+	result &= (smgr->getMeshCache()->getMeshCount() == meshCount + 1);
+	result &= (driver->getTextureCount() == textureCount + 1);
+	for (u32 i = 0; i < 64; ++i)
+	{
+		result &= (meshes[i] && meshes[i] == meshes[0]);
+		result &= (textures[i] && textures[i] == textures[0]);
+	}
+
+	if (!result)
+		logTestString("Resource caches failed\n");
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
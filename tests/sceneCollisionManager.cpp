@@ -439,6 +439,181 @@ static bool compareGetSceneNodeFromRayBBWithBBIntersectsWithLine(IrrlichtDevice
 }
 
 
+// Lines from one agent to another and down to the ground, like an AI would test.
+static void createAgentRays(core::array<core::line3df>& rays, u32 count)
+{
+	u32 seed = 7;
+	core::array<core::vector3df> agents;
+	for (u32 i=0; i<64; ++i)
+	{
+		f32 p[3];
+		for (u32 j=0; j<3; ++j)
+		{
+			seed = seed * 1103515245u + 12345u;
+			p[j] = ((seed >> 8) & 0xffff) / 65535.f;
+		}
+		agents.push_back(core::vector3df(p[0] * 160.f - 80.f, 5.f + p[1] * 10.f, p[2] * 160.f - 80.f));
+	}
+
+	for (u32 i=0; i<count; ++i)
+	{
+		const core::vector3df& from = agents[i % agents.size()];
+		if (i % 4 == 0)
+			rays.push_back(core::line3df(from, from - core::vector3df(0.f, 100.f, 0.f)));
+		else
+			rays.push_back(core::line3df(from, agents[(i * 7 + i / agents.size()) % agents.size()]));
+	}
+}
+
+static bool sameHit(bool found, const SCollisionHit& hit, bool expectedFound,
+		const SCollisionHit& expected, const core::line3df& ray)
+{
+	if (found != expectedFound)
+		return false;
+	if (!found)
+		return true;
+	return core::equals(hit.Intersection.getDistanceFrom(ray.start),
+			expected.Intersection.getDistanceFrom(ray.start), 0.001f) &&
+		hit.Node == expected.Node && hit.MeshBuffer == expected.MeshBuffer;
+}
+
+// Batch queries must find the same collisions as one query per line.
+static bool batchCollisionPoints(IrrlichtDevice * device, ISceneManager * smgr,
+					ISceneCollisionManager * collMgr)
+{
+	IMesh* hills = smgr->getGeometryCreator()->createHillPlaneMesh(core::dimension2df(2.f, 2.f),
+		core::dimension2du(100, 100), 0, 6.f, core::dimension2df(4.f, 4.f), core::dimension2df(1.f, 1.f));
+	IMeshSceneNode* ground = smgr->addMeshSceneNode(hills, 0, 1);
+	hills->drop();
+	for (u32 i=0; i<20; ++i)
+	{
+		ISceneNode* block = smgr->addCubeSceneNode(8.f, 0, 2,
+			core::vector3df((i % 5) * 30.f - 60.f, 8.f, (i / 5) * 30.f - 45.f), core::vector3df(0.f, i * 10.f, 0.f));
+		ITriangleSelector* blockSelector = smgr->createTriangleSelectorFromBoundingBox(block);
+		block->setTriangleSelector(blockSelector);
+		blockSelector->drop();
+	}
+	smgr->getRootSceneNode()->OnAnimate(0);
+
+	core::array<core::line3df> rays;
+	createAgentRays(rays, 4000);
+	const u32 count = rays.size();
+
+	ITriangleSelector* selectors[3] =
+	{
+		smgr->createTriangleSelector(ground->getMesh(), ground),
+		smgr->createOctreeTriangleSelector(ground->getMesh(), ground),
+		smgr->createBVHTriangleSelector(ground->getMesh(), ground)
+	};
+	const c8* names[3] = { "plain", "octree", "bvh" };
+
+	bool result = true;
+	core::array<SCollisionHit> expected(count), hits(count);
+	core::array<bool> expectedFound(count), found(count);
+	expected.set_used(count);
+	hits.set_used(count);
+	expectedFound.set_used(count);
+	found.set_used(count);
+
+	for (u32 s=0; s<3; ++s)
+	{
+		u32 start = device->getTimer()->getRealTime();
+		for (u32 i=0; i<count; ++i)
+			expectedFound[i] = collMgr->getCollisionPoint(expected[i], rays[i], selectors[s]);
+		const u32 singleTime = device->getTimer()->getRealTime() - start;
+
+		const u32 threads[3] = { 1, 0, 4 };
+		for (u32 t=0; t<3; ++t)
+		{
+			start = device->getTimer()->getRealTime();
+			const u32 hitCount = collMgr->getCollisionPoints(rays.const_pointer(), count, selectors[s],
+				hits.pointer(), found.pointer(), false, threads[t]);
+			const u32 batchTime = device->getTimer()->getRealTime() - start;
+			if (t == 0)
+				logTestString("%u lines against the %s selector: %u ms one by one, %u ms as batch, %u hits\n",
+					count, names[s], singleTime, batchTime, hitCount);
+
+			u32 wrong = 0;
+			u32 expectedCount = 0;
+			for (u32 i=0; i<count; ++i)
+			{
+				if (!sameHit(found[i], hits[i], expectedFound[i], expected[i], rays[i]))
+					++wrong;
+				if (expectedFound[i])
+					++expectedCount;
+			}
+			if (wrong || hitCount != expectedCount)
+			{
+				logTestString("Batch of %s selector with %u threads differs for %u lines\n", names[s], threads[t], wrong);
+				result = false;
+			}
+		}
+
+		// line of sight only needs any hit
+		collMgr->getCollisionPoints(rays.const_pointer(), count, selectors[s],
+			hits.pointer(), found.pointer(), true, 1);
+		for (u32 i=0; i<count; ++i)
+		{
+			if (found[i] != expectedFound[i])
+			{
+				logTestString("Any hit batch of %s selector differs\n", names[s]);
+				result = false;
+				break;
+			}
+		}
+	}
+
+	// picking nodes, with the ground and the blocks
+	ground->setTriangleSelector(selectors[0]);
+	u32 start = device->getTimer()->getRealTime();
+	for (u32 i=0; i<count; ++i)
+	{
+		expected[i] = SCollisionHit();
+		expectedFound[i] = collMgr->getSceneNodeAndCollisionPointFromRay(expected[i], rays[i]) != 0;
+	}
+	const u32 singleTime = device->getTimer()->getRealTime() - start;
+
+	start = device->getTimer()->getRealTime();
+	const u32 hitCount = collMgr->getSceneNodesAndCollisionPointsFromRays(rays.const_pointer(), count, hits.pointer());
+	logTestString("%u lines picking nodes: %u ms one by one, %u ms as batch, %u hits\n",
+		count, singleTime, device->getTimer()->getRealTime() - start, hitCount);
+
+	u32 blockHits = 0;
+	for (u32 i=0; i<count; ++i)
+	{
+		if (!sameHit(hits[i].Node != 0, hits[i], expectedFound[i], expected[i], rays[i]))
+		{
+			logTestString("Batch picking differs for line %u\n", i);
+			result = false;
+			break;
+		}
+		if (hits[i].Node && hits[i].Node->getID() == 2)
+			++blockHits;
+	}
+	result &= (blockHits > 0);
+
+	// only the blocks
+	collMgr->getSceneNodesAndCollisionPointsFromRays(rays.const_pointer(), count, hits.pointer(), 2, 0, false, 0);
+	for (u32 i=0; i<count; ++i)
+	{
+		if (hits[i].Node && hits[i].Node->getID() != 2)
+		{
+			logTestString("Batch picking ignores the id bitmask\n");
+			result = false;
+			break;
+		}
+	}
+
+	for (u32 s=0; s<3; ++s)
+		selectors[s]->drop();
+	smgr->clear();
+
+	if (!result)
+		logTestString("Batch collision queries failed\n");
+	return result;
+}
+
+
 /** Test functionality of the sceneCollisionManager */
 bool sceneCollisionManager(void)
 {
@@ -464,6 +639,8 @@ bool sceneCollisionManager(void)
 
 	result &= compareGetSceneNodeFromRayBBWithBBIntersectsWithLine(device, smgr, collMgr);
 
+	result &= batchCollisionPoints(device, smgr, collMgr);
+
 	device->closeDevice();
 	device->run();
 	device->drop();
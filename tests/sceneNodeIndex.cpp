@@ -0,0 +1,312 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 Seed = 1;
+
+f32 random(f32 lo, f32 hi)
+{
+	Seed = Seed * 1103515245u + 12345u;
+	return lo + (hi - lo) * ((Seed >> 8) & 0xffff) / 65535.f;
+}
+
+vector3df randomPosition()
+{
+	return vector3df(random(-100.f, 100.f), random(-20.f, 20.f), random(-100.f, 100.f));
+}
+
+// cubes, some of them children of others
+void addNodes(ISceneManager* smgr, array<ISceneNode*>& nodes, u32 count)
+{
+	for (u32 i=0; i<count; ++i)
+	{
+		ISceneNode* parent = (i % 4 == 3) ? nodes[nodes.size() - 1] : 0;
+		ISceneNode* node = smgr->addCubeSceneNode(random(0.5f, 5.f), parent, i,
+			parent ? vector3df(random(-5.f, 5.f), 0.f, 0.f) : randomPosition(),
+			vector3df(0.f, random(0.f, 90.f), 0.f));
+		node->updateAbsolutePosition();
+		nodes.push_back(node);
+	}
+}
+
+// all nodes below the root, found by walking the scene
+void collectNodes(ISceneNode* node, array<ISceneNode*>& outNodes)
+{
+	const ISceneNodeList& children = node->getChildren();
+	for (ISceneNodeList::ConstIterator it = children.begin(); it != children.end(); ++it)
+	{
+		outNodes.push_back(*it);
+		collectNodes(*it, outNodes);
+	}
+}
+
+bool sameNodes(array<ISceneNode*>& found, array<ISceneNode*>& expected, const c8* query)
+{
+	found.sort();
+	expected.sort();
+	bool result = (found.size() == expected.size());
+	for (u32 i=0; result && i<found.size(); ++i)
+		result = (found[i] == expected[i]);
+
+	if (!result)
+		logTestString("%s query found %u nodes instead of %u\n", query, found.size(), expected.size());
+	return result;
+}
+
+// the queries find the same nodes as testing the boxes of all nodes
+bool compareQueries(ISceneManager* smgr)
+{
+	array<ISceneNode*> all;
+	collectNodes(smgr->getRootSceneNode(), all);
+	bool result = true;
+
+	for (u32 i=0; i<20; ++i)
+	{
+		const vector3df center = randomPosition();
+		const vector3df extent(random(0.f, 20.f), random(0.f, 20.f), random(0.f, 20.f));
+		const aabbox3df box(center - extent, center + extent);
+		const f32 radius = random(0.f, 30.f);
+		const line3df line(randomPosition(), randomPosition());
+
+		array<ISceneNode*> expectedBox, expectedSphere, expectedLine;
+		for (u32 j=0; j<all.size(); ++j)
+		{
+			const aabbox3df nodeBox = all[j]->getTransformedBoundingBox();
+			if (nodeBox.intersectsWithBox(box))
+				expectedBox.push_back(all[j]);
+			vector3df nearest = center;
+			nearest.X = clamp(nearest.X, nodeBox.MinEdge.X, nodeBox.MaxEdge.X);
+			nearest.Y = clamp(nearest.Y, nodeBox.MinEdge.Y, nodeBox.MaxEdge.Y);
+			nearest.Z = clamp(nearest.Z, nodeBox.MinEdge.Z, nodeBox.MaxEdge.Z);
+			if (nearest.getDistanceFromSQ(center) <= radius * radius)
+				expectedSphere.push_back(all[j]);
+			if (nodeBox.intersectsWithLine(line))
+				expectedLine.push_back(all[j]);
+		}
+
+		array<ISceneNode*> found;
+		smgr->getSceneNodesFromBox(box, found);
+		result &= sameNodes(found, expectedBox, "Box");
+		found.clear();
+		smgr->getSceneNodesFromSphere(center, radius, found);
+		result &= sameNodes(found, expectedSphere, "Sphere");
+		found.clear();
+		smgr->getSceneNodesFromLine(line, found);
+		result &= sameNodes(found, expectedLine, "Line");
+	}
+
+	// frustum queries find at least all nodes with a corner inside
+	matrix4 projection, view;
+	projection.buildProjectionMatrixPerspectiveFovLH(PI / 4.f, 4.f / 3.f, 1.f, 100.f);
+	for (u32 i=0; i<10; ++i)
+	{
+		view.buildCameraLookAtMatrixLH(randomPosition(), randomPosition(), vector3df(0.f, 1.f, 0.f));
+		const SViewFrustum frustum(projection * view);
+
+		array<ISceneNode*> found;
+		smgr->getSceneNodesFromFrustum(frustum, found);
+		found.sort();
+		for (u32 j=0; j<all.size(); ++j)
+		{
+			vector3df edges[8];
+			all[j]->getTransformedBoundingBox().getEdges(edges);
+			for (u32 k=0; k<8; ++k)
+			{
+				u32 p=0;
+				while (p<SViewFrustum::VF_PLANE_COUNT &&
+					frustum.planes[p].classifyPointRelation(edges[k]) != ISREL3D_FRONT)
+					++p;
+				if (p == SViewFrustum::VF_PLANE_COUNT && found.binary_search(all[j]) < 0)
+				{
+					logTestString("Frustum query is missing a node inside\n");
+					result = false;
+					break;
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+// nodes which are moved, removed and moved between parents are updated
+bool changeScene(ISceneManager* smgr, array<ISceneNode*>& nodes)
+{
+	for (u32 i=0; i<nodes.size(); i+=3)
+	{
+		nodes[i]->setPosition(randomPosition());
+		nodes[i]->updateAbsolutePosition();
+	}
+
+	// the removed nodes and their children aren't found any more
+	for (u32 i=0; i<nodes.size(); i+=10)
+	{
+		if (nodes[i]->getParent() && nodes[i]->getReferenceCount() == 1)
+			nodes[i]->remove();
+	}
+
+	// a node and its children move to another parent
+	ISceneNode* node = *smgr->getRootSceneNode()->getChildren().getLast();
+	ISceneNode* parent = *smgr->getRootSceneNode()->getChildren().begin();
+	parent->addChild(node);
+	node->setPosition(vector3df(0.f, 200.f, 0.f));
+	node->updateAbsolutePosition();
+	ISceneNodeList::ConstIterator it = node->getChildren().begin();
+	for (; it != node->getChildren().end(); ++it)
+		(*it)->updateAbsolutePosition();
+
+	nodes.clear();
+	collectNodes(smgr->getRootSceneNode(), nodes);
+	bool result = compareQueries(smgr);
+
+	// a detached node is no longer found
+	node->grab();
+	node->remove();
+	array<ISceneNode*> found;
+	smgr->getSceneNodesFromBox(aabbox3df(vector3df(-1000.f), vector3df(1000.f)), found);
+	result &= (found.linear_search(node) < 0);
+	node->updateAbsolutePosition();
+	found.clear();
+	smgr->getSceneNodesFromBox(aabbox3df(vector3df(-1000.f), vector3df(1000.f)), found);
+	result &= (found.linear_search(node) < 0) && (node->getSceneNodeIndexEntry() == -1);
+	node->drop();
+
+	if (!result)
+		logTestString("Changed scene isn't in the index\n");
+	return result;
+}
+
+// picking finds the top cube of a row below a ray, but not invisible ones or those with other ids
+bool pickNodes(ISceneManager* smgr)
+{
+	ISceneCollisionManager* collMgr = smgr->getSceneCollisionManager();
+	ISceneNode* parent = smgr->addEmptySceneNode();
+	bool result = true;
+
+	array<ISceneNode*> cubes;
+	for (s32 i=0; i<10; ++i)
+	{
+		cubes.push_back(smgr->addCubeSceneNode(2.f, parent, 1 << (i % 3), vector3df(500.f + i * 10.f, 300.f, 0.f)));
+		cubes.getLast()->updateAbsolutePosition();
+	}
+
+	for (s32 i=0; i<10; ++i)
+	{
+		const line3df ray(vector3df(500.f + i * 10.f, 400.f, 0.f), vector3df(500.f + i * 10.f, 200.f, 0.f));
+		result &= (collMgr->getSceneNodeFromRayBB(ray) == cubes[i]);
+		result &= (collMgr->getSceneNodeFromRayBB(ray, 1 << ((i + 1) % 3)) == 0);
+		result &= (collMgr->getSceneNodeFromRayBB(ray, 0, false, parent) == cubes[i]);
+		result &= (collMgr->getSceneNodeFromRayBB(ray, 0, false, cubes[i]) == 0);
+	}
+
+	// a ray along the row hits the nearest cube
+	const line3df row(vector3df(650.f, 300.f, 0.f), vector3df(400.f, 300.f, 0.f));
+	result &= (collMgr->getSceneNodeFromRayBB(row) == cubes[9]);
+	cubes[9]->setVisible(false);
+	result &= (collMgr->getSceneNodeFromRayBB(row) == cubes[8]);
+	parent->setVisible(false);
+	result &= (collMgr->getSceneNodeFromRayBB(row) == 0);
+
+	parent->remove();
+	if (!result)
+		logTestString("Picking nodes with the index failed\n");
+	return result;
+}
+
+// the nodes the index culls in drawAll are the same as those culled by their boxes
+bool cullNodes(IrrlichtDevice* device, const array<ISceneNode*>& nodes)
+{
+	ISceneManager* smgr = device->getSceneManager();
+	ICameraSceneNode* camera = smgr->addCameraSceneNode(0, vector3df(0.f, 0.f, 0.f), vector3df(100.f, 0.f, 0.f));
+	camera->setFarValue(100.f);
+	device->getVideoDriver()->beginScene();
+	smgr->drawAll();
+	device->getVideoDriver()->endScene();
+
+	const aabbox3df& frustumBox = camera->getViewFrustum()->getBoundingBox();
+	u32 culled = 0;
+	bool result = true;
+	for (u32 i=0; i<nodes.size(); ++i)
+	{
+		const bool outside = !nodes[i]->getTransformedBoundingBox().intersectsWithBox(frustumBox);
+		culled += outside ? 1 : 0;
+		if (smgr->isCulled(nodes[i]) != outside)
+			result = false;
+	}
+	logTestString("%u of %u nodes culled\n", culled, nodes.size());
+	result &= (culled > 0 && culled < nodes.size());
+
+	camera->remove();
+	if (!result)
+		logTestString("Culling with the index failed\n");
+	return result;
+}
+
+void logTiming(IrrlichtDevice* device)
+{
+	ISceneManager* smgr = device->getSceneManager();
+	array<ISceneNode*> nodes;
+	addNodes(smgr, nodes, 10000);
+
+	u32 start = device->getTimer()->getRealTime();
+	u32 hits = 0;
+	for (u32 i=0; i<1000; ++i)
+	{
+		if (smgr->getSceneCollisionManager()->getSceneNodeFromRayBB(line3df(randomPosition(), randomPosition())))
+			++hits;
+	}
+	logTestString("1000 rays against %u nodes took %u ms, %u hits\n", nodes.size(),
+		device->getTimer()->getRealTime() - start, hits);
+
+	start = device->getTimer()->getRealTime();
+	u32 found = 0;
+	for (u32 i=0; i<1000; ++i)
+	{
+		array<ISceneNode*> inside;
+		smgr->getSceneNodesFromSphere(randomPosition(), 10.f, inside);
+		found += inside.size();
+	}
+	logTestString("1000 spheres against %u nodes took %u ms, %u nodes found\n", nodes.size(),
+		device->getTimer()->getRealTime() - start, found);
+}
+
+} // end anonymous namespace
+
+//! Tests the spatial index of the scene nodes against testing all nodes
+bool sceneNodeIndex(void)
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+
+	array<ISceneNode*> nodes;
+	addNodes(smgr, nodes, 500);
+
+	bool result = compareQueries(smgr);
+	result &= cullNodes(device, nodes);
+	result &= changeScene(smgr, nodes);
+	result &= pickNodes(smgr);
+
+	// nothing is left after clearing the scene
+	smgr->clear();
+	array<ISceneNode*> found;
+	smgr->getSceneNodesFromBox(aabbox3df(vector3df(-1000.f), vector3df(1000.f)), found);
+	result &= found.empty();
+
+	logTiming(device);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+	return result;
+}
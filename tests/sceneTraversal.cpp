@@ -0,0 +1,177 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+// stores its id when rendered
+class CRenderOrderNode : public ISceneNode
+{
+public:
+	CRenderOrderNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			array<s32>& rendered, E_SCENE_NODE_RENDER_PASS pass)
+		: ISceneNode(parent, mgr, id), Rendered(rendered), Pass(pass)
+	{
+		Box.reset(vector3df(-1.f, -1.f, -1.f));
+		Box.addInternalPoint(vector3df(1.f, 1.f, 1.f));
+	}
+
+	virtual void OnRegisterSceneNode()
+	{
+		if (IsVisible)
+			SceneManager->registerNodeForRendering(this, Pass);
+
+		ISceneNode::OnRegisterSceneNode();
+	}
+
+	virtual void render()
+	{
+		Rendered.push_back(getID());
+	}
+
+	virtual const aabbox3d<f32>& getBoundingBox() const
+	{
+		return Box;
+	}
+
+private:
+	aabbox3df Box;
+	array<s32>& Rendered;
+	E_SCENE_NODE_RENDER_PASS Pass;
+};
+
+void createScene(ISceneManager* smgr, array<s32>& rendered)
+{
+	smgr->addCameraSceneNode(0, vector3df(0, 0, 0), vector3df(0, 0, 100));
+
+	s32 id = 0;
+	for (s32 i = 0; i < 50; ++i)
+	{
+		ISceneNode* group = smgr->addEmptySceneNode();
+		group->setPosition(vector3df((f32)(i % 10) * 20.f - 90.f, 0.f, (f32)(i / 10) * 40.f - 80.f));
+
+		ISceneNodeAnimator* anim = smgr->createFlyCircleAnimator(group->getPosition(), 15.f, 0.002f);
+		group->addAnimator(anim);
+		anim->drop();
+
+		for (s32 j = 0; j < 20; ++j)
+		{
+			const E_SCENE_NODE_RENDER_PASS pass = (j % 3) ? ESNRP_SOLID : ESNRP_TRANSPARENT;
+			CRenderOrderNode* node = new CRenderOrderNode(group, smgr, id++, rendered, pass);
+			node->setPosition(vector3df((f32)(j % 5) * 4.f, (f32)(j / 5) * 4.f, 0.f));
+			node->drop();
+		}
+	}
+}
+
+// solid nodes without material front to back, then transparent nodes back to front
+bool checkRenderOrder(ISceneManager* smgr, const array<s32>& rendered)
+{
+	const vector3df camera = smgr->getActiveCamera()->getAbsolutePosition();
+	bool transparent = false;
+	u32 last = 0;
+
+	for (u32 i = 0; i < rendered.size(); ++i)
+	{
+		const ISceneNode* node = smgr->getSceneNodeFromId(rendered[i]);
+		core::inttofloat distance;
+		distance.f = node->getAbsolutePosition().getDistanceFromSQ(camera);
+
+		if ((rendered[i] % 20) % 3 == 0)
+		{
+			if (!transparent)
+			{
+				transparent = true;
+				last = 0xFFFFFFFF;
+			}
+			if (distance.u > last)
+				return false;
+			last = distance.u;
+		}
+		else
+		{
+			// the solid sort key only has the upper 16 bits of the distance
+			if (transparent || (distance.u >> 16) < last)
+				return false;
+			last = distance.u >> 16;
+		}
+	}
+	return true;
+}
+
+} // end anonymous namespace
+
+/** Tests the sorting of the render lists and that culling and animating on
+several threads renders the same nodes in the same order as without threads. */
+bool sceneTraversal(void)
+{
+	IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* serial = device->getSceneManager();
+	ISceneManager* parallel = serial->createNewSceneManager(false);
+
+	array<s32> serialRendered;
+	array<s32> parallelRendered;
+	createScene(serial, serialRendered);
+	createScene(parallel, parallelRendered);
+
+	parallel->getParameters()->setAttribute(PARALLEL_SCENE_THREADS, 4);
+	parallel->getParameters()->setAttribute(PARALLEL_SCENE_ANIMATION, true);
+
+	ITimer* timer = device->getTimer();
+	timer->stop();
+
+	bool result = true;
+	for (u32 frame = 0; frame < 4; ++frame)
+	{
+		timer->setTime(frame * 400);
+
+		serialRendered.set_used(0);
+		parallelRendered.set_used(0);
+		serial->drawAll();
+		parallel->drawAll();
+
+		// some nodes are behind the camera
+		if (serialRendered.empty() || serialRendered.size() >= 1000)
+		{
+			logTestString("Culling failed in frame %d, %d nodes rendered\n", frame, serialRendered.size());
+			result = false;
+		}
+
+		if (serialRendered != parallelRendered)
+		{
+			logTestString("Different render order in frame %d\n", frame);
+			result = false;
+		}
+
+		if (!checkRenderOrder(serial, serialRendered))
+		{
+			logTestString("Nodes not sorted by distance in frame %d\n", frame);
+			result = false;
+		}
+	}
+
+	// and back to one thread
+	parallel->getParameters()->setAttribute(PARALLEL_SCENE_THREADS, 0);
+	serialRendered.set_used(0);
+	parallelRendered.set_used(0);
+	serial->drawAll();
+	parallel->drawAll();
+	result &= (serialRendered == parallelRendered);
+
+	parallel->drop();
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,102 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+
+// animates the mesh and returns the translations of all joints
+void getJointPositions(scene::ISkinnedMesh* mesh, f32 frame, core::array<core::vector3df>& positions)
+{
+	mesh->animateMesh(frame, 1.f);
+	mesh->skinMesh();
+
+	positions.set_used(0);
+	for (u32 i=0; i<mesh->getAllJoints().size(); ++i)
+		positions.push_back(mesh->getAllJoints()[i]->GlobalAnimatedMatrix.getTranslation());
+}
+
+} // end anonymous namespace
+
+/** Tests that compressed animations of skinned meshes move the joints like
+the original keys, and that nodes sharing a mesh keep their own frames. */
+bool skinnedMeshCompression(void)
+{
+	IrrlichtDevice *device = createDevice(video::EDT_NULL, core::dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	scene::ISceneManager * smgr = device->getSceneManager();
+
+	scene::ISkinnedMesh* mesh = (scene::ISkinnedMesh*)smgr->getMesh("../media/ninja.b3d");
+	if (!mesh)
+	{
+		logTestString("Could not load ninja.\n");
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	bool result = true;
+
+	// nodes sharing the mesh at different frames get the boxes of their frames
+	scene::IAnimatedMeshSceneNode* node1 = smgr->addAnimatedMeshSceneNode(mesh);
+	scene::IAnimatedMeshSceneNode* node2 = smgr->addAnimatedMeshSceneNode(mesh);
+	node1->setAnimationSpeed(0.f);
+	node2->setAnimationSpeed(0.f);
+	node1->setCurrentFrame(10.f);
+	node2->setCurrentFrame(62.f);
+	smgr->drawAll();
+	mesh->animateMesh(10.f, 1.f);
+	mesh->skinMesh();
+	result &= node1->getBoundingBox().MaxEdge.equals(mesh->getBoundingBox().MaxEdge);
+	mesh->animateMesh(62.f, 1.f);
+	mesh->skinMesh();
+	result &= node2->getBoundingBox().MaxEdge.equals(mesh->getBoundingBox().MaxEdge);
+	if (!result)
+		logTestString("Nodes sharing a mesh got wrong boxes.\n");
+
+	// compared at the samples, as the animation jumps between the clips of the ninja
+	const f32 endFrame = (f32)mesh->getFrameCount()-1.f;
+	core::array< core::array<core::vector3df> > keyed;
+	for (f32 frame=0.f; frame<=endFrame; frame+=1.f)
+	{
+		keyed.push_back(core::array<core::vector3df>());
+		getJointPositions(mesh, frame, keyed.getLast());
+	}
+
+	mesh->compressAnimation(1.f);
+
+	const core::aabbox3df box = mesh->getBoundingBox();
+	const f32 tolerance = box.getExtent().getLength() * 0.001f;
+
+	core::array<core::vector3df> compressed;
+	f32 maxError = 0.f;
+	u32 n = 0;
+	for (f32 frame=0.f; frame<=endFrame; frame+=1.f, ++n)
+	{
+		getJointPositions(mesh, frame, compressed);
+		for (u32 i=0; i<compressed.size(); ++i)
+			maxError = core::max_(maxError, (f32)compressed[i].getDistanceFrom(keyed[n][i]));
+	}
+	logTestString("Largest joint distance after compression %f, tolerance %f\n", maxError, tolerance);
+	if (maxError > tolerance)
+		result = false;
+
+	// the keys are gone, so compressing again is refused
+	logTestString("Ignore warning in log, this is intended.\n");
+	mesh->compressAnimation(1.f);
+	getJointPositions(mesh, 150.f, compressed);
+	result &= compressed[1].equals(keyed[150][1], tolerance);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,70 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+
+/** Tests that nodes sharing a skinned mesh get the same bounding boxes when
+animated on several threads as when animated one after the other. */
+bool skinnedMeshThreads(void)
+{
+	IrrlichtDevice *device = createDevice(video::EDT_NULL, core::dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	scene::ISceneManager * smgr = device->getSceneManager();
+
+	scene::ISkinnedMesh* mesh = (scene::ISkinnedMesh*)smgr->getMesh("../media/ninja.b3d");
+	if (!mesh)
+	{
+		logTestString("Could not load ninja.\n");
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	smgr->getParameters()->setAttribute(scene::PARALLEL_SCENE_THREADS, 4);
+	smgr->getParameters()->setAttribute(scene::PARALLEL_SCENE_ANIMATION, true);
+
+	// the nodes are behind the camera, so only OnAnimate updates their boxes
+	smgr->addCameraSceneNode(0, core::vector3df(0, 0, 100), core::vector3df(0, 0, 200));
+
+	core::array<scene::IAnimatedMeshSceneNode*> nodes;
+	for (u32 i=0; i<64; ++i)
+	{
+		nodes.push_back(smgr->addAnimatedMeshSceneNode(mesh));
+		nodes[i]->setAnimationSpeed(0.f);
+		nodes[i]->setCurrentFrame((f32)(i*3));
+	}
+
+	bool result = true;
+	for (u32 frame=0; frame<8; ++frame)
+	{
+		smgr->drawAll();
+
+		for (u32 i=0; i<nodes.size(); ++i)
+		{
+			mesh->animateMesh(nodes[i]->getFrameNr(), 1.f);
+			mesh->skinMesh();
+			const core::aabbox3df& box = nodes[i]->getBoundingBox();
+			if (!box.MinEdge.equals(mesh->getBoundingBox().MinEdge) ||
+				!box.MaxEdge.equals(mesh->getBoundingBox().MaxEdge))
+			{
+				logTestString("Wrong bounding box of node %d in frame %d.\n", i, frame);
+				result = false;
+			}
+		}
+
+		for (u32 i=0; i<nodes.size(); ++i)
+			nodes[i]->setCurrentFrame(nodes[i]->getFrameNr()+3.f);
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,128 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace video;
+
+namespace
+{
+
+// reads a texel of a locked texture
+SColor getTexel(const ITexture* texture, const u8* data, u32 x, u32 y)
+{
+	const u8* line = data + y * texture->getPitch();
+	if (texture->getColorFormat() == ECF_A8R8G8B8)
+		return SColor(((const u32*)line)[x]);
+	return SColor(A1R5G5B5toA8R8G8B8(((const u16*)line)[x]));
+}
+
+// largest difference of a color channel in a mip map level of two textures
+u32 compareLevel(ITexture* a, ITexture* b, u32 level)
+{
+	const u8* dataA = (const u8*)a->lock(ETLM_READ_ONLY, level);
+	const u8* dataB = (const u8*)b->lock(ETLM_READ_ONLY, level);
+
+	u32 difference = 0;
+	if (!dataA || !dataB || a->getSize() != b->getSize())
+		difference = 256;
+	else
+	{
+		for (u32 y = 0; y < a->getSize().Height; ++y)
+		{
+			for (u32 x = 0; x < a->getSize().Width; ++x)
+			{
+				const SColor ca = getTexel(a, dataA, x, y);
+				const SColor cb = getTexel(b, dataB, x, y);
+				difference = max_(difference, (u32)abs_((s32)ca.getAlpha() - (s32)cb.getAlpha()));
+				difference = max_(difference, (u32)abs_((s32)ca.getRed() - (s32)cb.getRed()));
+				difference = max_(difference, (u32)abs_((s32)ca.getGreen() - (s32)cb.getGreen()));
+				difference = max_(difference, (u32)abs_((s32)ca.getBlue() - (s32)cb.getBlue()));
+			}
+		}
+	}
+
+	a->unlock();
+	b->unlock();
+	return difference;
+}
+
+IImage* createTestImage(IVideoDriver* driver, bool translucent)
+{
+	IImage* image = driver->createImage(ECF_A8R8G8B8, dimension2du(64, 64));
+	for (u32 y = 0; y < 64; ++y)
+	{
+		for (u32 x = 0; x < 64; ++x)
+			image->setPixel(x, y, SColor(translucent ? x * 4 : 255, x * 2, y * 2, x + y));
+	}
+	return image;
+}
+
+} // end anonymous namespace
+
+/** Tests that textures compressed at load time are decoded by the software
+driver to nearly the same texels as the uncompressed textures. */
+bool textureCompression(void)
+{
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_CONSOLE;
+	params.DriverType = EDT_BURNINGSVIDEO;
+	params.WindowSize = dimension2du(160, 120);
+
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return true; // software driver not compiled in
+
+	IVideoDriver* driver = device->getVideoDriver();
+
+	bool result = driver->queryFeature(EVDF_TEXTURE_COMPRESSED_DXT);
+
+	for (u32 i = 0; i < 4; ++i)
+	{
+		const bool translucent = (i & 1) != 0;
+		const bool mipMaps = (i & 2) != 0;
+
+		IImage* image = createTestImage(driver, translucent);
+		driver->setTextureCreationFlag(ETCF_CREATE_MIP_MAPS, mipMaps);
+
+		driver->setTextureCreationFlag(ETCF_ALLOW_COMPRESSION, false);
+		ITexture* plain = driver->addTexture("plain", image);
+		driver->setTextureCreationFlag(ETCF_ALLOW_COMPRESSION, true);
+		ITexture* compressed = driver->addTexture("compressed", image);
+		image->drop();
+
+		if (!plain || !compressed)
+		{
+			logTestString("Could not create textures\n");
+			result = false;
+			break;
+		}
+
+		// smaller levels first, which doesn't need the largest level
+		for (s32 level = mipMaps ? 2 : 0; level >= 0; --level)
+		{
+			// lossy, but close to the image
+			const u32 difference = compareLevel(plain, compressed, level);
+			if ((level == 0 && difference == 0) || difference > 24)
+			{
+				logTestString("Texel difference %d in level %d, translucent %d, mip maps %d\n",
+					difference, level, translucent, mipMaps);
+				result = false;
+			}
+		}
+
+		driver->removeTexture(plain);
+		driver->removeTexture(compressed);
+	}
+
+	driver->setTextureCreationFlag(ETCF_ALLOW_COMPRESSION, false);
+	driver->setTextureCreationFlag(ETCF_CREATE_MIP_MAPS, true);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,277 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+// the quadratic search createMeshWelded did before, to compare with
+void referenceWeld(const SMeshBuffer* mb, f32 tolerance, array<u16>& redirects, u32& vertexCount)
+{
+	const array<video::S3DVertex>& v = mb->Vertices;
+	redirects.set_used(v.size());
+	vertexCount = 0;
+	for (u32 i=0; i < v.size(); ++i)
+	{
+		bool found = false;
+		for (u32 j=0; j < i; ++j)
+		{
+			if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
+				 v[i].Normal.equals( v[j].Normal, tolerance) &&
+				 v[i].TCoords.equals( v[j].TCoords ) &&
+				(v[i].Color == v[j].Color) )
+			{
+				redirects[i] = redirects[j];
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+			redirects[i] = vertexCount++;
+	}
+}
+
+// the welded mesh must have the vertices and triangles of the reference
+bool sameAsReference(IMeshManipulator* manipulator, SMesh* mesh, f32 tolerance)
+{
+	const SMeshBuffer* mb = static_cast<SMeshBuffer*>(mesh->getMeshBuffer(0));
+	array<u16> redirects;
+	u32 vertexCount;
+	referenceWeld(mb, tolerance, redirects, vertexCount);
+
+	array<u16> indices;
+	for (u32 i=0; i < mb->Indices.size(); i+=3)
+	{
+		const u16 a = redirects[mb->Indices[i]];
+		const u16 b = redirects[mb->Indices[i+1]];
+		const u16 c = redirects[mb->Indices[i+2]];
+		if (a != b && b != c && a != c)
+		{
+			indices.push_back(a);
+			indices.push_back(b);
+			indices.push_back(c);
+		}
+	}
+
+	IMesh* welded = manipulator->createMeshWelded(mesh, tolerance);
+	const IMeshBuffer* wb = welded->getMeshBuffer(0);
+	bool result = (wb->getVertexCount() == vertexCount) && (wb->getIndexCount() == indices.size());
+	for (u32 i=0; result && i < indices.size(); ++i)
+		result = (wb->getIndices()[i] == indices[i]);
+	// the welded vertices are the first of each group
+	const video::S3DVertex* vertices = (const video::S3DVertex*)wb->getVertices();
+	for (u32 i=0, next=0; result && i < mb->Vertices.size(); ++i)
+	{
+		if (redirects[i] == next)
+			result = (memcmp(&vertices[next++], &mb->Vertices[i], sizeof(video::S3DVertex)) == 0);
+	}
+	welded->drop();
+
+	if (!result)
+		logTestString("Welding with tolerance %f differs from the reference\n", tolerance);
+	return result;
+}
+
+// a grid of size*size quads with the corners of each triangle as vertices of their own
+SMesh* createGrid(u32 size, f32 jitter)
+{
+	SMeshBuffer* mb = new SMeshBuffer();
+	u32 seed = 1;
+	for (u32 y=0; y < size; ++y)
+	{
+		for (u32 x=0; x < size; ++x)
+		{
+			const u32 corners[6][2] = { {x,y}, {x,y+1}, {x+1,y}, {x+1,y}, {x,y+1}, {x+1,y+1} };
+			for (u32 i=0; i < 6; ++i)
+			{
+				seed = seed * 1103515245u + 12345u;
+				const f32 offset = jitter * ((f32)((seed >> 16) & 0xff) / 255.f - 0.5f);
+				mb->Indices.push_back(mb->Vertices.size());
+				mb->Vertices.push_back(video::S3DVertex(
+					corners[i][0] + offset, 0.f, corners[i][1] * 1000.f, 0.f, 1.f, 0.f,
+					video::SColor(0xffffffff), (f32)corners[i][0], (f32)corners[i][1]));
+			}
+		}
+	}
+	mb->recalculateBoundingBox();
+
+	SMesh* mesh = new SMesh();
+	mesh->addMeshBuffer(mb);
+	mesh->recalculateBoundingBox();
+	mb->drop();
+	return mesh;
+}
+
+bool weldGrid(IMeshManipulator* manipulator)
+{
+	bool result = true;
+
+	// exact copies
+	SMesh* mesh = createGrid(20, 0.f);
+	result &= sameAsReference(manipulator, mesh, 0.f);
+	result &= sameAsReference(manipulator, mesh, ROUNDING_ERROR_f32);
+	IMesh* welded = manipulator->createMeshWelded(mesh);
+	result &= (welded->getMeshBuffer(0)->getVertexCount() == 21*21);
+	welded->drop();
+	mesh->drop();
+
+	// copies which differ by about the tolerance, some are welded and some aren't
+	mesh = createGrid(20, 0.02f);
+	result &= sameAsReference(manipulator, mesh, 0.005f);
+	result &= sameAsReference(manipulator, mesh, 0.01f);
+	result &= sameAsReference(manipulator, mesh, 0.05f);
+	welded = manipulator->createMeshWelded(mesh, 0.05f);
+	result &= (welded->getMeshBuffer(0)->getVertexCount() == 21*21);
+	welded->drop();
+	mesh->drop();
+
+	if (!result)
+		logTestString("Welding a grid failed\n");
+	return result;
+}
+
+// equality within tolerance isn't transitive, vertices chain to the first one
+bool weldChain(IMeshManipulator* manipulator)
+{
+	SMeshBuffer* mb = new SMeshBuffer();
+	const f32 x[4] = { 0.f, 0.6f, 1.2f, -0.f };
+	for (u32 i=0; i < 4; ++i)
+		mb->Vertices.push_back(video::S3DVertex(x[i], 0, 0, 0, 1, 0, video::SColor(0xffffffff), 0, 0));
+	// the second triangle is degenerate after welding
+	const u16 indices[6] = { 0, 1, 2, 0, 3, 2 };
+	for (u32 i=0; i < 6; ++i)
+		mb->Indices.push_back(indices[i]);
+	SMesh* mesh = new SMesh();
+	mesh->addMeshBuffer(mb);
+	mb->drop();
+
+	bool result = sameAsReference(manipulator, mesh, 1.f);
+	result &= sameAsReference(manipulator, mesh, 0.f);
+
+	IMesh* welded = manipulator->createMeshWelded(mesh, 1.f);
+	result &= (welded->getMeshBuffer(0)->getVertexCount() == 1);
+	result &= (welded->getMeshBuffer(0)->getIndexCount() == 0);
+	welded->drop();
+
+	// -0 and 0 are the same
+	welded = manipulator->createMeshWelded(mesh, 0.f);
+	result &= (welded->getMeshBuffer(0)->getVertexCount() == 3);
+	result &= (welded->getMeshBuffer(0)->getIndexCount() == 3);
+	welded->drop();
+	mesh->drop();
+
+	if (!result)
+		logTestString("Welding a chain of vertices failed\n");
+	return result;
+}
+
+bool weldLarge(IrrlichtDevice* device, IMeshManipulator* manipulator)
+{
+	// 60000 vertices, the most 16 bit indices allow with a bit of room
+	SMesh* mesh = createGrid(100, 0.f);
+	const u32 start = device->getTimer()->getRealTime();
+	IMesh* welded = manipulator->createMeshWelded(mesh);
+	const u32 time = device->getTimer()->getRealTime() - start;
+	const bool result = (welded->getMeshBuffer(0)->getVertexCount() == 101*101) &&
+		(welded->getMeshBuffer(0)->getIndexCount() == 60000);
+	logTestString("Welded %u vertices to %u in %u ms\n", mesh->getMeshBuffer(0)->getVertexCount(),
+		welded->getMeshBuffer(0)->getVertexCount(), time);
+	welded->drop();
+	mesh->drop();
+
+	if (!result)
+		logTestString("Welding a large grid failed\n");
+	return result;
+}
+
+bool writeText(io::IFileSystem* fs, const io::path& name, const c8* text)
+{
+	io::IWriteFile* file = fs->createAndWriteFile(name);
+	if (!file)
+		return false;
+	file->write(text, strlen(text));
+	file->drop();
+	return true;
+}
+
+bool checkCounts(ISceneManager* smgr, const io::path& name, u32 vertexCount, u32 indexCount)
+{
+	IAnimatedMesh* mesh = smgr->getMesh(name);
+	remove(name.c_str());
+	if (!mesh)
+	{
+		logTestString("Can't load %s\n", name.c_str());
+		return false;
+	}
+	const IMeshBuffer* mb = mesh->getMesh(0)->getMeshBuffer(0);
+	const bool result = (mb->getVertexCount() == vertexCount) && (mb->getIndexCount() == indexCount);
+	if (!result)
+		logTestString("%s has %u vertices and %u indices instead of %u and %u\n", name.c_str(),
+			mb->getVertexCount(), mb->getIndexCount(), vertexCount, indexCount);
+	smgr->getMeshCache()->removeMesh(mesh);
+	return result;
+}
+
+// loaders share the corners of neighbouring faces
+bool loaders(ISceneManager* smgr)
+{
+	io::IFileSystem* fs = smgr->getFileSystem();
+	bool result = true;
+
+	// two triangles, one quad
+	result &= writeText(fs, "vertexWelding.obj",
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvn 0 0 1\n"
+		"f 1//1 2//1 3//1\nf 1//1 3//1 4//1\n");
+	result &= checkCounts(smgr, "vertexWelding.obj", 4, 6);
+
+	// the corners of each face as vertices of their own
+	result &= writeText(fs, "vertexWelding.ply",
+		"ply\nformat ascii 1.0\nelement vertex 6\nproperty float x\nproperty float y\nproperty float z\n"
+		"element face 2\nproperty list uchar int vertex_indices\nend_header\n"
+		"0 0 0\n1 0 0\n1 1 0\n0 0 0\n1 1 0\n0 1 0\n3 0 1 2\n3 3 4 5\n");
+	result &= checkCounts(smgr, "vertexWelding.ply", 4, 6);
+
+	// six sides of two triangles each, the triangles of a side share two corners
+	IMesh* cube = smgr->getGeometryCreator()->createCubeMesh();
+	IMeshWriter* writer = smgr->createMeshWriter(EMWT_STL);
+	io::IWriteFile* file = fs->createAndWriteFile("vertexWelding.stl");
+	result &= writer && file && writer->writeMesh(file, cube);
+	if (file)
+		file->drop();
+	if (writer)
+		writer->drop();
+	cube->drop();
+	result &= checkCounts(smgr, "vertexWelding.stl", 24, 36);
+
+	if (!result)
+		logTestString("Loading meshes with shared vertices failed\n");
+	return result;
+}
+
+} // end anonymous namespace
+
+//! Tests welding of vertices and the loaders which share equal vertices
+bool vertexWelding(void)
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	IMeshManipulator* manipulator = smgr->getMeshManipulator();
+
+	bool result = weldGrid(manipulator);
+	result &= weldChain(manipulator);
+	result &= weldLarge(device, manipulator);
+	result &= loaders(smgr);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+	return result;
+}
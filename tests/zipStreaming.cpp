@@ -0,0 +1,206 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace io;
+
+namespace
+{
+
+// reads a file completely with read()
+core::array<c8> readAll(IReadFile* file)
+{
+	core::array<c8> data;
+	data.set_used(file->getSize());
+	file->seek(0);
+	if (file->getSize() && file->read(data.pointer(), file->getSize()) != (size_t)file->getSize())
+		data.clear();
+	return data;
+}
+
+// opens a file inflated on open and inflated while reading, both must read the same
+bool compareStreamed(IFileSystem* fs, const io::path& name)
+{
+	fs->setStreamingThreshold(0);
+	IReadFile* file = fs->createAndOpenFile(name);
+	fs->setStreamingThreshold(1024);
+	IReadFile* streamed = fs->createAndOpenFile(name);
+	fs->setStreamingThreshold(0);
+	if (!file || !streamed)
+	{
+		logTestString("Could not open %s\n", name.c_str());
+		if (file)
+			file->drop();
+		if (streamed)
+			streamed->drop();
+		return false;
+	}
+
+	const core::array<c8> expected = readAll(file);
+	const long size = streamed->getSize();
+	bool result = size == file->getSize() && size > 1024 && !streamed->getData();
+
+	// reads in odd sized pieces
+	core::array<c8> data;
+	data.set_used(size);
+	long pos = 0;
+	while (result && pos < size)
+	{
+		const size_t read = streamed->read(data.pointer() + pos, core::min_(7777L, size - pos));
+		result &= read > 0 && streamed->getPos() == pos + (long)read;
+		pos += read;
+	}
+	result &= data == expected;
+
+	// seeks back and forth, backwards starts from a saved state of the inflater
+	c8 piece[1000];
+	for (u32 i = 0; i < 50 && result; ++i)
+	{
+		const long start = (rand() * (RAND_MAX + 1L) + rand()) % (size - 1000);
+		result &= streamed->seek(start);
+		result &= streamed->read(piece, 1000) == 1000;
+		result &= memcmp(piece, expected.const_pointer() + start, 1000) == 0;
+	}
+
+	// reads at the end stop at the end, seeks beyond fail
+	result &= streamed->seek(size - 2);
+	result &= streamed->read(piece, 4) == 2 && piece[1] == expected.getLast();
+	result &= streamed->read(piece, 4) == 0;
+	result &= !streamed->seek(size + 1);
+	result &= streamed->seek(-size, true) && streamed->getPos() == 0;
+
+	if (!result)
+		logTestString("Streamed %s differs from the inflated file\n", name.c_str());
+
+	file->drop();
+	streamed->drop();
+	return result;
+}
+
+// opens files at once and one by one, the contents must be the same
+bool compareBatch(IFileSystem* fs, const core::array<io::path>& names)
+{
+	core::array<IReadFile*> files;
+	const u32 count = fs->createAndOpenFiles(names, files);
+	bool result = files.size() == names.size();
+
+	u32 opened = 0;
+	for (u32 i = 0; i < files.size(); ++i)
+	{
+		IReadFile* file = fs->createAndOpenFile(names[i]);
+		if (!file || !files[i])
+		{
+			if (file || files[i])
+			{
+				logTestString("%s was opened only one way\n", names[i].c_str());
+				result = false;
+			}
+		}
+		else
+		{
+			++opened;
+			if (readAll(files[i]) != readAll(file) || files[i]->getFileName() != file->getFileName())
+			{
+				logTestString("%s differs when opened with others\n", names[i].c_str());
+				result = false;
+			}
+		}
+
+		if (file)
+			file->drop();
+		if (files[i])
+			files[i]->drop();
+	}
+
+	return result && count == opened;
+}
+
+} // end anonymous namespace
+
+/** Tests deflated archive files which are inflated while they are read, and
+opening several archive files at once, which decompresses them in parallel. */
+bool zipStreaming(void)
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IFileSystem* fs = device->getFileSystem();
+	srand(5);
+
+	bool result = fs->getStreamingThreshold() == 0;
+	result &= fs->addFileArchive("media/streaming.zip", true, false);
+	result &= fs->addFileArchive("media/streaming.txt.gz", true, false);
+	result &= fs->addFileArchive("media/Monty.zip", true, false);
+	result &= fs->addFileArchive("media/lzmadata.zip", true, false);
+	result &= fs->addFileArchive("media/file_with_path.zip", true, false);
+
+	result &= compareStreamed(fs, "streaming/large.txt");
+	result &= compareStreamed(fs, "streaming.txt");
+
+	// small files are still inflated when they are opened
+	fs->setStreamingThreshold(1024 * 1024);
+	IReadFile* file = fs->createAndOpenFile("streaming/small.txt");
+	result &= file && file->getData();
+	if (file)
+		file->drop();
+
+	// deflated, lzma, stored, streamed, missing and plain files together
+	core::array<io::path> names;
+	names.push_back("monty/License.txt");
+	names.push_back("tahoma10_.xml");
+	names.push_back("monty/materials.dat");
+	names.push_back("tahoma10_0.png");
+	names.push_back("mypath/myfile.txt");
+	names.push_back("streaming/large.txt");
+	names.push_back("missing.txt");
+	names.push_back("tahoma10_1.png");
+	names.push_back("monty/Monty.kart");
+	names.push_back("media/Monty.zip");
+	result &= compareBatch(fs, names);
+	fs->setStreamingThreshold(0);
+	result &= compareBatch(fs, names);
+
+	// speed of opening the lzma files one by one and together
+	ITimer* timer = device->getTimer();
+	core::array<io::path> lzma;
+	for (u32 i = 0; i < 8; ++i)
+	{
+		lzma.push_back("tahoma10_.xml");
+		lzma.push_back("tahoma10_0.png");
+		lzma.push_back("tahoma10_1.png");
+	}
+
+	u32 start = timer->getRealTime();
+	for (u32 i = 0; i < lzma.size(); ++i)
+	{
+		file = fs->createAndOpenFile(lzma[i]);
+		if (file)
+			file->drop();
+	}
+	const u32 singleTime = timer->getRealTime() - start;
+
+	core::array<IReadFile*> files;
+	start = timer->getRealTime();
+	result &= fs->createAndOpenFiles(lzma, files) == lzma.size();
+	const u32 batchTime = timer->getRealTime() - start;
+	for (u32 i = 0; i < files.size(); ++i)
+	{
+		if (files[i])
+			files[i]->drop();
+	}
+	logTestString("%d lzma files: one by one %d ms, together %d ms\n", lzma.size(), singleTime, batchTime);
+
+	while (fs->getFileArchiveCount())
+		fs->removeFileArchive(fs->getFileArchiveCount() - 1);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -16,9 +16,68 @@ using namespace gui;
 void usage(const char* name)
 {
 	std::cerr << "Usage: " << name << " [options] <srcFile> <destFile>" << std::endl;
+	std::cerr << "   or: " << name << " [options] --batch <destDir> <srcFile>..." << std::endl;
 	std::cerr << "  where options are" << std::endl;
 	std::cerr << " --createTangents: convert to tangents mesh is possible." << std::endl;
-	std::cerr << " --format=[irrmesh|collada|stl|obj|ply]: Choose target format" << std::endl;
+	std::cerr << " --format=[irrmesh|irrbin|collada|stl|obj|ply]: Choose target format" << std::endl;
+	std::cerr << " --batch: convert all source files into destDir, named like the source" << std::endl;
+	std::cerr << "          files with the extension of the target format." << std::endl;
+}
+
+const c8* getExtension(EMESH_WRITER_TYPE type)
+{
+	switch (type)
+	{
+		case EMWT_IRR_BINARY_MESH: return "irrbin";
+		case EMWT_COLLADA: return "dae";
+		case EMWT_STL: return "stl";
+		case EMWT_OBJ: return "obj";
+		case EMWT_PLY: return "ply";
+		default: return "irrmesh";
+	}
+}
+
+bool convert(IrrlichtDevice* device, const c8* src, const io::path& dest, EMESH_WRITER_TYPE type, bool createTangents)
+{
+	ISceneManager* smgr = device->getSceneManager();
+
+	std::cout << "Converting " << src << " to " << dest.c_str() << std::endl;
+	IAnimatedMesh* animatedMesh = smgr->getMesh(src);
+	if (!animatedMesh)
+	{
+		std::cerr << "Could not load " << src << std::endl;
+		return false;
+	}
+
+	// the binary format keeps the joints and animation of skinned meshes,
+	// the other formats get the first frame
+	IMesh* mesh = animatedMesh;
+	if (animatedMesh->getMeshType() != EAMT_SKINNED || type != EMWT_IRR_BINARY_MESH)
+		mesh = animatedMesh->getMesh(0);
+
+	IMesh* tangentMesh = 0;
+	if (createTangents && mesh != animatedMesh)
+	{
+		tangentMesh = smgr->getMeshManipulator()->createMeshWithTangents(mesh);
+		mesh = tangentMesh;
+	}
+
+	IMeshWriter* mw = smgr->createMeshWriter(type);
+	IWriteFile* file = device->getFileSystem()->createAndWriteFile(dest);
+	bool result = mw && file && mw->writeMesh(file, mesh);
+	if (!result)
+		std::cerr << "Could not write " << dest.c_str() << std::endl;
+
+	if (file)
+		file->drop();
+	if (mw)
+		mw->drop();
+	if (tangentMesh)
+		tangentMesh->drop();
+
+	// batches can be large, keep only one mesh in memory
+	smgr->getMeshCache()->removeMesh(animatedMesh);
+	return result;
 }
 
 int main(int argc, char* argv[])
@@ -36,9 +95,10 @@ int main(int argc, char* argv[])
 	device->setWindowCaption(L"Mesh Converter");
 
 	scene::EMESH_WRITER_TYPE type = EMWT_IRR_MESH;
-	u32 i=1;
+	s32 i=1;
 	bool createTangents=false;
-	while (argv[i][0]=='-')
+	bool batch=false;
+	while (i<argc && argv[i][0]=='-')
 	{
 		core::stringc format = argv[i];
 		if (format.size() > 3)
@@ -54,12 +114,17 @@ int main(int argc, char* argv[])
 					type = EMWT_OBJ;
 				else if (format=="ply")
 					type = EMWT_PLY;
+				else if (format=="irrbin")
+					type = EMWT_IRR_BINARY_MESH;
 				else
 					type = EMWT_IRR_MESH;
 			}
 			else
 			if (format =="--createTangents")
 				createTangents=true;
+			else
+			if (format =="--batch")
+				batch=true;
 		}
 		else
 		if (format=="--")
@@ -70,39 +135,35 @@ int main(int argc, char* argv[])
 		++i;
 	}
 
-	const s32 srcmesh = i;
-	const s32 destmesh = i+1;
-
-	--argc;
-	if ((argc<srcmesh) || (argc<destmesh))
+	if (argc < i+2)
 	{
 		std::cerr << "Not enough files given." << std::endl;
 		usage(argv[0]);
+		device->drop();
 		return 1;
 	}
 
-	createTangents = createTangents && (type==EMWT_IRR_MESH);
-	std::cout << "Converting " << argv[srcmesh] << " to " << argv[destmesh] << std::endl;
-	IMesh* mesh = device->getSceneManager()->getMesh(argv[srcmesh])->getMesh(0);
-	if (!mesh)
-	{
-		std::cerr << "Could not load " << argv[srcmesh] << std::endl;
-		return 1;
-	}
-	if (createTangents)
+	createTangents = createTangents && (type==EMWT_IRR_MESH || type==EMWT_IRR_BINARY_MESH);
+
+	u32 failed = 0;
+	if (batch)
 	{
-		IMesh* tmp = device->getSceneManager()->getMeshManipulator()->createMeshWithTangents(mesh);
-		mesh->drop();
-		mesh=tmp;
+		const io::path destDir = argv[i];
+		for (s32 src=i+1; src<argc; ++src)
+		{
+			io::path dest = destDir;
+			dest += "/";
+			dest += device->getFileSystem()->getFileBasename(argv[src], false);
+			dest += ".";
+			dest += getExtension(type);
+			if (!convert(device, argv[src], dest, type, createTangents))
+				++failed;
+		}
 	}
-	IMeshWriter* mw = device->getSceneManager()->createMeshWriter(type);
-	IWriteFile* file = device->getFileSystem()->createAndWriteFile(argv[destmesh]);
-	mw->writeMesh(file, mesh);
+	else if (!convert(device, argv[i], argv[i+1], type, createTangents))
+		++failed;
 
-	file->drop();
-	mw->drop();
 	device->drop();
 
-	return 0;
+	return failed ? 1 : 0;
 }
-